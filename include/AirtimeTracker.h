@@ -0,0 +1,39 @@
+#ifndef AIRTIME_TRACKER_H
+#define AIRTIME_TRACKER_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+// Sliding-window transmit airtime accounting for a duty-cycle limited interface.
+// The window is split into fixed buckets so the tracker costs a few dozen bytes
+// regardless of how many frames are sent.
+class AirtimeTracker {
+public:
+    static const uint8_t BUCKET_COUNT = 12;
+
+    AirtimeTracker(float budgetPercent, unsigned long windowMs);
+
+    // LoRa time-on-air in ms (Semtech SX127x datasheet formula, explicit header, CRC on)
+    static uint32_t loraTimeOnAirMs(size_t payloadLen, uint8_t spreadingFactor, float bandwidthKHz,
+                                    uint8_t codingRate, uint16_t preambleLength);
+
+    // True if airtimeMs more would keep usage within budget over the window
+    bool canTransmit(uint32_t airtimeMs, unsigned long now = millis());
+    void record(uint32_t airtimeMs, unsigned long now = millis());
+
+    uint32_t getUsedMs(unsigned long now = millis());
+    uint32_t getBudgetMs() const { return _budgetMs; }
+    float getUtilizationPercent(unsigned long now = millis()); // Used share of the budget
+
+private:
+    void advance(unsigned long now); // Expire buckets that fell out of the window
+
+    uint32_t _budgetMs;
+    unsigned long _bucketMs;
+    unsigned long _bucketStart;
+    uint8_t _current;
+    uint32_t _buckets[BUCKET_COUNT];
+};
+
+#endif // AIRTIME_TRACKER_H
@@ -0,0 +1,60 @@
+#ifndef ANNOUNCE_QUEUE_H
+#define ANNOUNCE_QUEUE_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include <vector>
+#include "Config.h"
+
+// Outbound announce scheduler. Each interface drains the queue at its own pace:
+// after sending an announce taking t ms on air, that interface may not send
+// another one for t * 100 / ANNOUNCE_CAP_PERCENT ms. Among ready entries the
+// lowest hop count goes first. Packet bytes are stored once and shared by all
+// interfaces through a pending bitmask, which keeps RAM use flat per interface.
+class AnnounceQueue {
+public:
+    static uint32_t interfaceBit(InterfaceType ifType) { return 1u << static_cast<uint8_t>(ifType); }
+
+    explicit AnnounceQueue(size_t maxEntries = ANNOUNCE_QUEUE_MAX);
+
+    // Queue an announce for every interface in interfaceMask, released after delayMs.
+    // A queued announce for the same destination is replaced (the new one is fresher).
+    // Returns false if the queue is full of better (fewer-hop) announces.
+    bool enqueue(const uint8_t* packet, size_t packetLen, const uint8_t* announcedAddr, uint8_t hops,
+                 uint32_t interfaceMask, unsigned long delayMs, unsigned long now = millis());
+
+    // Take the best ready announce for ifType if the interface's announce budget allows
+    bool next(InterfaceType ifType, std::vector<uint8_t>& packet, unsigned long now = millis());
+    // Charge an announce transmission against ifType's announce budget
+    void recordTransmit(InterfaceType ifType, uint32_t txTimeMs, unsigned long now = millis());
+
+    // Drop entries older than ANNOUNCE_QUEUE_MAX_AGE_MS
+    void expire(unsigned long now = millis());
+    // Time until next() could return something for one of the interfaces in mask (ULONG_MAX if never)
+    unsigned long msUntilReady(uint32_t interfaceMask, unsigned long now = millis()) const;
+
+    size_t size() const { return _entries.size(); }
+    uint32_t getSuppressedCount() const { return _suppressed; }
+    uint32_t getDroppedCount() const { return _dropped; }
+
+private:
+    struct Entry {
+        uint8_t announced[RNS_ADDRESS_SIZE]; // Destination the announce is for
+        uint8_t hops;
+        uint32_t pendingMask;     // Interfaces still to send on
+        unsigned long queuedAt;
+        unsigned long releaseAt;  // Randomized rebroadcast delay
+        std::vector<uint8_t> packet;
+    };
+    static const uint8_t INTERFACE_SLOTS = 16;
+
+    size_t _maxEntries;
+    std::vector<Entry> _entries;
+    // Per-interface announce budget: quiet for _holdoffMs after the last send
+    unsigned long _lastTxAt[INTERFACE_SLOTS];
+    unsigned long _holdoffMs[INTERFACE_SLOTS];
+    uint32_t _suppressed;
+    uint32_t _dropped;
+};
+
+#endif // ANNOUNCE_QUEUE_H
@@ -0,0 +1,140 @@
+#ifndef ANNOUNCE_VALIDATOR_H
+#define ANNOUNCE_VALIDATOR_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Config.h"
+#include "Identity.h"
+#include "ReticulumPacket.h" // For RnsPacketInfo
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#endif
+
+// Checks the Ed25519 signature on official-format announces:
+//   [public key 64][name hash 10][random hash 10][ratchet 32, if context flag][signature 64][app data]
+// signed over destination hash + public key + name hash + random hash + ratchet + app data.
+//
+// An announce heard over several interfaces or from several neighbours is byte for
+// byte the same signed data, so results are cached on a digest of the signed data
+// and signature, and each announce is verified once. A copy with anything changed
+// (app data, ratchet, key or signature) has another digest: it cannot ride on the
+// genuine announce's result, and a forgery heard first cannot block it.
+//
+// verifyDeferred() hands the check to a low-priority FreeRTOS task so the main loop
+// is not held up for the several milliseconds an Ed25519 check takes, and collect()
+// reports the verdicts. Without the task (host builds, or if it failed to start)
+// collect() runs the queued checks itself. verify() checks on the spot, for callers
+// that cannot wait (e.g. restoring a snapshot at boot).
+class AnnounceValidator {
+public:
+    static const size_t RANDOM_HASH_SIZE = 10;
+    static const size_t RATCHET_SIZE = 32;
+    static const size_t DIGEST_SIZE = 16; // Truncated SHA-256 of signed data + signature
+
+    enum class Result : uint8_t {
+        VALID,
+        INVALID,
+        PENDING, // Queued; collect() reports the verdict
+        SKIPPED  // Queue full (or too large to check): left unverified
+    };
+
+    // Fields of an announce, pointing into the packet's data
+    struct Announce {
+        const uint8_t* destinationHash;
+        const uint8_t* publicKey;  // Identity::PUBLIC_KEY_SIZE
+        const uint8_t* nameHash;   // Identity::NAME_HASH_SIZE
+        const uint8_t* randomHash; // RANDOM_HASH_SIZE
+        const uint8_t* ratchet;    // RATCHET_SIZE, nullptr if absent
+        const uint8_t* signature;  // Identity::SIGNATURE_SIZE
+        const uint8_t* appData;
+        size_t appDataLen;
+        uint8_t identityHash[Identity::HASH_SIZE];
+    };
+
+    // Outcome of a deferred check
+    struct Verdict {
+        uint8_t destinationHash[Identity::HASH_SIZE];
+        uint8_t randomHash[RANDOM_HASH_SIZE]; // Tells a forged announce from later genuine ones
+        uint8_t digest[DIGEST_SIZE];          // As returned by verifyDeferred()
+        bool valid;
+    };
+
+    AnnounceValidator();
+    ~AnnounceValidator();
+
+    // Start the background verification task (no-op off-target)
+    void begin();
+
+    // Split an announce into its fields. False if too short or if the destination hash
+    // was not derived from the announced key and name (cheap: two SHA-256 blocks).
+    static bool parse(const RnsPacketInfo& packetInfo, Announce& out);
+
+    // Verify now, unless the result is cached
+    bool verify(const Announce& announce);
+    // Cached result, or PENDING once queued for the background task (copies of a queued
+    // announce are PENDING too). digest, if given, receives the key its Verdict will carry.
+    Result verifyDeferred(const Announce& announce, uint8_t* digest = nullptr);
+    // Apply finished background checks to the cache and append their verdicts
+    void collect(std::vector<Verdict>& verdicts);
+
+    // --- Statistics ---
+    uint32_t getVerifiedCount() const { return _verified; }    // Signature checks run
+    uint32_t getCacheHitCount() const { return _cacheHits; }
+    uint32_t getInvalidCount() const { return _invalid; }
+    uint32_t getDeferredCount() const { return _deferred; }
+    uint32_t getSkippedCount() const { return _skipped; }      // SKIPPED results
+    bool isTaskRunning() const;
+
+private:
+    struct CacheEntry {
+        uint8_t digest[DIGEST_SIZE];
+        bool valid;
+    };
+
+    enum class JobState : uint8_t { FREE, QUEUED };
+    struct Job {
+        uint8_t message[RNS_MTU]; // Signed data
+        size_t messageLen;
+        uint8_t publicKey[Identity::PUBLIC_KEY_SIZE];
+        uint8_t signature[Identity::SIGNATURE_SIZE];
+        uint8_t destinationHash[Identity::HASH_SIZE];
+        uint8_t randomHash[RANDOM_HASH_SIZE];
+        uint8_t digest[DIGEST_SIZE];
+        bool valid;
+    };
+
+    static size_t buildSignedData(const Announce& announce, uint8_t* out, size_t capacity);
+    static bool checkSignature(const uint8_t* publicKey, const uint8_t* message, size_t len, const uint8_t* signature);
+    static void digestOf(const uint8_t* message, size_t len, const uint8_t* signature, uint8_t digest[DIGEST_SIZE]);
+    const CacheEntry* findCached(const uint8_t* digest) const;
+    bool isQueued(const uint8_t* digest) const;
+    void remember(const uint8_t* digest, bool valid);
+    void finishJob(size_t index, std::vector<Verdict>& verdicts);
+
+    CacheEntry _cache[ANNOUNCE_VERIFY_CACHE_SIZE];
+    size_t _cacheCount;
+    size_t _cacheNext; // Oldest entry, overwritten next once full
+    Job _jobs[ANNOUNCE_VERIFY_QUEUE_SIZE];
+    JobState _jobState[ANNOUNCE_VERIFY_QUEUE_SIZE]; // Main loop only
+    uint8_t _scratch[RNS_MTU]; // Signed data of the announce being looked up
+
+#if defined(ARDUINO_ARCH_ESP32)
+    static void taskMain(void* arg);
+    TaskHandle_t _task;
+    QueueHandle_t _todo; // Job indices for the task
+    QueueHandle_t _done; // Job indices back to the main loop
+#endif
+
+    uint32_t _verified;
+    uint32_t _cacheHits;
+    uint32_t _invalid;
+    uint32_t _deferred;
+    uint32_t _skipped;
+};
+
+#endif // ANNOUNCE_VALIDATOR_H
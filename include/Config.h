@@ -89,13 +89,21 @@ extern DebugSerialShim DebugSerial; // Use USB/UART0 for debug (Arduino Serial M
 #endif
 
 // --- Runtime features & Web UI (disabled by default) ---
-// Enable a lightweight Web UI + REST API for status/config (requires enabling and adding AsyncWebServer to build flags)
+// Enable a lightweight Web UI + REST API for status/config (needs ArduinoJson, see the esp32-c3-web environment)
 #ifndef WEBSERVER_ENABLED
 #define WEBSERVER_ENABLED 0
 #endif
 #ifndef WEBSERVER_PORT
 #define WEBSERVER_PORT 80
 #endif
+// Sockets are serviced on their own task; request handlers run briefly on the main loop
+const size_t HTTP_REQUEST_BUFFER_SIZE = 2048;     // Per connection: request line, headers and body
+const uint8_t HTTP_MAX_HEADERS = 16;              // Further headers are ignored
+const uint8_t HTTP_MAX_CONNECTIONS = 3;           // Keep-alive connections served at once
+const unsigned long HTTP_IDLE_TIMEOUT_MS = 15000; // Idle keep-alive (or stalled) connections are closed
+const unsigned long HTTP_POLL_MS = 50;            // Longest select() wait, bounds accept latency
+const uint32_t HTTP_TASK_STACK = 4096;            // Bytes
+const uint8_t HTTP_TASK_PRIORITY = 1;             // Same as loopTask (time-sliced)
 
 // Web UI authentication (Bearer token). When enabled and a token is present
 // in the runtime JSON config the REST API will require Authorization: Bearer <token>
@@ -124,50 +132,177 @@ extern DebugSerialShim DebugSerial; // Use USB/UART0 for debug (Arduino Serial M
 #define METRICS_ENABLED 0
 #endif
 
+// Low-power mode for battery/solar nodes: the main loop blocks on an event group between
+// packets and the chip uses automatic light sleep (needs CONFIG_PM_ENABLE + tickless idle)
+#ifndef LOW_POWER_MODE_ENABLED
+#define LOW_POWER_MODE_ENABLED 0
+#endif
+const unsigned long LOW_POWER_MAX_SLEEP_MS = 1000; // Upper bound on a single blocking wait
+const unsigned long LOW_POWER_UDP_POLL_MS = 50;    // WiFiUDP has no RX callback; cap waits while WiFi is connected
+// Low-power mode only: WIFI_PS_MAX_MODEM lets the modem sleep across several DTIM beacons
+// while associated, but ESP-NOW frames sent during that sleep are lost. ESP-NOW is always
+// on, so the default stays WIFI_PS_MIN_MODEM; enable for nodes that rely on WiFi/LoRa only.
+#ifndef LOW_POWER_WIFI_MAX_MODEM
+#define LOW_POWER_WIFI_MAX_MODEM 0
+#endif
+
 // --- WiFi Credentials ---
 extern const char *WIFI_SSID; // <<< CHANGE ME in Config.cpp
 extern const char *WIFI_PASSWORD; // <<< CHANGE ME in Config.cpp
+// Station connect runs in the background (see WiFiConnection); UDP and NTP attach on IP
+const unsigned long WIFI_CONNECT_TIMEOUT_MS = 15000; // An attempt with no IP by then counts as failed
+const unsigned long WIFI_RECONNECT_MIN_MS = 2000;    // First retry; doubles per failed attempt
+const unsigned long WIFI_RECONNECT_MAX_MS = 120000;  // Each attempt scans, taking the radio from ESP-NOW
 
 // --- Node Configuration ---
 extern const char *BT_DEVICE_NAME;
+// Layout used by earlier firmware; read once to carry the node address over to NVS
 const int EEPROM_ADDR_NODE = 0;  // 8 bytes
 const int EEPROM_ADDR_PKTID = 8; // 2 bytes (Start after node address)
 const int EEPROM_SIZE = 16;      // Min size needed (8+2 = 10, use 16 or 32)
 
 // --- Reticulum Network Parameters ---
 const size_t RNS_ADDRESS_SIZE = 8;
-const size_t RNS_MAX_PAYLOAD = 200; // Max data payload size (adjust based on memory/MTU)
+// Full MTU mode carries standard 500-byte Reticulum packets (plus IFAC) end to end,
+// e.g. for a gateway between UDP/serial Reticulum and constrained radios. Interfaces
+// with smaller frames fragment (ESP-NOW) or are capped by their own MTU (LoRa).
+#ifndef RNS_FULL_MTU_ENABLED
+#define RNS_FULL_MTU_ENABLED 0
+#endif
+#if RNS_FULL_MTU_ENABLED
+const size_t RNS_MTU = 500;            // Reticulum standard MTU
+const size_t RNS_IFAC_MAX_SIZE = 64;   // Interface access code carried on top of the MTU
+#else
+const size_t RNS_MTU = 219;            // Header + 200-byte payload; fits one ESP-NOW v1 frame
+const size_t RNS_IFAC_MAX_SIZE = 16;   // Reticulum's default code size; 219 + 16 still fits one frame
+#endif
+const size_t RNS_MAX_PAYLOAD = RNS_MTU - 19; // Max data payload size (MTU minus the 19-byte header)
+const uint8_t ESPNOW_RX_QUEUE_SIZE = 4; // Received ESP-NOW frames waiting for the main loop (each holds a pool buffer)
+const size_t PACKET_POOL_SIZE = 6 + ESPNOW_RX_QUEUE_SIZE; // MAX_PACKET_SIZE staging buffers shared by RX/forward/serialize paths
 const uint16_t RNS_UDP_PORT = 4242; // Default Reticulum UDP port
 const uint8_t MAX_HOPS = 15;        // Max hop count for packets
 
 // --- Timing & Intervals (milliseconds) ---
-const uint16_t PACKET_ID_SAVE_INTERVAL = 100; // Save counter every N packets generated
 const unsigned long ANNOUNCE_INTERVAL_MS = 180000; // Announce every 3 minutes
 const unsigned long ROUTE_TIMEOUT_MS = ANNOUNCE_INTERVAL_MS * 3 + 15000; // Timeout after ~3 missed announces
 const unsigned long PRUNE_INTERVAL_MS = ANNOUNCE_INTERVAL_MS / 2; // Check for old routes periodically
 const unsigned long MEM_CHECK_INTERVAL_MS = 15000; // Check memory every 15 seconds
-const unsigned long RECENT_ANNOUNCE_TIMEOUT_MS = ANNOUNCE_INTERVAL_MS / 2; // How long to remember forwarded announces
+const unsigned long PACKET_FILTER_ROTATE_MS = ANNOUNCE_INTERVAL_MS / 2; // Seen packets are remembered 1-2 rotations
+
+// --- Runtime Config (see RuntimeConfig) ---
+// The announce interval, route limits and interface MTUs here are defaults. /config.json
+// (JSON_CONFIG_ENABLED) may override them, within these bounds, without reflashing.
+#define RUNTIME_CONFIG_PATH "/config.json"
+const unsigned long ANNOUNCE_INTERVAL_MIN_MS = 10000; // Lowest interval config.json may set
+const size_t RUNTIME_CONFIG_MAX_SIZE = 2048;          // Larger files are rejected unparsed
+
+// --- Persistent State (NVS, see StateStore) ---
+#define STATE_NVS_NAMESPACE "rns_state"
+const uint16_t PACKET_ID_BLOCK = 1024; // Packet IDs reserved per flash write; a reboot skips the unused rest
+// The snapshot (routes, paths, known identities, packet filter) and open links are staged
+// this often and before a restart. A full-size snapshot every 15 min is ~580 KB/day into the
+// 20 KB NVS partition, about 7 years of its 100k erase cycles (typical snapshots are far smaller).
+const unsigned long STATE_SAVE_INTERVAL_MS = 900000;
+const unsigned long STATE_LINK_REOPEN_DELAY_MS = 5000; // Re-establish saved links once interfaces had time to come up
+const size_t STATE_SNAPSHOT_MAX_SIZE = 6144; // Heap only while a save is pending; announces fill what routes/paths leave
+// Snapshot entries are aged by the wall-clock time the node was down. The ESP32 keeps its clock
+// across software resets; after a power cycle without NTP the downtime is unknown and assumed to be:
+const unsigned long STATE_UNKNOWN_DOWNTIME_MS = 60000;
+const uint32_t STATE_COMMIT_TASK_STACK = 4096; // Bytes; NVS writes need ~2 KB
+const uint8_t STATE_COMMIT_TASK_PRIORITY = 1;  // Same as loopTask (time-sliced), below WiFi/lwIP
 
 // --- Link Layer Parameters ---
 const unsigned long LINK_REQ_TIMEOUT_MS = 10000; // Timeout for initial Link Request ACK
 const unsigned long LINK_RETRY_TIMEOUT_MS = 5000; // Timeout for data packet ACK
 const unsigned long LINK_INACTIVITY_TIMEOUT_MS = ROUTE_TIMEOUT_MS * 2; // Timeout for closing inactive links
 const uint8_t LINK_MAX_RETRIES = 3; // Max retries for a packet before closing link
-const size_t LINK_MAX_ACTIVE = 10; // Max concurrent active links (Adjust based on memory)
+const uint8_t LINK_WINDOW_SIZE = 4; // Max unacknowledged data packets in flight per link
+const unsigned long LINK_ACK_DELAY_MS = 200; // Hold ACKs this long to coalesce or piggyback on reverse data
+const uint8_t LINK_ACK_EVERY_N = 2; // Always send a cumulative ACK after N unacknowledged in-order packets
+// Max concurrent links = crypto context pool size, set at startup from the heap left once
+// interfaces are up: (free heap - LINK_HEAP_RESERVE) / per-link cost, clamped to this range
+const size_t LINK_POOL_MIN = 2;
+const size_t LINK_POOL_MAX = 32;
+const size_t LINK_HEAP_RESERVE = 48 * 1024; // Kept free for WiFi/lwIP buffers, route growth and the web UI
 
 // --- Routing & Limits ---
 const size_t MAX_ROUTES = 20;             // Max entries in routing table
-const size_t MAX_RECENT_ANNOUNCES = 40; // Max announce IDs to remember for loop prevention
+const uint8_t ROUTE_MAX_CANDIDATES = 3;   // Next hops remembered per destination
+
+// Route cost = (hops + 1) * ETX + interface cost + signal penalty + age penalty (lower wins)
+const float ROUTE_COST_SIGNAL_WEIGHT = 2.0f; // Penalty for a link quality of 0 (1.0 costs nothing)
+const float ROUTE_COST_AGE_WEIGHT = 1.0f;    // Penalty for a candidate about to time out
+const float ROUTE_SWITCH_HYSTERESIS = 0.2f;  // A candidate must be this much cheaper to take over
+const float ROUTE_ETX_ALPHA = 0.25f;         // EWMA weight of each link delivery report
+const float ROUTE_ETX_MAX = 10.0f;           // ETX ceiling (delivery ratio of 10%)
+const float ROUTE_LINK_QUALITY_UNKNOWN = -1.0f; // Interfaces without RSSI/SNR (ESP-NOW on IDF 4.4, UDP, serial)
+
+// Failover: a next hop with this many consecutive failures (ESP-NOW send status or link
+// ACK timeouts) is treated as down and traffic moves to a backup candidate
+const uint8_t ROUTE_FAILOVER_FAILURES = 2;
+const unsigned long ROUTE_FAILOVER_HOLDDOWN_MS = 30000; // Down next hops get another chance after this
+const float ROUTE_DOWN_COST_PENALTY = 1000.0f;          // Used only if every candidate is down
+
+// Load-split reliable link traffic over the two best next hops on different interfaces
+// (e.g. ESP-NOW + UDP to the same peer) when their costs are within ROUTE_MULTIPATH_COST_RATIO
+#ifndef LINK_MULTIPATH_ENABLED
+#define LINK_MULTIPATH_ENABLED 0
+#endif
+const float ROUTE_MULTIPATH_COST_RATIO = 1.5f;
+const uint8_t ESPNOW_SEND_RESULT_QUEUE_SIZE = 8; // Send-status callbacks buffered for the main loop
+
+// ESP-NOW peer cache and per-peer link statistics from MAC ACKs (EspNowPeerTable)
+const size_t ESPNOW_PEER_TABLE_SIZE = 32;   // Neighbours tracked (LRU)
+const size_t ESPNOW_HW_PEER_SLOTS = 19;     // esp_now_add_peer slots for unicast peers (20 minus broadcast)
+const uint8_t ESPNOW_INFLIGHT_MAX = 8;      // Unicast frames awaiting a send status
+const float ESPNOW_DELIVERY_ALPHA = 0.1f;   // EWMA weight for delivery ratio and latency
+const unsigned long LINK_FAST_RETRY_GUARD_MS = 50; // Min gap between NAK-triggered link retransmits
+
+// ESP-NOW fragmentation of packets larger than one frame (EspNowFragmenter)
+#ifndef ESPNOW_V2_FRAMES
+#define ESPNOW_V2_FRAMES 0 // 1470 B frames on IDF 5.4+; enable only if every node runs ESP-NOW v2
+#endif
+const uint8_t ESPNOW_REASSEMBLY_SLOTS = 4;                 // Packets reassembled concurrently
+const unsigned long ESPNOW_REASSEMBLY_TIMEOUT_MS = 500;    // Drop partial packets after this
+
+// Reticulum transport: HEADER_2 packets addressed to this node's transport ID are
+// forwarded to the next hop learned from announces (PathTable), not flooded
+const size_t PATH_TABLE_SIZE = 32;                        // Destinations with a known next hop
+const unsigned long PATH_TIMEOUT_MS = ROUTE_TIMEOUT_MS;   // Paths not re-announced expire after this
+// Packets for a destination without a path wait in PathRequestQueue while a path request goes out
+const size_t PATH_QUEUE_MAX = 8;                          // Packets held awaiting a path (oldest dropped)
+const unsigned long PATH_REQUEST_TIMEOUT_MS = 2000;       // Wait this long for a path response per request
+const uint8_t PATH_REQUEST_RETRIES = 2;                   // Requests per destination before flooding instead
+// Announce signatures (Ed25519) are checked by a background task. An announce that would
+// install or move a path waits for its verdict; refreshes of a verified path are used at once
+const size_t ANNOUNCE_VERIFY_CACHE_SIZE = 32;             // Remembered results, keyed on a digest of the signed announce
+const size_t ANNOUNCE_VERIFY_QUEUE_SIZE = 4;              // Announces awaiting background verification
+const size_t ANNOUNCE_PENDING_MAX = 8;                    // New-path announces (and copies) held for their verdict
+const uint32_t ANNOUNCE_VERIFY_TASK_STACK = 6144;         // Bytes; Ed25519 check needs ~3 KB
+const uint8_t ANNOUNCE_VERIFY_TASK_PRIORITY = 1;          // Same as loopTask (time-sliced), below WiFi/lwIP
+
+// Duplicate suppression (two rotating Bloom filters, 2 * PACKET_FILTER_BITS / 8 bytes of RAM)
+const uint32_t PACKET_FILTER_BITS = 8192;        // Bits per filter (multiple of 8)
+const uint8_t PACKET_FILTER_HASHES = 4;          // Bit positions per packet
+const size_t PACKET_FILTER_MAX_ENTRIES = 1000;   // Rotate early past this (~2% false positives)
+
+// --- Announce Propagation ---
+const float ANNOUNCE_CAP_PERCENT = 2.0f; // Max share of each interface's capacity spent on announces
+const unsigned long ANNOUNCE_RANDOM_DELAY_MS = 500; // Rebroadcast jitter window for forwarded announces
+const unsigned long ANNOUNCE_QUEUE_MAX_AGE_MS = ANNOUNCE_INTERVAL_MS / 4; // Drop queued announces older than this
+const size_t ANNOUNCE_QUEUE_MAX = 16; // Max queued announces (shared by all interfaces)
 
 // --- Group Addresses ---
 // Define groups this node belongs to. Example:
 const std::vector<std::array<uint8_t, RNS_ADDRESS_SIZE>> SUBSCRIBED_GROUPS = {
     // {0xCA, 0xFE, 0xBA, 0xBE, 0x00, 0x00, 0x00, 0x01}, // Example Group 1
     // {0xDE, 0xAD, 0xBE, 0xEF, 0x12, 0x34, 0x56, 0x78}  // Example Group 2
-    // Destination hash for PLAIN destination ["esp32", "node"] - calculated by tests/read_from_reticulum.py
-    // This allows the ESP32 to receive messages sent to this destination
-    {0xB6, 0x01, 0x0E, 0xA1, 0x1F, 0xDF, 0xC0, 0x4E} // First 8 bytes of 16-byte hash (truncated for group)
+};
 
+// PLAIN destinations this node receives, by full name. Their destination hashes are
+// computed at startup (Identity::destinationHash) and joined to the groups above.
+const std::vector<const char*> SUBSCRIBED_PLAIN_DESTINATIONS = {
+    "esp32.node", // Reticulum PLAIN destination ["esp32", "node"]
 };
 
 // --- LoRa Configuration ---
@@ -208,6 +343,18 @@ const std::vector<std::array<uint8_t, RNS_ADDRESS_SIZE>> SUBSCRIBED_GROUPS = {
     #define LORA_OUTPUT_POWER 10  // dBm
     #define LORA_PREAMBLE_LENGTH 8
     #define LORA_GAIN 0  // 0 = automatic gain control
+    #define LORA_TX_QUEUE_SIZE 8  // Outbound frames buffered while the radio is on air
+    #define LORA_TX_TIMEOUT_MARGIN_MS 500  // Slack over computed time-on-air before a TX is declared stuck
+    // CSMA: channel activity detection before every frame, then p-persistence
+    #define LORA_CSMA_PERSISTENCE 63   // Transmit on a free channel with probability (p+1)/256, as AX25_DEFAULT_PERSISTENCE
+    #define LORA_CSMA_SLOT_TIME 2      // Slot time in 10ms units, as AX25_DEFAULT_SLOT_TIME
+    // Transmit airtime budget (duty cycle) over a sliding window. 1% is the limit of the
+    // common EU868 sub-bands (863-868 MHz); 10% only applies in 869.4-869.65 MHz.
+    // Raise it only for a band that allows more.
+    #ifndef LORA_AIRTIME_BUDGET_PERCENT
+    #define LORA_AIRTIME_BUDGET_PERCENT 1.0
+    #endif
+    #define LORA_AIRTIME_WINDOW_MS 3600000UL  // 1 hour regulatory averaging window
 #endif
 
 // --- HAM Modem Configuration ---
@@ -279,8 +426,25 @@ enum class InterfaceType {
     IPFS         // IPFS content addressing (virtual interface)
 };
 
+// --- Interface Access Codes (IFAC) ---
+// Interfaces listed here only accept frames signed for the same virtual network, as with
+// Reticulum's ifac_netname / ifac_netkey options, so a node on a shared channel drops
+// foreign traffic before parsing it. Outgoing frames carry a code of `size` bytes
+// (1..RNS_IFAC_MAX_SIZE; Reticulum uses 16, or 8 on LoRa). Either string may be nullptr.
+struct IfacInterfaceConfig {
+    InterfaceType interface;
+    const char* netname;
+    const char* netkey;
+    uint8_t size;
+};
+const std::vector<IfacInterfaceConfig> IFAC_INTERFACES = {
+    // { InterfaceType::LORA, "my_network", "shared passphrase", 8 },
+};
+const size_t IFAC_VERIFY_CACHE_SIZE = 8; // Frames checked recently per interface; copies heard again skip the signature
+
 // --- Packet Contexts (Includes Link and Local Command) ---
 #define RNS_CONTEXT_NONE        0x00
+#define RNS_CONTEXT_PATH_RESPONSE 0x0B // Announce sent in reply to a path request
 #define RNS_CONTEXT_LINK_REQ    0xA1 // Request to establish link
 #define RNS_CONTEXT_LINK_CLOSE  0xA2 // Request to close link
 #define RNS_CONTEXT_LINK_DATA   0xA3 // Data packet over an established link
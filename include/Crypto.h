@@ -0,0 +1,149 @@
+#ifndef CRYPTO_H
+#define CRYPTO_H
+
+#include <cstddef>
+#include <cstdint>
+
+// SHA-256 and AES-128 backend. On ESP32 targets they go through mbedTLS, which
+// ESP-IDF backs with the chip's SHA and AES accelerators (CONFIG_MBEDTLS_HARDWARE_SHA
+// / _AES, enabled in the Arduino core). Other builds (host-side tests, tools) use the
+// portable software implementation in Crypto.cpp; both give identical results.
+#ifndef CRYPTO_HW_ACCEL
+  #if defined(ARDUINO_ARCH_ESP32) || defined(ESP_PLATFORM)
+    #define CRYPTO_HW_ACCEL 1
+  #else
+    #define CRYPTO_HW_ACCEL 0
+  #endif
+#endif
+
+#if CRYPTO_HW_ACCEL
+  #include <mbedtls/aes.h>
+  #include <mbedtls/sha256.h>
+#endif
+
+// Hashing and symmetric crypto for Reticulum: destination hashes, HKDF key
+// derivation and the Fernet-style token (IV + AES-128-CBC + HMAC-SHA256) that
+// Reticulum encrypts link and single-destination traffic with.
+namespace Crypto {
+
+const size_t SHA256_SIZE = 32;
+const size_t SHA256_BLOCK_SIZE = 64;
+const size_t AES_BLOCK_SIZE = 16;
+const size_t AES128_KEY_SIZE = 16;
+const size_t TOKEN_KEY_SIZE = 32; // HMAC signing key (16) followed by AES encryption key (16)
+const size_t TOKEN_MIN_SIZE = AES_BLOCK_SIZE + AES_BLOCK_SIZE + SHA256_SIZE; // IV + one block + HMAC
+
+// Size of the token for plaintextLen bytes (PKCS#7 always adds 1-16 bytes)
+inline size_t tokenSize(size_t plaintextLen) {
+    return AES_BLOCK_SIZE + (plaintextLen / AES_BLOCK_SIZE + 1) * AES_BLOCK_SIZE + SHA256_SIZE;
+}
+
+class Sha256 {
+public:
+    Sha256();
+    ~Sha256();
+    Sha256(const Sha256& other);
+    Sha256& operator=(const Sha256& other);
+
+    void begin();
+    void update(const uint8_t* data, size_t len);
+    void finish(uint8_t digest[SHA256_SIZE]); // Call begin() before reusing
+
+private:
+#if CRYPTO_HW_ACCEL
+    mbedtls_sha256_context _ctx;
+#else
+    void processBlock(const uint8_t* block);
+
+    uint32_t _state[8];
+    uint64_t _length; // Bytes hashed so far
+    uint8_t _buffer[SHA256_BLOCK_SIZE];
+    size_t _bufferLen;
+#endif
+};
+
+// HMAC-SHA256 with the key folded into the inner and outer hash states once, so
+// each message costs two hashes of its own length plus two block finishes
+class HmacSha256 {
+public:
+    HmacSha256() = default;
+    HmacSha256(const uint8_t* key, size_t keyLen) { setKey(key, keyLen); }
+
+    void setKey(const uint8_t* key, size_t keyLen);
+    void compute(const uint8_t* data, size_t len, uint8_t mac[SHA256_SIZE]) const;
+    // MAC over two or three concatenated parts without copying them together
+    void compute(const uint8_t* a, size_t aLen, const uint8_t* b, size_t bLen, uint8_t mac[SHA256_SIZE]) const;
+    void compute(const uint8_t* a, size_t aLen, const uint8_t* b, size_t bLen,
+                 const uint8_t* c, size_t cLen, uint8_t mac[SHA256_SIZE]) const;
+
+private:
+    Sha256 _inner; // State after hashing key ^ ipad
+    Sha256 _outer; // State after hashing key ^ opad
+};
+
+// AES-128 with both key schedules expanded once at setKey()
+class Aes128 {
+public:
+    Aes128();
+    ~Aes128();
+    Aes128(const Aes128&) = delete;
+    Aes128& operator=(const Aes128&) = delete;
+
+    void setKey(const uint8_t key[AES128_KEY_SIZE]);
+
+    // CBC over len bytes (a multiple of AES_BLOCK_SIZE). iv is advanced to the last
+    // ciphertext block; in and out may be the same buffer.
+    bool cbcEncrypt(uint8_t iv[AES_BLOCK_SIZE], const uint8_t* in, uint8_t* out, size_t len);
+    bool cbcDecrypt(uint8_t iv[AES_BLOCK_SIZE], const uint8_t* in, uint8_t* out, size_t len);
+
+private:
+#if CRYPTO_HW_ACCEL
+    mbedtls_aes_context _enc;
+    mbedtls_aes_context _dec;
+#else
+    void encryptBlock(const uint8_t in[AES_BLOCK_SIZE], uint8_t out[AES_BLOCK_SIZE]) const;
+    void decryptBlock(const uint8_t in[AES_BLOCK_SIZE], uint8_t out[AES_BLOCK_SIZE]) const;
+
+    uint8_t _roundKeys[176]; // 11 round keys
+#endif
+};
+
+// Reticulum token: IV(16) + AES-128-CBC(PKCS#7 plaintext) + HMAC-SHA256(IV + ciphertext).
+// The 32-byte key is split as signing key [0:16] and encryption key [16:32].
+// A Token holds the expanded AES schedules and keyed HMAC state, so a link sets
+// it up once at handshake and reuses it for every packet.
+class Token {
+public:
+    Token() : _keyed(false) {}
+    explicit Token(const uint8_t key[TOKEN_KEY_SIZE]) : _keyed(false) { setKey(key); }
+
+    void setKey(const uint8_t key[TOKEN_KEY_SIZE]);
+    void clear() { _keyed = false; }
+    bool isKeyed() const { return _keyed; }
+
+    // Returns false if not keyed or out cannot hold tokenSize(len) bytes
+    bool encrypt(const uint8_t* plaintext, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen);
+    // Returns false on a bad length, HMAC or padding; out needs len - TOKEN_MIN_SIZE + 16 bytes
+    bool decrypt(const uint8_t* token, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen);
+
+private:
+    bool _keyed;
+    HmacSha256 _hmac;
+    Aes128 _aes;
+};
+
+// One-shot helpers
+void sha256(const uint8_t* data, size_t len, uint8_t digest[SHA256_SIZE]);
+void hmacSha256(const uint8_t* key, size_t keyLen, const uint8_t* data, size_t len, uint8_t mac[SHA256_SIZE]);
+// RFC 5869 HKDF-SHA256. A null salt means 32 zero bytes, as in Reticulum.
+void hkdf(uint8_t* out, size_t outLen, const uint8_t* ikm, size_t ikmLen,
+          const uint8_t* salt, size_t saltLen, const uint8_t* info = nullptr, size_t infoLen = 0);
+
+// Hardware RNG on ESP32 (esp_fill_random); std::random_device elsewhere
+void randomBytes(uint8_t* out, size_t len);
+// Comparison whose time does not depend on where the buffers differ
+bool constantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len);
+
+} // namespace Crypto
+
+#endif // CRYPTO_H
@@ -0,0 +1,37 @@
+#ifndef ED25519_STREAM_VERIFIER_H
+#define ED25519_STREAM_VERIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <monocypher.h>
+#include <optional/monocypher-ed25519.h> // SHA-512 Ed25519 and its streaming hash
+
+// Checks a plain (RFC 8032) Ed25519 signature over a message that arrives in pieces,
+// e.g. a firmware image being written to flash. Verification hashes
+// SHA-512(R || A || M): R is the first half of the signature and A the public key, so
+// both are hashed up front and M as it streams in. Only the final group equation
+// needs the digest. Memory use is one SHA-512 state, whatever the message size.
+class Ed25519StreamVerifier {
+public:
+    static const size_t SIGNATURE_SIZE = 64;
+    static const size_t PUBLIC_KEY_SIZE = 32;
+
+    Ed25519StreamVerifier();
+    ~Ed25519StreamVerifier();
+
+    void begin(const uint8_t signature[SIGNATURE_SIZE], const uint8_t publicKey[PUBLIC_KEY_SIZE]);
+    void update(const uint8_t* data, size_t len);
+    // true if the signature matches everything passed to update(); call begin() before reuse
+    bool finish();
+
+    size_t getLength() const { return _length; }
+
+private:
+    crypto_sha512_ctx _hash;
+    uint8_t _signature[SIGNATURE_SIZE];
+    uint8_t _publicKey[PUBLIC_KEY_SIZE];
+    size_t _length;
+    bool _started;
+};
+
+#endif // ED25519_STREAM_VERIFIER_H
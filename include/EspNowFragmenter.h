@@ -0,0 +1,73 @@
+#ifndef ESPNOW_FRAGMENTER_H
+#define ESPNOW_FRAGMENTER_H
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include <cstdint>
+#include <functional>
+#include "Config.h"
+#include "ReticulumPacket.h" // For MAX_PACKET_SIZE
+
+// ESP-NOW link-layer fragmentation, so Reticulum packets larger than one ESP-NOW
+// frame cross the hop as a single packet. Packets that fit a frame are sent
+// unchanged (compatible with nodes without this shim). Larger ones are split into
+// fragments carrying a 9-byte header:
+//
+//   [0x7E][0xF5][MSG_ID:2][INDEX:1][OFFSET:2][TOTAL:2][DATA...]
+//
+// 0xF5 in the hops position is above any valid hop count, so a fragment is never a
+// valid Reticulum packet. The IFAC flag (bit 7) of the first byte is clear: frames
+// coded with an interface access code have it set and masked hops, so they can never
+// be taken for fragments. The receiver reassembles per (sender MAC, MSG_ID) in one
+// of ESPNOW_REASSEMBLY_SLOTS fixed buffers; incomplete packets are discarded after
+// ESPNOW_REASSEMBLY_TIMEOUT_MS.
+class EspNowFragmenter {
+public:
+#if ESPNOW_V2_FRAMES && defined(ESP_NOW_MAX_DATA_LEN_V2)
+    static const size_t FRAME_MAX = ESP_NOW_MAX_DATA_LEN_V2; // 1470 B frames (IDF 5.4+)
+#else
+    static const size_t FRAME_MAX = ESP_NOW_MAX_DATA_LEN;    // 250 B frames
+#endif
+    static const size_t HEADER_SIZE = 9;
+    static const size_t FRAGMENT_PAYLOAD = FRAME_MAX - HEADER_SIZE;
+
+    // Sends one frame; returns false if the radio refused it
+    using FrameSender = std::function<bool(const uint8_t* frame, size_t len)>;
+
+    EspNowFragmenter();
+
+    // frameMax < FRAME_MAX leaves room in each frame, e.g. for an interface access code
+    static bool needsFragmentation(size_t packetLen, size_t frameMax = FRAME_MAX) { return packetLen > frameMax; }
+    static bool isFragment(const uint8_t* frame, size_t len);
+
+    // Split packet into fragments of at most frameMax bytes and hand each to sendFrame.
+    // Stops at the first refused frame.
+    bool send(const uint8_t* packet, size_t packetLen, const FrameSender& sendFrame, size_t frameMax = FRAME_MAX);
+
+    // Feed a received fragment. Returns true once the packet is complete; packet then points
+    // into an internal buffer that stays valid until the next call.
+    bool reassemble(const uint8_t* mac, const uint8_t* frame, size_t len,
+                    const uint8_t*& packet, size_t& packetLen, unsigned long now = millis());
+
+    uint32_t getReassembledCount() const { return _reassembled; }
+    uint32_t getDroppedCount() const { return _dropped; }
+
+private:
+    struct Slot {
+        bool active;
+        uint8_t mac[6];
+        uint16_t msgId;
+        uint16_t total;
+        uint16_t received;  // Bytes so far
+        uint32_t indexMask; // Fragments seen (duplicates are ignored)
+        unsigned long startedAt;
+        uint8_t data[MAX_PACKET_SIZE];
+    };
+
+    Slot _slots[ESPNOW_REASSEMBLY_SLOTS];
+    uint16_t _nextMsgId;
+    uint32_t _reassembled;
+    uint32_t _dropped;
+};
+
+#endif // ESPNOW_FRAGMENTER_H
@@ -0,0 +1,72 @@
+#ifndef ESPNOW_PEER_TABLE_H
+#define ESPNOW_PEER_TABLE_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include "Config.h"
+
+// Per-neighbour ESP-NOW state: cache of which peers hold one of the radio's
+// ESPNOW_HW_PEER_SLOTS hardware peer slots, plus link statistics built from the
+// send-status callback.
+//
+// The registered flag lets sends skip esp_now_get_peer(); when every hardware slot
+// is taken, the least recently used registered peer is the one to give its slot up,
+// so meshes with more neighbours than slots rotate peers instead of broadcasting.
+// Every unicast frame is remembered in a small in-flight FIFO when handed to
+// esp_now_send; its MAC-layer ACK/NAK then updates the peer's delivery ratio
+// (EWMA) and send-to-status latency. The table holds ESPNOW_PEER_TABLE_SIZE
+// peers and recycles the least recently used unregistered entry when full.
+static_assert(ESPNOW_PEER_TABLE_SIZE > ESPNOW_HW_PEER_SLOTS,
+              "EspNowPeerTable must be able to recycle an unregistered entry");
+
+class EspNowPeerTable {
+public:
+    struct Peer {
+        uint8_t mac[6];
+        uint32_t sent;          // Frames with a send status
+        uint32_t acked;         // ... of which were MAC-ACKed
+        float deliveryRatio;    // EWMA of ACK outcomes, 0..1
+        uint32_t latencyUs;     // EWMA of esp_now_send() to status callback
+        unsigned long lastUsed; // millis() of the last send or status
+        bool registered;        // Holds a hardware peer slot (esp_now_add_peer)
+    };
+
+    EspNowPeerTable();
+
+    Peer* find(const uint8_t* mac);
+    // Find the peer, creating it (evicting the least recently used) if needed
+    Peer* touch(const uint8_t* mac, unsigned long now = millis());
+
+    // A unicast frame left for mac at sentUs (micros())
+    void recordSend(const uint8_t* mac, uint32_t sentUs);
+    // Send status for mac arrived at statusUs; returns the updated peer
+    Peer* recordResult(const uint8_t* mac, bool success, uint32_t statusUs);
+
+    // Hardware slot bookkeeping; the caller does the esp_now_add_peer/del_peer
+    void setRegistered(Peer* peer, bool registered);
+    size_t getRegisteredCount() const { return _registered; }
+    // Registered peer to evict for a new one (least recently used, never exceptMac)
+    Peer* leastRecentRegistered(const uint8_t* exceptMac = nullptr);
+
+    size_t size() const { return _count; }
+    const Peer& at(size_t index) const { return _peers[index]; }
+    uint32_t getTotalSent() const { return _totalSent; }
+    uint32_t getTotalAcked() const { return _totalAcked; }
+
+private:
+    struct InFlight {
+        uint8_t mac[6];
+        uint32_t sentUs;
+    };
+
+    Peer _peers[ESPNOW_PEER_TABLE_SIZE];
+    size_t _count;
+    size_t _registered;
+    InFlight _inFlight[ESPNOW_INFLIGHT_MAX]; // Ring; statuses arrive in send order
+    uint8_t _inFlightHead;
+    uint8_t _inFlightCount;
+    uint32_t _totalSent;
+    uint32_t _totalAcked;
+};
+
+#endif // ESPNOW_PEER_TABLE_H
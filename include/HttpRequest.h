@@ -0,0 +1,88 @@
+#ifndef HTTP_REQUEST_H
+#define HTTP_REQUEST_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include "Config.h"
+
+// A span of the request buffer: no copy, valid until the parser moves on
+struct HttpText {
+    const char* data = nullptr;
+    size_t len = 0;
+
+    bool empty() const { return len == 0; }
+    bool equals(const char* s) const;
+    bool equalsIgnoreCase(const char* s) const;
+    bool startsWith(const char* prefix) const;
+    HttpText trimmed() const;
+    HttpText substr(size_t start) const;
+    String toString() const;
+};
+
+// Incremental HTTP/1.x request parser over one fixed buffer per connection. Socket
+// reads land directly in writePtr(); commit() scans only the new bytes for the end
+// of the headers, then records the request line and headers as spans of the buffer.
+// Headers must fit the buffer. A body that does not fit as well is reported as
+// STREAMING and drained in pieces with takeBody(), so the buffer never grows.
+// After a request is handled, next() keeps any pipelined bytes that followed it.
+class HttpRequestParser {
+public:
+    static const size_t BUFFER_SIZE = HTTP_REQUEST_BUFFER_SIZE;
+
+    enum class Status : uint8_t {
+        INCOMPLETE,  // Need more bytes
+        COMPLETE,    // Request (and body) available
+        STREAMING,   // Headers available, body larger than the buffer: drain with takeBody()
+        BAD_REQUEST, // Malformed request line or header
+        TOO_LARGE    // Headers do not fit the buffer
+    };
+
+    HttpRequestParser();
+
+    char* writePtr() { return _buf + _len; }
+    size_t writeRoom() const { return BUFFER_SIZE - _len; }
+    // count bytes were written at writePtr()
+    Status commit(size_t count);
+    Status status() const { return _status; }
+    bool hasData() const { return _len > 0; } // Part of a request has arrived
+
+    HttpText method() const { return _method; }
+    HttpText path() const { return _path; }
+    HttpText header(const char* name) const; // Empty if absent
+    HttpText body() const; // Whole body once COMPLETE, less what takeBody() returned
+    size_t contentLength() const { return _contentLength; }
+    // Body bytes received so far and not yet taken, then drops them from the buffer
+    // so the next read lands right after the headers. Valid until the next commit().
+    HttpText takeBody();
+    size_t bodyRemaining() const { return _contentLength - _bodyTaken; } // Not yet taken
+    // HTTP/1.1 unless "Connection: close", HTTP/1.0 only with "Connection: keep-alive"
+    bool keepAlive() const { return _keepAlive; }
+
+    // Drop the handled request, keeping what followed it
+    void next();
+    void reset();
+
+private:
+    struct Header {
+        HttpText name;
+        HttpText value;
+    };
+
+    Status parseHead();
+
+    char _buf[BUFFER_SIZE];
+    size_t _len;
+    size_t _scanned;   // Bytes already searched for the end of the headers
+    size_t _headerEnd; // Offset of the body, 0 until the headers are complete
+    size_t _contentLength;
+    size_t _bodyTaken; // Body bytes already handed out by takeBody()
+    Status _status;
+    bool _keepAlive;
+    HttpText _method;
+    HttpText _path;
+    Header _headers[HTTP_MAX_HEADERS];
+    uint8_t _headerCount;
+};
+
+#endif // HTTP_REQUEST_H
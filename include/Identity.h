@@ -0,0 +1,69 @@
+#ifndef IDENTITY_H
+#define IDENTITY_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Crypto.h"
+#include "ReticulumPacket.h" // For RNS_TRUNCATED_HASHLENGTH_BYTES
+
+// A Reticulum identity: an X25519 key pair for key exchange and an Ed25519 key
+// pair for signatures. The public key is the two 32-byte public keys concatenated
+// (X25519 first), and the identity hash is its truncated SHA-256. Peers' identities
+// are held with only the public half loaded.
+class Identity {
+public:
+    static const size_t KEY_SIZE = 32;
+    static const size_t PUBLIC_KEY_SIZE = 2 * KEY_SIZE;  // X25519 + Ed25519
+    static const size_t PRIVATE_KEY_SIZE = 2 * KEY_SIZE; // X25519 secret + Ed25519 seed
+    static const size_t SIGNATURE_SIZE = 64;
+    static const size_t HASH_SIZE = RNS_TRUNCATED_HASHLENGTH_BYTES;
+    static const size_t NAME_HASH_SIZE = 10;
+
+    Identity();
+    ~Identity();
+
+    // Fresh key pairs from the hardware RNG
+    void generate();
+    // Restore both key pairs from a private key produced by getPrivateKey()
+    bool loadPrivateKey(const uint8_t* privateKey, size_t len);
+    void getPrivateKey(uint8_t out[PRIVATE_KEY_SIZE]) const;
+    // A remote identity, e.g. from an announce; it can verify but not sign
+    bool loadPublicKey(const uint8_t* publicKey, size_t len);
+
+    bool isValid() const { return _hasPublic; }
+    bool hasPrivateKey() const { return _hasPrivate; }
+    const uint8_t* getPublicKey() const { return _publicKey; }
+    const uint8_t* getHash() const { return _hash; }
+
+    // X25519 shared secret with a peer's X25519 public key (first half of its public key)
+    bool exchange(const uint8_t peerPublicKey[KEY_SIZE], uint8_t sharedSecret[KEY_SIZE]) const;
+    // Ephemeral X25519 key pair (e.g. per link) and the exchange with it
+    static void generateEphemeral(uint8_t secret[KEY_SIZE], uint8_t publicKey[KEY_SIZE]);
+    static bool exchange(const uint8_t secret[KEY_SIZE], const uint8_t peerPublicKey[KEY_SIZE], uint8_t sharedSecret[KEY_SIZE]);
+    // Ed25519
+    bool sign(const uint8_t* message, size_t len, uint8_t signature[SIGNATURE_SIZE]) const;
+    bool verify(const uint8_t* message, size_t len, const uint8_t signature[SIGNATURE_SIZE]) const;
+
+    // --- Reticulum hashes ---
+    // SHA-256 truncated to 16 bytes
+    static void truncatedHash(const uint8_t* data, size_t len, uint8_t out[HASH_SIZE]);
+    // First 10 bytes of SHA-256 over the dotted full name ("app.aspect1.aspect2")
+    static void nameHash(const char* fullName, uint8_t out[NAME_HASH_SIZE]);
+    // Destination hash for fullName: truncatedHash(nameHash + identity hash), or of
+    // the name hash alone for PLAIN destinations (identity == nullptr)
+    static void destinationHash(const char* fullName, const Identity* identity, uint8_t out[HASH_SIZE]);
+
+private:
+    void updateHash();
+    void wipe();
+
+    uint8_t _x25519Secret[KEY_SIZE];
+    uint8_t _ed25519Seed[KEY_SIZE];
+    uint8_t _ed25519Secret[2 * KEY_SIZE]; // Expanded form Monocypher signs with
+    uint8_t _publicKey[PUBLIC_KEY_SIZE];
+    uint8_t _hash[HASH_SIZE];
+    bool _hasPublic;
+    bool _hasPrivate;
+};
+
+#endif // IDENTITY_H
@@ -0,0 +1,57 @@
+#ifndef INTERFACE_ACCESS_CODE_H
+#define INTERFACE_ACCESS_CODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Config.h"
+#include "Identity.h"
+
+// Reticulum interface access code for one interface. The network name and/or
+// passphrase derive a 64-byte key, used as the private key of an Ed25519 signer.
+// Each outgoing frame gets the IFAC flag (bit 7 of the first byte), and the last
+// `size` bytes of its signature are inserted after the two header bytes. The rest
+// of the frame is then masked with HKDF(code, salt = key). Incoming frames are
+// checked on the raw bytes, before anything is parsed or allocated. A frame whose
+// flag does not match the interface's configuration costs one bit test. A copy of a
+// frame checked recently costs one SHA-256 instead of a signature.
+class InterfaceAccessCode {
+public:
+    static const size_t KEY_SIZE = 64;
+    static const uint8_t FLAG = 0x80;
+
+    InterfaceAccessCode();
+
+    // Derive the key; false (and left disabled) if both strings are empty or size is out of range
+    bool configure(const char* netname, const char* netkey, size_t size);
+    bool isEnabled() const { return _size > 0; }
+    size_t getSize() const { return _size; }
+
+    static bool hasFlag(const uint8_t* frame, size_t len) { return len > 0 && (frame[0] & FLAG); }
+
+    // Egress: out receives the flagged, coded and masked frame of len + getSize() bytes.
+    // out must not overlap raw.
+    bool apply(const uint8_t* raw, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen) const;
+    // Ingress: unmask and check a flagged frame. On success out holds the frame without
+    // its code (len - getSize() bytes). out must not overlap frame and needs len bytes.
+    bool verify(const uint8_t* frame, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen);
+
+    uint32_t getCacheHitCount() const { return _cacheHits; }
+
+private:
+    struct CacheEntry {
+        uint8_t digest[8]; // Truncated SHA-256 of the masked frame
+        bool valid;
+    };
+
+    void mask(const uint8_t* code, uint8_t* out, size_t len) const;
+
+    uint8_t _key[KEY_SIZE];
+    Identity _signer;
+    size_t _size; // 0 = disabled
+    CacheEntry _cache[IFAC_VERIFY_CACHE_SIZE];
+    size_t _cacheCount;
+    size_t _cacheNext;
+    uint32_t _cacheHits;
+};
+
+#endif // INTERFACE_ACCESS_CODE_H
@@ -2,12 +2,14 @@
 #define INTERFACE_MANAGER_H
 
 #include <Arduino.h>
+#include <WiFi.h>
 #include <WiFiUdp.h>
 #include "Config.h"
 #if BLUETOOTH_CLASSIC_AVAILABLE
 #include <BluetoothSerial.h> // Requires CONFIG_BT_ENABLED=y and CONFIG_CLASSIC_BT_ENABLED=y in sdkconfig
 #endif
 #include <esp_now.h>
+#include <atomic>
 #include <functional>
 #include <vector>
 #include <IPAddress.h> // Include IPAddress
@@ -31,15 +33,31 @@
 #endif
 
 #include "KISS.h"
+#include "ReticulumPacket.h" // For MAX_PACKET_SIZE
+#include "AirtimeTracker.h"
+#include "AnnounceQueue.h"
+#include "EspNowPeerTable.h"
+#include "EspNowFragmenter.h"
+#include "InterfaceAccessCode.h"
+#include "PacketBufferPool.h"
+#include "WiFiConnection.h"
+#include "RuntimeConfig.h"
 
 // Forward declarations
 class RoutingTable;
+struct RouteCandidate;
 class ReticulumNode;
 
 // Callback type for received packets:
 // void packet_receiver(const uint8_t *packetBuffer, size_t packetLen, InterfaceType interface,
 //                      const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port)
 using PacketReceiverCallback = std::function<void(const uint8_t*, size_t, InterfaceType, const uint8_t*, const IPAddress&, uint16_t)>;
+// Called from the main loop when a unicast ESP-NOW frame to mac was not MAC-ACKed
+using EspNowSendFailureCallback = std::function<void(const uint8_t* mac)>;
+#ifdef LORA_ENABLED
+// Called from the main loop when a queued LoRa frame has left the radio (or failed/timed out)
+using LoRaTxDoneCallback = std::function<void(bool success, size_t frameLen)>;
+#endif
 
 class InterfaceManager {
 public:
@@ -47,19 +65,65 @@ public:
 
     void setup();
     void loop(); // Process inputs from interfaces
+    // Picks up a changed RuntimeConfig: interface MTUs, and WiFi credentials (reconnects)
+    void applyRuntimeConfig(const RuntimeConfig& previous);
+    // Longest the main loop may block without missing input on a polled interface
+    unsigned long getMaxIdleMs() const;
 
     // Sending methods
     // Sends packet out relevant interfaces based on routing (or broadcast), excluding source interface
     void sendPacket(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr, InterfaceType excludeInterface = InterfaceType::UNKNOWN);
     // Sends packet via a specific interface type (used internally or for specific needs)
     void sendPacketVia(InterfaceType ifType, const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr);
-    // Broadcasts an announce packet on relevant interfaces
-    void broadcastAnnounce(const uint8_t *packetBuffer, size_t packetLen);
+    // Sends packet to one specific next hop (a backup or load-split route candidate)
+    void sendPacketViaCandidate(const RouteCandidate& candidate, const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr);
+    // Queues an announce for every broadcast-capable interface. Each interface sends it
+    // after delayMs, within its ANNOUNCE_CAP_PERCENT budget, fewest hops first.
+    void queueAnnounce(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *announcedAddr,
+                       uint8_t hops, unsigned long delayMs);
+    const AnnounceQueue& getAnnounceQueue() const { return _announceQueue; }
 #ifdef LORA_ENABLED
     // LoRa-specific methods
     bool isLoRaInitialized() const { return _loraInitialized; }
+    bool isLoRaTransmitting() const { return _loraTxState == LoRaTxState::TRANSMITTING; }
+    size_t getLoRaTxQueueDepth() const { return _loraTxCount; }
+    void setLoRaTxDoneCallback(LoRaTxDoneCallback cb) { _loraTxDoneCallback = cb; }
 #endif
 
+    // Airtime accounting for duty-cycle limited interfaces (nullptr if the interface is unmetered)
+    AirtimeTracker* getAirtimeTracker(InterfaceType ifType);
+    // True if a packetLen frame fits the interface's remaining airtime budget (always true if unmetered)
+    bool hasAirtimeFor(InterfaceType ifType, size_t packetLen);
+
+    // Largest packet an interface sends: its configured MTU, clamped to what the medium
+    // (or, for ESP-NOW, the fragmenter) can carry. Larger packets are dropped and counted.
+    size_t getInterfaceMtu(InterfaceType ifType) const;
+    // Lower an interface's MTU, e.g. to match a peer with smaller buffers; returns the effective value
+    size_t setInterfaceMtu(InterfaceType ifType, size_t mtu);
+    // MTU towards a destination: its route's interface, or the smallest broadcast interface if unrouted
+    size_t getPathMtu(const uint8_t* destinationAddr);
+    uint32_t getMtuDropCount() const { return _mtuDrops; }
+
+    // Interface access codes: interfaces in IFAC_INTERFACES are configured in setup()
+    bool setIfac(InterfaceType ifType, const char* netname, const char* netkey, size_t size);
+    size_t getIfacSize(InterfaceType ifType) const; // 0 if the interface is open
+    uint32_t getIfacDropCount() const { return _ifacDrops; }
+
+    // Station connection: connects in the background, UDP is usable while isConnected()
+    const WiFiConnection& getWiFiConnection() const { return _wifi; }
+
+    // Boot timing, in millis() since boot (0 = not yet): interfaces set up, and the first
+    // frame accepted from / handed to an interface (per interface, or earliest of all)
+    uint32_t getReadyMs() const { return _readyMs; }
+    uint32_t getFirstRxMs() const;
+    uint32_t getFirstTxMs() const;
+    uint32_t getFirstRxMs(InterfaceType ifType) const;
+    uint32_t getFirstTxMs(InterfaceType ifType) const;
+
+    // Link quality (0..1) of the packet currently being handed to the receiver callback,
+    // ROUTE_LINK_QUALITY_UNKNOWN if its interface cannot measure signal
+    float getLastRxLinkQuality() const { return _lastRxLinkQuality; }
+
 #ifdef IPFS_ENABLED
     // IPFS methods
     bool fetchIPFSContent(const char* ipfsHash, std::vector<uint8_t>& output);
@@ -84,10 +148,17 @@ public:
 
     // Static callbacks needed for C-style APIs like ESP-NOW
     static void staticEspNowRecvCallback(const uint8_t *mac_addr, const uint8_t *incomingData, int len);
-    // static void staticEspNowSendCallback(const uint8_t *mac_addr, esp_now_send_status_t status); // Optional
+    static void staticEspNowSendCallback(const uint8_t *mac_addr, esp_now_send_status_t status);
+    static void staticWiFiEventCallback(arduino_event_id_t event, arduino_event_info_t info);
+    void setEspNowSendFailureCallback(EspNowSendFailureCallback cb) { _espNowSendFailureCallback = cb; }
+    const EspNowPeerTable& getEspNowPeerTable() const { return _espNowPeers; }
+    uint32_t getEspNowPeerEvictions() const { return _espNowPeerEvictions; }
+    const EspNowFragmenter& getEspNowFragmenter() const { return _espNowFragmenter; }
+    uint32_t getEspNowRxDropCount() const { return _espNowRxDrops; }
 
 private:
-    void setupWiFi();
+    void setupWiFi(); // Starts the first connect attempt and returns
+    void applyWiFiActions(uint8_t actions, WiFiConnection::State previous);
     void setupESPNow();
     void setupBluetooth();
     void setupSerial();
@@ -103,9 +174,33 @@ private:
 
     void processWiFiInput();
     void processSerialInput();
+    void processAnnounceQueue(); // Drains queued announces per interface
+    void processEspNowSendResults(); // Feeds unicast MAC ACK outcomes to the routing table
+    void processEspNowInput(); // Reassembles and delivers frames queued by the receive callback
+    uint32_t announceInterfaceMask() const;
+    static size_t hardwareMtu(InterfaceType ifType);
+    void configureMtu(InterfaceType ifType); // RuntimeConfig value, raised to fit the access code
+    bool fitsMtu(InterfaceType ifType, size_t packetLen); // Counts and logs the drop if not
+    InterfaceAccessCode* ifacFor(InterfaceType ifType) const;
+    // Ingress check on the raw frame, before it is parsed. False: drop it. On IFAC
+    // interfaces packet/len are pointed at the frame without its code, held in scratch.
+    bool checkIfac(InterfaceType ifType, const uint8_t*& packet, size_t& len, PacketBufferPool::Buffer& scratch);
+    // Hands a received frame that passes checkIfac() to the packet receiver
+    void deliverPacket(const uint8_t* packet, size_t len, InterfaceType ifType,
+                       const uint8_t* senderMac = nullptr, const IPAddress& senderIp = IPAddress(), uint16_t senderPort = 0);
+    static void noteFirstFrame(volatile uint32_t* firstMs, InterfaceType ifType);
+    // Egress: the frame to send on ifType (coded into scratch if it uses IFAC), nullptr on failure
+    const uint8_t* applyIfac(InterfaceType ifType, const uint8_t* packet, size_t& len, PacketBufferPool::Buffer& scratch);
+    uint32_t announceTxTimeMs(InterfaceType ifType, size_t packetLen) const; // Time on the medium
     void processBluetoothInput();
 #ifdef LORA_ENABLED
-    void processLoRaInput();
+    void processLoRaInput();     // Services DIO0 events: RX done or TX done
+    void startLoRaReceive();
+    void startNextLoRaTransmit(); // Starts CSMA for the head of the TX queue if the radio is idle
+    void handleLoRaChannelScan(); // CAD finished: transmit, or back off for a slot
+    void transmitLoRaHead();
+    void finishLoRaTransmit(bool success);
+    uint32_t loraTimeOnAirMs(size_t packetLen) const;
 #endif
 #ifdef HAM_MODEM_ENABLED
     void processHAMModemInput();
@@ -114,6 +209,9 @@ private:
     // Specific Send implementations called by public send methods
     void sendPacketViaEspNow(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr);
     void sendPacketViaWiFi(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr);
+    void sendEspNowPacket(const uint8_t *targetMac, const uint8_t *packetBuffer, size_t packetLen); // Fragments if needed
+    bool transmitEspNowFrame(const uint8_t *targetMac, const uint8_t *frame, size_t len); // Adds the access code
+    void sendUdpFrame(const IPAddress& targetIp, const uint8_t *packetBuffer, size_t packetLen);
     void sendPacketViaSerial(const uint8_t *packetBuffer, size_t packetLen);
     void sendPacketViaBluetooth(const uint8_t *packetBuffer, size_t packetLen);
 #ifdef LORA_ENABLED
@@ -128,6 +226,44 @@ private:
 
     PacketReceiverCallback _packetReceiver; // Callback to ReticulumNode::handleReceivedPacket
     RoutingTable& _routingTableRef; // Reference for route lookups / peer management
+    float _lastRxLinkQuality;
+    static const uint8_t MTU_SLOTS = 16; // Indexed by InterfaceType
+    uint16_t _interfaceMtu[MTU_SLOTS];
+    uint32_t _mtuDrops;
+    InterfaceAccessCode* _ifac[MTU_SLOTS]; // Allocated for IFAC interfaces only
+    uint32_t _ifacDrops;
+    uint32_t _readyMs;
+    volatile uint32_t _firstRxMs[MTU_SLOTS];
+    volatile uint32_t _firstTxMs[MTU_SLOTS];
+    bool _firstRxLogged;
+
+    // ESP-NOW send status is reported on the WiFi task; results wait here for the main loop
+    struct EspNowSendResult {
+        uint8_t mac[6];
+        bool success;
+        uint32_t atUs; // micros() when the status arrived, for latency
+    };
+    // SPSC ring buffer. Each side publishes its index with a release store and reads the other's
+    // with an acquire load, so a slot is never seen before its contents on dual-core targets.
+    EspNowSendResult _espNowSendResults[ESPNOW_SEND_RESULT_QUEUE_SIZE];
+    std::atomic<uint8_t> _espNowSendResultHead; // Written by the callback
+    std::atomic<uint8_t> _espNowSendResultTail; // Written by the main loop
+    // Received ESP-NOW frames, copied out of the WiFi task so every packet is handled on the main loop
+    struct EspNowRxFrame {
+        PacketBufferPool::Buffer buffer;
+        uint8_t mac[6];
+        uint16_t len;
+    };
+    EspNowRxFrame _espNowRxFrames[ESPNOW_RX_QUEUE_SIZE]; // SPSC ring buffer, same ordering as above
+    std::atomic<uint8_t> _espNowRxHead; // Written by the callback
+    std::atomic<uint8_t> _espNowRxTail; // Written by the main loop
+    uint32_t _espNowRxDrops; // Queue full or pool exhausted
+    EspNowPeerTable _espNowPeers; // Peer slot cache + per-peer MAC ACK stats
+    uint32_t _espNowPeerEvictions; // Hardware peer slots recycled for newer neighbours
+    EspNowFragmenter _espNowFragmenter;
+    EspNowSendFailureCallback _espNowSendFailureCallback;
+    AnnounceQueue _announceQueue;
+    WiFiConnection _wifi; // Events posted from the Arduino event task, applied in loop()
     WiFiUDP _udp;
 #if BLUETOOTH_CLASSIC_AVAILABLE
     BluetoothSerial _serialBT; // Bluetooth Serial object
@@ -137,6 +273,21 @@ private:
 #ifdef LORA_ENABLED
     SX1278* _lora; // LoRa radio instance
     bool _loraInitialized;
+    // Outbound frames wait here so the loop never blocks while the radio is on air
+    struct LoRaTxFrame {
+        uint8_t data[MAX_PACKET_SIZE];
+        size_t len;
+    };
+    LoRaTxFrame _loraTxQueue[LORA_TX_QUEUE_SIZE]; // Ring buffer
+    uint8_t _loraTxHead;
+    uint8_t _loraTxCount;
+    // What DIO0 means next: RX done (IDLE/BACKOFF), CAD done (CHANNEL_SCAN) or TX done (TRANSMITTING)
+    enum class LoRaTxState : uint8_t { IDLE, CHANNEL_SCAN, BACKOFF, TRANSMITTING };
+    LoRaTxState _loraTxState;
+    unsigned long _loraTxDeadline; // End of backoff slot, or millis() after which a scan/TX is abandoned
+    LoRaTxDoneCallback _loraTxDoneCallback;
+    AirtimeTracker _loraAirtime;
+    bool _loraBudgetWarned;
 #endif
 #ifdef HAM_MODEM_ENABLED
     KISSProcessor _hamModemKissProcessor; // KISS processor for HAM modem
@@ -10,6 +10,7 @@
 
 #include "Config.h"
 #include "ReticulumPacket.h" // For RnsPacketInfo
+#include "Identity.h"        // For Identity::KEY_SIZE
 
 // Forward declaration
 class LinkManager;
@@ -23,15 +24,18 @@ public:
         CLOSING      // Waiting for ACK to our LINK_CLOSE
     };
 
-    // Constructor requires destination address and owner (LinkManager)
-    Link(const uint8_t* destination, LinkManager& owner);
+    // Constructor requires destination address, owner (LinkManager) and the crypto
+    // context slot the owner reserved for this link; the slot is released on destruction
+    Link(const uint8_t* destination, LinkManager& owner, size_t cryptoSlot);
     ~Link(); // Destructor
 
     // Core methods
     bool establish(); // Initiate link establishment
     bool sendData(const std::vector<uint8_t>& dataPayload); // Send application data
     void handlePacket(const RnsPacketInfo& packetInfo); // Process incoming packet for this link
-    void checkTimeouts(); // Called periodically to check for ACK/retransmission timeouts
+    void checkTimeouts(); // Called when a deadline expires to handle ACK/retransmission timeouts
+    bool getNextDeadline(unsigned long& deadline) const; // Earliest millis() at which checkTimeouts() has work
+    void retransmitNow(); // Next hop reported a lost frame: resend the window without waiting for the ACK timeout
     void close(bool notifyPeer = true); // Initiate link closure
     bool teardown(); // Force immediate closure and cleanup (sets state to CLOSED)
 
@@ -54,15 +58,27 @@ private:
 
     void sendLinkRequest();
     void sendLinkClose();
-    void sendAck(uint16_t sequenceToAck);
+    void sendAck(uint16_t sequenceToAck, bool withKey = false); // withKey: handshake ACK carrying our ephemeral key
+    bool deriveSessionKey(const std::vector<uint8_t>& peerKey); // Key the crypto slot from the peer's ephemeral key
+    // Sealed link frame payload: token over [seq 2][flags 1][piggybacked ACK 2][data]
+    static size_t sealedSize(size_t dataLen, bool piggyback);
+    bool fitsPath(size_t sealedLen, const uint8_t* destination);
     void sendPacketInternal(const RnsPacketInfo& packetInfo); // Adds to queue, serializes, sends, starts timers
+    bool transmitPending(PendingPacket& pending); // Serializes (piggybacking any held ACK) and sends
     void processAck(const RnsPacketInfo& ackPacket);
+    void acknowledgeUpTo(uint16_t ackedSequence); // Cumulative ACK: releases all pending packets <= ackedSequence
     void processData(const RnsPacketInfo& dataPacket);
     void processLinkRequest(const RnsPacketInfo& reqPacket);
     void processLinkClose(const RnsPacketInfo& closePacket);
-    void retransmitOldestPending();
+    void retransmitPending(); // Go-back-N: resend every unacknowledged packet in the window
     void clearPendingQueue();
+    void scheduleAck(uint16_t sequenceToAck); // Delay/coalesce ACK for in-order data
+    void flushPendingAck(); // Send held ACK now as a standalone control packet
     void updateActivity() { _lastActivityTime = millis(); } // Update timestamp
+    unsigned long currentTimeoutDuration() const; // ACK timeout for the current state
+
+    // Wrap-around safe sequence comparison (RFC 1982 style)
+    static bool sequenceLessOrEqual(uint16_t a, uint16_t b) { return (int16_t)(a - b) <= 0; }
 
 
     std::array<uint8_t, RNS_ADDRESS_SIZE> _destinationAddress;
@@ -74,9 +90,21 @@ private:
     uint16_t _expectedIncomingSequence = 0; // Next data sequence number expected
     uint16_t _linkReqPacketId = 0; // Packet ID of the link request we sent
 
-    // Queue for reliable data packets awaiting ACK (simplified: size 1 initially)
+    // Handshake: X25519 ephemeral key pair, kept until the session key is derived
+    size_t _cryptoSlot;
+    uint8_t _ephemeralSecret[Identity::KEY_SIZE];
+    uint8_t _ephemeralPublic[Identity::KEY_SIZE];
+
+    // Queue for reliable data packets awaiting ACK (up to LINK_WINDOW_SIZE in flight)
     std::list<PendingPacket> _pendingOutgoingPackets;
     uint8_t _currentRetryCount = 0; // Retries for the packet/state action currently awaiting ACK/timeout
+    unsigned long _lastFastRetryTime = 0; // Last retransmitNow(); NAKs for the previous window are ignored briefly
+
+    // Delayed/cumulative ACK state for incoming data
+    bool _ackPending = false;          // An ACK is owed to the peer but not yet sent
+    uint16_t _ackPendingSequence = 0;  // Highest in-order sequence received (cumulative ACK value)
+    uint8_t _unackedInOrderCount = 0;  // In-order packets received since the last ACK went out
+    unsigned long _ackDeadline = 0;    // millis() by which the held ACK must be flushed
 
 
 };
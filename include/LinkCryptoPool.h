@@ -0,0 +1,56 @@
+#ifndef LINK_CRYPTO_POOL_H
+#define LINK_CRYPTO_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory> // For std::unique_ptr
+#include "Config.h"
+#include "Crypto.h"
+#include "Identity.h" // For Identity::KEY_SIZE
+
+// Fixed pool of per-link crypto contexts. Each slot is a Crypto::Token whose AES key
+// schedules and keyed HMAC state are expanded once, when the link handshake derives
+// the session key; sealing and opening link frames afterwards only binds the slot,
+// with no key expansion and no allocation per packet. The pool is allocated once by
+// begin() and sized from the heap headroom at that point, so its capacity is also
+// the node's limit on concurrent links.
+class LinkCryptoPool {
+public:
+    static const size_t NO_SLOT = (size_t)-1;
+
+    LinkCryptoPool() : _capacity(0), _used(0) {}
+    LinkCryptoPool(const LinkCryptoPool&) = delete;
+    LinkCryptoPool& operator=(const LinkCryptoPool&) = delete;
+
+    // (freeHeap - LINK_HEAP_RESERVE) / perLinkCost, clamped to [LINK_POOL_MIN, LINK_POOL_MAX]
+    static size_t capacityFor(size_t freeHeap, size_t perLinkCost);
+
+    // Allocate the pool; returns the capacity (0 if allocation failed). Only the first call allocates.
+    size_t begin(size_t freeHeap, size_t perLinkCost);
+
+    // A free slot, or NO_SLOT when every slot is taken
+    size_t acquire();
+    // Forget the slot's key and return it to the pool
+    void release(size_t slot);
+
+    // Session key = HKDF(X25519(ownSecret, peerPublic)) salted with both ephemeral
+    // public keys in byte order, so both ends (and simultaneous requests) agree on it.
+    // Expands it into the slot. False on a bad slot or a degenerate peer key.
+    bool establish(size_t slot, const uint8_t ownSecret[Identity::KEY_SIZE],
+                   const uint8_t ownPublic[Identity::KEY_SIZE],
+                   const uint8_t peerPublic[Identity::KEY_SIZE]);
+
+    // The slot's context once keyed, else nullptr
+    Crypto::Token* get(size_t slot);
+
+    size_t getCapacity() const { return _capacity; }
+    size_t getUsedCount() const { return _used; }
+
+private:
+    std::unique_ptr<Crypto::Token[]> _tokens;
+    std::unique_ptr<bool[]> _inUse;
+    size_t _capacity;
+    size_t _used;
+};
+
+#endif // LINK_CRYPTO_POOL_H
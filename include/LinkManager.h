@@ -10,6 +10,8 @@
 
 #include "Config.h"
 #include "Link.h" // Include Link class definition
+#include "LinkCryptoPool.h"
+#include "TimerService.h" // For TimerService::TimerId
 #include "ReticulumPacket.h" // For RnsPacketInfo
 
 // Forward declaration
@@ -27,28 +29,54 @@ class LinkManager {
 public:
     LinkManager(ReticulumNode& owner);
 
+    // Size the link crypto pool (and with it the link limit) from the free heap.
+    // Call once interfaces are up so their buffers are already accounted for.
+    void begin();
+
     // Called from ReticulumNode::handleReceivedPacket for link-related packets
     void processPacket(const RnsPacketInfo& packetInfo, InterfaceType interface);
 
     // Called from application logic or command handler to send reliable data
     bool sendReliableData(const uint8_t* destination, const std::vector<uint8_t>& payload);
 
-    // Called from ReticulumNode::loop periodically
+    // Runs from the node's TimerService when the earliest link deadline expires
     void checkAllTimeouts();
 
+    // A unicast frame to this ESP-NOW neighbour was not MAC-ACKed: links routed through it
+    // retransmit their window now (possibly via a backup next hop) rather than at ACK timeout
+    void handleEspNowSendFailure(const uint8_t* mac);
+
     // Called by Link::teardown or externally if needed
     void removeLink(const uint8_t* destination);
 
     // Return the number of active links
     size_t getActiveLinkCount() const;
 
+    // Destinations of established links, RNS_ADDRESS_SIZE bytes each, for persisting across
+    // reboots. Session keys are never saved: restored links run a fresh handshake.
+    size_t exportLinkPeers(uint8_t* out, size_t capacity) const;
+    // Starts establishing a link to each saved destination. Returns the number initiated.
+    size_t reopenLinks(const uint8_t* peers, size_t len);
+    // Concurrent links the crypto pool allows
+    size_t getLinkCapacity() const { return _cryptoPool.getCapacity(); }
+
     // --- Methods needed by Link instances (called via ownerRef) ---
     const uint8_t* getNodeAddress() const;
     uint16_t getNextPacketId();
     // Send packet using the main node's interface manager
     void sendPacketRaw(const uint8_t* buffer, size_t len, const uint8_t* destination);
+    // Largest packet the interface towards destination carries
+    size_t getPathMtu(const uint8_t* destination);
+    // Report whether a data packet to destination was ACKed (routing metric feedback)
+    void reportDelivery(const uint8_t* destination, bool success);
     // Callback to pass received data up to the application layer via ReticulumNode
     void processReceivedLinkData(const uint8_t* source_address, const std::vector<uint8_t>& data);
+    // Per-link crypto context, keyed at handshake
+    bool establishSessionKey(size_t slot, const uint8_t* ownSecret, const uint8_t* ownPublic, const uint8_t* peerPublic) {
+        return _cryptoPool.establish(slot, ownSecret, ownPublic, peerPublic);
+    }
+    Crypto::Token* getCryptoContext(size_t slot) { return _cryptoPool.get(slot); }
+    void releaseCryptoSlot(size_t slot) { _cryptoPool.release(slot); }
 
 
 private:
@@ -56,6 +84,7 @@ private:
     using LinkPtr = std::shared_ptr<Link>;
     using LinkMap = std::map<std::array<uint8_t, RNS_ADDRESS_SIZE>, LinkPtr, ArrayCompare>;
 
+    LinkCryptoPool _cryptoPool; // Declared before _activeLinks: links release their slot on destruction
     LinkMap _activeLinks;       // Map destination address to Link object
     ReticulumNode& _ownerRef; // Reference back to main node
 
@@ -63,6 +92,13 @@ private:
     LinkPtr getOrCreateLink(const uint8_t* destination, bool create = true);
     // Helper to clean up inactive/closed links
     void pruneInactiveLinks();
+    // Re-arm the single timer covering the earliest deadline across all links
+    void armTimer();
+
+    TimerService::TimerId _timerId = TimerService::INVALID_TIMER;
+#if LINK_MULTIPATH_ENABLED
+    uint32_t _multipathCounter = 0; // Odd frames take the split path
+#endif
 
 };
 
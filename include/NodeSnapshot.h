@@ -0,0 +1,54 @@
+#ifndef NODE_SNAPSHOT_H
+#define NODE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include "Config.h"
+#include "RoutingTable.h"
+#include "PathTable.h"
+#include "PacketFilter.h"
+
+// Binary snapshot of what the node has learned from the network, so a reboot or OTA
+// does not leave it flooding every packet until announces arrive again:
+//   [magic "RNSS"][version 1][saved at: wall-clock s 4][clock synced 1]
+//   then sections [type 1][length 2][body]: routes, paths, packet filter, announces
+// Bodies are the tables' own export formats, with entry ages relative to the save.
+// On load, every age grows by the downtime, measured by the wall clock. If that is
+// not comparable (the clock was NTP-synced on one side only, or went backwards after
+// a power cycle) STATE_UNKNOWN_DOWNTIME_MS is assumed. Entries that would have
+// expired while the node was down are dropped. Unknown sections are skipped.
+class NodeSnapshot {
+public:
+    static const uint8_t VERSION = 1;
+    static const size_t HEADER_SIZE = 10;
+
+    struct Restored {
+        unsigned long downtimeMs = 0;
+        bool downtimeKnown = false;
+        size_t routes = 0;
+        size_t paths = 0;
+        size_t announces = 0; // Paths that came back with their announce (known identity)
+        size_t rejected = 0;  // Announces that failed checkAnnounce; their paths were dropped
+        bool filter = false;
+    };
+
+    // Returns the snapshot length, 0 if capacity cannot hold the header. Announces are
+    // written last, newest first, into whatever room the rest leaves.
+    static size_t write(uint8_t* out, size_t capacity, const RoutingTable& routes, const PathTable& paths,
+                        const PacketFilter& filter, time_t wallNow);
+    // false if data is not a snapshot this version understands. checkAnnounce verifies
+    // each saved announce before it is trusted again (see PathTable::importAnnounces).
+    static bool read(const uint8_t* data, size_t len, RoutingTable& routes, PathTable& paths,
+                     PacketFilter& filter, time_t wallNow, Restored& result,
+                     const PathTable::AnnounceCheck& checkAnnounce = nullptr);
+
+    // Time since epoch looks NTP-set (after 2020-01-01)
+    static bool isClockSynced(time_t wallNow) { return wallNow > 1577836800; }
+
+private:
+    // Section 4 held announces without their ratchet flag; it is skipped like any unknown one
+    enum Section : uint8_t { ROUTES = 1, PATHS = 2, FILTER = 3, ANNOUNCES = 5 };
+};
+
+#endif // NODE_SNAPSHOT_H
@@ -0,0 +1,52 @@
+#ifndef PACKET_BUFFER_POOL_H
+#define PACKET_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Config.h"
+#include "ReticulumPacket.h" // For MAX_PACKET_SIZE
+
+// Fixed pool of PACKET_POOL_SIZE MAX_PACKET_SIZE buffers for packet staging
+// (receive, forward, serialize). With the full 500-byte MTU a stack buffer per
+// call would eat into the small WiFi-task stack the ESP-NOW receive callback runs
+// on, and heap buffers fragment; pool buffers cost neither. Acquisition is
+// lock-free so the receive callback and the main loop can share the pool.
+// An exhausted pool yields an empty Buffer: the caller drops the packet.
+class PacketBufferPool {
+public:
+    // Move-only handle; returns its buffer to the pool when destroyed
+    class Buffer {
+    public:
+        Buffer() : _index(-1) {}
+        Buffer(Buffer&& other) : _index(other._index) { other._index = -1; }
+        Buffer& operator=(Buffer&& other);
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+        ~Buffer() { release(); }
+
+        explicit operator bool() const { return _index >= 0; }
+        uint8_t* data() const;
+        static constexpr size_t capacity() { return MAX_PACKET_SIZE; }
+        void release();
+
+    private:
+        friend class PacketBufferPool;
+        explicit Buffer(int index) : _index(index) {}
+        int _index;
+    };
+
+    static Buffer acquire();
+
+    static size_t getFreeCount();
+    static uint32_t getExhaustedCount() { return _exhausted; }
+
+private:
+    static_assert(PACKET_POOL_SIZE <= 32, "In-use mask is 32 bits");
+
+    static uint8_t _buffers[PACKET_POOL_SIZE][MAX_PACKET_SIZE];
+    static std::atomic<uint32_t> _inUse;
+    static uint32_t _exhausted;
+};
+
+#endif // PACKET_BUFFER_POOL_H
@@ -0,0 +1,52 @@
+#ifndef PACKET_FILTER_H
+#define PACKET_FILTER_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include "Config.h"
+
+// Duplicate packet suppression with constant memory: a pair of Bloom filters
+// over a hash of each packet's hashable part. New hashes go into the current
+// filter; lookups check both. Every PACKET_FILTER_ROTATE_MS (or once the current
+// filter holds PACKET_FILTER_MAX_ENTRIES) the previous filter is discarded and
+// the current one takes its place, so a packet is remembered for one to two
+// rotation periods and the false-positive rate stays bounded under load.
+// Main loop only (no locking): checkAndInsert() and rotate() must not interleave.
+class PacketFilter {
+public:
+    PacketFilter();
+
+    // Reticulum's hashable part: low nibble of the flags byte plus everything after
+    // the hops byte (and after the transport ID for HEADER_2), so the same packet
+    // hashes equally at every hop.
+    static uint64_t hashPacket(const uint8_t* packet, size_t len);
+
+    bool contains(uint64_t hash) const;
+    void insert(uint64_t hash);
+    // Returns true if the packet was already seen; records it otherwise
+    bool checkAndInsert(const uint8_t* packet, size_t len);
+
+    void rotate(); // Age out the older filter
+
+    // Both filters merged, for warm restarts (EXPORT_SIZE bytes)
+    static const size_t EXPORT_SIZE = PACKET_FILTER_BITS / 8;
+    size_t exportBits(uint8_t* out, size_t capacity) const;
+    // Merges exported bits into the older filter: remembered until the next rotation
+    bool importBits(const uint8_t* data, size_t len);
+    size_t getCurrentCount() const { return _currentCount; }
+    uint32_t getDuplicateCount() const { return _duplicates; }
+
+private:
+    static const size_t FILTER_BYTES = PACKET_FILTER_BITS / 8;
+
+    bool testBits(const uint8_t* filter, uint64_t hash) const;
+    void setBits(uint8_t* filter, uint64_t hash);
+
+    uint8_t _filters[2][FILTER_BYTES];
+    uint8_t _current; // Index of the filter receiving inserts
+    size_t _currentCount;
+    uint32_t _duplicates;
+};
+
+#endif // PACKET_FILTER_H
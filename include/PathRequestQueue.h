@@ -0,0 +1,59 @@
+#ifndef PATH_REQUEST_QUEUE_H
+#define PATH_REQUEST_QUEUE_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+#include <cstring> // For memcmp
+#include <vector>
+#include "Config.h"
+#include "ReticulumPacket.h" // For RnsPacketInfo
+
+// Packets waiting for a path, and the path requests issued for them. A packet for
+// a destination without a path is held here while the node asks the network for
+// one; when the path arrives the packet is unicast along it. A destination whose
+// PATH_REQUEST_RETRIES requests went unanswered gives its packets back to be
+// flooded. At most PATH_QUEUE_MAX packets are held; the oldest one makes room.
+// Main loop only (no locking), like the timer that retries its requests.
+class PathRequestQueue {
+public:
+    struct Pending {
+        RnsPacketInfo packet;
+        InterfaceType incoming; // Not flooded back out of here
+        unsigned long queuedAt;
+    };
+
+    PathRequestQueue();
+
+    // Hold a packet until its destination has a path. Returns true if a path request
+    // for the destination should go out now (none is outstanding yet).
+    bool enqueue(const RnsPacketInfo& packet, InterfaceType incoming, unsigned long now = millis());
+
+    // A path to destinationHash is known: move its packets to out and forget the request
+    void take(const uint8_t* destinationHash, std::vector<Pending>& out);
+
+    // Requests whose response is overdue: destinations to ask again go to retry, packets
+    // of destinations out of retries go to expired
+    void poll(std::vector<std::array<uint8_t, RNS_TRUNCATED_HASHLENGTH_BYTES>>& retry,
+              std::vector<Pending>& expired, unsigned long now = millis());
+
+    bool empty() const { return _packets.empty(); }
+    size_t size() const { return _packets.size(); }
+    uint32_t getDroppedCount() const { return _dropped; }
+
+private:
+    struct Request {
+        uint8_t destination_hash[RNS_TRUNCATED_HASHLENGTH_BYTES];
+        uint8_t attempts;
+        unsigned long sentAt;
+    };
+
+    static bool sameHash(const uint8_t* a, const uint8_t* b) { return memcmp(a, b, RNS_TRUNCATED_HASHLENGTH_BYTES) == 0; }
+    void dropRequestIfUnused(const uint8_t* destinationHash);
+
+    std::vector<Pending> _packets; // Oldest first
+    std::vector<Request> _requests;
+    uint32_t _dropped;
+};
+
+#endif // PATH_REQUEST_QUEUE_H
@@ -0,0 +1,83 @@
+#ifndef PATH_TABLE_H
+#define PATH_TABLE_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Config.h"
+#include "ReticulumPacket.h" // For RNS_TRUNCATED_HASHLENGTH_BYTES
+#include "RoutingTable.h"    // For RouteCandidate
+
+// Reticulum transport paths, keyed by 16-byte destination hash and learned from
+// announces in the official wire format. For each destination the table keeps the
+// transport ID to address the next hop by (the transport node that rebroadcast the
+// announce, or the destination itself if it announced directly) and the neighbour
+// link to send on. HEADER_2 packets addressed to this node are forwarded along it.
+//
+// A path is replaced by one with no more hops, by any announce through the same
+// next hop, or once it has gone PATH_TIMEOUT_MS without being re-announced. A full
+// table recycles its oldest entry. The announce behind each path is kept so path
+// requests for the destination can be answered without the destination's help.
+// Main loop only (no locking): received packets, including ESP-NOW frames, are
+// handled there, and paths hold vectors that must not change under an iterator.
+class PathTable {
+public:
+    struct Path {
+        uint8_t destination_hash[RNS_TRUNCATED_HASHLENGTH_BYTES];
+        uint8_t next_hop[RNS_TRUNCATED_HASHLENGTH_BYTES]; // Transport ID to put in HEADER_2
+        uint8_t hops;         // To the destination; 1 = the destination is a neighbour
+        RouteCandidate via;   // Neighbour link the next hop was heard on
+        unsigned long updated;
+        std::vector<uint8_t> announce; // Latest announce payload, replayed to answer path requests
+        bool ratchet;                  // The announce was sent with the context flag (carries a ratchet)
+    };
+
+    PathTable();
+
+    // An announce for destinationHash arrived through nextHop, hops away (counting the
+    // hop to us). Returns false if a shorter unexpired path through another hop is kept.
+    bool update(const uint8_t* destinationHash, const uint8_t* nextHop, uint8_t hops,
+                InterfaceType interface, const uint8_t* senderMac, const IPAddress& senderIp,
+                uint16_t senderPort, unsigned long now = millis());
+
+    // Remember the announce payload of a destination with a path, for path responses.
+    // ratchet is the announce packet's context flag, needed to parse the payload again.
+    void cacheAnnounce(const uint8_t* destinationHash, const std::vector<uint8_t>& data, bool ratchet);
+
+    // Unexpired path to destinationHash, nullptr if none
+    const Path* find(const uint8_t* destinationHash, unsigned long now = millis()) const;
+
+    // Forget the path to destinationHash (e.g. its announce proved forged)
+    void remove(const uint8_t* destinationHash);
+    void expire(unsigned long now = millis());
+    size_t size() const { return _count; }
+
+    // Compact copy of the table for warm restarts:
+    //   [destination 16][next hop 16][hops 1][interface 1][mac 6][ip 4][port 2][age s 4]
+    static const size_t EXPORT_RECORD_SIZE = 50;
+    size_t exportPaths(uint8_t* out, size_t capacity, unsigned long now = millis()) const;
+    // Adds exported paths not known yet, extraAgeMs older than when saved (the downtime).
+    // Paths that would have expired are skipped. Returns the number restored.
+    size_t importPaths(const uint8_t* data, size_t len, unsigned long extraAgeMs, unsigned long now = millis());
+    // Cached announces (the known identities), newest paths first, as
+    // [destination 16][ratchet 1][length 2][announce]; stops at the first that does not fit
+    size_t exportAnnounces(uint8_t* out, size_t capacity) const;
+    // Saved announces are not trusted as is: check (if given) verifies each one, and a
+    // path whose announce fails is removed and counted in rejected.
+    using AnnounceCheck = std::function<bool(const uint8_t* destinationHash, const uint8_t* announce, size_t len,
+                                             bool ratchet)>;
+    // For paths present; returns the number cached
+    size_t importAnnounces(const uint8_t* data, size_t len, const AnnounceCheck& check = nullptr,
+                           size_t* rejected = nullptr);
+
+private:
+    Path* findEntry(const uint8_t* destinationHash);
+    void removeAt(size_t index);
+    static bool isExpired(const Path& path, unsigned long now) { return now - path.updated > PATH_TIMEOUT_MS; }
+
+    Path _paths[PATH_TABLE_SIZE];
+    size_t _count;
+};
+
+#endif // PATH_TABLE_H
@@ -0,0 +1,54 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include "Config.h"
+
+// Wake-up sources signalled into the main loop's event group
+enum PowerEvent : uint32_t {
+    POWER_EVENT_UART_RX   = (1u << 0), // KISS serial bytes arrived
+    POWER_EVENT_ESPNOW_RX = (1u << 1), // ESP-NOW receive callback ran
+    POWER_EVENT_LORA_DIO  = (1u << 2), // LoRa DIO0 interrupt (RX done / TX done)
+    POWER_EVENT_WIFI      = (1u << 3), // Station got or lost its IP
+    POWER_EVENT_HTTP      = (1u << 4), // Web server task has a request for the loop
+    POWER_EVENT_ANNOUNCE  = (1u << 5), // Background announce signature check finished
+};
+const uint8_t POWER_EVENT_SOURCE_COUNT = 6;
+// WiFiUDP offers no RX callback, so UDP is covered by capping waits (LOW_POWER_UDP_POLL_MS)
+
+// Low-power scheduling for battery/solar nodes. With LOW_POWER_MODE_ENABLED the
+// main loop blocks on a FreeRTOS event group until an interface signals data or
+// the next TimerService deadline is due; the idle task then drops the chip into
+// automatic light sleep. Statistics are kept in both modes for the status API.
+class PowerManager {
+public:
+    // Create the event group and enable automatic light sleep (if built for it)
+    static void begin();
+
+    // Signal the main loop from task context (e.g. WiFi task callbacks)
+    static void notify(uint32_t events);
+    // Signal the main loop from an interrupt handler
+    static void IRAM_ATTR notifyFromISR(uint32_t events);
+
+    // Block until an event arrives or timeoutMs elapses (returns immediately when disabled)
+    static void waitForEvent(unsigned long timeoutMs);
+
+    static bool isLowPowerEnabled() { return LOW_POWER_MODE_ENABLED != 0; }
+    static bool isLightSleepActive() { return _lightSleepActive; }
+
+    // --- Statistics ---
+    static uint32_t getWakeCount(); // Total wake-ups from waitForEvent()
+    static uint32_t getWakeCount(PowerEvent source);
+    static uint32_t getTimerWakeCount() { return _timerWakes; } // Woken by deadline, no event
+    // Percentage of uptime spent outside waitForEvent() (100 when low-power mode is off)
+    static float getDutyCyclePercent();
+
+private:
+    static bool _lightSleepActive;
+    static uint32_t _sourceWakes[POWER_EVENT_SOURCE_COUNT];
+    static uint32_t _timerWakes;
+    static uint64_t _blockedUs; // Time spent waiting for events
+};
+
+#endif // POWER_MANAGER_H
@@ -15,6 +15,7 @@
 #define RNS_HEADER_TYPE_ANN   0x02
 #define RNS_HEADER_TYPE_MASK  0x0F
 #define RNS_HEADER_FLAG_REQUEST_ACK_MASK  0x10
+#define RNS_HEADER_FLAG_PIGGYBACK_ACK_MASK 0x20 // LINK_DATA payload starts with a cumulative ACK sequence
 
 // Legacy Destination Types (old format)
 #define RNS_DST_TYPE_SINGLE  0x00
@@ -23,6 +24,9 @@
 // Legacy size constants
 // Note: RNS_SEQ_SIZE is defined in Config.h
 const size_t RNS_MIN_HEADER_SIZE = 2 + 2 * RNS_ADDRESS_SIZE + 2;  // header_type + dest + src + packet_id
+// Legacy link frame up to (not including) the sequence number:
+// header_type, context, packet_id(2), hops, then type + length + address for dest and src
+const size_t RNS_LEGACY_HEADER_SIZE = 5 + 2 * (2 + RNS_ADDRESS_SIZE);
 
 // --- Reticulum Official Wire Format Defines ---
 // Based on official Reticulum source code
@@ -53,7 +57,12 @@ const size_t RNS_MIN_HEADER_SIZE = 2 + 2 * RNS_ADDRESS_SIZE + 2;  // header_type
 const size_t RNS_TRUNCATED_HASHLENGTH_BYTES = 16;  // 128 bits / 8
 const size_t RNS_HEADER_1_SIZE = 2 + 16 + 1;  // flags + hops + dest_hash + context = 19 bytes
 const size_t RNS_HEADER_2_SIZE = 2 + 16 + 16 + 1;  // flags + hops + transport_id + dest_hash + context = 35 bytes
-const size_t MAX_PACKET_SIZE = RNS_HEADER_1_SIZE + RNS_MAX_PAYLOAD;
+// PLAIN destination "rnstransport.path.request": SHA-256(SHA-256(name)[:10])[:16]
+const uint8_t RNS_PATH_REQUEST_HASH[RNS_TRUNCATED_HASHLENGTH_BYTES] = {
+    0x6B, 0x9F, 0x66, 0x01, 0x4D, 0x98, 0x53, 0xFA, 0xAB, 0x22, 0x0F, 0xBA, 0x47, 0xD0, 0x27, 0x61
+};
+static_assert(RNS_HEADER_1_SIZE + RNS_MAX_PAYLOAD == RNS_MTU, "RNS_MAX_PAYLOAD must match the header size");
+const size_t MAX_PACKET_SIZE = RNS_MTU + RNS_IFAC_MAX_SIZE; // Largest frame any buffer must hold
 
 
 // --- Decoded Packet Info Structure (Hybrid: supports both formats) ---
@@ -69,6 +78,7 @@ struct RnsPacketInfo {
     bool ifac_flag = false;        // bit 7
 
     uint8_t hops = 0;
+    uint8_t transport_id[RNS_TRUNCATED_HASHLENGTH_BYTES] = {0};      // HEADER_2 only: next transport node
     uint8_t destination_hash[RNS_TRUNCATED_HASHLENGTH_BYTES] = {0};  // 16 bytes
     uint8_t context = RNS_CONTEXT_NONE;
 
@@ -109,11 +119,14 @@ struct RnsPacketInfo {
 
 // --- Serialization/Deserialization Functions ---
 namespace ReticulumPacket {
-    // Official Reticulum wire format deserialize
+    // Official Reticulum wire format deserialize (HEADER_1 and HEADER_2)
     bool deserialize(const uint8_t *buffer, size_t len, RnsPacketInfo &info);
 
     // Official Reticulum wire format serialize
-    // Format: [FLAGS 1] [HOPS 1] [DEST_HASH 16] [CONTEXT 1] [DATA]
+    // HEADER_1: [FLAGS 1] [HOPS 1] [DEST_HASH 16] [CONTEXT 1] [DATA]
+    // HEADER_2: [FLAGS 1] [HOPS 1] [TRANSPORT_ID 16] [DEST_HASH 16] [CONTEXT 1] [DATA]
+    // A non-null transport_id selects HEADER_2 (and transport propagation). context_flag
+    // is bit 5; pass it through when re-sending (an announce with it set has a ratchet).
     bool serialize(uint8_t *buffer, size_t &len,
                    const uint8_t* dest_hash_16bytes,  // Full 16-byte destination hash
                    uint8_t packet_type,                // RNS_PACKET_DATA, etc.
@@ -121,7 +134,9 @@ namespace ReticulumPacket {
                    uint8_t propagation_type,           // RNS_PROPAGATION_BROADCAST, etc.
                    uint8_t context,                    // RNS_CONTEXT_NONE, etc.
                    uint8_t hops,
-                   const std::vector<uint8_t>& data);  // Payload data (unencrypted for PLAIN)
+                   const std::vector<uint8_t>& data,   // Payload data (unencrypted for PLAIN)
+                   const uint8_t* transport_id = nullptr,
+                   bool context_flag = false);
 
     // --- Legacy Custom Format Functions (for Link layer) ---
     // Legacy serialize for data packets with sequence numbers
@@ -135,15 +150,38 @@ namespace ReticulumPacket {
                    uint8_t hops,
                    const std::vector<uint8_t>& payload,
                    uint16_t sequence_number);
+    // Same, for a payload that is not in a vector (e.g. sealed link data on the stack)
+    bool serialize(uint8_t *buffer, size_t &len,
+                   const uint8_t* destination,
+                   const uint8_t* source,
+                   uint8_t destination_type,
+                   uint8_t header_type,
+                   uint8_t context,
+                   uint16_t packet_id,
+                   uint8_t hops,
+                   const uint8_t* payload,
+                   size_t payload_len,
+                   uint16_t sequence_number);
 
-    // Legacy serialize for control packets (LINK_REQ, ACK, LINK_CLOSE)
+    // Legacy serialize for control packets (LINK_REQ, ACK, LINK_CLOSE). extra follows
+    // the sequence number (a link handshake's ephemeral key); buffer needs
+    // RNS_LEGACY_HEADER_SIZE + RNS_SEQ_SIZE + extra_len bytes.
     bool serialize_control(uint8_t *buffer, size_t &len,
                           const uint8_t* destination,
                           const uint8_t* source,
                           uint8_t header_type,
                           uint8_t context,
                           uint16_t packet_id,
-                          uint16_t sequence_number);
+                          uint16_t sequence_number,
+                          const uint8_t* extra = nullptr,
+                          size_t extra_len = 0);
+
+    // True for a frame built by the two functions above: a link context where the
+    // official format has its hop count, and 8-byte address fields after it
+    bool isLinkFrame(const uint8_t *buffer, size_t len);
+    // Legacy link frame deserialize. header_type keeps the whole legacy byte (ACK and
+    // piggyback flags included), sequence_number is filled and data starts after it.
+    bool deserializeLink(const uint8_t *buffer, size_t len, RnsPacketInfo &info);
 }
 
 #endif // RETICULUM_PACKET_H
@@ -5,10 +5,6 @@
 #include <cstdint>
 #include <IPAddress.h>
 #include <functional> // For callbacks if needed later
-#include <map>        // For recent announces
-#include <utility>    // For std::pair
-#include <vector>     // For recent announce ID value
-#include <array>      // For map key
 
 #include "Config.h"
 #include "ReticulumPacket.h" // For RnsPacketInfo
@@ -16,28 +12,34 @@
 // Forward declaration
 class InterfaceManager; // Needed? Only if RoutingTable needs to call InterfaceManager for peer removal
 
+// One way of reaching a destination, learned from an announce heard via a neighbour
+struct RouteCandidate {
+    InterfaceType interface;
+    uint8_t next_hop_mac[6];
+    IPAddress next_hop_ip;
+    uint16_t next_hop_port;
+    uint8_t hops;
+    unsigned long last_heard_time;
+    float link_quality;   // 0..1 from RSSI/SNR of the last announce, or ROUTE_LINK_QUALITY_UNKNOWN
+    float delivery_ratio; // EWMA of link ACK outcomes over this next hop; ETX = 1 / delivery_ratio
+    uint8_t consecutive_failures; // Send-status / ACK timeouts since the last success
+    unsigned long last_failure_time;
+};
+
 struct RouteEntry {
     uint8_t destination_addr[RNS_ADDRESS_SIZE];
+    // Copy of the active candidate, so callers need not know about candidates
     uint8_t next_hop_mac[6];
     IPAddress next_hop_ip;
     uint16_t next_hop_port;
     unsigned long last_heard_time;
     InterfaceType interface;
     uint8_t hops; // Store hops from Announce
-    // Note: RSSI is not reliably available via Arduino ESP-NOW API
-};
 
-// Structure to store recent announce IDs (Packet ID + Source Addr prefix)
-// Used as key in std::map for loop prevention
-struct RecentAnnounceKey {
-    uint16_t packet_id;
-    uint8_t source_prefix[4]; // Use first 4 bytes of source addr
-
-    // Need operator< for std::map
-    bool operator<(const RecentAnnounceKey& other) const {
-        if (packet_id != other.packet_id) return packet_id < other.packet_id;
-        return memcmp(source_prefix, other.source_prefix, sizeof(source_prefix)) < 0;
-    }
+    RouteCandidate candidates[ROUTE_MAX_CANDIDATES];
+    uint8_t candidate_count;
+    uint8_t active_candidate;
+    float cost; // Cost of the active candidate when it was last (re)selected
 };
 
 
@@ -45,36 +47,74 @@ class RoutingTable {
 public:
     RoutingTable();
 
-    // Updates table based on a received Announce packet
+    // Capacity (at most MAX_ROUTES) and expiry, from RuntimeConfig. A lower capacity
+    // applies as routes are added; routes already held stay until they expire.
+    void setLimits(size_t maxRoutes, unsigned long timeoutMs);
+    size_t getMaxRoutes() const { return _maxRoutes; }
+    unsigned long getTimeoutMs() const { return _timeoutMs; }
+
+    // Updates table based on a received Announce packet. Each (interface, next hop) the
+    // destination is heard through becomes a candidate; the cheapest one is used.
     void update(const RnsPacketInfo &announcePacket, InterfaceType interface,
                 const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port,
-                InterfaceManager* ifManager = nullptr);
+                InterfaceManager* ifManager = nullptr,
+                float linkQuality = ROUTE_LINK_QUALITY_UNKNOWN);
 
     // Finds the best route for a destination address
     RouteEntry* findRoute(const uint8_t *destination_addr);
 
-    // Removes expired routes
+    // Link layer feedback: was a packet sent along the active route to destination ACKed?
+    // Feeds the ETX of the active candidate and may move the route to a cheaper one.
+    void reportDelivery(const uint8_t *destination_addr, bool success);
+
+    // Send-status feedback for a neighbour (e.g. ESP-NOW MAC ACK). Applies to every route
+    // through that next hop; ROUTE_FAILOVER_FAILURES in a row fail those routes over to backups.
+    // linkQuality (0..1), if known, replaces the candidates' signal-based link quality.
+    void reportNextHopResult(InterfaceType interface, const uint8_t* mac, const IPAddress& ip, bool success,
+                             float linkQuality = ROUTE_LINK_QUALITY_UNKNOWN);
+
+    // True if this neighbour is one of destination's next hop candidates
+    bool hasNextHop(const uint8_t *destination_addr, InterfaceType interface, const uint8_t* mac, const IPAddress& ip);
+
+    // Second path for load-splitting: the cheapest usable candidate on another interface than
+    // the active one, within ROUTE_MULTIPATH_COST_RATIO of its cost. nullptr if there is none.
+    const RouteCandidate* findSplitCandidate(const uint8_t *destination_addr);
+
+    // Cost of reaching a destination through a candidate (lower is better). Age counts
+    // against the table's current route timeout (setLimits), not the Config.h default.
+    float candidateCost(const RouteCandidate& candidate, unsigned long now) const;
+    // Failed ROUTE_FAILOVER_FAILURES times in a row and still within the hold-down
+    static bool isCandidateDown(const RouteCandidate& candidate, unsigned long now);
+
+    // Removes expired routes (scheduled every PRUNE_INTERVAL_MS by the node's TimerService)
     void prune(InterfaceManager* ifManager = nullptr); // Pass IfMgr if peer removal is needed
 
+    // Compact copy of each route's active next hop, for persisting across reboots:
+    //   [destination 8][interface 1][hops 1][mac 6][ip 4][port 2][age s 2][delivery ratio 1]
+    // Backup candidates are not saved; announces bring them back.
+    static const size_t EXPORT_RECORD_SIZE = 25;
+    size_t exportRoutes(uint8_t* out, size_t capacity) const;
+    // Adds exported routes not known yet, extraAgeMs older than when saved (the downtime).
+    // Routes that would have timed out are skipped. Returns the number restored.
+    size_t importRoutes(const uint8_t* data, size_t len, unsigned long extraAgeMs = 0);
+
     // Prints the routing table to Serial
     void print();
 
     // Return current route count
     size_t getRouteCount() const;
 
-    // Announce forwarding prevention
-    bool shouldForwardAnnounce(uint16_t packet_id, const uint8_t* source_addr);
-    void markAnnounceForwarded(uint16_t packet_id, const uint8_t* source_addr);
-    void pruneRecentAnnounces(bool force = false);
-
 
 private:
     std::list<RouteEntry> _routes;
-    unsigned long _last_prune_time = 0;
-
-    // Map to track recently forwarded announce IDs and when they were seen
-    std::map<RecentAnnounceKey, unsigned long> _recentAnnounces;
-    unsigned long _last_recent_announce_prune = 0;
+    size_t _maxRoutes;
+    unsigned long _timeoutMs;
+
+    // Pick the cheapest candidate, switching only past ROUTE_SWITCH_HYSTERESIS unless forced
+    void selectCandidate(RouteEntry& entry, unsigned long now, bool force);
+    void removeCandidate(RouteEntry& entry, uint8_t index, InterfaceManager* ifManager);
+    // Count a success/failure against one candidate; fails over if the active one goes down
+    void recordCandidateResult(RouteEntry& entry, uint8_t index, bool success, unsigned long now);
 
 };
 
@@ -0,0 +1,83 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include "Config.h"
+
+// ArduinoJson is a dependency of the builds with JSON config or the REST API only
+#define RUNTIME_CONFIG_JSON (JSON_CONFIG_ENABLED || WEBSERVER_ENABLED)
+
+// Settings that can change without reflashing. Defaults come from Config.h; with
+// JSON_CONFIG_ENABLED, /config.json overrides them. The file is parsed once at boot
+// and again when the REST API stores a new one, so request handlers, the node and the
+// interfaces read plain fields instead of the file. Main loop only (no locking).
+//
+// config.json keys (all optional):
+//   node_name, wifi.ssid, wifi.password, api.token, api.public_key (64 hex chars),
+//   announce_interval_ms, routes.max, routes.timeout_ms, mtu.espnow, mtu.udp, mtu.lora
+class RuntimeConfig {
+public:
+    static const size_t NAME_MAX_LEN = 32;
+    static const size_t SSID_MAX_LEN = 32;     // 802.11 limit
+    static const size_t PASSWORD_MAX_LEN = 64; // WPA2 passphrase limit
+    static const size_t TOKEN_MAX_LEN = 64;
+    static const size_t PUBLIC_KEY_SIZE = 32;
+
+    RuntimeConfig();
+
+    // Back to the Config.h values
+    void setDefaults();
+
+    // Setters validate and return false (leaving the value unchanged) if out of range
+    bool setNodeName(const char* name);
+    bool setWiFiCredentials(const char* ssid, const char* password);
+    bool setApiToken(const char* token); // Surrounding whitespace is trimmed; empty disables auth
+    bool setOtaPublicKeyHex(const char* hex); // Empty clears the key
+    bool setAnnounceInterval(unsigned long intervalMs); // Also rescales the default route timeout
+    bool setRouteLimits(size_t maxRoutes, unsigned long timeoutMs);
+    bool setInterfaceMtu(InterfaceType ifType, size_t mtu); // 0 = the medium's own MTU
+
+#if RUNTIME_CONFIG_JSON
+    // Replaces every setting with defaults + the given JSON. On a bad value, nothing
+    // changes and false is returned with the offending key in error.
+    bool parse(const char* json, size_t len, String* error = nullptr);
+#endif
+    // Reads RUNTIME_CONFIG_PATH; keeps the current settings if it is missing or invalid
+    bool load(const char* path = RUNTIME_CONFIG_PATH);
+
+    const char* getNodeName() const { return _nodeName; }
+    const char* getWiFiSsid() const { return _wifiSsid; }
+    const char* getWiFiPassword() const { return _wifiPassword; }
+    const char* getApiToken() const { return _apiToken; }
+    bool hasApiToken() const { return _apiToken[0] != '\0'; }
+    const uint8_t* getOtaPublicKey() const { return _hasOtaPublicKey ? _otaPublicKey : nullptr; }
+    unsigned long getAnnounceIntervalMs() const { return _announceIntervalMs; }
+    size_t getMaxRoutes() const { return _maxRoutes; }
+    unsigned long getRouteTimeoutMs() const { return _routeTimeoutMs; }
+    size_t getInterfaceMtu(InterfaceType ifType) const; // 0 if not overridden
+    uint32_t getLoadCount() const { return _loads; }
+
+private:
+    static bool copyText(char* out, size_t capacity, const char* text);
+
+    char _nodeName[NAME_MAX_LEN + 1];
+    char _wifiSsid[SSID_MAX_LEN + 1];
+    char _wifiPassword[PASSWORD_MAX_LEN + 1];
+    char _apiToken[TOKEN_MAX_LEN + 1];
+    uint8_t _otaPublicKey[PUBLIC_KEY_SIZE];
+    bool _hasOtaPublicKey;
+    unsigned long _announceIntervalMs;
+    size_t _maxRoutes;
+    unsigned long _routeTimeoutMs;
+    bool _routeTimeoutSet; // Else it follows the announce interval
+    uint16_t _espNowMtu;
+    uint16_t _udpMtu;
+    uint16_t _loraMtu;
+    uint32_t _loads; // Successful load()/parse() calls
+};
+
+extern RuntimeConfig runtimeConfig;
+
+#endif // RUNTIME_CONFIG_H
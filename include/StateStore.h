@@ -0,0 +1,110 @@
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "Config.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+// Node state kept across reboots, one NVS key per record. NVS is log-structured:
+// a write appends a new entry and retires the old one, so wear is spread over the
+// whole partition. Writes are staged in a heap buffer and committed by a low-priority
+// FreeRTOS task, so the main loop never waits for a flash erase. Without the task
+// (host builds, or if it failed to start) stage() commits on the spot. Records
+// whose content did not change since the last commit are not rewritten.
+//
+// Packet IDs are reserved PACKET_ID_BLOCK at a time: the store persists the last ID
+// of the reserved range, and after a reboot numbering resumes past it. A busy node
+// writes once per PACKET_ID_BLOCK / 2 IDs instead of once every few packets.
+//
+// On the single-core ESP32-C3 a flash erase still pauses every task for a moment;
+// what the task saves the loop is the rest of the commit, and what the batching
+// saves is most of the erases.
+class StateStore {
+public:
+    enum class Record : uint8_t {
+        ADDRESS,   // Node address (RNS_ADDRESS_SIZE)
+        IDENTITY,  // Identity private key (Identity::PRIVATE_KEY_SIZE)
+        PACKET_ID, // Last ID of the reserved packet ID range (uint16, little endian)
+        SNAPSHOT,  // NodeSnapshot: routes, paths, known identities, packet filter
+        LINKS,     // LinkManager::exportLinkPeers()
+        COUNT
+    };
+
+    explicit StateStore(const char* nvsNamespace = STATE_NVS_NAMESPACE);
+    ~StateStore();
+
+    // Open NVS and start the commit task. false if NVS is unavailable: nothing persists.
+    bool begin();
+    bool isOpen() const { return _open; }
+
+    // Largest size a record can hold
+    static size_t capacity(Record record);
+
+    // Read a record straight from NVS; 0 if it was never written or does not fit
+    size_t load(Record record, uint8_t* out, size_t outCapacity);
+    // Calls use() with the record's content (if any), read into a temporary heap buffer
+    bool loadWith(Record record, const std::function<void(const uint8_t* data, size_t len)>& use);
+
+    // Queue a record for writing. Returns false if it is too large.
+    bool stage(Record record, const uint8_t* data, size_t len);
+    // fill() writes the record into a fresh staging buffer and returns its length
+    bool stageWith(Record record, const std::function<size_t(uint8_t* out, size_t capacity)>& fill);
+    // Commit everything staged, on the caller's task (before a restart)
+    void flush();
+
+    // Numbering resumes after the range reserved before the last reboot. Call after begin().
+    void beginPacketIds(uint16_t fallbackStart);
+    uint16_t nextPacketId();
+
+    uint32_t getCommitCount() const { return _commits; }   // Records written to flash
+    uint32_t getUnchangedCount() const { return _unchanged; } // Staged but identical to flash
+    uint32_t getFailedCount() const { return _failed; }
+    bool isTaskRunning() const;
+
+private:
+    struct Slot {
+        std::unique_ptr<uint8_t[]> data; // Staged and not committed yet, or null
+        size_t len = 0;
+        uint32_t committedHash = 0;      // Of what flash holds, 0 if unknown
+    };
+
+    void lock();
+    void unlock();
+    void lockCommit();
+    void unlockCommit();
+    size_t read(size_t index, uint8_t* out, size_t outCapacity);
+    void requestCommit();
+    void commitDirty();
+    void reservePacketIds();
+
+    const char* _namespace;
+    Preferences _prefs;
+    bool _open;
+    Slot _slots[static_cast<size_t>(Record::COUNT)];
+
+    uint16_t _packetId;
+    uint16_t _reservedEnd; // Last ID covered by the persisted reservation
+
+#if defined(ARDUINO_ARCH_ESP32)
+    static void taskMain(void* arg);
+    TaskHandle_t _task;
+    SemaphoreHandle_t _stageLock;  // Slot buffers (held for a pointer swap)
+    SemaphoreHandle_t _commitLock; // NVS writes and committedHash
+#endif
+
+    uint32_t _commits;
+    uint32_t _unchanged;
+    uint32_t _failed;
+};
+
+#endif // STATE_STORE_H
@@ -0,0 +1,54 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include <vector>
+#include <functional> // For std::function
+
+// Deadline scheduler backed by a min-heap ordered on millis() deadlines.
+// Components schedule the next time they need attention; ReticulumNode::loop()
+// only runs what has expired instead of every component polling millis().
+class TimerService {
+public:
+    using TimerId = uint32_t;
+    using Callback = std::function<void()>;
+    static const TimerId INVALID_TIMER = 0;
+
+    TimerService();
+
+    // One-shot timer firing delayMs from now. Returns a handle for cancel().
+    TimerId schedule(unsigned long delayMs, Callback callback, unsigned long now = millis());
+    // Repeating timer, first firing after intervalMs. Keeps its id across firings.
+    TimerId schedulePeriodic(unsigned long intervalMs, Callback callback, unsigned long now = millis());
+    // Cancel id (if still pending) and schedule a one-shot in its place
+    TimerId reschedule(TimerId id, unsigned long delayMs, Callback callback, unsigned long now = millis());
+    // Remove a pending timer (no-op if already fired or invalid)
+    void cancel(TimerId id);
+    bool isPending(TimerId id) const;
+
+    // Fire every timer whose deadline has passed. Returns number of callbacks run.
+    size_t runExpired(unsigned long now = millis());
+    // Milliseconds until the earliest deadline (0 if overdue, ULONG_MAX if nothing scheduled)
+    unsigned long msUntilNext(unsigned long now = millis()) const;
+    size_t getPendingCount() const { return _heap.size(); }
+
+private:
+    struct Timer {
+        unsigned long deadline;
+        unsigned long period; // 0 for one-shot
+        TimerId id;
+        Callback callback;
+    };
+    // Heap comparator: earliest deadline on top (wrap-around safe)
+    struct FiresLater {
+        bool operator()(const Timer& a, const Timer& b) const { return (long)(a.deadline - b.deadline) > 0; }
+    };
+
+    TimerId push(unsigned long delayMs, unsigned long period, Callback callback, unsigned long now, TimerId id = INVALID_TIMER);
+
+    std::vector<Timer> _heap;
+    TimerId _nextId = 1;
+};
+
+#endif // TIMER_SERVICE_H
@@ -6,15 +6,19 @@
 
 class WebServerManager {
 public:
-    // Initialize the web UI / REST API (no-op when disabled)
+    // Initialize the web UI / REST API (no-op when disabled). Connections are accepted,
+    // read and written by a server task with non-blocking sockets, so slow clients
+    // never hold up the main loop.
     static void begin();
 
-    // Call from main loop to service any async tasks
+    // Call from main loop: runs the handler for a request the server task has
+    // completely received (handlers read node state, which the loop owns)
     static void loop();
 
-    // Load/Save runtime JSON config (returns false if not implemented)
-    static bool loadConfigFromFS(const char* path = "/config.json");
-    static bool saveConfigToFS(const char* path = "/config.json");
+    // Reload the RuntimeConfig from a JSON file and apply it to the node (false if
+    // missing, invalid or not implemented); save only reports whether the file exists
+    static bool loadConfigFromFS(const char* path = RUNTIME_CONFIG_PATH);
+    static bool saveConfigToFS(const char* path = RUNTIME_CONFIG_PATH);
 };
 
 #endif // WEBSERVER_MANAGER_H
@@ -0,0 +1,83 @@
+#ifndef WIFI_CONNECTION_H
+#define WIFI_CONNECTION_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstdint>
+#include "Config.h"
+
+// Station connection state, driven by WiFi/IP events instead of a blocking wait at
+// boot. The event handler (Arduino event task) only posts events; the main loop
+// applies them in poll() and carries out the returned actions, so UDP and NTP are
+// attached and detached on the loop's own task. A failed attempt or a lost
+// connection is retried after WIFI_RECONNECT_MIN_MS, doubling up to
+// WIFI_RECONNECT_MAX_MS: a node away from its access point does not spend the
+// radio on a channel scan every few seconds while ESP-NOW and LoRa carry traffic.
+// A failed attempt is dropped (WiFi.disconnect) as the backoff starts, so each retry
+// begins from a clean station; the disconnect event that follows is ignored.
+class WiFiConnection {
+public:
+    enum class State : uint8_t {
+        IDLE,       // begin() not called yet, or stopped (no SSID configured)
+        CONNECTING, // Attempt in progress, waiting for an IP
+        CONNECTED,  // Station has an IP
+        BACKOFF     // Waiting to retry
+    };
+
+    // Posted from the event handler
+    enum Event : uint32_t {
+        EVENT_GOT_IP       = (1u << 0),
+        EVENT_LOST_IP      = (1u << 1),
+        EVENT_DISCONNECTED = (1u << 2),
+    };
+
+    // Returned by begin()/stop()/poll(), carried out by the caller in this order
+    enum Action : uint8_t {
+        ACTION_NONE       = 0,
+        ACTION_DETACH     = (1u << 0), // Connection lost: stop UDP
+        ACTION_DISCONNECT = (1u << 1), // Attempt failed or connection lost: drop it (WiFi.disconnect)
+        ACTION_CONNECT    = (1u << 2), // Start an attempt (WiFi.begin)
+        ACTION_ATTACH     = (1u << 3), // IP obtained: start UDP, (re)start NTP
+    };
+
+    WiFiConnection();
+
+    // First attempt, right away
+    uint8_t begin(unsigned long now = millis());
+    // Back to IDLE without retries, e.g. when the SSID is cleared; begin() starts again
+    uint8_t stop();
+    // Safe from any task
+    void post(Event event);
+    // Apply pending events, connect timeout and retry time
+    uint8_t poll(unsigned long now = millis());
+
+    bool isConnected() const { return _state == State::CONNECTED; }
+    State getState() const { return _state; }
+    // Until poll() has something to do without an event (ULONG_MAX if nothing is scheduled)
+    unsigned long msUntilDeadline(unsigned long now = millis()) const;
+
+    // Wait before the retry that follows the given number of consecutive failures
+    static unsigned long backoffDelay(uint8_t failures);
+
+    uint32_t getAttemptCount() const { return _attempts; }
+    uint32_t getConnectCount() const { return _connects; }   // Times an IP was obtained
+    uint32_t getDisconnectCount() const { return _disconnects; }
+    uint8_t getFailureStreak() const { return _failures; }
+    unsigned long getFirstConnectMs() const { return _firstConnectMs; } // millis() of the first IP, 0 if never
+
+private:
+    void fail(unsigned long now);
+    void connected(unsigned long now);
+
+    std::atomic<uint32_t> _pending;
+    std::atomic<uint32_t> _lastEvent; // Settles GOT_IP vs. DISCONNECTED when both are pending
+    State _state;
+    uint8_t _failures;
+    unsigned long _deadline; // Connect timeout (CONNECTING) or retry time (BACKOFF)
+    uint32_t _attempts;
+    uint32_t _connects;
+    uint32_t _disconnects;
+    unsigned long _firstConnectMs;
+};
+
+#endif // WIFI_CONNECTION_H
@@ -13,6 +13,15 @@
 #include "InterfaceManager.h"
 #include "RoutingTable.h"
 #include "LinkManager.h" // Include the LinkManager header
+#include "TimerService.h"
+#include "PacketFilter.h"
+#include "PathTable.h"
+#include "PathRequestQueue.h"
+#include "Identity.h"
+#include "AnnounceValidator.h"
+#include "StateStore.h"
+#include "NodeSnapshot.h"
+#include "RuntimeConfig.h"
 
 // Callback for application layer to receive data from Links
 using AppDataHandler = std::function<void(const uint8_t* source_address, const std::vector<uint8_t>& data)>;
@@ -29,6 +38,28 @@ public:
     InterfaceManager& getInterfaceManager() { return _interfaceManager; }
     LinkManager& getLinkManager() { return _linkManager; }
     RoutingTable& getRoutingTable() { return _routingTable; }
+    const PathTable& getPathTable() const { return _pathTable; }
+    // X25519/Ed25519 keys this node does key exchange and signs with
+    const Identity& getIdentity() const { return _identity; }
+    // 16-byte ID other Reticulum nodes address HEADER_2 packets to when routing through us
+    const uint8_t* getTransportId() const { return _transportId; }
+    uint32_t getTransportForwardCount() const { return _transportForwarded; }
+    const PathRequestQueue& getPathRequestQueue() const { return _pathRequests; }
+    uint32_t getPathRequestsSent() const { return _pathRequestsSent; }
+    uint32_t getPathResponsesSent() const { return _pathResponsesSent; }
+    uint32_t getPathFallbackFloods() const { return _pathFallbackFloods; }
+    const AnnounceValidator& getAnnounceValidator() const { return _announceValidator; }
+    uint32_t getAnnouncesRejected() const { return _announcesRejected; } // Malformed or forged
+    size_t getPendingAnnounceCount() const { return _pendingAnnounces.size(); } // New paths awaiting their verdict
+    TimerService& getTimerService() { return _timers; }
+    const StateStore& getStateStore() const { return _stateStore; }
+    const NodeSnapshot::Restored& getWarmStart() const { return _warmStart; } // What the boot snapshot restored
+    // Save routes and links and wait for the write, e.g. right before ESP.restart()
+    void saveStateForRestart();
+    // Takes up a new RuntimeConfig (loaded at boot in setup()): announce interval, route limits, interfaces
+    void applyRuntimeConfig(const RuntimeConfig& previous);
+    // Milliseconds until the next scheduled deadline (idle time available to the caller)
+    unsigned long getMsUntilNextDeadline() const { return _timers.msUntilNext(); }
 
     // --- Application Layer Integration ---
     // Sets the handler function for received link data
@@ -38,17 +69,21 @@ public:
 
 private:
     // --- Initialization Helpers ---
-    void loadConfig();                // Loads address/packet ID from EEPROM
-    void loadOrGenerateAddress();     // Load existing or generate new node address
-    void savePacketCounterIfNeeded(); // Saves packet ID to EEPROM periodically
-    void loadPacketCounter();
+    void loadConfig();                // Loads address/identity/packet IDs from the state store
+    void loadOrGenerateAddress(uint16_t& packetIdStart); // Load existing (or EEPROM-migrated) or generate new
+    void loadOrGenerateIdentity();
     void generateNodeAddress();
+    void deriveTransportId();
     void saveNodeAddress();
     void printNodeAddress();
 
-    // --- Periodic Tasks ---
+    // --- Periodic Tasks (driven by _timers) ---
+    void schedulePeriodicTasks();
+    void scheduleAnnounces(unsigned long firstDelayMs); // Then every RuntimeConfig announce interval
     void checkMemoryUsage();
-    void sendAnnounceIfNeeded(); // Generates and sends announce packets
+    void restoreState(); // Snapshot (routes, paths, identities, filter) now, saved links once interfaces are up
+    void saveState();    // Stage the snapshot and open links; the store writes what changed
+    void sendAnnounce(); // Generates and sends announce packets
 
     // --- Core Packet Handling ---
     // Main callback passed to InterfaceManager
@@ -58,22 +93,67 @@ private:
     void processPacketForSelf(const RnsPacketInfo& packetInfo, InterfaceType interface);
     // Handles forwarding of non-link, non-announce packets
     void forwardPacket(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface);
-    // Handles forwarding/re-broadcasting of announce packets
-    void forwardAnnounce(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface);
+    // Sends via the routing table's route, or broadcasts if there is none
+    void floodPacket(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface);
+
+    // --- Reticulum Transport (official wire format) ---
+    // Checks an announce, holding it until its signature is verified if it would change a path
+    void handleTransportAnnounce(const RnsPacketInfo& packetInfo, InterfaceType interface, bool duplicate,
+                                 const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port);
+    // Learns the path and route from a verified announce and rebroadcasts it with our transport ID (HEADER_2)
+    void acceptTransportAnnounce(const RnsPacketInfo& packetInfo, InterfaceType interface, bool duplicate,
+                                 const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port,
+                                 float linkQuality);
+    // Forwards a HEADER_2 packet addressed to us to the next hop on the destination's path
+    void forwardTransport(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface);
+    // Sends along the destination's path, or queues the packet and requests a path
+    void forwardViaPath(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface);
+    void sendAlongPath(const RnsPacketInfo& packetInfo, const PathTable::Path& path);
+    void sendAwaitingPath(const uint8_t* destinationHash); // A path arrived: release queued packets
+    void sendPathRequest(const uint8_t* destinationHash);
+    // Answers from the path table, or passes the request on
+    void handlePathRequest(const RnsPacketInfo& packetInfo, InterfaceType interface);
+    void processPathRequests(); // Retries overdue requests; floods packets nobody found a path for
+    // Accepts held announces that verified; drops held or refreshed ones found forged
+    void applyAnnounceVerdicts();
 
     // --- Member Variables ---
     uint8_t _nodeAddress[RNS_ADDRESS_SIZE];
-    uint16_t _packetCounter = 0;
-    uint16_t _packetIdUnsavedCount = 0;
+    uint8_t _transportId[RNS_TRUNCATED_HASHLENGTH_BYTES];
+    Identity _identity;
+    uint32_t _transportForwarded = 0;
+    uint32_t _pathRequestsSent = 0;
+    uint32_t _pathResponsesSent = 0;
+    uint32_t _pathFallbackFloods = 0;
+    uint32_t _announcesRejected = 0;
+    std::vector<AnnounceValidator::Verdict> _announceVerdicts; // Reused by applyAnnounceVerdicts()
+    // Announces that would install or move a path, waiting for their signature check
+    struct PendingAnnounce {
+        uint8_t digest[AnnounceValidator::DIGEST_SIZE];
+        RnsPacketInfo packet;
+        InterfaceType interface;
+        bool duplicate;
+        bool hasSenderMac;
+        uint8_t senderMac[6];
+        IPAddress senderIp;
+        uint16_t senderPort;
+        float linkQuality; // Of the reception, for the route candidate
+    };
+    std::vector<PendingAnnounce> _pendingAnnounces; // At most ANNOUNCE_PENDING_MAX, oldest first
+    TimerService::TimerId _pathRequestTimer = TimerService::INVALID_TIMER;
+    TimerService::TimerId _announceTimer = TimerService::INVALID_TIMER;
 
+    StateStore _stateStore;           // NVS-backed address, identity, packet IDs, snapshot, links
+    NodeSnapshot::Restored _warmStart;
+    TimerService _timers;             // Deadlines for periodic tasks, links, routes
+    PacketFilter _packetFilter;       // Duplicate suppression for announces and data
     RoutingTable _routingTable;       // Owns the routing table instance
+    PathTable _pathTable;             // Transport next hops by 16-byte destination hash
+    PathRequestQueue _pathRequests;   // Packets waiting for a path response
+    AnnounceValidator _announceValidator; // Announce signature checks and their cache
     InterfaceManager _interfaceManager; // Owns the interface manager instance
     LinkManager _linkManager;         // Owns the link manager instance
 
-    // Timers for periodic tasks
-    unsigned long _last_announce_time = 0;
-    unsigned long _last_mem_check_time = 0;
-
     // Application layer data handler
     AppDataHandler _appDataHandler = nullptr;
 
@@ -0,0 +1,67 @@
+#include "AirtimeTracker.h"
+#include <algorithm> // For std::max
+#include <cmath>   // For ceil
+#include <cstring> // For memset
+
+AirtimeTracker::AirtimeTracker(float budgetPercent, unsigned long windowMs) :
+    _budgetMs((uint32_t)(windowMs * (budgetPercent / 100.0f))),
+    _bucketMs(windowMs / BUCKET_COUNT > 0 ? windowMs / BUCKET_COUNT : 1),
+    _bucketStart(0),
+    _current(0)
+{
+    memset(_buckets, 0, sizeof(_buckets));
+}
+
+uint32_t AirtimeTracker::loraTimeOnAirMs(size_t payloadLen, uint8_t spreadingFactor, float bandwidthKHz,
+                                         uint8_t codingRate, uint16_t preambleLength) {
+    if (bandwidthKHz <= 0.0f) return 0;
+    // Config/RadioLib express coding rate as the 4/x denominator (5-8); the formula wants 1-4
+    int cr = codingRate >= 5 ? codingRate - 4 : codingRate;
+    double symbolMs = (double)(1UL << spreadingFactor) / bandwidthKHz;
+    int lowDataRateOptimize = symbolMs > 16.0 ? 1 : 0; // Mandated above 16 ms symbols
+
+    double preambleMs = (preambleLength + 4.25) * symbolMs;
+    // Explicit header (IH = 0), CRC on
+    double numerator = 8.0 * payloadLen - 4.0 * spreadingFactor + 28 + 16;
+    double denominator = 4.0 * (spreadingFactor - 2 * lowDataRateOptimize);
+    double payloadSymbols = 8 + std::max(std::ceil(numerator / denominator) * (cr + 4), 0.0);
+
+    return (uint32_t)std::ceil(preambleMs + payloadSymbols * symbolMs);
+}
+
+void AirtimeTracker::advance(unsigned long now) {
+    unsigned long elapsed = now - _bucketStart;
+    if (elapsed < _bucketMs) return;
+
+    unsigned long steps = elapsed / _bucketMs;
+    if (steps >= BUCKET_COUNT) {
+        memset(_buckets, 0, sizeof(_buckets)); // Whole window has passed
+    } else {
+        for (unsigned long i = 0; i < steps; i++) {
+            _current = (_current + 1) % BUCKET_COUNT;
+            _buckets[_current] = 0;
+        }
+    }
+    _bucketStart += steps * _bucketMs;
+}
+
+uint32_t AirtimeTracker::getUsedMs(unsigned long now) {
+    advance(now);
+    uint32_t used = 0;
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) used += _buckets[i];
+    return used;
+}
+
+bool AirtimeTracker::canTransmit(uint32_t airtimeMs, unsigned long now) {
+    return getUsedMs(now) + airtimeMs <= _budgetMs;
+}
+
+void AirtimeTracker::record(uint32_t airtimeMs, unsigned long now) {
+    advance(now);
+    _buckets[_current] += airtimeMs;
+}
+
+float AirtimeTracker::getUtilizationPercent(unsigned long now) {
+    if (_budgetMs == 0) return 100.0f;
+    return 100.0f * (float)getUsedMs(now) / (float)_budgetMs;
+}
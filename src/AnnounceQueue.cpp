@@ -0,0 +1,108 @@
+#include "AnnounceQueue.h"
+#include "Utils.h"   // For compareAddresses
+#include <algorithm> // For std::max
+#include <climits>   // For ULONG_MAX
+#include <cstring>   // For memcpy, memset
+
+AnnounceQueue::AnnounceQueue(size_t maxEntries) :
+    _maxEntries(maxEntries),
+    _suppressed(0),
+    _dropped(0)
+{
+    memset(_lastTxAt, 0, sizeof(_lastTxAt));
+    memset(_holdoffMs, 0, sizeof(_holdoffMs));
+    _entries.reserve(maxEntries);
+}
+
+bool AnnounceQueue::enqueue(const uint8_t* packet, size_t packetLen, const uint8_t* announcedAddr, uint8_t hops,
+                            uint32_t interfaceMask, unsigned long delayMs, unsigned long now) {
+    if (!packet || packetLen == 0 || !announcedAddr || interfaceMask == 0) return false;
+
+    Entry* slot = nullptr;
+    for (auto& entry : _entries) {
+        if (Utils::compareAddresses(entry.announced, announcedAddr)) {
+            slot = &entry; // Stale announce for this destination, overwrite in place
+            _suppressed++;
+            break;
+        }
+    }
+
+    if (!slot && _entries.size() >= _maxEntries) {
+        // Evict the worst queued announce (most hops, then oldest) if the new one beats it
+        auto worst = _entries.begin();
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->hops > worst->hops || (it->hops == worst->hops && (long)(it->queuedAt - worst->queuedAt) < 0)) {
+                worst = it;
+            }
+        }
+        _dropped++;
+        if (worst->hops <= hops) return false;
+        slot = &(*worst);
+    }
+
+    if (!slot) {
+        _entries.emplace_back();
+        slot = &_entries.back();
+    }
+    memcpy(slot->announced, announcedAddr, RNS_ADDRESS_SIZE);
+    slot->hops = hops;
+    slot->pendingMask = interfaceMask;
+    slot->queuedAt = now;
+    slot->releaseAt = now + delayMs;
+    slot->packet.assign(packet, packet + packetLen);
+    return true;
+}
+
+bool AnnounceQueue::next(InterfaceType ifType, std::vector<uint8_t>& packet, unsigned long now) {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    if (slot >= INTERFACE_SLOTS || now - _lastTxAt[slot] < _holdoffMs[slot]) return false;
+
+    uint32_t bit = interfaceBit(ifType);
+    auto best = _entries.end();
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        if (!(it->pendingMask & bit) || (long)(now - it->releaseAt) < 0) continue;
+        if (best == _entries.end() || it->hops < best->hops ||
+            (it->hops == best->hops && (long)(it->queuedAt - best->queuedAt) < 0)) {
+            best = it;
+        }
+    }
+    if (best == _entries.end()) return false;
+
+    packet = best->packet;
+    best->pendingMask &= ~bit;
+    if (best->pendingMask == 0) _entries.erase(best);
+    return true;
+}
+
+void AnnounceQueue::recordTransmit(InterfaceType ifType, uint32_t txTimeMs, unsigned long now) {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    if (slot >= INTERFACE_SLOTS) return;
+    _lastTxAt[slot] = now;
+    _holdoffMs[slot] = (unsigned long)(txTimeMs * (100.0f / ANNOUNCE_CAP_PERCENT));
+}
+
+void AnnounceQueue::expire(unsigned long now) {
+    for (auto it = _entries.begin(); it != _entries.end(); ) {
+        if (now - it->queuedAt > ANNOUNCE_QUEUE_MAX_AGE_MS) {
+            it = _entries.erase(it);
+            _dropped++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+unsigned long AnnounceQueue::msUntilReady(uint32_t interfaceMask, unsigned long now) const {
+    unsigned long best = ULONG_MAX;
+    for (const auto& entry : _entries) {
+        for (uint8_t slot = 0; slot < INTERFACE_SLOTS; slot++) {
+            if (!(entry.pendingMask & interfaceMask & (1u << slot))) continue;
+            unsigned long sinceTx = now - _lastTxAt[slot];
+            long budgetWait = sinceTx < _holdoffMs[slot] ? (long)(_holdoffMs[slot] - sinceTx) : 0;
+            long wait = std::max((long)(entry.releaseAt - now), budgetWait);
+            unsigned long ms = wait > 0 ? (unsigned long)wait : 0;
+            if (ms < best) best = ms;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,236 @@
+#include "AnnounceValidator.h"
+#include "Crypto.h"
+#include "PowerManager.h"
+#include <cstring> // For memcmp, memcpy
+
+AnnounceValidator::AnnounceValidator() :
+    _cache(), _cacheCount(0), _cacheNext(0),
+#if defined(ARDUINO_ARCH_ESP32)
+    _task(nullptr), _todo(nullptr), _done(nullptr),
+#endif
+    _verified(0), _cacheHits(0), _invalid(0), _deferred(0), _skipped(0)
+{
+    for (size_t i = 0; i < ANNOUNCE_VERIFY_QUEUE_SIZE; i++) _jobState[i] = JobState::FREE;
+}
+
+AnnounceValidator::~AnnounceValidator() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) vTaskDelete(_task);
+    if (_todo) vQueueDelete(_todo);
+    if (_done) vQueueDelete(_done);
+#endif
+}
+
+void AnnounceValidator::begin() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) return;
+    _todo = xQueueCreate(ANNOUNCE_VERIFY_QUEUE_SIZE, sizeof(uint8_t));
+    _done = xQueueCreate(ANNOUNCE_VERIFY_QUEUE_SIZE, sizeof(uint8_t));
+    if (!_todo || !_done ||
+        xTaskCreate(taskMain, "ann_verify", ANNOUNCE_VERIFY_TASK_STACK, this,
+                    ANNOUNCE_VERIFY_TASK_PRIORITY, &_task) != pdPASS) {
+        DebugSerial.println("! WARN: Announce verification task not started, verifying from the main loop.");
+        _task = nullptr;
+    }
+#endif
+}
+
+bool AnnounceValidator::isTaskRunning() const {
+#if defined(ARDUINO_ARCH_ESP32)
+    return _task != nullptr;
+#else
+    return false;
+#endif
+}
+
+bool AnnounceValidator::parse(const RnsPacketInfo& packetInfo, Announce& out) {
+    const std::vector<uint8_t>& data = packetInfo.data;
+    size_t ratchetLen = packetInfo.context_flag ? RATCHET_SIZE : 0;
+    size_t fixedLen = Identity::PUBLIC_KEY_SIZE + Identity::NAME_HASH_SIZE + RANDOM_HASH_SIZE +
+                      ratchetLen + Identity::SIGNATURE_SIZE;
+    if (data.size() < fixedLen) return false;
+
+    const uint8_t* p = data.data();
+    out.destinationHash = packetInfo.destination_hash;
+    out.publicKey = p;            p += Identity::PUBLIC_KEY_SIZE;
+    out.nameHash = p;             p += Identity::NAME_HASH_SIZE;
+    out.randomHash = p;           p += RANDOM_HASH_SIZE;
+    out.ratchet = ratchetLen ? p : nullptr; p += ratchetLen;
+    out.signature = p;            p += Identity::SIGNATURE_SIZE;
+    out.appData = p;
+    out.appDataLen = data.size() - fixedLen;
+
+    // The destination hash must belong to this key and name, or anyone could claim it
+    Identity::truncatedHash(out.publicKey, Identity::PUBLIC_KEY_SIZE, out.identityHash);
+    uint8_t material[Identity::NAME_HASH_SIZE + Identity::HASH_SIZE];
+    memcpy(material, out.nameHash, Identity::NAME_HASH_SIZE);
+    memcpy(material + Identity::NAME_HASH_SIZE, out.identityHash, Identity::HASH_SIZE);
+    uint8_t expected[Identity::HASH_SIZE];
+    Identity::truncatedHash(material, sizeof(material), expected);
+    return memcmp(expected, out.destinationHash, Identity::HASH_SIZE) == 0;
+}
+
+size_t AnnounceValidator::buildSignedData(const Announce& announce, uint8_t* out, size_t capacity) {
+    size_t len = Identity::HASH_SIZE + Identity::PUBLIC_KEY_SIZE + Identity::NAME_HASH_SIZE +
+                 RANDOM_HASH_SIZE + (announce.ratchet ? RATCHET_SIZE : 0) + announce.appDataLen;
+    if (len > capacity) return 0;
+    uint8_t* p = out;
+    memcpy(p, announce.destinationHash, Identity::HASH_SIZE);    p += Identity::HASH_SIZE;
+    memcpy(p, announce.publicKey, Identity::PUBLIC_KEY_SIZE);    p += Identity::PUBLIC_KEY_SIZE;
+    memcpy(p, announce.nameHash, Identity::NAME_HASH_SIZE);      p += Identity::NAME_HASH_SIZE;
+    memcpy(p, announce.randomHash, RANDOM_HASH_SIZE);            p += RANDOM_HASH_SIZE;
+    if (announce.ratchet) { memcpy(p, announce.ratchet, RATCHET_SIZE); p += RATCHET_SIZE; }
+    if (announce.appDataLen) memcpy(p, announce.appData, announce.appDataLen);
+    return len;
+}
+
+bool AnnounceValidator::checkSignature(const uint8_t* publicKey, const uint8_t* message, size_t len,
+                                       const uint8_t* signature) {
+    Identity signer;
+    return signer.loadPublicKey(publicKey, Identity::PUBLIC_KEY_SIZE) && signer.verify(message, len, signature);
+}
+
+// --- Cache ---
+void AnnounceValidator::digestOf(const uint8_t* message, size_t len, const uint8_t* signature,
+                                 uint8_t digest[DIGEST_SIZE]) {
+    Crypto::Sha256 sha;
+    sha.begin();
+    sha.update(message, len);
+    sha.update(signature, Identity::SIGNATURE_SIZE);
+    uint8_t full[Crypto::SHA256_SIZE];
+    sha.finish(full);
+    memcpy(digest, full, DIGEST_SIZE);
+}
+
+const AnnounceValidator::CacheEntry* AnnounceValidator::findCached(const uint8_t* digest) const {
+    for (size_t i = 0; i < _cacheCount; i++) {
+        if (memcmp(_cache[i].digest, digest, DIGEST_SIZE) == 0) return &_cache[i];
+    }
+    return nullptr;
+}
+
+void AnnounceValidator::remember(const uint8_t* digest, bool valid) {
+    CacheEntry& entry = _cache[_cacheNext];
+    memcpy(entry.digest, digest, DIGEST_SIZE);
+    entry.valid = valid;
+    _cacheNext = (_cacheNext + 1) % ANNOUNCE_VERIFY_CACHE_SIZE;
+    if (_cacheCount < ANNOUNCE_VERIFY_CACHE_SIZE) _cacheCount++;
+}
+
+bool AnnounceValidator::isQueued(const uint8_t* digest) const {
+    for (size_t i = 0; i < ANNOUNCE_VERIFY_QUEUE_SIZE; i++) {
+        if (_jobState[i] != JobState::FREE && memcmp(_jobs[i].digest, digest, DIGEST_SIZE) == 0) return true;
+    }
+    return false;
+}
+
+// --- Verification ---
+bool AnnounceValidator::verify(const Announce& announce) {
+    size_t len = buildSignedData(announce, _scratch, sizeof(_scratch));
+    if (len == 0) {
+        _invalid++;
+        return false;
+    }
+    uint8_t digest[DIGEST_SIZE];
+    digestOf(_scratch, len, announce.signature, digest);
+    const CacheEntry* cached = findCached(digest);
+    if (cached) {
+        _cacheHits++;
+        return cached->valid;
+    }
+
+    bool valid = checkSignature(announce.publicKey, _scratch, len, announce.signature);
+    _verified++;
+    if (!valid) _invalid++;
+    remember(digest, valid);
+    return valid;
+}
+
+AnnounceValidator::Result AnnounceValidator::verifyDeferred(const Announce& announce, uint8_t* digestOut) {
+    size_t len = buildSignedData(announce, _scratch, sizeof(_scratch));
+    if (len == 0) {
+        _skipped++;
+        return Result::SKIPPED;
+    }
+    uint8_t digest[DIGEST_SIZE];
+    digestOf(_scratch, len, announce.signature, digest);
+    if (digestOut) memcpy(digestOut, digest, DIGEST_SIZE);
+    const CacheEntry* cached = findCached(digest);
+    if (cached) {
+        _cacheHits++;
+        return cached->valid ? Result::VALID : Result::INVALID;
+    }
+    if (isQueued(digest)) return Result::PENDING; // Another copy
+
+    size_t slot = 0;
+    while (slot < ANNOUNCE_VERIFY_QUEUE_SIZE && _jobState[slot] != JobState::FREE) slot++;
+    if (slot == ANNOUNCE_VERIFY_QUEUE_SIZE) {
+        _skipped++;
+        return Result::SKIPPED;
+    }
+    Job& job = _jobs[slot];
+    memcpy(job.message, _scratch, len);
+    job.messageLen = len;
+    memcpy(job.publicKey, announce.publicKey, Identity::PUBLIC_KEY_SIZE);
+    memcpy(job.signature, announce.signature, Identity::SIGNATURE_SIZE);
+    memcpy(job.destinationHash, announce.destinationHash, Identity::HASH_SIZE);
+    memcpy(job.randomHash, announce.randomHash, RANDOM_HASH_SIZE);
+    memcpy(job.digest, digest, DIGEST_SIZE);
+    job.valid = false;
+    _jobState[slot] = JobState::QUEUED;
+    _deferred++;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) {
+        uint8_t index = (uint8_t)slot;
+        xQueueSend(_todo, &index, 0); // Cannot fail: one queue entry per job slot
+    }
+#endif
+    return Result::PENDING;
+}
+
+void AnnounceValidator::finishJob(size_t index, std::vector<Verdict>& verdicts) {
+    Job& job = _jobs[index];
+    _verified++;
+    if (!job.valid) _invalid++;
+    remember(job.digest, job.valid);
+    Verdict v;
+    memcpy(v.destinationHash, job.destinationHash, Identity::HASH_SIZE);
+    memcpy(v.randomHash, job.randomHash, RANDOM_HASH_SIZE);
+    memcpy(v.digest, job.digest, DIGEST_SIZE);
+    v.valid = job.valid;
+    verdicts.push_back(v);
+    _jobState[index] = JobState::FREE;
+}
+
+void AnnounceValidator::collect(std::vector<Verdict>& verdicts) {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) {
+        uint8_t index;
+        while (xQueueReceive(_done, &index, 0) == pdTRUE) finishJob(index, verdicts);
+        return;
+    }
+#endif
+    // No task: verify one queued announce per call so a backlog cannot stall the loop
+    for (size_t i = 0; i < ANNOUNCE_VERIFY_QUEUE_SIZE; i++) {
+        if (_jobState[i] != JobState::QUEUED) continue;
+        Job& job = _jobs[i];
+        job.valid = checkSignature(job.publicKey, job.message, job.messageLen, job.signature);
+        finishJob(i, verdicts);
+        return;
+    }
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void AnnounceValidator::taskMain(void* arg) {
+    AnnounceValidator* self = static_cast<AnnounceValidator*>(arg);
+    uint8_t index;
+    for (;;) {
+        if (xQueueReceive(self->_todo, &index, portMAX_DELAY) != pdTRUE) continue;
+        Job& job = self->_jobs[index];
+        job.valid = checkSignature(job.publicKey, job.message, job.messageLen, job.signature);
+        xQueueSend(self->_done, &index, portMAX_DELAY);
+        PowerManager::notify(POWER_EVENT_ANNOUNCE); // Held announces wait on the verdict
+    }
+}
+#endif
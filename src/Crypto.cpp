@@ -0,0 +1,431 @@
+#include "Crypto.h"
+#include <cstring> // For memcpy, memset
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP_PLATFORM)
+  #include <esp_system.h> // For esp_fill_random
+#else
+  #include <random>
+#endif
+
+namespace Crypto {
+
+// --- SHA-256 ---
+#if CRYPTO_HW_ACCEL
+
+Sha256::Sha256() { mbedtls_sha256_init(&_ctx); begin(); }
+Sha256::~Sha256() { mbedtls_sha256_free(&_ctx); }
+Sha256::Sha256(const Sha256& other) { mbedtls_sha256_init(&_ctx); mbedtls_sha256_clone(&_ctx, &other._ctx); }
+Sha256& Sha256::operator=(const Sha256& other) {
+    if (this != &other) mbedtls_sha256_clone(&_ctx, &other._ctx);
+    return *this;
+}
+
+void Sha256::begin() { mbedtls_sha256_starts_ret(&_ctx, 0); }
+void Sha256::update(const uint8_t* data, size_t len) { mbedtls_sha256_update_ret(&_ctx, data, len); }
+void Sha256::finish(uint8_t digest[SHA256_SIZE]) { mbedtls_sha256_finish_ret(&_ctx, digest); }
+
+#else
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, unsigned n) { return (x >> n) | (x << (32 - n)); }
+
+Sha256::Sha256() { begin(); }
+Sha256::~Sha256() {}
+Sha256::Sha256(const Sha256& other) = default;
+Sha256& Sha256::operator=(const Sha256& other) = default;
+
+void Sha256::begin() {
+    static const uint32_t IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(_state, IV, sizeof(_state));
+    _length = 0;
+    _bufferLen = 0;
+}
+
+void Sha256::processBlock(const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = _state[0], b = _state[1], c = _state[2], d = _state[3];
+    uint32_t e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    _state[0] += a; _state[1] += b; _state[2] += c; _state[3] += d;
+    _state[4] += e; _state[5] += f; _state[6] += g; _state[7] += h;
+}
+
+void Sha256::update(const uint8_t* data, size_t len) {
+    _length += len;
+    if (_bufferLen > 0) {
+        size_t take = SHA256_BLOCK_SIZE - _bufferLen;
+        if (take > len) take = len;
+        memcpy(_buffer + _bufferLen, data, take);
+        _bufferLen += take;
+        data += take;
+        len -= take;
+        if (_bufferLen < SHA256_BLOCK_SIZE) return;
+        processBlock(_buffer);
+        _bufferLen = 0;
+    }
+    while (len >= SHA256_BLOCK_SIZE) {
+        processBlock(data);
+        data += SHA256_BLOCK_SIZE;
+        len -= SHA256_BLOCK_SIZE;
+    }
+    memcpy(_buffer, data, len);
+    _bufferLen = len;
+}
+
+void Sha256::finish(uint8_t digest[SHA256_SIZE]) {
+    uint64_t bits = _length * 8;
+    _buffer[_bufferLen++] = 0x80;
+    if (_bufferLen > SHA256_BLOCK_SIZE - 8) {
+        memset(_buffer + _bufferLen, 0, SHA256_BLOCK_SIZE - _bufferLen);
+        processBlock(_buffer);
+        _bufferLen = 0;
+    }
+    memset(_buffer + _bufferLen, 0, SHA256_BLOCK_SIZE - 8 - _bufferLen);
+    for (int i = 0; i < 8; i++) _buffer[SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (i * 8));
+    processBlock(_buffer);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t)(_state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(_state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(_state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)_state[i];
+    }
+}
+
+#endif // CRYPTO_HW_ACCEL
+
+// --- HMAC-SHA256 ---
+void HmacSha256::setKey(const uint8_t* key, size_t keyLen) {
+    uint8_t block[SHA256_BLOCK_SIZE] = {0};
+    if (keyLen > SHA256_BLOCK_SIZE) sha256(key, keyLen, block);
+    else if (keyLen > 0) memcpy(block, key, keyLen);
+
+    uint8_t pad[SHA256_BLOCK_SIZE];
+    for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++) pad[i] = block[i] ^ 0x36;
+    _inner.begin();
+    _inner.update(pad, sizeof(pad));
+    for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++) pad[i] = block[i] ^ 0x5c;
+    _outer.begin();
+    _outer.update(pad, sizeof(pad));
+}
+
+void HmacSha256::compute(const uint8_t* data, size_t len, uint8_t mac[SHA256_SIZE]) const {
+    compute(data, len, nullptr, 0, mac);
+}
+
+void HmacSha256::compute(const uint8_t* a, size_t aLen, const uint8_t* b, size_t bLen, uint8_t mac[SHA256_SIZE]) const {
+    compute(a, aLen, b, bLen, nullptr, 0, mac);
+}
+
+void HmacSha256::compute(const uint8_t* a, size_t aLen, const uint8_t* b, size_t bLen,
+                         const uint8_t* c, size_t cLen, uint8_t mac[SHA256_SIZE]) const {
+    uint8_t innerDigest[SHA256_SIZE];
+    Sha256 inner(_inner);
+    if (aLen) inner.update(a, aLen);
+    if (bLen) inner.update(b, bLen);
+    if (cLen) inner.update(c, cLen);
+    inner.finish(innerDigest);
+    Sha256 outer(_outer);
+    outer.update(innerDigest, sizeof(innerDigest));
+    outer.finish(mac);
+}
+
+// --- AES-128 ---
+#if CRYPTO_HW_ACCEL
+
+Aes128::Aes128() { mbedtls_aes_init(&_enc); mbedtls_aes_init(&_dec); }
+Aes128::~Aes128() { mbedtls_aes_free(&_enc); mbedtls_aes_free(&_dec); }
+
+void Aes128::setKey(const uint8_t key[AES128_KEY_SIZE]) {
+    mbedtls_aes_setkey_enc(&_enc, key, AES128_KEY_SIZE * 8);
+    mbedtls_aes_setkey_dec(&_dec, key, AES128_KEY_SIZE * 8);
+}
+
+bool Aes128::cbcEncrypt(uint8_t iv[AES_BLOCK_SIZE], const uint8_t* in, uint8_t* out, size_t len) {
+    if (len % AES_BLOCK_SIZE != 0) return false;
+    return mbedtls_aes_crypt_cbc(&_enc, MBEDTLS_AES_ENCRYPT, len, iv, in, out) == 0;
+}
+
+bool Aes128::cbcDecrypt(uint8_t iv[AES_BLOCK_SIZE], const uint8_t* in, uint8_t* out, size_t len) {
+    if (len % AES_BLOCK_SIZE != 0) return false;
+    return mbedtls_aes_crypt_cbc(&_dec, MBEDTLS_AES_DECRYPT, len, iv, in, out) == 0;
+}
+
+#else
+
+// Software AES tables (FIPS-197)
+static const uint8_t SBOX[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+static const uint8_t INV_SBOX[256] = {
+    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
+    0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
+    0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25,
+    0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92,
+    0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06,
+    0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02, 0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b,
+    0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e,
+    0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89, 0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b,
+    0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f,
+    0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d, 0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef,
+    0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d,
+};
+
+static inline uint8_t xtime(uint8_t x) { return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00)); }
+
+static inline uint8_t gmul(uint8_t a, uint8_t b) {
+    uint8_t p = 0;
+    while (b) {
+        if (b & 1) p ^= a;
+        a = xtime(a);
+        b >>= 1;
+    }
+    return p;
+}
+
+Aes128::Aes128() { memset(_roundKeys, 0, sizeof(_roundKeys)); }
+Aes128::~Aes128() { memset(_roundKeys, 0, sizeof(_roundKeys)); }
+
+void Aes128::setKey(const uint8_t key[AES128_KEY_SIZE]) {
+    static const uint8_t RCON[10] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+    memcpy(_roundKeys, key, AES128_KEY_SIZE);
+    for (int i = 4; i < 44; i++) {
+        uint8_t t[4];
+        memcpy(t, _roundKeys + (i - 1) * 4, 4);
+        if (i % 4 == 0) {
+            uint8_t first = t[0];
+            t[0] = SBOX[t[1]] ^ RCON[i / 4 - 1];
+            t[1] = SBOX[t[2]];
+            t[2] = SBOX[t[3]];
+            t[3] = SBOX[first];
+        }
+        for (int j = 0; j < 4; j++) _roundKeys[i * 4 + j] = _roundKeys[(i - 4) * 4 + j] ^ t[j];
+    }
+}
+
+// State is column-major: byte c * 4 + r holds row r of column c
+void Aes128::encryptBlock(const uint8_t in[AES_BLOCK_SIZE], uint8_t out[AES_BLOCK_SIZE]) const {
+    uint8_t s[AES_BLOCK_SIZE], t[AES_BLOCK_SIZE];
+    for (int i = 0; i < 16; i++) s[i] = in[i] ^ _roundKeys[i];
+
+    for (int round = 1; round <= 10; round++) {
+        // SubBytes + ShiftRows
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) t[c * 4 + r] = SBOX[s[((c + r) % 4) * 4 + r]];
+        }
+        if (round < 10) {
+            // MixColumns
+            for (int c = 0; c < 4; c++) {
+                uint8_t* col = t + c * 4;
+                uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+                col[0] ^= all ^ xtime(a0 ^ a1);
+                col[1] ^= all ^ xtime(a1 ^ a2);
+                col[2] ^= all ^ xtime(a2 ^ a3);
+                col[3] ^= all ^ xtime(a3 ^ a0);
+            }
+        }
+        const uint8_t* rk = _roundKeys + round * 16;
+        for (int i = 0; i < 16; i++) s[i] = t[i] ^ rk[i];
+    }
+    memcpy(out, s, AES_BLOCK_SIZE);
+}
+
+void Aes128::decryptBlock(const uint8_t in[AES_BLOCK_SIZE], uint8_t out[AES_BLOCK_SIZE]) const {
+    uint8_t s[AES_BLOCK_SIZE], t[AES_BLOCK_SIZE];
+    for (int i = 0; i < 16; i++) s[i] = in[i] ^ _roundKeys[160 + i];
+
+    for (int round = 9; round >= 0; round--) {
+        // InvShiftRows + InvSubBytes
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) t[c * 4 + r] = INV_SBOX[s[((c + 4 - r) % 4) * 4 + r]];
+        }
+        const uint8_t* rk = _roundKeys + round * 16;
+        for (int i = 0; i < 16; i++) t[i] ^= rk[i];
+        if (round > 0) {
+            // InvMixColumns
+            for (int c = 0; c < 4; c++) {
+                const uint8_t* col = t + c * 4;
+                s[c * 4 + 0] = gmul(col[0], 14) ^ gmul(col[1], 11) ^ gmul(col[2], 13) ^ gmul(col[3], 9);
+                s[c * 4 + 1] = gmul(col[0], 9) ^ gmul(col[1], 14) ^ gmul(col[2], 11) ^ gmul(col[3], 13);
+                s[c * 4 + 2] = gmul(col[0], 13) ^ gmul(col[1], 9) ^ gmul(col[2], 14) ^ gmul(col[3], 11);
+                s[c * 4 + 3] = gmul(col[0], 11) ^ gmul(col[1], 13) ^ gmul(col[2], 9) ^ gmul(col[3], 14);
+            }
+        } else {
+            memcpy(s, t, AES_BLOCK_SIZE);
+        }
+    }
+    memcpy(out, s, AES_BLOCK_SIZE);
+}
+
+bool Aes128::cbcEncrypt(uint8_t iv[AES_BLOCK_SIZE], const uint8_t* in, uint8_t* out, size_t len) {
+    if (len % AES_BLOCK_SIZE != 0) return false;
+    for (size_t off = 0; off < len; off += AES_BLOCK_SIZE) {
+        uint8_t block[AES_BLOCK_SIZE];
+        for (size_t i = 0; i < AES_BLOCK_SIZE; i++) block[i] = in[off + i] ^ iv[i];
+        encryptBlock(block, out + off);
+        memcpy(iv, out + off, AES_BLOCK_SIZE);
+    }
+    return true;
+}
+
+bool Aes128::cbcDecrypt(uint8_t iv[AES_BLOCK_SIZE], const uint8_t* in, uint8_t* out, size_t len) {
+    if (len % AES_BLOCK_SIZE != 0) return false;
+    for (size_t off = 0; off < len; off += AES_BLOCK_SIZE) {
+        uint8_t cipher[AES_BLOCK_SIZE], plain[AES_BLOCK_SIZE];
+        memcpy(cipher, in + off, AES_BLOCK_SIZE); // in may alias out
+        decryptBlock(cipher, plain);
+        for (size_t i = 0; i < AES_BLOCK_SIZE; i++) out[off + i] = plain[i] ^ iv[i];
+        memcpy(iv, cipher, AES_BLOCK_SIZE);
+    }
+    return true;
+}
+
+#endif // CRYPTO_HW_ACCEL
+
+// --- Token ---
+void Token::setKey(const uint8_t key[TOKEN_KEY_SIZE]) {
+    _hmac.setKey(key, 16);
+    _aes.setKey(key + 16);
+    _keyed = true;
+}
+
+bool Token::encrypt(const uint8_t* plaintext, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen) {
+    size_t total = tokenSize(len);
+    if (!_keyed || outCapacity < total) return false;
+    size_t cipherLen = total - AES_BLOCK_SIZE - SHA256_SIZE;
+
+    uint8_t* cipher = out + AES_BLOCK_SIZE;
+    memmove(cipher, plaintext, len);
+    uint8_t pad = (uint8_t)(cipherLen - len);
+    memset(cipher + len, pad, pad);
+
+    randomBytes(out, AES_BLOCK_SIZE);
+    uint8_t iv[AES_BLOCK_SIZE];
+    memcpy(iv, out, AES_BLOCK_SIZE);
+    if (!_aes.cbcEncrypt(iv, cipher, cipher, cipherLen)) return false;
+
+    _hmac.compute(out, AES_BLOCK_SIZE + cipherLen, out + AES_BLOCK_SIZE + cipherLen);
+    outLen = total;
+    return true;
+}
+
+bool Token::decrypt(const uint8_t* token, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen) {
+    if (!_keyed || len < TOKEN_MIN_SIZE) return false;
+    size_t cipherLen = len - AES_BLOCK_SIZE - SHA256_SIZE;
+    if (cipherLen % AES_BLOCK_SIZE != 0 || outCapacity < cipherLen) return false;
+
+    // Authenticate before touching the ciphertext
+    uint8_t mac[SHA256_SIZE];
+    _hmac.compute(token, AES_BLOCK_SIZE + cipherLen, mac);
+    if (!constantTimeEqual(mac, token + AES_BLOCK_SIZE + cipherLen, SHA256_SIZE)) return false;
+
+    uint8_t iv[AES_BLOCK_SIZE];
+    memcpy(iv, token, AES_BLOCK_SIZE);
+    if (!_aes.cbcDecrypt(iv, token + AES_BLOCK_SIZE, out, cipherLen)) return false;
+
+    uint8_t pad = out[cipherLen - 1];
+    if (pad == 0 || pad > AES_BLOCK_SIZE) return false;
+    for (size_t i = cipherLen - pad; i < cipherLen; i++) {
+        if (out[i] != pad) return false;
+    }
+    outLen = cipherLen - pad;
+    return true;
+}
+
+// --- One-shot helpers ---
+void sha256(const uint8_t* data, size_t len, uint8_t digest[SHA256_SIZE]) {
+    Sha256 hash;
+    hash.update(data, len);
+    hash.finish(digest);
+}
+
+void hmacSha256(const uint8_t* key, size_t keyLen, const uint8_t* data, size_t len, uint8_t mac[SHA256_SIZE]) {
+    HmacSha256(key, keyLen).compute(data, len, mac);
+}
+
+void hkdf(uint8_t* out, size_t outLen, const uint8_t* ikm, size_t ikmLen,
+          const uint8_t* salt, size_t saltLen, const uint8_t* info, size_t infoLen) {
+    static const uint8_t ZERO_SALT[SHA256_SIZE] = {0};
+    if (!salt || saltLen == 0) { salt = ZERO_SALT; saltLen = sizeof(ZERO_SALT); }
+
+    // Extract
+    uint8_t prk[SHA256_SIZE];
+    hmacSha256(salt, saltLen, ikm, ikmLen, prk);
+
+    // Expand: T(i) = HMAC(PRK, T(i-1) | info | i), without copying the parts together
+    HmacSha256 expand(prk, sizeof(prk));
+    uint8_t block[SHA256_SIZE];
+    size_t done = 0;
+    for (uint8_t counter = 1; done < outLen; counter++) {
+        expand.compute(block, counter > 1 ? SHA256_SIZE : 0, info, info ? infoLen : 0, &counter, 1, block);
+
+        size_t take = outLen - done < SHA256_SIZE ? outLen - done : SHA256_SIZE;
+        memcpy(out + done, block, take);
+        done += take;
+    }
+    memset(prk, 0, sizeof(prk));
+}
+
+void randomBytes(uint8_t* out, size_t len) {
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP_PLATFORM)
+    esp_fill_random(out, len); // True RNG while the radio is on, else seeded from boot entropy
+#else
+    static std::random_device rd;
+    for (size_t i = 0; i < len; i++) out[i] = (uint8_t)rd();
+#endif
+}
+
+bool constantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+} // namespace Crypto
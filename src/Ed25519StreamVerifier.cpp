@@ -0,0 +1,36 @@
+#include "Ed25519StreamVerifier.h"
+#include <cstring> // For memcpy
+
+Ed25519StreamVerifier::Ed25519StreamVerifier() : _length(0), _started(false) {}
+
+Ed25519StreamVerifier::~Ed25519StreamVerifier() {
+    crypto_wipe(&_hash, sizeof(_hash));
+}
+
+void Ed25519StreamVerifier::begin(const uint8_t signature[SIGNATURE_SIZE], const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    memcpy(_signature, signature, SIGNATURE_SIZE);
+    memcpy(_publicKey, publicKey, PUBLIC_KEY_SIZE);
+    crypto_sha512_init(&_hash);
+    crypto_sha512_update(&_hash, _signature, 32); // R
+    crypto_sha512_update(&_hash, _publicKey, PUBLIC_KEY_SIZE); // A
+    _length = 0;
+    _started = true;
+}
+
+void Ed25519StreamVerifier::update(const uint8_t* data, size_t len) {
+    if (!_started || !data || len == 0) return;
+    crypto_sha512_update(&_hash, data, len);
+    _length += len;
+}
+
+bool Ed25519StreamVerifier::finish() {
+    if (!_started) return false;
+    _started = false;
+    uint8_t digest[64];
+    uint8_t hRam[32];
+    crypto_sha512_final(&_hash, digest);
+    crypto_eddsa_reduce(hRam, digest); // h = SHA-512(R || A || M) mod L, as crypto_ed25519_check computes it
+    bool valid = crypto_eddsa_check_equation(_signature, _publicKey, hRam) == 0;
+    crypto_wipe(digest, sizeof(digest));
+    return valid;
+}
@@ -0,0 +1,102 @@
+#include "EspNowFragmenter.h"
+#include <cstring> // For memcmp, memcpy
+
+static const uint8_t FRAGMENT_MAGIC_0 = 0x7E; // IFAC flag clear, unlike any coded frame
+static const uint8_t FRAGMENT_MAGIC_1 = 0xF5; // Hops byte of a real packet never gets this high
+
+EspNowFragmenter::EspNowFragmenter() : _nextMsgId(0), _reassembled(0), _dropped(0) {
+    memset(_slots, 0, sizeof(_slots));
+}
+
+bool EspNowFragmenter::isFragment(const uint8_t* frame, size_t len) {
+    return frame && len > HEADER_SIZE && frame[0] == FRAGMENT_MAGIC_0 && frame[1] == FRAGMENT_MAGIC_1;
+}
+
+bool EspNowFragmenter::send(const uint8_t* packet, size_t packetLen, const FrameSender& sendFrame, size_t frameMax) {
+    if (!packet || packetLen == 0 || packetLen > MAX_PACKET_SIZE) return false;
+    if (frameMax <= HEADER_SIZE || frameMax > FRAME_MAX) return false;
+    size_t payloadMax = frameMax - HEADER_SIZE;
+    if ((packetLen + payloadMax - 1) / payloadMax > 32) return false; // indexMask width
+
+    uint16_t msgId = _nextMsgId++;
+    uint8_t frame[FRAME_MAX];
+    uint8_t index = 0;
+    for (size_t offset = 0; offset < packetLen; offset += payloadMax, index++) {
+        size_t chunk = packetLen - offset < payloadMax ? packetLen - offset : payloadMax;
+        frame[0] = FRAGMENT_MAGIC_0;
+        frame[1] = FRAGMENT_MAGIC_1;
+        frame[2] = (msgId >> 8) & 0xFF;
+        frame[3] = msgId & 0xFF;
+        frame[4] = index;
+        frame[5] = (offset >> 8) & 0xFF;
+        frame[6] = offset & 0xFF;
+        frame[7] = (packetLen >> 8) & 0xFF;
+        frame[8] = packetLen & 0xFF;
+        memcpy(frame + HEADER_SIZE, packet + offset, chunk);
+        if (!sendFrame(frame, HEADER_SIZE + chunk)) return false;
+    }
+    return true;
+}
+
+bool EspNowFragmenter::reassemble(const uint8_t* mac, const uint8_t* frame, size_t len,
+                                  const uint8_t*& packet, size_t& packetLen, unsigned long now) {
+    if (!mac || !isFragment(frame, len)) return false;
+
+    uint16_t msgId = ((uint16_t)frame[2] << 8) | frame[3];
+    uint8_t index = frame[4];
+    size_t offset = ((size_t)frame[5] << 8) | frame[6];
+    size_t total = ((size_t)frame[7] << 8) | frame[8];
+    size_t chunk = len - HEADER_SIZE;
+    if (total == 0 || total > MAX_PACKET_SIZE || offset + chunk > total || index >= 32) {
+        _dropped++;
+        return false;
+    }
+
+    // Find the slot for this message, expiring stale ones on the way
+    Slot* slot = nullptr;
+    Slot* freeSlot = nullptr;
+    Slot* oldest = nullptr;
+    for (uint8_t i = 0; i < ESPNOW_REASSEMBLY_SLOTS; i++) {
+        Slot& s = _slots[i];
+        if (s.active && now - s.startedAt > ESPNOW_REASSEMBLY_TIMEOUT_MS) {
+            s.active = false; // A fragment never arrived
+            _dropped++;
+        }
+        if (!s.active) {
+            if (!freeSlot) freeSlot = &s;
+            continue;
+        }
+        if (s.msgId == msgId && memcmp(s.mac, mac, 6) == 0) slot = &s;
+        if (!oldest || (long)(s.startedAt - oldest->startedAt) < 0) oldest = &s;
+    }
+    if (!slot) {
+        if (!freeSlot) {
+            freeSlot = oldest; // All busy: the oldest partial packet loses
+            _dropped++;
+        }
+        slot = freeSlot;
+        slot->active = true;
+        memcpy(slot->mac, mac, 6);
+        slot->msgId = msgId;
+        slot->total = (uint16_t)total;
+        slot->received = 0;
+        slot->indexMask = 0;
+        slot->startedAt = now;
+    } else if (slot->total != total) {
+        _dropped++; // Inconsistent header; ignore the fragment
+        return false;
+    }
+
+    uint32_t bit = 1UL << index;
+    if (slot->indexMask & bit) return false; // Duplicate fragment
+    slot->indexMask |= bit;
+    memcpy(slot->data + offset, frame + HEADER_SIZE, chunk);
+    slot->received += chunk;
+    if (slot->received < slot->total) return false;
+
+    slot->active = false;
+    _reassembled++;
+    packet = slot->data;
+    packetLen = slot->total;
+    return true;
+}
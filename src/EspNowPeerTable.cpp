@@ -0,0 +1,105 @@
+#include "EspNowPeerTable.h"
+#include <cstring> // For memcmp, memcpy
+
+EspNowPeerTable::EspNowPeerTable() :
+    _count(0), _registered(0), _inFlightHead(0), _inFlightCount(0), _totalSent(0), _totalAcked(0)
+{
+    memset(_peers, 0, sizeof(_peers));
+    memset(_inFlight, 0, sizeof(_inFlight));
+}
+
+EspNowPeerTable::Peer* EspNowPeerTable::find(const uint8_t* mac) {
+    if (!mac) return nullptr;
+    for (size_t i = 0; i < _count; i++) {
+        if (memcmp(_peers[i].mac, mac, 6) == 0) return &_peers[i];
+    }
+    return nullptr;
+}
+
+EspNowPeerTable::Peer* EspNowPeerTable::touch(const uint8_t* mac, unsigned long now) {
+    if (!mac) return nullptr;
+    Peer* peer = find(mac);
+    if (!peer) {
+        if (_count < ESPNOW_PEER_TABLE_SIZE) {
+            peer = &_peers[_count++];
+        } else {
+            // Recycle the least recently used entry not holding a hardware slot
+            for (size_t i = 0; i < _count; i++) {
+                if (_peers[i].registered) continue;
+                if (!peer || (long)(_peers[i].lastUsed - peer->lastUsed) < 0) peer = &_peers[i];
+            }
+        }
+        memcpy(peer->mac, mac, 6);
+        peer->sent = 0;
+        peer->acked = 0;
+        peer->deliveryRatio = 1.0f; // Innocent until a frame goes unacknowledged
+        peer->latencyUs = 0;
+        peer->registered = false;
+    }
+    peer->lastUsed = now;
+    return peer;
+}
+
+void EspNowPeerTable::setRegistered(Peer* peer, bool registered) {
+    if (!peer || peer->registered == registered) return;
+    peer->registered = registered;
+    if (registered) _registered++;
+    else _registered--;
+}
+
+EspNowPeerTable::Peer* EspNowPeerTable::leastRecentRegistered(const uint8_t* exceptMac) {
+    Peer* victim = nullptr;
+    for (size_t i = 0; i < _count; i++) {
+        Peer& peer = _peers[i];
+        if (!peer.registered || (exceptMac && memcmp(peer.mac, exceptMac, 6) == 0)) continue;
+        if (!victim || (long)(peer.lastUsed - victim->lastUsed) < 0) victim = &peer;
+    }
+    return victim;
+}
+
+void EspNowPeerTable::recordSend(const uint8_t* mac, uint32_t sentUs) {
+    if (!mac) return;
+    touch(mac);
+    if (_inFlightCount == ESPNOW_INFLIGHT_MAX) {
+        // Status for the oldest frame never came (or was dropped); forget it
+        _inFlightHead = (_inFlightHead + 1) % ESPNOW_INFLIGHT_MAX;
+        _inFlightCount--;
+    }
+    InFlight& slot = _inFlight[(_inFlightHead + _inFlightCount) % ESPNOW_INFLIGHT_MAX];
+    memcpy(slot.mac, mac, 6);
+    slot.sentUs = sentUs;
+    _inFlightCount++;
+}
+
+EspNowPeerTable::Peer* EspNowPeerTable::recordResult(const uint8_t* mac, bool success, uint32_t statusUs) {
+    Peer* peer = touch(mac);
+    if (!peer) return nullptr;
+
+    // Match the oldest in-flight frame for this MAC; older frames ahead of it lost their status
+    bool matched = false;
+    uint32_t sentUs = 0;
+    for (uint8_t i = 0; i < _inFlightCount; i++) {
+        const InFlight& entry = _inFlight[(_inFlightHead + i) % ESPNOW_INFLIGHT_MAX];
+        if (memcmp(entry.mac, mac, 6) == 0) {
+            matched = true;
+            sentUs = entry.sentUs;
+            _inFlightHead = (_inFlightHead + i + 1) % ESPNOW_INFLIGHT_MAX;
+            _inFlightCount -= i + 1;
+            break;
+        }
+    }
+
+    peer->sent++;
+    _totalSent++;
+    if (success) {
+        peer->acked++;
+        _totalAcked++;
+    }
+    peer->deliveryRatio += ESPNOW_DELIVERY_ALPHA * ((success ? 1.0f : 0.0f) - peer->deliveryRatio);
+    if (matched) {
+        uint32_t latency = statusUs - sentUs;
+        peer->latencyUs = peer->latencyUs == 0 ? latency
+                        : (uint32_t)(peer->latencyUs + ESPNOW_DELIVERY_ALPHA * ((float)latency - (float)peer->latencyUs));
+    }
+    return peer;
+}
@@ -0,0 +1,184 @@
+#include "HttpRequest.h"
+#include <cctype>  // For tolower, isdigit
+#include <cstring> // For memchr, memcmp, memmove, strlen
+
+bool HttpText::equals(const char* s) const {
+    size_t n = strlen(s);
+    return n == len && memcmp(data, s, n) == 0;
+}
+
+bool HttpText::equalsIgnoreCase(const char* s) const {
+    size_t n = strlen(s);
+    if (n != len) return false;
+    for (size_t i = 0; i < n; i++) {
+        if (tolower((unsigned char)data[i]) != tolower((unsigned char)s[i])) return false;
+    }
+    return true;
+}
+
+bool HttpText::startsWith(const char* prefix) const {
+    size_t n = strlen(prefix);
+    return n <= len && memcmp(data, prefix, n) == 0;
+}
+
+HttpText HttpText::trimmed() const {
+    HttpText t = *this;
+    while (t.len > 0 && (t.data[0] == ' ' || t.data[0] == '\t')) { t.data++; t.len--; }
+    while (t.len > 0 && (t.data[t.len - 1] == ' ' || t.data[t.len - 1] == '\t')) t.len--;
+    return t;
+}
+
+HttpText HttpText::substr(size_t start) const {
+    HttpText t;
+    if (start < len) { t.data = data + start; t.len = len - start; }
+    return t;
+}
+
+String HttpText::toString() const {
+    String s;
+    if (len == 0) return s;
+    s.reserve(len);
+    for (size_t i = 0; i < len; i++) s += data[i];
+    return s;
+}
+
+HttpRequestParser::HttpRequestParser() {
+    reset();
+}
+
+void HttpRequestParser::reset() {
+    _len = 0;
+    _status = Status::INCOMPLETE;
+    next();
+}
+
+void HttpRequestParser::next() {
+    size_t consumed = _status == Status::COMPLETE ? _headerEnd + _contentLength - _bodyTaken : _len;
+    if (consumed > _len) consumed = _len;
+    if (consumed > 0 && consumed < _len) memmove(_buf, _buf + consumed, _len - consumed);
+    _len -= consumed;
+    _scanned = 0;
+    _headerEnd = 0;
+    _contentLength = 0;
+    _bodyTaken = 0;
+    _status = Status::INCOMPLETE;
+    _keepAlive = false;
+    _method = HttpText();
+    _path = HttpText();
+    _headerCount = 0;
+    if (_len > 0) commit(0); // A pipelined request may be complete already
+}
+
+HttpRequestParser::Status HttpRequestParser::commit(size_t count) {
+    _len += count;
+    if (_status != Status::INCOMPLETE) return _status;
+
+    if (_headerEnd == 0) {
+        // Resume the search a few bytes back, in case the terminator straddles two reads
+        size_t i = _scanned >= 3 ? _scanned - 3 : 0;
+        while (i + 4 <= _len) {
+            const char* cr = (const char*)memchr(_buf + i, '\r', _len - i);
+            if (!cr || (size_t)(cr - _buf) + 4 > _len) break;
+            i = cr - _buf;
+            if (memcmp(cr, "\r\n\r\n", 4) == 0) { _headerEnd = i + 4; break; }
+            i++;
+        }
+        if (_headerEnd == 0) {
+            _scanned = _len;
+            if (_len == BUFFER_SIZE) _status = Status::TOO_LARGE;
+            return _status;
+        }
+        _status = parseHead();
+        if (_status != Status::INCOMPLETE) return _status;
+    }
+
+    if (_len - _headerEnd >= _contentLength) _status = Status::COMPLETE;
+    return _status;
+}
+
+HttpRequestParser::Status HttpRequestParser::parseHead() {
+    const char* p = _buf;
+    const char* end = _buf + _headerEnd - 2; // Up to the blank line
+
+    // Request line: METHOD SP PATH SP VERSION CRLF
+    const char* eol = (const char*)memchr(p, '\r', end - p);
+    const char* sp1 = (const char*)memchr(p, ' ', eol - p);
+    if (!sp1 || sp1 == p) return Status::BAD_REQUEST;
+    const char* sp2 = (const char*)memchr(sp1 + 1, ' ', eol - sp1 - 1);
+    if (!sp2 || sp2 == sp1 + 1) return Status::BAD_REQUEST;
+    _method.data = p; _method.len = sp1 - p;
+    _path.data = sp1 + 1; _path.len = sp2 - sp1 - 1;
+    HttpText version; version.data = sp2 + 1; version.len = eol - sp2 - 1;
+    if (version.equals("HTTP/1.1")) _keepAlive = true;
+    else if (!version.equals("HTTP/1.0")) return Status::BAD_REQUEST;
+
+    // Headers: NAME ":" VALUE CRLF
+    for (p = eol + 2; p < end; p = eol + 2) {
+        eol = (const char*)memchr(p, '\r', end - p + 2);
+        const char* colon = (const char*)memchr(p, ':', eol - p);
+        if (!colon || colon == p) return Status::BAD_REQUEST;
+        Header h;
+        h.name.data = p; h.name.len = colon - p;
+        h.value.data = colon + 1; h.value.len = eol - colon - 1;
+        h.value = h.value.trimmed();
+
+        if (h.name.equalsIgnoreCase("Content-Length")) {
+            if (h.value.empty()) return Status::BAD_REQUEST;
+            size_t length = 0;
+            for (size_t i = 0; i < h.value.len; i++) {
+                if (!isdigit((unsigned char)h.value.data[i])) return Status::BAD_REQUEST;
+                if (length > (SIZE_MAX - BUFFER_SIZE) / 10) return Status::TOO_LARGE; // Would overflow
+                length = length * 10 + (h.value.data[i] - '0');
+            }
+            _contentLength = length;
+        } else if (h.name.equalsIgnoreCase("Connection")) {
+            if (h.value.equalsIgnoreCase("close")) _keepAlive = false;
+            else if (h.value.equalsIgnoreCase("keep-alive")) _keepAlive = true;
+        } else if (h.name.equalsIgnoreCase("Transfer-Encoding")) {
+            return Status::BAD_REQUEST; // Chunked bodies are not supported; clients send a length
+        }
+        if (_headerCount < HTTP_MAX_HEADERS) _headers[_headerCount++] = h;
+    }
+
+    if (_headerEnd + _contentLength > BUFFER_SIZE) {
+        // The body is passed on in pieces, which needs room after the headers
+        return _headerEnd < BUFFER_SIZE ? Status::STREAMING : Status::TOO_LARGE;
+    }
+    return Status::INCOMPLETE;
+}
+
+HttpText HttpRequestParser::header(const char* name) const {
+    for (uint8_t i = 0; i < _headerCount; i++) {
+        if (_headers[i].name.equalsIgnoreCase(name)) return _headers[i].value;
+    }
+    return HttpText();
+}
+
+HttpText HttpRequestParser::body() const {
+    HttpText t;
+    if (_status == Status::COMPLETE && _contentLength > _bodyTaken) {
+        t.data = _buf + _headerEnd;
+        t.len = _contentLength - _bodyTaken;
+    }
+    return t;
+}
+
+HttpText HttpRequestParser::takeBody() {
+    HttpText t;
+    if ((_status != Status::COMPLETE && _status != Status::STREAMING) || _len <= _headerEnd) return t;
+    size_t n = _len - _headerEnd;
+    if (n > bodyRemaining()) n = bodyRemaining();
+    if (n == 0) return t;
+    t.data = _buf + _headerEnd;
+    t.len = n;
+    _bodyTaken += n;
+    if (_len == _headerEnd + n) {
+        _len = _headerEnd; // The next read lands here, after the caller is done with the chunk
+    } else {
+        // The body ended inside this chunk and a pipelined request follows: leave both in
+        // place and move the body offset past the chunk, so next() keeps only what followed
+        _headerEnd += n;
+    }
+    if (_bodyTaken == _contentLength) _status = Status::COMPLETE;
+    return t;
+}
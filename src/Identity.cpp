@@ -0,0 +1,114 @@
+#include "Identity.h"
+#include <cstring> // For memcpy, strlen
+#include <monocypher.h>
+#include <optional/monocypher-ed25519.h> // SHA-512 Ed25519, as Reticulum signs with
+
+Identity::Identity() : _hasPublic(false), _hasPrivate(false) {
+    wipe();
+}
+
+Identity::~Identity() {
+    wipe();
+}
+
+void Identity::wipe() {
+    crypto_wipe(_x25519Secret, sizeof(_x25519Secret));
+    crypto_wipe(_ed25519Seed, sizeof(_ed25519Seed));
+    crypto_wipe(_ed25519Secret, sizeof(_ed25519Secret));
+    memset(_publicKey, 0, sizeof(_publicKey));
+    memset(_hash, 0, sizeof(_hash));
+}
+
+void Identity::generate() {
+    uint8_t privateKey[PRIVATE_KEY_SIZE];
+    Crypto::randomBytes(privateKey, sizeof(privateKey));
+    loadPrivateKey(privateKey, sizeof(privateKey));
+    crypto_wipe(privateKey, sizeof(privateKey));
+}
+
+bool Identity::loadPrivateKey(const uint8_t* privateKey, size_t len) {
+    if (!privateKey || len != PRIVATE_KEY_SIZE) return false;
+    memcpy(_x25519Secret, privateKey, KEY_SIZE);
+    memcpy(_ed25519Seed, privateKey + KEY_SIZE, KEY_SIZE);
+
+    crypto_x25519_public_key(_publicKey, _x25519Secret);
+    uint8_t seed[KEY_SIZE];
+    memcpy(seed, _ed25519Seed, KEY_SIZE); // Consumed (wiped) by key_pair
+    crypto_ed25519_key_pair(_ed25519Secret, _publicKey + KEY_SIZE, seed);
+
+    _hasPrivate = true;
+    _hasPublic = true;
+    updateHash();
+    return true;
+}
+
+void Identity::getPrivateKey(uint8_t out[PRIVATE_KEY_SIZE]) const {
+    memcpy(out, _x25519Secret, KEY_SIZE);
+    memcpy(out + KEY_SIZE, _ed25519Seed, KEY_SIZE);
+}
+
+bool Identity::loadPublicKey(const uint8_t* publicKey, size_t len) {
+    if (!publicKey || len != PUBLIC_KEY_SIZE) return false;
+    wipe();
+    memcpy(_publicKey, publicKey, PUBLIC_KEY_SIZE);
+    _hasPrivate = false;
+    _hasPublic = true;
+    updateHash();
+    return true;
+}
+
+void Identity::updateHash() {
+    truncatedHash(_publicKey, PUBLIC_KEY_SIZE, _hash);
+}
+
+bool Identity::exchange(const uint8_t peerPublicKey[KEY_SIZE], uint8_t sharedSecret[KEY_SIZE]) const {
+    if (!_hasPrivate) return false;
+    return exchange(_x25519Secret, peerPublicKey, sharedSecret);
+}
+
+void Identity::generateEphemeral(uint8_t secret[KEY_SIZE], uint8_t publicKey[KEY_SIZE]) {
+    Crypto::randomBytes(secret, KEY_SIZE);
+    crypto_x25519_public_key(publicKey, secret);
+}
+
+bool Identity::exchange(const uint8_t secret[KEY_SIZE], const uint8_t peerPublicKey[KEY_SIZE], uint8_t sharedSecret[KEY_SIZE]) {
+    crypto_x25519(sharedSecret, secret, peerPublicKey);
+    // A low-order peer key yields all zeros; refuse to derive keys from it
+    uint8_t zero[KEY_SIZE] = {0};
+    return !Crypto::constantTimeEqual(sharedSecret, zero, KEY_SIZE);
+}
+
+bool Identity::sign(const uint8_t* message, size_t len, uint8_t signature[SIGNATURE_SIZE]) const {
+    if (!_hasPrivate) return false;
+    crypto_ed25519_sign(signature, _ed25519Secret, message, len);
+    return true;
+}
+
+bool Identity::verify(const uint8_t* message, size_t len, const uint8_t signature[SIGNATURE_SIZE]) const {
+    if (!_hasPublic) return false;
+    return crypto_ed25519_check(signature, _publicKey + KEY_SIZE, message, len) == 0;
+}
+
+// --- Reticulum hashes ---
+void Identity::truncatedHash(const uint8_t* data, size_t len, uint8_t out[HASH_SIZE]) {
+    uint8_t digest[Crypto::SHA256_SIZE];
+    Crypto::sha256(data, len, digest);
+    memcpy(out, digest, HASH_SIZE);
+}
+
+void Identity::nameHash(const char* fullName, uint8_t out[NAME_HASH_SIZE]) {
+    uint8_t digest[Crypto::SHA256_SIZE];
+    Crypto::sha256(reinterpret_cast<const uint8_t*>(fullName), strlen(fullName), digest);
+    memcpy(out, digest, NAME_HASH_SIZE);
+}
+
+void Identity::destinationHash(const char* fullName, const Identity* identity, uint8_t out[HASH_SIZE]) {
+    uint8_t material[NAME_HASH_SIZE + HASH_SIZE];
+    nameHash(fullName, material);
+    size_t len = NAME_HASH_SIZE;
+    if (identity && identity->isValid()) {
+        memcpy(material + NAME_HASH_SIZE, identity->getHash(), HASH_SIZE);
+        len += HASH_SIZE;
+    }
+    truncatedHash(material, len, out);
+}
@@ -0,0 +1,104 @@
+#include "InterfaceAccessCode.h"
+#include <cstring> // For memcpy, memcmp, strlen
+
+// Reticulum's fixed salt for deriving IFAC keys (Reticulum.IFAC_SALT)
+static const uint8_t IFAC_SALT[32] = {
+    0xad, 0xf5, 0x4d, 0x88, 0x2c, 0x9a, 0x9b, 0x80, 0x77, 0x1e, 0xb4, 0x99, 0x5d, 0x70, 0x2d, 0x4a,
+    0x3e, 0x73, 0x33, 0x91, 0xb2, 0xa0, 0xf5, 0x3f, 0x41, 0x6d, 0x9f, 0x90, 0x7e, 0x55, 0xcf, 0xf8
+};
+
+InterfaceAccessCode::InterfaceAccessCode() :
+    _size(0), _cache(), _cacheCount(0), _cacheNext(0), _cacheHits(0)
+{
+    memset(_key, 0, sizeof(_key));
+}
+
+bool InterfaceAccessCode::configure(const char* netname, const char* netkey, size_t size) {
+    _size = 0;
+    _cacheCount = 0;
+    _cacheNext = 0;
+    bool hasName = netname && *netname;
+    bool hasKey = netkey && *netkey;
+    if ((!hasName && !hasKey) || size < 1 || size > RNS_IFAC_MAX_SIZE || size > Identity::SIGNATURE_SIZE) {
+        return false;
+    }
+
+    // origin = SHA-256(netname) + SHA-256(netkey), either part omitted if unset
+    uint8_t origin[2 * Crypto::SHA256_SIZE];
+    size_t originLen = 0;
+    if (hasName) {
+        Crypto::sha256(reinterpret_cast<const uint8_t*>(netname), strlen(netname), origin);
+        originLen += Crypto::SHA256_SIZE;
+    }
+    if (hasKey) {
+        Crypto::sha256(reinterpret_cast<const uint8_t*>(netkey), strlen(netkey), origin + originLen);
+        originLen += Crypto::SHA256_SIZE;
+    }
+    uint8_t originHash[Crypto::SHA256_SIZE];
+    Crypto::sha256(origin, originLen, originHash);
+    Crypto::hkdf(_key, KEY_SIZE, originHash, sizeof(originHash), IFAC_SALT, sizeof(IFAC_SALT));
+    if (!_signer.loadPrivateKey(_key, KEY_SIZE)) return false;
+    _size = size;
+    return true;
+}
+
+// Mask stream for a frame of len bytes carrying this code
+void InterfaceAccessCode::mask(const uint8_t* code, uint8_t* out, size_t len) const {
+    Crypto::hkdf(out, len, code, _size, _key, KEY_SIZE);
+}
+
+bool InterfaceAccessCode::apply(const uint8_t* raw, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen) const {
+    if (!_size || !raw || len < 2 || len + _size > outCapacity) return false;
+    uint8_t signature[Identity::SIGNATURE_SIZE];
+    if (!_signer.sign(raw, len, signature)) return false;
+    const uint8_t* code = signature + Identity::SIGNATURE_SIZE - _size;
+
+    outLen = len + _size;
+    mask(code, out, outLen);
+    // Header and payload are masked, the code itself goes in the clear
+    out[0] = (uint8_t)(((raw[0] | FLAG) ^ out[0]) | FLAG);
+    out[1] ^= raw[1];
+    memcpy(out + 2, code, _size);
+    for (size_t i = 2 + _size; i < outLen; i++) out[i] ^= raw[i - _size];
+    return true;
+}
+
+bool InterfaceAccessCode::verify(const uint8_t* frame, size_t len, uint8_t* out, size_t outCapacity, size_t& outLen) {
+    if (!_size || !frame || !hasFlag(frame, len) || len <= 2 + _size || len > outCapacity) return false;
+    const uint8_t* code = frame + 2;
+
+    // A copy of a frame we already checked (flooded packets are heard repeatedly)
+    uint8_t digest[Crypto::SHA256_SIZE];
+    Crypto::sha256(frame, len, digest);
+    const CacheEntry* cached = nullptr;
+    for (size_t i = 0; i < _cacheCount; i++) {
+        if (memcmp(_cache[i].digest, digest, sizeof(_cache[i].digest)) == 0) { cached = &_cache[i]; break; }
+    }
+    if (cached && !cached->valid) {
+        _cacheHits++;
+        return false;
+    }
+
+    // Unmask, dropping the code: out[j - size] is written only after mask byte j - size was used
+    mask(code, out, len);
+    out[0] = (uint8_t)((frame[0] ^ out[0]) & ~FLAG);
+    out[1] ^= frame[1];
+    for (size_t i = 2 + _size; i < len; i++) out[i - _size] = frame[i] ^ out[i];
+    outLen = len - _size;
+
+    bool valid;
+    if (cached) {
+        _cacheHits++;
+        valid = true;
+    } else {
+        uint8_t signature[Identity::SIGNATURE_SIZE];
+        valid = _signer.sign(out, outLen, signature) &&
+                Crypto::constantTimeEqual(signature + Identity::SIGNATURE_SIZE - _size, code, _size);
+        CacheEntry& entry = _cache[_cacheNext];
+        memcpy(entry.digest, digest, sizeof(entry.digest));
+        entry.valid = valid;
+        _cacheNext = (_cacheNext + 1) % IFAC_VERIFY_CACHE_SIZE;
+        if (_cacheCount < IFAC_VERIFY_CACHE_SIZE) _cacheCount++;
+    }
+    return valid;
+}
@@ -4,9 +4,14 @@
 #include "RoutingTable.h" // Need full definition now for RouteEntry
 #include "ReticulumPacket.h" // For MAX_PACKET_SIZE
 #include "AX25.h"
+#include "PowerManager.h"
+#include "PacketBufferPool.h"
 #include <WiFi.h>
 #include <esp_wifi.h> // For esp_wifi_set_ps
 #include <time.h>
+#include <climits> // For ULONG_MAX
+#include <algorithm> // For std::min
+#include <new>       // For std::nothrow
 #ifdef LORA_ENABLED
 #include <SPI.h>
 #endif
@@ -29,12 +34,23 @@
 // ESP-NOW broadcast MAC address (FF:FF:FF:FF:FF:FF)
 static const uint8_t espnow_broadcast_mac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
+#if LOW_POWER_MODE_ENABLED && LOW_POWER_WIFI_MAX_MODEM
+static const wifi_ps_type_t WIFI_POWER_SAVE = WIFI_PS_MAX_MODEM; // Sleeps across DTIM beacons; ESP-NOW frames meanwhile are lost
+#else
+// Wakes for every DTIM beacon, so ESP-NOW neighbours are still heard while associated
+static const wifi_ps_type_t WIFI_POWER_SAVE = WIFI_PS_MIN_MODEM;
+#endif
+
 // Define static instance pointer
 InterfaceManager* InterfaceManager::_instance = nullptr;
 
 InterfaceManager::InterfaceManager(PacketReceiverCallback receiver, RoutingTable& routingTable) :
     _packetReceiver(receiver),
     _routingTableRef(routingTable),
+    _lastRxLinkQuality(ROUTE_LINK_QUALITY_UNKNOWN),
+    _mtuDrops(0), _ifacDrops(0), _readyMs(0), _firstRxLogged(false),
+    _espNowSendResultHead(0), _espNowSendResultTail(0), _espNowRxHead(0), _espNowRxTail(0), _espNowRxDrops(0),
+    _espNowPeerEvictions(0),
     // Use lambda to capture 'this' for the member function callback
     _serialKissProcessor([this](const std::vector<uint8_t>& data, InterfaceType iface){ this->handleKissPacket(data, iface); })
 #if BLUETOOTH_CLASSIC_AVAILABLE
@@ -42,6 +58,8 @@ InterfaceManager::InterfaceManager(PacketReceiverCallback receiver, RoutingTable
 #endif
 #ifdef LORA_ENABLED
     , _lora(nullptr), _loraInitialized(false)
+    , _loraTxHead(0), _loraTxCount(0), _loraTxState(LoRaTxState::IDLE), _loraTxDeadline(0)
+    , _loraAirtime(LORA_AIRTIME_BUDGET_PERCENT, LORA_AIRTIME_WINDOW_MS), _loraBudgetWarned(false)
 #endif
 #ifdef HAM_MODEM_ENABLED
     , _hamModemKissProcessor([this](const std::vector<uint8_t>& data, InterfaceType iface){ this->handleKissPacket(data, iface); })
@@ -64,9 +82,27 @@ InterfaceManager::InterfaceManager(PacketReceiverCallback receiver, RoutingTable
          return;
     }
     _instance = this; // Set the static instance pointer
+    for (uint8_t i = 0; i < MTU_SLOTS; i++) {
+        _interfaceMtu[i] = hardwareMtu(static_cast<InterfaceType>(i));
+        _ifac[i] = nullptr;
+        _firstRxMs[i] = 0;
+        _firstTxMs[i] = 0;
+    }
 }
 
 void InterfaceManager::setup() {
+    // MTUs from RuntimeConfig; setIfac() below makes room for access codes on top
+    configureMtu(InterfaceType::ESP_NOW);
+    configureMtu(InterfaceType::WIFI_UDP);
+    configureMtu(InterfaceType::LORA);
+
+    // Access codes first: receive callbacks check them from the first frame on
+    for (const IfacInterfaceConfig& ifac : IFAC_INTERFACES) {
+        if (!setIfac(ifac.interface, ifac.netname, ifac.netkey, ifac.size)) {
+            DebugSerial.print("! ERROR: Invalid IFAC configuration for interface "); DebugSerial.println(static_cast<int>(ifac.interface));
+        }
+    }
+
     setupSerial(); // Assumes Serial.begin() already called
     
     // Initialize Bluetooth first (if available)
@@ -75,7 +111,7 @@ void InterfaceManager::setup() {
 #endif
     
     // Configure WiFi power save mode BEFORE initializing WiFi
-    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);  // Use minimum power save mode when both BT and WiFi are active
+    esp_wifi_set_ps(WIFI_POWER_SAVE);  // Minimum modem sleep unless LOW_POWER_WIFI_MAX_MODEM trades ESP-NOW reception for it
     
     // Now setup WiFi and ESP-NOW
     setupWiFi();   // Sets mode, connects, starts UDP
@@ -93,7 +129,8 @@ void InterfaceManager::setup() {
     setupIPFS();
 #endif
     
-    DebugSerial.println("Interface Manager Setup Complete.");
+    _readyMs = millis();
+    DebugSerial.print("Interface Manager Setup Complete ("); DebugSerial.print(_readyMs); DebugSerial.println(" ms after boot).");
 }
 
 void InterfaceManager::loop() {
@@ -103,8 +140,12 @@ void InterfaceManager::loop() {
     processBluetoothInput();
 #endif
 
+    // WiFi events: attach/detach UDP and NTP, schedule reconnects
+    WiFiConnection::State wifiState = _wifi.getState();
+    applyWiFiActions(_wifi.poll(), wifiState);
+
     // Process UDP input if WiFi is connected
-    if (WiFi.status() == WL_CONNECTED) {
+    if (_wifi.isConnected()) {
         processWiFiInput();
     }
 
@@ -119,10 +160,36 @@ void InterfaceManager::loop() {
 #if defined(HAM_MODEM_ENABLED) && defined(AUDIO_MODEM_ENABLED)
     pollAX25FromAudioModem();
 #endif
+
+    processEspNowInput();
+    processEspNowSendResults();
+    processAnnounceQueue();
+
+    if (!_firstRxLogged && getFirstRxMs() != 0) {
+        _firstRxLogged = true;
+        DebugSerial.print("IF: First packet received "); DebugSerial.print(getFirstRxMs()); DebugSerial.println(" ms after boot.");
+    }
+}
+
+unsigned long InterfaceManager::getMaxIdleMs() const {
+    // Wake for the next queued announce that an interface is allowed to send
+    unsigned long maxIdle = _announceQueue.msUntilReady(announceInterfaceMask());
+    // UDP, Bluetooth and the HAM modem are polled, not signalled, so bound the wait
+    if (_wifi.isConnected()) maxIdle = std::min(maxIdle, LOW_POWER_UDP_POLL_MS);
+    maxIdle = std::min(maxIdle, _wifi.msUntilDeadline()); // Connect timeout or next retry
+#if BLUETOOTH_CLASSIC_AVAILABLE
+    maxIdle = std::min(maxIdle, LOW_POWER_UDP_POLL_MS);
+#endif
+#ifdef HAM_MODEM_ENABLED
+    if (_hamModemInitialized) maxIdle = std::min(maxIdle, LOW_POWER_UDP_POLL_MS);
+#endif
+    return maxIdle;
 }
 
 void InterfaceManager::setupSerial() {
     // KissSerial (Serial2) is started in main.cpp for KISS interface
+    // Wake the main loop as soon as KISS bytes arrive (UART RX timeout/FIFO threshold)
+    KissSerial.onReceive([]() { PowerManager::notify(POWER_EVENT_UART_RX); });
     DebugSerial.println("IF: KISS Serial interface ready on Serial2 (GPIO16/17).");
 }
 
@@ -134,28 +201,72 @@ void InterfaceManager::setupWiFi() {
     WiFi.mode(WIFI_AP_STA); // ESP-NOW needs STA or AP mode active
     
     // Set WiFi to use reduced power mode when BT is active
-    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    esp_wifi_set_ps(WIFI_POWER_SAVE);
     
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    DebugSerial.print("IF: Connecting to WiFi ");
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500); DebugSerial.print("."); attempts++;
-    }
-    if (WiFi.status() == WL_CONNECTED) {
-        DebugSerial.println("\nIF: WiFi connected.");
-        DebugSerial.print("IF: IP address: "); DebugSerial.println(WiFi.localIP());
-        setenv("TZ", "UTC0", 1);
-        tzset();
+    // Retries follow WiFiConnection's backoff, not the core's immediate reconnect
+    WiFi.setAutoReconnect(false);
+    WiFi.onEvent(staticWiFiEventCallback);
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    // No SSID: ESP-NOW still runs on the radio, the station stays idle instead of retrying forever
+    if (runtimeConfig.getWiFiSsid()[0] == '\0') {
+        DebugSerial.println("! WARN: No WiFi SSID configured, station idle.");
+        return;
+    }
+    // Boot carries on with the other interfaces; UDP and NTP attach once an IP arrives
+    DebugSerial.print("IF: Connecting to WiFi "); DebugSerial.print(runtimeConfig.getWiFiSsid()); DebugSerial.println(" in the background.");
+    applyWiFiActions(_wifi.begin(), WiFiConnection::State::IDLE);
+}
+
+void InterfaceManager::staticWiFiEventCallback(arduino_event_id_t event, arduino_event_info_t info) {
+    (void)info;
+    if (!_instance) return;
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:       _instance->_wifi.post(WiFiConnection::EVENT_GOT_IP); break;
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:      _instance->_wifi.post(WiFiConnection::EVENT_LOST_IP); break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED: _instance->_wifi.post(WiFiConnection::EVENT_DISCONNECTED); break;
+        default: return;
+    }
+    PowerManager::notify(POWER_EVENT_WIFI);
+}
+
+// Runs on the main loop: the actions WiFiConnection::begin()/poll() asked for
+void InterfaceManager::applyWiFiActions(uint8_t actions, WiFiConnection::State previous) {
+    if (actions & WiFiConnection::ACTION_DETACH) {
+        _udp.stop();
+        if (_wifi.getState() == WiFiConnection::State::BACKOFF) {
+            DebugSerial.print("! WARN: WiFi connection lost, retrying in ");
+            DebugSerial.print(_wifi.msUntilDeadline()); DebugSerial.println(" ms.");
+        }
+    }
+    if (actions & WiFiConnection::ACTION_DISCONNECT) {
+        WiFi.disconnect(); // The next attempt starts from a clean station, not a half-open one
+    }
+    if (actions & WiFiConnection::ACTION_CONNECT) {
+        // Credentials may have been changed at runtime (see applyRuntimeConfig)
+        // DebugSerial.print("IF: WiFi connect attempt "); DebugSerial.println(_wifi.getAttemptCount()); // Verbose
+        WiFi.begin(runtimeConfig.getWiFiSsid(), runtimeConfig.getWiFiPassword());
+    }
+    if (actions & WiFiConnection::ACTION_ATTACH) {
+        if (_wifi.getConnectCount() == 1) {
+            DebugSerial.print("IF: WiFi connected "); DebugSerial.print(_wifi.getFirstConnectMs()); DebugSerial.print(" ms after boot. ");
+        } else {
+            DebugSerial.print("IF: WiFi reconnected. ");
+        }
+        DebugSerial.print("IP address: "); DebugSerial.println(WiFi.localIP());
+        // SNTP restarts and syncs right away, also after a reconnect
         configTime(0, 0, "pool.ntp.org", "time.nist.gov", "time.google.com");
+        _udp.stop(); // Rebind if the address changed
         if (_udp.begin(RNS_UDP_PORT)) {
             DebugSerial.print("IF: UDP Listening on port "); DebugSerial.println(RNS_UDP_PORT);
         } else {
             DebugSerial.println("! ERROR: Failed to start UDP listener!");
         }
-    } else {
-        DebugSerial.println("\n! IF: WiFi connection failed.");
-        // Node might operate without WiFi, but UDP interface won't work
+    } else if (previous == WiFiConnection::State::CONNECTING && _wifi.getState() == WiFiConnection::State::BACKOFF) {
+        // The delay doubles per failure, so a node without its AP logs rarely
+        DebugSerial.print("! WARN: WiFi connect attempt failed, retrying in ");
+        DebugSerial.print(_wifi.msUntilDeadline()); DebugSerial.println(" ms.");
     }
 }
 
@@ -170,7 +281,11 @@ void InterfaceManager::setupESPNow() {
     if (result != ESP_OK) {
          DebugSerial.print("! ERROR: Failed to register ESP-NOW recv cb: "); DebugSerial.println(esp_err_to_name(result));
     }
-    // esp_now_register_send_cb(staticEspNowSendCallback); // Optional: register send status callback
+    // Send status (MAC ACK) for unicast frames drives next-hop failover
+    result = esp_now_register_send_cb(staticEspNowSendCallback);
+    if (result != ESP_OK) {
+         DebugSerial.print("! ERROR: Failed to register ESP-NOW send cb: "); DebugSerial.println(esp_err_to_name(result));
+    }
 
     // Add broadcast peer initially (needed to receive broadcasts)
     if (!addEspNowPeer(espnow_broadcast_mac)) {
@@ -181,11 +296,11 @@ void InterfaceManager::setupESPNow() {
 
 #if BLUETOOTH_CLASSIC_AVAILABLE
 void InterfaceManager::setupBluetooth() {
-     if (!_serialBT.begin(BT_DEVICE_NAME)) {
+     if (!_serialBT.begin(runtimeConfig.getNodeName())) {
          DebugSerial.println("! ERROR: Bluetooth Serial initialization failed!");
      } else {
         DebugSerial.print("IF: Bluetooth ready. Device Name: ");
-        DebugSerial.println(BT_DEVICE_NAME);
+        DebugSerial.println(runtimeConfig.getNodeName());
     }
 }
 #endif
@@ -200,17 +315,16 @@ void InterfaceManager::processWiFiInput() {
              return;
         }
 
-        // Use unique_ptr for automatic memory management
-        std::unique_ptr<uint8_t[]> udpBuffer(new (std::nothrow) uint8_t[packetSize]);
+        PacketBufferPool::Buffer udpBuffer = PacketBufferPool::acquire();
         if (!udpBuffer) {
-             DebugSerial.println("! ERROR: new failed for UDP buffer!");
+             DebugSerial.println("! WARN: Packet buffer pool exhausted, discarding UDP packet.");
              _udp.flush();
              return;
         }
 
-        int len = _udp.read(udpBuffer.get(), packetSize);
+        int len = _udp.read(udpBuffer.data(), packetSize);
         if (len > 0 && _packetReceiver) {
-            _packetReceiver(udpBuffer.get(), len, InterfaceType::WIFI_UDP, nullptr, _udp.remoteIP(), _udp.remotePort());
+            deliverPacket(udpBuffer.data(), len, InterfaceType::WIFI_UDP, nullptr, _udp.remoteIP(), _udp.remotePort());
         }
     }
 }
@@ -247,7 +361,7 @@ void InterfaceManager::handleKissPacket(const std::vector<uint8_t>& packetData,
 
      if (_packetReceiver) {
          // Pass received packet up to ReticulumNode, indicate no specific sender MAC/IP/Port
-         _packetReceiver(packetData.data(), packetData.size(), interface, nullptr, IPAddress(), 0);
+         deliverPacket(packetData.data(), packetData.size(), interface);
      }
 }
 
@@ -264,6 +378,12 @@ void InterfaceManager::sendPacket(const uint8_t *packetBuffer, size_t packetLen,
         if (route->interface != excludeInterface) {
              // Send only via the routed interface
              sendPacketVia(route->interface, packetBuffer, packetLen, destinationAddr);
+        } else if (route->candidate_count > 1) {
+             // Active next hop is where the packet came from; try the best backup on another interface
+             const RouteCandidate* backup = _routingTableRef.findSplitCandidate(destinationAddr);
+             if (backup && backup->interface != excludeInterface) {
+                 sendPacketViaCandidate(*backup, packetBuffer, packetLen, destinationAddr);
+             }
         }
     } else {
         // No route, broadcast on primary interfaces (excluding source)
@@ -271,7 +391,7 @@ void InterfaceManager::sendPacket(const uint8_t *packetBuffer, size_t packetLen,
         if (excludeInterface != InterfaceType::ESP_NOW) {
             sendPacketViaEspNow(packetBuffer, packetLen, nullptr); // Broadcast = null dest for internal func
         }
-        if (WiFi.status() == WL_CONNECTED && excludeInterface != InterfaceType::WIFI_UDP) {
+        if (_wifi.isConnected() && excludeInterface != InterfaceType::WIFI_UDP) {
              sendPacketViaWiFi(packetBuffer, packetLen, nullptr); // Broadcast = null dest for internal func
         }
 #ifdef LORA_ENABLED
@@ -309,54 +429,347 @@ void InterfaceManager::sendPacketVia(InterfaceType ifType, const uint8_t *packet
      }
 }
 
-void InterfaceManager::broadcastAnnounce(const uint8_t *packetBuffer, size_t packetLen) {
+void InterfaceManager::sendPacketViaCandidate(const RouteCandidate& candidate, const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr) {
      if (!packetBuffer || packetLen == 0) return;
-     // Use nullptr destination for broadcast variants
-     sendPacketViaEspNow(packetBuffer, packetLen, nullptr);
-     if (WiFi.status() == WL_CONNECTED) {
-         sendPacketViaWiFi(packetBuffer, packetLen, nullptr);
+     if (candidate.interface == InterfaceType::ESP_NOW) {
+         sendEspNowPacket(candidate.next_hop_mac, packetBuffer, packetLen);
+     } else if (candidate.interface == InterfaceType::WIFI_UDP) {
+         if (_wifi.isConnected()) sendUdpFrame(candidate.next_hop_ip, packetBuffer, packetLen);
+     } else {
+         sendPacketVia(candidate.interface, packetBuffer, packetLen, destinationAddr); // Broadcast media
      }
+}
+
+void InterfaceManager::queueAnnounce(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *announcedAddr,
+                                     uint8_t hops, unsigned long delayMs) {
+     if (!packetBuffer || packetLen == 0 || !announcedAddr) return;
+     // Replaces a stale queued announce for the same destination; refused if the queue is full of closer ones
+     _announceQueue.enqueue(packetBuffer, packetLen, announcedAddr, hops, announceInterfaceMask(), delayMs);
+     processAnnounceQueue(); // Zero-delay announces go out now if the budget allows
+}
+
+// Interfaces announces are broadcast on
+uint32_t InterfaceManager::announceInterfaceMask() const {
+    uint32_t mask = AnnounceQueue::interfaceBit(InterfaceType::ESP_NOW);
+    if (_wifi.isConnected()) mask |= AnnounceQueue::interfaceBit(InterfaceType::WIFI_UDP);
 #ifdef LORA_ENABLED
-     if (_loraInitialized) {
-         sendPacketViaLoRa(packetBuffer, packetLen, nullptr);
-     }
+    if (_loraInitialized) mask |= AnnounceQueue::interfaceBit(InterfaceType::LORA);
 #endif
 #ifdef HAM_MODEM_ENABLED
-     if (_hamModemInitialized) {
-         sendPacketViaHAMModem(packetBuffer, packetLen);
-     }
+    if (_hamModemInitialized) mask |= AnnounceQueue::interfaceBit(InterfaceType::HAM_MODEM);
+#endif
+    return mask;
+}
+
+// Approximate time a frame occupies the medium, used to charge the announce budget
+uint32_t InterfaceManager::announceTxTimeMs(InterfaceType ifType, size_t packetLen) const {
+    uint32_t bitrate = 1000000; // ESP-NOW / WiFi base rate (1 Mbps)
+    switch (ifType) {
+#ifdef LORA_ENABLED
+        case InterfaceType::LORA: return loraTimeOnAirMs(packetLen);
+#endif
+#ifdef HAM_MODEM_ENABLED
+        case InterfaceType::HAM_MODEM: bitrate = AUDIO_MODEM_BAUD_RATE; break;
+#endif
+        default: break;
+    }
+    uint32_t ms = (uint32_t)((packetLen * 8UL * 1000UL) / bitrate);
+    return ms > 0 ? ms : 1;
+}
+
+void InterfaceManager::processAnnounceQueue() {
+    _announceQueue.expire();
+    if (_announceQueue.size() == 0) return;
+
+    std::vector<uint8_t> packet;
+    // ESP-NOW (broadcast MAC)
+    while (_announceQueue.next(InterfaceType::ESP_NOW, packet)) {
+        sendPacketViaEspNow(packet.data(), packet.size(), nullptr);
+        _announceQueue.recordTransmit(InterfaceType::ESP_NOW, announceTxTimeMs(InterfaceType::ESP_NOW, packet.size()));
+    }
+    while (_announceQueue.next(InterfaceType::WIFI_UDP, packet)) {
+        if (!_wifi.isConnected()) continue; // Lost WiFi since queuing; discard
+        sendPacketViaWiFi(packet.data(), packet.size(), nullptr);
+        _announceQueue.recordTransmit(InterfaceType::WIFI_UDP, announceTxTimeMs(InterfaceType::WIFI_UDP, packet.size()));
+    }
+#ifdef LORA_ENABLED
+    // Announces are the first thing to give up when the duty-cycle budget runs low
+    while (_loraInitialized && _loraTxCount < LORA_TX_QUEUE_SIZE && _announceQueue.next(InterfaceType::LORA, packet)) {
+        if (!hasAirtimeFor(InterfaceType::LORA, packet.size())) continue;
+        sendPacketViaLoRa(packet.data(), packet.size(), nullptr);
+        _announceQueue.recordTransmit(InterfaceType::LORA, announceTxTimeMs(InterfaceType::LORA, packet.size()));
+    }
+#endif
+#ifdef HAM_MODEM_ENABLED
+    while (_hamModemInitialized && _announceQueue.next(InterfaceType::HAM_MODEM, packet)) {
+        sendPacketViaHAMModem(packet.data(), packet.size());
+        _announceQueue.recordTransmit(InterfaceType::HAM_MODEM, announceTxTimeMs(InterfaceType::HAM_MODEM, packet.size()));
+    }
+#endif
+}
+
+// --- MTU ---
+// Frame limits of each medium; every buffer on the node holds MAX_PACKET_SIZE
+size_t InterfaceManager::hardwareMtu(InterfaceType ifType) {
+    switch (ifType) {
+        case InterfaceType::LORA:      return std::min(MAX_PACKET_SIZE, (size_t)255); // SX127x FIFO
+        case InterfaceType::HAM_MODEM: return std::min(MAX_PACKET_SIZE, (size_t)256); // AX.25 default I-field
+        default:                       return MAX_PACKET_SIZE; // ESP-NOW fragments; UDP and KISS are unbounded
+    }
+}
+
+size_t InterfaceManager::getInterfaceMtu(InterfaceType ifType) const {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    return slot < MTU_SLOTS ? _interfaceMtu[slot] : MAX_PACKET_SIZE;
+}
+
+size_t InterfaceManager::setInterfaceMtu(InterfaceType ifType, size_t mtu) {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    if (slot >= MTU_SLOTS) return 0;
+    // Below a bare header nothing fits; above the medium limit frames would be truncated
+    _interfaceMtu[slot] = (uint16_t)std::max(RNS_HEADER_1_SIZE, std::min(mtu, hardwareMtu(ifType)));
+    return _interfaceMtu[slot];
+}
+
+void InterfaceManager::configureMtu(InterfaceType ifType) {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    if (slot >= MTU_SLOTS) return;
+    size_t mtu = runtimeConfig.getInterfaceMtu(ifType);
+    _interfaceMtu[slot] = hardwareMtu(ifType);
+    if (mtu > 0) setInterfaceMtu(ifType, mtu);
+    size_t ifacSize = getIfacSize(ifType);
+    if (ifacSize > 0) setInterfaceMtu(ifType, std::max(getInterfaceMtu(ifType), RNS_HEADER_1_SIZE + ifacSize));
+}
+
+void InterfaceManager::applyRuntimeConfig(const RuntimeConfig& previous) {
+    configureMtu(InterfaceType::ESP_NOW);
+    configureMtu(InterfaceType::WIFI_UDP);
+    configureMtu(InterfaceType::LORA);
+
+    if (strcmp(previous.getWiFiSsid(), runtimeConfig.getWiFiSsid()) != 0 ||
+        strcmp(previous.getWiFiPassword(), runtimeConfig.getWiFiPassword()) != 0) {
+        WiFiConnection::State wifiState = _wifi.getState();
+        if (runtimeConfig.getWiFiSsid()[0] == '\0') {
+            DebugSerial.println("IF: WiFi SSID cleared, station idle.");
+            applyWiFiActions(_wifi.stop(), wifiState);
+        } else if (wifiState == WiFiConnection::State::IDLE) {
+            DebugSerial.print("IF: WiFi SSID set, connecting to "); DebugSerial.println(runtimeConfig.getWiFiSsid());
+            applyWiFiActions(_wifi.begin(), wifiState);
+        } else {
+            // The disconnect event runs the usual retry, which connects with the new credentials
+            DebugSerial.print("IF: WiFi credentials changed, connecting to "); DebugSerial.println(runtimeConfig.getWiFiSsid());
+            WiFi.disconnect();
+        }
+    }
+}
+
+// Packet size the path carries: interface MTU less the access code added on the way out
+size_t InterfaceManager::getPathMtu(const uint8_t* destinationAddr) {
+    RouteEntry* route = destinationAddr ? _routingTableRef.findRoute(destinationAddr) : nullptr;
+    if (route) return getInterfaceMtu(route->interface) - getIfacSize(route->interface);
+
+    // Unrouted packets are broadcast on every interface below; the smallest one decides
+    size_t mtu = getInterfaceMtu(InterfaceType::ESP_NOW) - getIfacSize(InterfaceType::ESP_NOW);
+    if (_wifi.isConnected()) {
+        mtu = std::min(mtu, getInterfaceMtu(InterfaceType::WIFI_UDP) - getIfacSize(InterfaceType::WIFI_UDP));
+    }
+#ifdef LORA_ENABLED
+    if (_loraInitialized) mtu = std::min(mtu, getInterfaceMtu(InterfaceType::LORA) - getIfacSize(InterfaceType::LORA));
+#endif
+    return mtu;
+}
+
+bool InterfaceManager::fitsMtu(InterfaceType ifType, size_t packetLen) {
+    if (packetLen <= getInterfaceMtu(ifType)) {
+        noteFirstFrame(_firstTxMs, ifType); // Every send path checks the MTU right before transmitting
+        return true;
+    }
+    _mtuDrops++;
+    DebugSerial.print("! WARN: Packet of "); DebugSerial.print(packetLen);
+    DebugSerial.print(" bytes exceeds MTU of interface "); DebugSerial.print(static_cast<int>(ifType));
+    DebugSerial.println(", dropping.");
+    return false;
+}
+
+// --- Boot Timing ---
+void InterfaceManager::noteFirstFrame(volatile uint32_t* firstMs, InterfaceType ifType) {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    if (slot < MTU_SLOTS && firstMs[slot] == 0) {
+        uint32_t now = millis();
+        firstMs[slot] = now ? now : 1; // 0 means "none yet"
+    }
+}
+
+uint32_t InterfaceManager::getFirstRxMs(InterfaceType ifType) const {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    return slot < MTU_SLOTS ? _firstRxMs[slot] : 0;
+}
+
+uint32_t InterfaceManager::getFirstTxMs(InterfaceType ifType) const {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    return slot < MTU_SLOTS ? _firstTxMs[slot] : 0;
+}
+
+// Earliest over all interfaces, 0 if none yet
+static uint32_t earliestFrame(const volatile uint32_t* firstMs, uint8_t slots) {
+    uint32_t earliest = 0;
+    for (uint8_t i = 0; i < slots; i++) {
+        uint32_t at = firstMs[i];
+        if (at != 0 && (earliest == 0 || at < earliest)) earliest = at;
+    }
+    return earliest;
+}
+
+uint32_t InterfaceManager::getFirstRxMs() const { return earliestFrame(_firstRxMs, MTU_SLOTS); }
+uint32_t InterfaceManager::getFirstTxMs() const { return earliestFrame(_firstTxMs, MTU_SLOTS); }
+
+// --- Interface Access Codes ---
+bool InterfaceManager::setIfac(InterfaceType ifType, const char* netname, const char* netkey, size_t size) {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    if (slot >= MTU_SLOTS) return false;
+    if (!_ifac[slot]) {
+        _ifac[slot] = new (std::nothrow) InterfaceAccessCode();
+        if (!_ifac[slot]) return false;
+    }
+    if (!_ifac[slot]->configure(netname, netkey, size)) {
+        delete _ifac[slot];
+        _ifac[slot] = nullptr;
+        return false;
+    }
+    // Code bytes come out of the interface's MTU, so a small MTU must still leave room for a header
+    setInterfaceMtu(ifType, std::max(getInterfaceMtu(ifType), RNS_HEADER_1_SIZE + size));
+    DebugSerial.print("IFAC enabled on interface "); DebugSerial.print(static_cast<int>(ifType));
+    DebugSerial.print(" ("); DebugSerial.print(size); DebugSerial.println("-byte code)");
+    return true;
+}
+
+InterfaceAccessCode* InterfaceManager::ifacFor(InterfaceType ifType) const {
+    uint8_t slot = static_cast<uint8_t>(ifType);
+    return slot < MTU_SLOTS ? _ifac[slot] : nullptr;
+}
+
+size_t InterfaceManager::getIfacSize(InterfaceType ifType) const {
+    InterfaceAccessCode* ifac = ifacFor(ifType);
+    return ifac ? ifac->getSize() : 0;
+}
+
+// A flagged frame on an open interface, or an unflagged one on an IFAC interface, costs a
+// bit test; only frames claiming our network are unmasked and checked
+bool InterfaceManager::checkIfac(InterfaceType ifType, const uint8_t*& packet, size_t& len,
+                                 PacketBufferPool::Buffer& scratch) {
+    InterfaceAccessCode* ifac = ifacFor(ifType);
+    bool flagged = InterfaceAccessCode::hasFlag(packet, len);
+    if (!ifac) {
+        if (!flagged) {
+            noteFirstFrame(_firstRxMs, ifType);
+            return true;
+        }
+    } else if (flagged) {
+        scratch = PacketBufferPool::acquire();
+        size_t plainLen = 0;
+        if (scratch && ifac->verify(packet, len, scratch.data(), scratch.capacity(), plainLen)) {
+            packet = scratch.data();
+            len = plainLen;
+            noteFirstFrame(_firstRxMs, ifType);
+            return true;
+        }
+    }
+    _ifacDrops++;
+    return false;
+}
+
+void InterfaceManager::deliverPacket(const uint8_t* packet, size_t len, InterfaceType ifType,
+                                     const uint8_t* senderMac, const IPAddress& senderIp, uint16_t senderPort) {
+    PacketBufferPool::Buffer unmasked;
+    if (!checkIfac(ifType, packet, len, unmasked)) {
+        // DebugSerial.println("IFAC check failed, dropping frame."); // Verbose
+        return;
+    }
+    if (_packetReceiver) _packetReceiver(packet, len, ifType, senderMac, senderIp, senderPort);
+}
+
+const uint8_t* InterfaceManager::applyIfac(InterfaceType ifType, const uint8_t* packet, size_t& len,
+                                           PacketBufferPool::Buffer& scratch) {
+    InterfaceAccessCode* ifac = ifacFor(ifType);
+    if (!ifac) return packet;
+    scratch = PacketBufferPool::acquire();
+    size_t codedLen = 0;
+    if (!scratch || !ifac->apply(packet, len, scratch.data(), scratch.capacity(), codedLen)) {
+        DebugSerial.println("! WARN: Could not add interface access code, dropping frame.");
+        return nullptr;
+    }
+    len = codedLen;
+    return scratch.data();
+}
+
+AirtimeTracker* InterfaceManager::getAirtimeTracker(InterfaceType ifType) {
+#ifdef LORA_ENABLED
+    if (ifType == InterfaceType::LORA) return &_loraAirtime;
 #endif
+    (void)ifType;
+    return nullptr;
+}
+
+bool InterfaceManager::hasAirtimeFor(InterfaceType ifType, size_t packetLen) {
+    AirtimeTracker* tracker = getAirtimeTracker(ifType);
+    if (!tracker) return true;
+#ifdef LORA_ENABLED
+    if (ifType == InterfaceType::LORA) return tracker->canTransmit(loraTimeOnAirMs(packetLen));
+#endif
+    (void)packetLen;
+    return true;
 }
 
 // Internal send implementations
 void InterfaceManager::sendPacketViaEspNow(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr) {
     const uint8_t* targetMac = espnow_broadcast_mac; // Default to broadcast
-    RouteEntry* route = nullptr;
 
     if (destinationAddr != nullptr) { // If destination provided, try to find route
-        route = _routingTableRef.findRoute(destinationAddr);
-         if (route && route->interface == InterfaceType::ESP_NOW) {
-             targetMac = route->next_hop_mac;
-             // Ensure peer exists - crucial for direct send
-             if (!checkEspNowPeer(targetMac)) {
-                 if (!addEspNowPeer(targetMac)) {
-                     targetMac = espnow_broadcast_mac; // Fallback if add fails
-                 }
-             }
-         } else { targetMac = espnow_broadcast_mac; } // No route / wrong interface
+        RouteEntry* route = _routingTableRef.findRoute(destinationAddr);
+        if (route && route->interface == InterfaceType::ESP_NOW) {
+            targetMac = route->next_hop_mac;
+        } // else: No route / wrong interface -> broadcast
     } // else: destinationAddr is null -> use broadcastMac
 
-    esp_err_t result = esp_now_send(targetMac, packetBuffer, packetLen);
+    sendEspNowPacket(targetMac, packetBuffer, packetLen);
+}
+
+void InterfaceManager::sendEspNowPacket(const uint8_t *targetMac, const uint8_t *packetBuffer, size_t packetLen) {
+    size_t ifacSize = getIfacSize(InterfaceType::ESP_NOW);
+    if (!fitsMtu(InterfaceType::ESP_NOW, packetLen + ifacSize)) return;
+    // Ensure peer exists - crucial for direct send. A cache hit costs no IDF call.
+    if (memcmp(targetMac, espnow_broadcast_mac, 6) != 0 && !addEspNowPeer(targetMac)) {
+        targetMac = espnow_broadcast_mac; // Fallback if add fails
+    }
+
+    // Every fragment carries its own access code, so receivers check it before reassembly
+    size_t frameMax = EspNowFragmenter::FRAME_MAX - ifacSize;
+    if (EspNowFragmenter::needsFragmentation(packetLen, frameMax)) {
+        _espNowFragmenter.send(packetBuffer, packetLen, [this, targetMac](const uint8_t* frame, size_t len) {
+            return transmitEspNowFrame(targetMac, frame, len);
+        }, frameMax);
+    } else {
+        transmitEspNowFrame(targetMac, packetBuffer, packetLen);
+    }
+}
+
+bool InterfaceManager::transmitEspNowFrame(const uint8_t *targetMac, const uint8_t *frame, size_t len) {
+    PacketBufferPool::Buffer coded;
+    frame = applyIfac(InterfaceType::ESP_NOW, frame, len, coded);
+    if (!frame) return false;
+    uint32_t sentUs = micros();
+    esp_err_t result = esp_now_send(targetMac, frame, len);
+    if (result == ESP_OK && memcmp(targetMac, espnow_broadcast_mac, 6) != 0) {
+        _espNowPeers.recordSend(targetMac, sentUs); // Matched by the send-status callback
+    }
     if (result != ESP_OK) { DebugSerial.print("! ESP-NOW Send Error to "); Utils::printBytes(targetMac, 6, DebugSerial); DebugSerial.print(": "); DebugSerial.println(esp_err_to_name(result)); }
+    return result == ESP_OK;
 }
 
 void InterfaceManager::sendPacketViaWiFi(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr) {
-     if (WiFi.status() != WL_CONNECTED) return;
+     if (!_wifi.isConnected()) return;
 
-    IPAddress targetIp;
-    uint16_t targetPort = RNS_UDP_PORT;
-    IPAddress broadcastIp = WiFi.broadcastIP();
-    targetIp = broadcastIp; // Default to broadcast
+    IPAddress targetIp = WiFi.broadcastIP(); // Default to broadcast
 
      if (destinationAddr != nullptr) { // If destination provided, try to find route
         RouteEntry* route = _routingTableRef.findRoute(destinationAddr);
@@ -366,12 +779,20 @@ void InterfaceManager::sendPacketViaWiFi(const uint8_t *packetBuffer, size_t pac
         } // else: use broadcast IP
      } // else: destinationAddr is null -> use broadcast IP
 
+    sendUdpFrame(targetIp, packetBuffer, packetLen);
+}
+
+void InterfaceManager::sendUdpFrame(const IPAddress& targetIp, const uint8_t *packetBuffer, size_t packetLen) {
     if (!targetIp || targetIp == INADDR_NONE) {
         DebugSerial.println("! WARN: UDP Target IP is invalid, cannot send.");
         return;
     }
+    if (!fitsMtu(InterfaceType::WIFI_UDP, packetLen + getIfacSize(InterfaceType::WIFI_UDP))) return;
+    PacketBufferPool::Buffer coded;
+    packetBuffer = applyIfac(InterfaceType::WIFI_UDP, packetBuffer, packetLen, coded);
+    if (!packetBuffer) return;
 
-    _udp.beginPacket(targetIp, targetPort);
+    _udp.beginPacket(targetIp, RNS_UDP_PORT);
     size_t sent = _udp.write(packetBuffer, packetLen);
     if (sent != packetLen) { DebugSerial.print("! WARN: UDP write incomplete (sent "); DebugSerial.print(sent); DebugSerial.print("/"); DebugSerial.print(packetLen); DebugSerial.println(" bytes)"); }
     if (!_udp.endPacket()) { DebugSerial.println("! ERROR: UDP endPacket failed!"); }
@@ -379,6 +800,10 @@ void InterfaceManager::sendPacketViaWiFi(const uint8_t *packetBuffer, size_t pac
 
 // KISS interface sends packaets over dedicated serial link
 void InterfaceManager::sendPacketViaSerial(const uint8_t *packetBuffer, size_t packetLen) {
+    if (!fitsMtu(InterfaceType::SERIAL_PORT, packetLen + getIfacSize(InterfaceType::SERIAL_PORT))) return;
+    PacketBufferPool::Buffer coded;
+    packetBuffer = applyIfac(InterfaceType::SERIAL_PORT, packetBuffer, packetLen, coded);
+    if (!packetBuffer) return;
     std::vector<uint8_t> kissEncoded;
     KISSProcessor::encode(packetBuffer, packetLen, kissEncoded);
     size_t sent = KissSerial.write(kissEncoded.data(), kissEncoded.size());
@@ -386,7 +811,10 @@ void InterfaceManager::sendPacketViaSerial(const uint8_t *packetBuffer, size_t p
 }
 #if BLUETOOTH_CLASSIC_AVAILABLE
 void InterfaceManager::sendPacketViaBluetooth(const uint8_t *packetBuffer, size_t packetLen) {
-    if (!_serialBT.connected()) return;
+    if (!_serialBT.connected() || !fitsMtu(InterfaceType::BLUETOOTH, packetLen + getIfacSize(InterfaceType::BLUETOOTH))) return;
+    PacketBufferPool::Buffer coded;
+    packetBuffer = applyIfac(InterfaceType::BLUETOOTH, packetBuffer, packetLen, coded);
+    if (!packetBuffer) return;
     std::vector<uint8_t> kissEncoded;
     KISSProcessor::encode(packetBuffer, packetLen, kissEncoded);
     size_t sent = _serialBT.write(kissEncoded.data(), kissEncoded.size());
@@ -395,9 +823,26 @@ void InterfaceManager::sendPacketViaBluetooth(const uint8_t *packetBuffer, size_
 #endif
 
 // --- ESP-NOW Peer Management ---
+// Unicast peers are cached in _espNowPeers; only cache misses reach the IDF peer list.
+// With all ESPNOW_HW_PEER_SLOTS in use, the least recently used peer is unregistered first.
 bool InterfaceManager::addEspNowPeer(const uint8_t* mac_addr) {
     if (!mac_addr) return false;
-    if (checkEspNowPeer(mac_addr)) return true; // Already exists
+    bool broadcast = memcmp(mac_addr, espnow_broadcast_mac, 6) == 0;
+    EspNowPeerTable::Peer* cached = nullptr;
+    if (broadcast) {
+        if (checkEspNowPeer(mac_addr)) return true; // Already exists
+    } else {
+        cached = _espNowPeers.touch(mac_addr);
+        if (cached->registered) return true; // Hot path: no IDF lookup
+        if (_espNowPeers.getRegisteredCount() >= ESPNOW_HW_PEER_SLOTS) {
+            EspNowPeerTable::Peer* victim = _espNowPeers.leastRecentRegistered(mac_addr);
+            if (victim && esp_now_del_peer(victim->mac) == ESP_OK) {
+                // DebugSerial.print("IF: Rotated out ESP-NOW peer: "); Utils::printBytes(victim->mac, 6, DebugSerial); DebugSerial.println(); // Verbose
+                _espNowPeers.setRegistered(victim, false);
+                _espNowPeerEvictions++;
+            }
+        }
+    }
 
     esp_now_peer_info_t peerInfo = {}; // Initialize all fields to 0/false/etc.
     memcpy(peerInfo.peer_addr, mac_addr, 6);
@@ -405,11 +850,12 @@ bool InterfaceManager::addEspNowPeer(const uint8_t* mac_addr) {
     peerInfo.encrypt = false; // Encryption disabled (requires shared keys)
     // peerInfo.ifidx = WIFI_IF_STA; // Use station interface? Or AP? Test which works best. WIFI_IF_AP might also be needed.
     esp_err_t add_result = esp_now_add_peer(&peerInfo);
-    if (add_result != ESP_OK) {
+    if (add_result != ESP_OK && add_result != ESP_ERR_ESPNOW_EXIST) {
          DebugSerial.print("! ERROR: Failed to add ESP-NOW peer "); Utils::printBytes(mac_addr, 6, DebugSerial); DebugSerial.print(": "); DebugSerial.println(esp_err_to_name(add_result));
          return false;
     }
-    DebugSerial.print("IF: Added ESP-NOW peer: "); Utils::printBytes(mac_addr, 6, DebugSerial); DebugSerial.println();
+    if (cached) _espNowPeers.setRegistered(cached, true);
+    // DebugSerial.print("IF: Added ESP-NOW peer: "); Utils::printBytes(mac_addr, 6, DebugSerial); DebugSerial.println(); // Verbose
     return true;
 }
 
@@ -418,16 +864,21 @@ bool InterfaceManager::removeEspNowPeer(const uint8_t* mac_addr) {
      if (!checkEspNowPeer(mac_addr)) return false; // Not found
 
      esp_err_t del_result = esp_now_del_peer(mac_addr);
-     if (del_result != ESP_OK) {
+     if (del_result != ESP_OK && del_result != ESP_ERR_ESPNOW_NOT_FOUND) {
          DebugSerial.print("! WARN: Failed to delete ESP-NOW peer "); Utils::printBytes(mac_addr, 6, DebugSerial); DebugSerial.print(": "); DebugSerial.println(esp_err_to_name(del_result));
          return false;
      }
+     _espNowPeers.setRegistered(_espNowPeers.find(mac_addr), false);
      DebugSerial.print("IF: Removed ESP-NOW peer: "); Utils::printBytes(mac_addr, 6, DebugSerial); DebugSerial.println();
      return true;
 }
 
 bool InterfaceManager::checkEspNowPeer(const uint8_t* mac_addr) {
     if (!mac_addr) return false;
+    if (memcmp(mac_addr, espnow_broadcast_mac, 6) != 0) {
+        const EspNowPeerTable::Peer* cached = _espNowPeers.find(mac_addr);
+        return cached && cached->registered;
+    }
     // esp_now_is_peer_exist() is deprecated/removed in later IDF versions.
     // Use esp_now_get_peer() and check result.
     esp_now_peer_info_t peer_info;
@@ -437,28 +888,106 @@ bool InterfaceManager::checkEspNowPeer(const uint8_t* mac_addr) {
 
 
 // --- Static Callbacks ---
+// Runs on the WiFi task: only copy the frame out, IFAC, reassembly and packet handling happen in loop()
 void InterfaceManager::staticEspNowRecvCallback(const uint8_t *mac_addr, const uint8_t *incomingData, int len) {
-    if (_instance && _instance->_packetReceiver && mac_addr && incomingData && len > 0) {
-        if (len <= MAX_PACKET_SIZE) {
-             // Pass to instance's packet receiver callback
-            _instance->_packetReceiver(incomingData, (size_t)len, InterfaceType::ESP_NOW, mac_addr, IPAddress(), 0);
-        } else {
-             DebugSerial.print("! WARN: Oversized ESP-NOW packet received ("); DebugSerial.print(len); DebugSerial.println(" bytes), discarding.");
+    if (!_instance || !mac_addr || !incomingData || len <= 0) return;
+    if ((size_t)len > PacketBufferPool::Buffer::capacity()) {
+        _instance->_espNowRxDrops++; // Larger than any valid frame or fragment
+        return;
+    }
+
+    uint8_t head = _instance->_espNowRxHead.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % ESPNOW_RX_QUEUE_SIZE;
+    if (next == _instance->_espNowRxTail.load(std::memory_order_acquire)) { // Full; the loop is behind, drop
+        _instance->_espNowRxDrops++;
+        return;
+    }
+    EspNowRxFrame& slot = _instance->_espNowRxFrames[head];
+    slot.buffer = PacketBufferPool::acquire();
+    if (!slot.buffer) {
+        _instance->_espNowRxDrops++;
+        return;
+    }
+    memcpy(slot.buffer.data(), incomingData, len);
+    memcpy(slot.mac, mac_addr, 6);
+    slot.len = (uint16_t)len;
+    _instance->_espNowRxHead.store(next, std::memory_order_release); // Frame is complete before the loop sees it
+    PowerManager::notify(POWER_EVENT_ESPNOW_RX);
+}
+
+void InterfaceManager::processEspNowInput() {
+    uint8_t tail = _espNowRxTail.load(std::memory_order_relaxed);
+    while (tail != _espNowRxHead.load(std::memory_order_acquire)) {
+        EspNowRxFrame& frame = _espNowRxFrames[tail];
+        // The access code is per frame: fragments from outside the network never reach the reassembler
+        const uint8_t* data = frame.buffer.data();
+        size_t len = frame.len;
+        PacketBufferPool::Buffer unmasked;
+        if (_packetReceiver && checkIfac(InterfaceType::ESP_NOW, data, len, unmasked)) {
+            if (EspNowFragmenter::isFragment(data, len)) {
+                // Part of a packet larger than one ESP-NOW frame; deliver once all parts are in
+                const uint8_t* packet = nullptr;
+                size_t packetLen = 0;
+                if (_espNowFragmenter.reassemble(frame.mac, data, len, packet, packetLen)) {
+                    _packetReceiver(packet, packetLen, InterfaceType::ESP_NOW, frame.mac, IPAddress(), 0);
+                }
+            } else {
+                _packetReceiver(data, len, InterfaceType::ESP_NOW, frame.mac, IPAddress(), 0);
+            }
         }
+        frame.buffer.release();
+        tail = (tail + 1) % ESPNOW_RX_QUEUE_SIZE;
+        _espNowRxTail.store(tail, std::memory_order_release); // Slot may be refilled from here on
     }
 }
 
-/* Optional Static Send Callback
+// Runs on the WiFi task: only record the outcome, the routing table is updated from loop()
 void InterfaceManager::staticEspNowSendCallback(const uint8_t *mac_addr, esp_now_send_status_t status) {
-    if (_instance && mac_addr) {
-        // Could notify routing table or link manager about send status
-        // DebugSerial.print("IF: ESP-NOW Send Status to MAC "); Utils::printBytes(mac_addr, 6, Serial); DebugSerial.print(": "); DebugSerial.println(status == ESP_NOW_SEND_SUCCESS ? "Success" : "Fail");
+    if (!_instance || !mac_addr) return;
+    if (memcmp(mac_addr, espnow_broadcast_mac, 6) == 0) return; // Broadcasts are never ACKed
+
+    uint8_t head = _instance->_espNowSendResultHead.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % ESPNOW_SEND_RESULT_QUEUE_SIZE;
+    if (next == _instance->_espNowSendResultTail.load(std::memory_order_acquire)) return; // Full; the loop is behind, drop
+    EspNowSendResult& slot = _instance->_espNowSendResults[head];
+    memcpy(slot.mac, mac_addr, 6);
+    slot.success = (status == ESP_NOW_SEND_SUCCESS);
+    slot.atUs = micros();
+    _instance->_espNowSendResultHead.store(next, std::memory_order_release);
+    PowerManager::notify(POWER_EVENT_ESPNOW_RX);
+}
+
+void InterfaceManager::processEspNowSendResults() {
+    uint8_t tail = _espNowSendResultTail.load(std::memory_order_relaxed);
+    while (tail != _espNowSendResultHead.load(std::memory_order_acquire)) {
+        const EspNowSendResult& result = _espNowSendResults[tail];
+        // DebugSerial.print("IF: ESP-NOW Send Status to MAC "); Utils::printBytes(result.mac, 6, Serial); DebugSerial.println(result.success ? ": Success" : ": Fail"); // Verbose
+        EspNowPeerTable::Peer* peer = _espNowPeers.recordResult(result.mac, result.success, result.atUs);
+        // MAC delivery ratio stands in for the RSSI the IDF 4.4 receive callback does not give us
+        _routingTableRef.reportNextHopResult(InterfaceType::ESP_NOW, result.mac, IPAddress(), result.success,
+                                             peer ? peer->deliveryRatio : ROUTE_LINK_QUALITY_UNKNOWN);
+        if (!result.success && _espNowSendFailureCallback) {
+            _espNowSendFailureCallback(result.mac); // Lets links retransmit now instead of at ACK timeout
+        }
+        tail = (tail + 1) % ESPNOW_SEND_RESULT_QUEUE_SIZE;
+        _espNowSendResultTail.store(tail, std::memory_order_release);
     }
 }
-*/
 
 #ifdef LORA_ENABLED
 // --- LoRa Implementation ---
+// Set by the DIO0 interrupt, consumed by processLoRaInput() on the main loop
+static volatile bool loraIrqPending = false;
+// SX127x RegModemStat: signal detected, signal synchronized, header info valid.
+// Any of them means a frame is arriving (preamble or header already heard).
+static const uint8_t LORA_MODEM_STAT_RECEIVING = 0x0B;
+
+// DIO0 fires on RX done / TX done; only flag it here, SPI access happens in the loop
+static void IRAM_ATTR loraDio0Isr() {
+    loraIrqPending = true;
+    PowerManager::notifyFromISR(POWER_EVENT_LORA_DIO);
+}
+
 void InterfaceManager::setupLoRa() {
     DebugSerial.println("IF: Initializing LoRa...");
     
@@ -483,10 +1012,12 @@ void InterfaceManager::setupLoRa() {
     
     if (state == RADIOLIB_ERR_NONE) {
         _loraInitialized = true;
+        _lora->setDio0Action(loraDio0Isr, RISING);
         DebugSerial.println("IF: LoRa initialized successfully.");
         DebugSerial.print("IF: Frequency: "); DebugSerial.print(LORA_FREQUENCY); DebugSerial.println(" MHz");
         DebugSerial.print("IF: Bandwidth: "); DebugSerial.print(LORA_BANDWIDTH); DebugSerial.println(" kHz");
         DebugSerial.print("IF: Spreading Factor: "); DebugSerial.println(LORA_SPREADING_FACTOR);
+        startLoRaReceive();
     } else {
         _loraInitialized = false;
         DebugSerial.print("! ERROR: LoRa initialization failed with code: ");
@@ -498,58 +1029,162 @@ void InterfaceManager::setupLoRa() {
 
 void InterfaceManager::processLoRaInput() {
     if (!_loraInitialized || !_lora) return;
-    
-    // Check if data is available
-    if (_lora->available()) {
-        // Determine packet size (LoRa can receive variable length packets)
-        size_t packetSize = _lora->getPacketLength();
-        if (packetSize == 0 || packetSize > MAX_PACKET_SIZE) {
-            DebugSerial.print("! WARN: Invalid LoRa packet size: ");
-            DebugSerial.println(packetSize);
-            _lora->clearIrqFlags(_lora->getIrqFlags());
-            return;
-        }
-        
-        // Allocate buffer for received packet
-        std::unique_ptr<uint8_t[]> loraBuffer(new (std::nothrow) uint8_t[packetSize]);
-        if (!loraBuffer) {
-            DebugSerial.println("! ERROR: Failed to allocate LoRa receive buffer!");
-            _lora->clearIrqFlags(_lora->getIrqFlags());
-            return;
-        }
-        
-        // Read packet data
-        int state = _lora->readData(loraBuffer.get(), packetSize);
-        if (state == RADIOLIB_ERR_NONE) {
-            // Pass received packet to packet receiver callback
-            // LoRa doesn't have MAC addresses, so use nullptr
-            if (_packetReceiver) {
-                _packetReceiver(loraBuffer.get(), packetSize, InterfaceType::LORA, nullptr, IPAddress(), 0);
-            }
+
+    if (loraIrqPending) {
+        loraIrqPending = false;
+        if (_loraTxState == LoRaTxState::TRANSMITTING) {
+            finishLoRaTransmit(true); // DIO0 = TX done
+        } else if (_loraTxState == LoRaTxState::CHANNEL_SCAN) {
+            handleLoRaChannelScan(); // DIO0 = CAD done
         } else {
-            DebugSerial.print("! WARN: LoRa read failed with code: ");
-            DebugSerial.println(state);
+            // DIO0 = RX done. Read into a pool buffer; no per-packet heap allocation
+            PacketBufferPool::Buffer loraBuffer = PacketBufferPool::acquire();
+            size_t packetSize = _lora->getPacketLength();
+            if (!loraBuffer) {
+                DebugSerial.println("! WARN: Packet buffer pool exhausted, discarding LoRa packet.");
+            } else if (packetSize == 0 || packetSize > MAX_PACKET_SIZE) {
+                DebugSerial.print("! WARN: Invalid LoRa packet size: ");
+                DebugSerial.println(packetSize);
+            } else {
+                int state = _lora->readData(loraBuffer.data(), packetSize);
+                if (state == RADIOLIB_ERR_NONE) {
+                    // LoRa doesn't have MAC addresses, so use nullptr
+                    if (_packetReceiver) {
+                        // SNR maps to route link quality: -20 dB (below SF12 floor) = 0, +10 dB = 1
+                        float quality = (_lora->getSNR() + 20.0f) / 30.0f;
+                        _lastRxLinkQuality = quality < 0.0f ? 0.0f : (quality > 1.0f ? 1.0f : quality);
+                        deliverPacket(loraBuffer.data(), packetSize, InterfaceType::LORA);
+                        _lastRxLinkQuality = ROUTE_LINK_QUALITY_UNKNOWN;
+                    }
+                } else {
+                    DebugSerial.print("! WARN: LoRa read failed with code: ");
+                    DebugSerial.println(state);
+                }
+            }
+            startLoRaReceive(); // Keep listening; CSMA for queued frames starts from receive
         }
-        
-        // Clear IRQ flags to prepare for next packet
-        _lora->clearIrqFlags(_lora->getIrqFlags());
+    } else if (_loraTxState == LoRaTxState::BACKOFF && (long)(millis() - _loraTxDeadline) >= 0) {
+        _loraTxState = LoRaTxState::IDLE; // Slot elapsed, sense the channel again
+    } else if ((_loraTxState == LoRaTxState::TRANSMITTING || _loraTxState == LoRaTxState::CHANNEL_SCAN) &&
+               (long)(millis() - _loraTxDeadline) > 0) {
+        DebugSerial.println("! WARN: LoRa DIO0 interrupt missed, abandoning frame.");
+        finishLoRaTransmit(false);
+    }
+
+    startNextLoRaTransmit();
+}
+
+void InterfaceManager::startLoRaReceive() {
+    int state = _lora->startReceive();
+    if (state != RADIOLIB_ERR_NONE) {
+        DebugSerial.print("! ERROR: LoRa startReceive failed with code: ");
+        DebugSerial.println(state);
+    }
+}
+
+uint32_t InterfaceManager::loraTimeOnAirMs(size_t packetLen) const {
+    return AirtimeTracker::loraTimeOnAirMs(packetLen, LORA_SPREADING_FACTOR, LORA_BANDWIDTH,
+                                           LORA_CODING_RATE, LORA_PREAMBLE_LENGTH);
+}
+
+void InterfaceManager::startNextLoRaTransmit() {
+    if (_loraTxState != LoRaTxState::IDLE || _loraTxCount == 0) return;
+    // Unserviced RX-done: a frame sits in the FIFO, which CAD or TX would throw away.
+    // processLoRaInput() reads it first and calls back here.
+    if (loraIrqPending) return;
+
+    // Hold the frame (rather than drop it) until the budget window frees enough airtime
+    if (!_loraAirtime.canTransmit(loraTimeOnAirMs(_loraTxQueue[_loraTxHead].len))) {
+        if (!_loraBudgetWarned) {
+            DebugSerial.println("! WARN: LoRa airtime budget exhausted, deferring transmit.");
+            _loraBudgetWarned = true;
+        }
+        return;
+    }
+    _loraBudgetWarned = false;
+
+    // Someone's preamble or header is being received: CAD would abort it, so wait a slot
+    if ((_lora->getModemStatus() & LORA_MODEM_STAT_RECEIVING) != 0) {
+        _loraTxState = LoRaTxState::BACKOFF;
+        _loraTxDeadline = millis() + (unsigned long)LORA_CSMA_SLOT_TIME * 10;
+        return;
+    }
+
+    // Listen before talk: DIO0 signals CAD done
+    int state = _lora->startChannelScan();
+    if (state == RADIOLIB_ERR_NONE) {
+        _loraTxState = LoRaTxState::CHANNEL_SCAN;
+        _loraTxDeadline = millis() + LORA_TX_TIMEOUT_MARGIN_MS;
+    } else {
+        DebugSerial.print("! WARN: LoRa CAD failed with code: ");
+        DebugSerial.println(state);
+        transmitLoRaHead(); // Fall back to plain ALOHA rather than stalling the queue
+    }
+}
+
+void InterfaceManager::handleLoRaChannelScan() {
+    int result = _lora->getChannelScanResult();
+    // p-persistence: on a free channel transmit with probability (p+1)/256, otherwise wait a slot
+    if (result == RADIOLIB_CHANNEL_FREE && random(256) <= LORA_CSMA_PERSISTENCE) {
+        transmitLoRaHead();
+        return;
+    }
+    _loraTxState = LoRaTxState::BACKOFF;
+    _loraTxDeadline = millis() + (unsigned long)LORA_CSMA_SLOT_TIME * 10;
+    // Busy channel: someone is on air, so listen for their frame during the slot
+    startLoRaReceive();
+}
+
+void InterfaceManager::transmitLoRaHead() {
+    LoRaTxFrame& frame = _loraTxQueue[_loraTxHead];
+    uint32_t airtimeMs = loraTimeOnAirMs(frame.len);
+    // No stale DIO0 flag here: CAD-done was just consumed, or startNextLoRaTransmit() saw none
+    int state = _lora->startTransmit(frame.data, frame.len);
+    _loraTxState = LoRaTxState::TRANSMITTING;
+    if (state == RADIOLIB_ERR_NONE) {
+        _loraAirtime.record(airtimeMs);
+        _loraTxDeadline = millis() + airtimeMs + LORA_TX_TIMEOUT_MARGIN_MS;
+    } else {
+        DebugSerial.print("! ERROR: LoRa startTransmit failed with code: ");
+        DebugSerial.println(state);
+        finishLoRaTransmit(false); // Pop and report the frame
     }
 }
 
+void InterfaceManager::finishLoRaTransmit(bool success) {
+    size_t frameLen = _loraTxQueue[_loraTxHead].len;
+    if (success) _lora->finishTransmit(); // Clears IRQ flags and returns to standby
+    _loraTxState = LoRaTxState::IDLE;
+    _loraTxHead = (_loraTxHead + 1) % LORA_TX_QUEUE_SIZE;
+    _loraTxCount--;
+
+    if (_loraTxDoneCallback) _loraTxDoneCallback(success, frameLen);
+    // Listen between frames; startNextLoRaTransmit() takes over if more are queued
+    startLoRaReceive();
+}
+
 void InterfaceManager::sendPacketViaLoRa(const uint8_t *packetBuffer, size_t packetLen, const uint8_t *destinationAddr) {
     if (!_loraInitialized || !_lora || !packetBuffer || packetLen == 0) return;
-    
+    if (!fitsMtu(InterfaceType::LORA, packetLen + getIfacSize(InterfaceType::LORA))) return;
+
     // LoRa is broadcast by nature, so destinationAddr is not used here.
-    
-    // Send packet
-    int state = _lora->transmit(packetBuffer, packetLen);
-    if (state == RADIOLIB_ERR_NONE) {
-        // Success - packet sent
-        // DebugSerial.println("IF: LoRa packet sent successfully.");
+    if (_loraTxCount >= LORA_TX_QUEUE_SIZE) {
+        DebugSerial.println("! WARN: LoRa TX queue full, dropping frame.");
+        return;
+    }
+    LoRaTxFrame& frame = _loraTxQueue[(_loraTxHead + _loraTxCount) % LORA_TX_QUEUE_SIZE];
+    InterfaceAccessCode* ifac = ifacFor(InterfaceType::LORA);
+    if (ifac) {
+        // Coded straight into the queue slot
+        if (!ifac->apply(packetBuffer, packetLen, frame.data, sizeof(frame.data), frame.len)) return;
     } else {
-        DebugSerial.print("! ERROR: LoRa transmit failed with code: ");
-        DebugSerial.println(state);
+        memcpy(frame.data, packetBuffer, packetLen);
+        frame.len = packetLen;
     }
+    _loraTxCount++;
+
+    // Start right away if idle; otherwise the TX-done interrupt chains the next frame
+    startNextLoRaTransmit();
 }
 #endif
 
@@ -633,7 +1268,7 @@ bool InterfaceManager::pollAX25FromAudioModem() {
         // Deliver as if received over HAM modem (AX.25 over KISS)
         if (!frame.empty() && _packetReceiver) {
             // Interpret as raw AX.25 frame; wrap in KISS data frame for consistency
-            _packetReceiver(frame.data(), frame.size(), InterfaceType::HAM_MODEM, nullptr, IPAddress(), 0);
+            deliverPacket(frame.data(), frame.size(), InterfaceType::HAM_MODEM);
         }
     }
     return got;
@@ -664,7 +1299,11 @@ void InterfaceManager::audioCaptureLoop() {
 
 void InterfaceManager::sendPacketViaHAMModem(const uint8_t *packetBuffer, size_t packetLen) {
     if (!_hamModemInitialized || !packetBuffer || packetLen == 0) return;
-    
+    if (!fitsMtu(InterfaceType::HAM_MODEM, packetLen + getIfacSize(InterfaceType::HAM_MODEM))) return;
+    PacketBufferPool::Buffer coded;
+    packetBuffer = applyIfac(InterfaceType::HAM_MODEM, packetBuffer, packetLen, coded);
+    if (!packetBuffer) return;
+
     // Encode packet with KISS framing
     std::vector<uint8_t> kissEncoded;
     KISSProcessor::encode(packetBuffer, packetLen, kissEncoded);
@@ -853,19 +1492,15 @@ void InterfaceManager::setupIPFS() {
     DebugSerial.println("IF: Initializing IPFS client...");
     
     // IPFS client is lightweight - just needs WiFi connection
-    if (WiFi.status() == WL_CONNECTED) {
-        _ipfsInitialized = true;
-        DebugSerial.print("IF: IPFS Gateway: ");
-        DebugSerial.println(IPFS_GATEWAY_URL);
-        DebugSerial.println("IF: IPFS client ready (gateway mode).");
-    } else {
-        _ipfsInitialized = false;
-        DebugSerial.println("! WARN: IPFS requires WiFi connection. Disabled.");
-    }
+    // WiFi connects in the background; requests check the connection when they are made
+    _ipfsInitialized = true;
+    DebugSerial.print("IF: IPFS Gateway: ");
+    DebugSerial.println(IPFS_GATEWAY_URL);
+    DebugSerial.println("IF: IPFS client ready (gateway mode, used while WiFi is connected).");
 }
 
 bool InterfaceManager::fetchIPFSContent(const char* ipfsHash, std::vector<uint8_t>& output) {
-    if (!_ipfsInitialized || WiFi.status() != WL_CONNECTED) {
+    if (!_ipfsInitialized || !_wifi.isConnected()) {
         DebugSerial.println("! ERROR: IPFS not available (WiFi not connected)");
         return false;
     }
@@ -919,7 +1554,7 @@ bool InterfaceManager::fetchIPFSContent(const char* ipfsHash, std::vector<uint8_
 }
 
 bool InterfaceManager::publishToIPFS(const uint8_t* data, size_t len, String& ipfsHash) {
-    if (!_ipfsInitialized || WiFi.status() != WL_CONNECTED) {
+    if (!_ipfsInitialized || !_wifi.isConnected()) {
         DebugSerial.println("! ERROR: IPFS not available (WiFi not connected)");
         return false;
     }
@@ -1046,7 +1681,7 @@ void InterfaceManager::sendPacketViaIPFS(const uint8_t *packetBuffer, size_t pac
 
     if (destinationAddr == nullptr || !route || route->interface == InterfaceType::IPFS) {
         sendPacketViaEspNow(refBuffer, refLen, destinationAddr);
-        if (WiFi.status() == WL_CONNECTED) {
+        if (_wifi.isConnected()) {
             sendPacketViaWiFi(refBuffer, refLen, destinationAddr);
         }
 #ifdef LORA_ENABLED
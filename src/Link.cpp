@@ -2,12 +2,22 @@
 #include "LinkManager.h" // Include owner class definition
 #include "ReticulumPacket.h"
 #include "Utils.h"
+#include "PacketBufferPool.h"
 #include <Arduino.h> // For millis(), Serial, isprint
 
-Link::Link(const uint8_t* destination, LinkManager& owner) :
+// Sealed data starts with the sequence number and flags again: the outer legacy header
+// is not authenticated, so the copies inside the token are the ones trusted
+static const size_t LINK_INNER_HEADER_SIZE = RNS_SEQ_SIZE + 1;
+static const uint8_t LINK_INNER_FLAG_PIGGYBACK = 0x01;
+static const uint8_t LINK_INNER_FLAG_ACK = 0x02; // Standalone ACK: the sealed sequence is the one acknowledged
+
+Link::Link(const uint8_t* destination, LinkManager& owner, size_t cryptoSlot) :
     _ownerRef(owner), _state(LinkState::CLOSED), _lastActivityTime(0), _stateTimer(0),
-    _outgoingSequence(0), _expectedIncomingSequence(0), _linkReqPacketId(0), _currentRetryCount(0)
+    _outgoingSequence(0), _expectedIncomingSequence(0), _linkReqPacketId(0),
+    _cryptoSlot(cryptoSlot), _currentRetryCount(0)
 {
+    memset(_ephemeralSecret, 0, sizeof(_ephemeralSecret));
+    memset(_ephemeralPublic, 0, sizeof(_ephemeralPublic));
     if(destination){
         memcpy(_destinationAddress.data(), destination, RNS_ADDRESS_SIZE);
     } else {
@@ -25,6 +35,8 @@ Link::Link(const uint8_t* destination, LinkManager& owner) :
 
 Link::~Link() {
     // DebugSerial.print("Link destructor: "); Utils::printBytes(_destinationAddress.data(), RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
+    memset(_ephemeralSecret, 0, sizeof(_ephemeralSecret));
+    _ownerRef.releaseCryptoSlot(_cryptoSlot); // Forgets the session key
 }
 
 // Public method to initiate link establishment
@@ -46,8 +58,9 @@ void Link::sendLinkRequest() {
     // State should be CLOSED before calling, set PENDING now
     _state = LinkState::PENDING_REQ;
     _linkReqPacketId = _ownerRef.getNextPacketId();
+    Identity::generateEphemeral(_ephemeralSecret, _ephemeralPublic); // Fresh key per handshake
 
-    uint8_t buffer[RNS_MIN_HEADER_SIZE]; // Control packets have no payload usually
+    uint8_t buffer[RNS_LEGACY_HEADER_SIZE + RNS_SEQ_SIZE + Identity::KEY_SIZE]; // Payload is our ephemeral key
     size_t len = 0;
     // Link Request uses DATA type, specific context
     bool ok = ReticulumPacket::serialize_control(buffer, len,
@@ -55,7 +68,8 @@ void Link::sendLinkRequest() {
         RNS_HEADER_TYPE_DATA,
         RNS_CONTEXT_LINK_REQ,
         _linkReqPacketId,
-        0); // No sequence number needed in REQ payload
+        0, // No sequence number needed in REQ payload
+        _ephemeralPublic, Identity::KEY_SIZE);
 
     if (ok) {
         _ownerRef.sendPacketRaw(buffer, len, _destinationAddress.data());
@@ -75,12 +89,13 @@ bool Link::sendData(const std::vector<uint8_t>& dataPayload) {
          DebugSerial.println("! Link::sendData failed: Link not established.");
          return false;
     }
-    // Enforce simplified window size of 1
-    if (!_pendingOutgoingPackets.empty()) {
-         DebugSerial.println("! Link::sendData failed: Link busy (awaiting ACK).");
-         return false; // Wait for previous ACK
+    // Enforce sliding window
+    if (_pendingOutgoingPackets.size() >= LINK_WINDOW_SIZE) {
+         DebugSerial.println("! Link::sendData failed: Link busy (window full, awaiting ACK).");
+         return false; // Wait for an ACK to open the window
     }
-    if (dataPayload.size() > RNS_MAX_PAYLOAD - RNS_SEQ_SIZE) {
+    // Must fit the path's MTU once sealed, not just our own buffers: a LoRa hop carries less than ESP-NOW
+    if (!fitsPath(sealedSize(dataPayload.size(), false), _destinationAddress.data())) {
         DebugSerial.println("! Link::sendData failed: Payload too large.");
         return false;
     }
@@ -104,7 +119,7 @@ bool Link::sendData(const std::vector<uint8_t>& dataPayload) {
 
 // Internal: Adds packet to queue, sends, starts timers
 void Link::sendPacketInternal(const RnsPacketInfo& packetInfo) {
-     if (_pendingOutgoingPackets.size() >= 1) { // Re-check window size
+     if (_pendingOutgoingPackets.size() >= LINK_WINDOW_SIZE) { // Re-check window size
         DebugSerial.println("! Link::sendPacketInternal failed: Window full.");
         return;
      }
@@ -116,20 +131,15 @@ void Link::sendPacketInternal(const RnsPacketInfo& packetInfo) {
     pending.lastSentTime = pending.firstSentTime;
     // pending.retryCount = 0; // Retry count is tracked by _currentRetryCount
 
-    uint8_t buffer[MAX_PACKET_SIZE];
-    size_t len = 0;
-    bool ok = ReticulumPacket::serialize(buffer, len,
-        pending.packetInfo.destination, _ownerRef.getNodeAddress(),
-        RNS_DST_TYPE_SINGLE, pending.packetInfo.header_type, pending.packetInfo.context,
-        pending.packetInfo.packet_id, 0, // Hops = 0 initially
-        pending.packetInfo.data,          // Pass actual data
-        pending.packetInfo.sequence_number); // Pass sequence number
+    bool windowWasEmpty = _pendingOutgoingPackets.empty();
+    _pendingOutgoingPackets.push_back(pending);
 
-    if (ok) {
-        _pendingOutgoingPackets.push_back(pending);
-        _ownerRef.sendPacketRaw(buffer, len, pending.packetInfo.destination);
-        _stateTimer = millis(); // Start/reset retransmission timer
-        _currentRetryCount = 0; // Reset overall retry count for this attempt
+    if (transmitPending(_pendingOutgoingPackets.back())) {
+        // Retransmission timer tracks the oldest unacknowledged packet only
+        if (windowWasEmpty) {
+            _stateTimer = millis();
+            _currentRetryCount = 0; // Reset overall retry count for this attempt
+        }
         updateActivity();
         // DebugSerial.print("Link::sendPacketInternal sent seq "); DebugSerial.println(pending.packetInfo.sequence_number); // Verbose
     } else {
@@ -139,6 +149,67 @@ void Link::sendPacketInternal(const RnsPacketInfo& packetInfo) {
     }
 }
 
+// Token over the inner header, an optional piggybacked ACK and the data
+size_t Link::sealedSize(size_t dataLen, bool piggyback) {
+    return Crypto::tokenSize(LINK_INNER_HEADER_SIZE + (piggyback ? RNS_SEQ_SIZE : 0) + dataLen);
+}
+
+// A sealed payload of this size fits our buffers and every hop towards destination
+bool Link::fitsPath(size_t sealedLen, const uint8_t* destination) {
+    return sealedLen <= RNS_MAX_PAYLOAD &&
+           RNS_LEGACY_HEADER_SIZE + RNS_SEQ_SIZE + sealedLen <= _ownerRef.getPathMtu(destination);
+}
+
+// Internal: Seals and sends one pending data packet. If an ACK is being held
+// for the peer it rides along in front of the payload instead of costing its own frame.
+// The session key was expanded into our crypto slot at handshake, so this only binds it.
+bool Link::transmitPending(PendingPacket& pending) {
+    Crypto::Token* token = _ownerRef.getCryptoContext(_cryptoSlot);
+    if (!token) return false; // No session key
+    const std::vector<uint8_t>& data = pending.packetInfo.data;
+    if (data.size() > RNS_MAX_PAYLOAD) return false;
+
+    uint8_t headerType = pending.packetInfo.header_type & ~RNS_HEADER_FLAG_PIGGYBACK_ACK_MASK;
+    bool piggyback = _ackPending && fitsPath(sealedSize(data.size(), true), pending.packetInfo.destination);
+
+    uint8_t plain[LINK_INNER_HEADER_SIZE + RNS_SEQ_SIZE + RNS_MAX_PAYLOAD];
+    size_t plainLen = 0;
+    plain[plainLen++] = (pending.packetInfo.sequence_number >> 8) & 0xFF;
+    plain[plainLen++] = pending.packetInfo.sequence_number & 0xFF;
+    plain[plainLen++] = piggyback ? LINK_INNER_FLAG_PIGGYBACK : 0;
+    if (piggyback) {
+        plain[plainLen++] = (_ackPendingSequence >> 8) & 0xFF;
+        plain[plainLen++] = _ackPendingSequence & 0xFF;
+        headerType |= RNS_HEADER_FLAG_PIGGYBACK_ACK_MASK;
+    }
+    if (!data.empty()) memcpy(plain + plainLen, data.data(), data.size());
+    plainLen += data.size();
+
+    PacketBufferPool::Buffer buffer = PacketBufferPool::acquire();
+    if (!buffer) return false; // Pool exhausted; retried on the next timeout
+    size_t len = 0;
+    // Header and sequence number first, then the token sealed straight into the frame
+    bool ok = ReticulumPacket::serialize(buffer.data(), len,
+        pending.packetInfo.destination, _ownerRef.getNodeAddress(),
+        RNS_DST_TYPE_SINGLE, headerType, pending.packetInfo.context,
+        pending.packetInfo.packet_id, 0, // Hops = 0 initially
+        nullptr, 0,
+        pending.packetInfo.sequence_number);
+    size_t sealedLen = 0;
+    ok = ok && token->encrypt(plain, plainLen, buffer.data() + len, buffer.capacity() - len, sealedLen);
+    if (!ok) return false;
+    len += sealedLen;
+
+    _ownerRef.sendPacketRaw(buffer.data(), len, pending.packetInfo.destination);
+    if (piggyback) {
+        // DebugSerial.print("Link piggybacked ACK for seq: "); DebugSerial.println(_ackPendingSequence); // Verbose
+        _ackPending = false;
+        _unackedInOrderCount = 0;
+        _ackDeadline = 0;
+    }
+    return true;
+}
+
 // Main state machine for processing incoming packets relevant to this link
 void Link::handlePacket(const RnsPacketInfo& packetInfo) {
     if (!packetInfo.valid) {
@@ -168,7 +239,9 @@ void Link::handlePacket(const RnsPacketInfo& packetInfo) {
             // If we receive another Link Request, peer might not have received ours or ACK lost
             if (packetInfo.context == RNS_CONTEXT_LINK_REQ) {
                  DebugSerial.println("Link(PENDING): Received concurrent LINK_REQ. Sending ACK.");
-                 sendAck(0); // ACK their REQ (seq 0 for control packets)
+                 // Both ends key from their own REQ's ephemeral key and the other's, which agree
+                 if (!deriveSessionKey(packetInfo.data)) break;
+                 sendAck(0, true); // ACK their REQ (seq 0 for control packets)
                  // Should we transition to ESTABLISHED here? RNS spec suggests yes.
                  _state = LinkState::ESTABLISHED;
                  _expectedIncomingSequence = 0; // Assume peer starts at 0
@@ -184,10 +257,8 @@ void Link::handlePacket(const RnsPacketInfo& packetInfo) {
             if (packetInfo.context == RNS_CONTEXT_LINK_DATA) {
                 processData(packetInfo);
             } else if (packetInfo.context == RNS_CONTEXT_LINK_REQ) {
-                 DebugSerial.println("Link(ESTABLISHED): Received LINK_REQ. Re-sending ACK.");
-                 sendAck(0); // Re-ACK their REQ
-                 // Maybe reset expected sequence? Assume peer restarted.
-                 _expectedIncomingSequence = 0;
+                 DebugSerial.println("Link(ESTABLISHED): Received LINK_REQ. Re-keying and re-sending ACK.");
+                 processLinkRequest(packetInfo); // Assume peer restarted
             } else if (packetInfo.context == RNS_CONTEXT_LINK_CLOSE) {
                  processLinkClose(packetInfo);
             } // Ignore other unexpected packets
@@ -204,7 +275,9 @@ void Link::handlePacket(const RnsPacketInfo& packetInfo) {
 void Link::processLinkRequest(const RnsPacketInfo& reqPacket) {
      // Can be received in CLOSED or ESTABLISHED state
      DebugSerial.print("Link::processLinkRequest from "); Utils::printBytes(reqPacket.source, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
-     sendAck(0); // ACK the control packet (seq 0)
+     Identity::generateEphemeral(_ephemeralSecret, _ephemeralPublic); // Fresh key per handshake
+     if (!deriveSessionKey(reqPacket.data)) return;
+     sendAck(0, true); // ACK the control packet (seq 0) with our ephemeral key
 
      // Transition to ESTABLISHED
      if (_state == LinkState::CLOSED) {
@@ -215,6 +288,7 @@ void Link::processLinkRequest(const RnsPacketInfo& reqPacket) {
          DebugSerial.println("Link Established (from Closed by REQ).");
      } else { // Was ESTABLISHED already
           DebugSerial.println("Link Re-Established (ACKed REQ).");
+          _expectedIncomingSequence = 0; // Peer restarted its sequence space
           // Optionally reset sequences if needed based on protocol interpretation
           // _expectedIncomingSequence = 0;
           // _outgoingSequence = 0;
@@ -229,6 +303,8 @@ void Link::processAck(const RnsPacketInfo& ackPacket) {
     if (_state == LinkState::PENDING_REQ) {
         // Expecting ACK for LINK_REQ (which used packet_id matching, conceptually seq 0)
         if (ackedSequence == 0) { // Check if ACK matches the control packet pseudo-sequence
+             // No usable key: keep waiting, the REQ times out if no keyed ACK arrives
+             if (!deriveSessionKey(ackPacket.data)) return;
              DebugSerial.println("Link(PENDING): Link Request ACK received.");
              _state = LinkState::ESTABLISHED;
              _expectedIncomingSequence = 0;
@@ -240,26 +316,18 @@ void Link::processAck(const RnsPacketInfo& ackPacket) {
              DebugSerial.print("! Link(PENDING): Received ACK with unexpected seq: "); DebugSerial.println(ackedSequence);
         }
     } else if (_state == LinkState::ESTABLISHED) {
-        // Expecting ACK for a data packet
-        if (!_pendingOutgoingPackets.empty()) {
-            PendingPacket& frontPacket = _pendingOutgoingPackets.front();
-            if (ackedSequence == frontPacket.packetInfo.sequence_number) {
-                 // Correct ACK received
-                 // DebugSerial.print("Link(ESTABLISHED): ACK received for data seq: "); DebugSerial.println(ackedSequence); // Verbose
-                 _pendingOutgoingPackets.pop_front(); // Remove acknowledged packet
-                 _currentRetryCount = 0; // Reset overall retries for the link
-                 _stateTimer = 0; // Stop retransmission timer until next send
-                 // If windowing > 1, might send next packet here
-            } else {
-                 // Wrong sequence number ACKed - could be duplicate ACK or error
-                 DebugSerial.print("! Link(ESTABLISHED): Received ACK for wrong seq (Expected: ");
-                 DebugSerial.print(frontPacket.packetInfo.sequence_number);
-                 DebugSerial.print(", Got: "); DebugSerial.print(ackedSequence); DebugSerial.println("). Ignoring.");
-            }
-        } else {
-             // Received an ACK but queue is empty - likely duplicate ACK, ignore.
-             // DebugSerial.println("Link(ESTABLISHED): Received unexpected ACK (queue empty). Ignoring."); // Verbose
+        // Expecting a (cumulative) ACK for data packets. It releases the whole window,
+        // so only the sealed copy of the sequence is trusted, as for piggybacked ACKs.
+        Crypto::Token* token = _ownerRef.getCryptoContext(_cryptoSlot);
+        uint8_t inner[Crypto::TOKEN_MIN_SIZE];
+        size_t innerLen = 0;
+        if (!token || !token->decrypt(ackPacket.data.data(), ackPacket.data.size(), inner, sizeof(inner), innerLen) ||
+            innerLen != LINK_INNER_HEADER_SIZE || inner[RNS_SEQ_SIZE] != LINK_INNER_FLAG_ACK ||
+            (((uint16_t)inner[0] << 8) | inner[1]) != ackedSequence) {
+             DebugSerial.println("! Link(ESTABLISHED): ACK failed authentication. Ignoring.");
+             return;
         }
+        acknowledgeUpTo(ackedSequence);
     } else if (_state == LinkState::CLOSING) {
          // Expecting ACK for LINK_CLOSE (conceptually seq 0)
          if (ackedSequence == 0) {
@@ -276,39 +344,131 @@ void Link::processAck(const RnsPacketInfo& ackPacket) {
      // Ignore ACKs in CLOSED state
 }
 
+// Release every pending packet covered by a cumulative ACK
+void Link::acknowledgeUpTo(uint16_t ackedSequence) {
+    if (_pendingOutgoingPackets.empty()) {
+        // Received an ACK but queue is empty - likely duplicate ACK, ignore.
+        // DebugSerial.println("Link(ESTABLISHED): Received unexpected ACK (queue empty). Ignoring."); // Verbose
+        return;
+    }
+    // Never accept an ACK for a sequence we have not sent yet
+    if (!sequenceLessOrEqual(ackedSequence, (uint16_t)(_outgoingSequence - 1))) {
+        DebugSerial.print("! Link(ESTABLISHED): Received ACK beyond last sent seq: "); DebugSerial.println(ackedSequence);
+        return;
+    }
+
+    size_t released = 0;
+    while (!_pendingOutgoingPackets.empty() &&
+           sequenceLessOrEqual(_pendingOutgoingPackets.front().packetInfo.sequence_number, ackedSequence)) {
+        _pendingOutgoingPackets.pop_front(); // Remove acknowledged packet
+        released++;
+    }
+
+    if (released == 0) {
+        // ACK older than the window - stale duplicate
+        DebugSerial.print("! Link(ESTABLISHED): Received stale ACK (Oldest pending: ");
+        DebugSerial.print(_pendingOutgoingPackets.front().packetInfo.sequence_number);
+        DebugSerial.print(", Got: "); DebugSerial.print(ackedSequence); DebugSerial.println("). Ignoring.");
+        return;
+    }
+
+    // DebugSerial.print("Link(ESTABLISHED): ACK released "); DebugSerial.print(released); DebugSerial.print(" packet(s) up to seq: "); DebugSerial.println(ackedSequence); // Verbose
+    _currentRetryCount = 0; // Reset overall retries for the link
+    _ownerRef.reportDelivery(_destinationAddress.data(), true);
+    // Restart retransmission timer for the new oldest packet, or stop it until next send
+    _stateTimer = _pendingOutgoingPackets.empty() ? 0 : millis();
+}
+
 // Handle incoming LINK_DATA packet
 void Link::processData(const RnsPacketInfo& dataPacket) {
      if (_state != LinkState::ESTABLISHED) return; // Should not happen
 
      // DebugSerial.print("Link(ESTABLISHED): Received Data seq: "); DebugSerial.println(dataPacket.sequence_number); // Verbose
 
+     // Open the token with the context keyed at handshake
+     Crypto::Token* token = _ownerRef.getCryptoContext(_cryptoSlot);
+     PacketBufferPool::Buffer plain = PacketBufferPool::acquire();
+     size_t plainLen = 0;
+     if (!token || !plain ||
+         !token->decrypt(dataPacket.data.data(), dataPacket.data.size(), plain.data(), plain.capacity(), plainLen) ||
+         plainLen < LINK_INNER_HEADER_SIZE) {
+          DebugSerial.println("! Link(ESTABLISHED): Data failed authentication. Ignoring.");
+          return;
+     }
+     const uint8_t* inner = plain.data();
+     bool piggyback = (inner[RNS_SEQ_SIZE] & LINK_INNER_FLAG_PIGGYBACK) != 0;
+     if ((inner[RNS_SEQ_SIZE] & LINK_INNER_FLAG_ACK) != 0 ||
+         (((uint16_t)inner[0] << 8) | inner[1]) != dataPacket.sequence_number ||
+         piggyback != ((dataPacket.header_type & RNS_HEADER_FLAG_PIGGYBACK_ACK_MASK) != 0)) {
+          DebugSerial.println("! Link(ESTABLISHED): Header does not match sealed header. Ignoring.");
+          return;
+     }
+     size_t offset = LINK_INNER_HEADER_SIZE;
+
+     // Peer may have piggybacked a cumulative ACK for our own data in front of the payload
+     if (piggyback) {
+          if (plainLen < offset + RNS_SEQ_SIZE) {
+               DebugSerial.println("! Link(ESTABLISHED): Piggyback ACK flag set but payload too short. Ignoring.");
+               return;
+          }
+          acknowledgeUpTo(((uint16_t)inner[offset] << 8) | inner[offset + 1]);
+          offset += RNS_SEQ_SIZE;
+     }
+
      if (dataPacket.sequence_number == _expectedIncomingSequence) {
-          // Correct sequence - Process data and send ACK
-          _ownerRef.processReceivedLinkData(dataPacket.source, dataPacket.data);
+          // Correct sequence - Process data, ACK is held briefly to coalesce or piggyback
+          std::vector<uint8_t> appData(inner + offset, inner + plainLen);
+          _ownerRef.processReceivedLinkData(dataPacket.source, appData);
           _expectedIncomingSequence++;
-          sendAck(dataPacket.sequence_number);
-     } else if (dataPacket.sequence_number < _expectedIncomingSequence) {
-          // Duplicate packet - Resend ACK for the duplicate's sequence number
+          scheduleAck(dataPacket.sequence_number);
+     } else if (sequenceLessOrEqual(dataPacket.sequence_number, (uint16_t)(_expectedIncomingSequence - 1))) {
+          // Duplicate packet - our ACK was likely lost, resend cumulative ACK immediately
           DebugSerial.print("Link(ESTABLISHED): Duplicate data seq "); DebugSerial.print(dataPacket.sequence_number); DebugSerial.print(" (expected "); DebugSerial.print(_expectedIncomingSequence); DebugSerial.println("). Resending ACK.");
-          sendAck(dataPacket.sequence_number);
+          _ackPending = true;
+          _ackPendingSequence = _expectedIncomingSequence - 1;
+          flushPendingAck();
      } else {
           // Out of order - Ignore (simple strategy)
           DebugSerial.print("! Link(ESTABLISHED): Out-of-order seq "); DebugSerial.print(dataPacket.sequence_number); DebugSerial.print(" (expected "); DebugSerial.print(_expectedIncomingSequence); DebugSerial.println("). Ignoring.");
      }
 }
 
-// Internal: Send ACK packet
-void Link::sendAck(uint16_t sequenceToAck) {
+// Internal: Derive the session key from the peer's ephemeral key (REQ or REQ ACK payload)
+bool Link::deriveSessionKey(const std::vector<uint8_t>& peerKey) {
+     if (peerKey.size() < Identity::KEY_SIZE ||
+         !_ownerRef.establishSessionKey(_cryptoSlot, _ephemeralSecret, _ephemeralPublic, peerKey.data())) {
+          DebugSerial.println("! WARN: Link handshake without a usable ephemeral key. Ignoring.");
+          return false;
+     }
+     memset(_ephemeralSecret, 0, sizeof(_ephemeralSecret)); // Only the expanded session key is kept
+     return true;
+}
+
+// Internal: Send ACK packet. Once the session is keyed the sequence is repeated inside
+// a token, so a forged plaintext ACK cannot release the peer's send window.
+void Link::sendAck(uint16_t sequenceToAck, bool withKey) {
      uint16_t ackPacketId = _ownerRef.getNextPacketId();
-     uint8_t buffer[RNS_MIN_HEADER_SIZE + RNS_SEQ_SIZE]; // ACK payload is just the sequence number
+     uint8_t buffer[RNS_LEGACY_HEADER_SIZE + RNS_SEQ_SIZE + Crypto::TOKEN_MIN_SIZE]; // Sequence number (+ our key for a REQ, or the sealed copy)
      size_t len = 0;
+     uint8_t sealed[Crypto::TOKEN_MIN_SIZE];
+     size_t sealedLen = 0;
+     if (!withKey && _state == LinkState::ESTABLISHED) {
+          Crypto::Token* token = _ownerRef.getCryptoContext(_cryptoSlot);
+          uint8_t inner[LINK_INNER_HEADER_SIZE] = {
+               (uint8_t)(sequenceToAck >> 8), (uint8_t)(sequenceToAck & 0xFF), LINK_INNER_FLAG_ACK };
+          if (!token || !token->encrypt(inner, sizeof(inner), sealed, sizeof(sealed), sealedLen)) {
+               DebugSerial.println("! ERROR: Link::sendAck seal failed!");
+               return;
+          }
+     }
      // ACK uses ACK header type, ACK context
      bool ok = ReticulumPacket::serialize_control(buffer, len,
         _destinationAddress.data(), _ownerRef.getNodeAddress(),
         RNS_HEADER_TYPE_ACK,
         RNS_CONTEXT_ACK,
         ackPacketId,
-        sequenceToAck); // Sequence being ACKed goes in payload
+        sequenceToAck, // Sequence being ACKed goes in payload
+        withKey ? _ephemeralPublic : sealed, withKey ? Identity::KEY_SIZE : sealedLen);
 
       if (ok) {
          // DebugSerial.print("Link Sending ACK for seq: "); DebugSerial.println(sequenceToAck); // Verbose
@@ -319,23 +479,46 @@ void Link::sendAck(uint16_t sequenceToAck) {
       }
 }
 
-// Check for timeouts (ACK for REQ/CLOSE, retransmission for DATA)
+// Internal: Hold an ACK for in-order data so it can be coalesced with later
+// packets or piggybacked on reverse traffic. Flushed after LINK_ACK_EVERY_N
+// packets or LINK_ACK_DELAY_MS, whichever comes first.
+void Link::scheduleAck(uint16_t sequenceToAck) {
+     _ackPendingSequence = sequenceToAck; // Cumulative: latest in-order seq covers earlier ones
+     _unackedInOrderCount++;
+     if (!_ackPending) {
+          _ackPending = true;
+          _ackDeadline = millis() + LINK_ACK_DELAY_MS;
+     }
+     if (_unackedInOrderCount >= LINK_ACK_EVERY_N) {
+          flushPendingAck();
+     }
+}
+
+// Internal: Send the held ACK as a standalone control packet
+void Link::flushPendingAck() {
+     if (!_ackPending) return;
+     sendAck(_ackPendingSequence);
+     _ackPending = false;
+     _unackedInOrderCount = 0;
+     _ackDeadline = 0;
+}
+
+// Check for timeouts (ACK for REQ/CLOSE, retransmission for DATA, delayed ACK flush)
 void Link::checkTimeouts() {
+    unsigned long now = millis();
+
+    // Held ACK found no reverse data to ride on within the delay window
+    if (_ackPending && _state == LinkState::ESTABLISHED && (long)(now - _ackDeadline) >= 0) {
+        flushPendingAck();
+    }
+
     // Don't check timeouts if link is cleanly closed or already established with nothing pending
     if (_state == LinkState::CLOSED || (_state == LinkState::ESTABLISHED && _pendingOutgoingPackets.empty())) {
         _stateTimer = 0; // Ensure timer is off
         return;
     }
 
-    unsigned long now = millis();
-    unsigned long timeoutDuration = LINK_RETRY_TIMEOUT_MS; // Default data retry timeout
-
-    if (_state == LinkState::PENDING_REQ) {
-        timeoutDuration = LINK_REQ_TIMEOUT_MS;
-    } else if (_state == LinkState::CLOSING) {
-         timeoutDuration = LINK_RETRY_TIMEOUT_MS; // Reuse data timeout for close ACK
-    }
-    // For ESTABLISHED state with pending packets, timeoutDuration remains LINK_RETRY_TIMEOUT_MS
+    unsigned long timeoutDuration = currentTimeoutDuration();
 
     if (_stateTimer != 0 && now - _stateTimer > timeoutDuration) {
         // Timeout occurred!
@@ -344,11 +527,12 @@ void Link::checkTimeouts() {
              teardown(); // Give up establishing
         } else if (_state == LinkState::ESTABLISHED && !_pendingOutgoingPackets.empty()) {
              // Data ACK timeout
+             _ownerRef.reportDelivery(_destinationAddress.data(), false);
              if (_currentRetryCount < LINK_MAX_RETRIES) {
                  _currentRetryCount++;
                  DebugSerial.print("! Link ACK timeout. Retrying packet (Attempt ");
                  DebugSerial.print(_currentRetryCount); DebugSerial.print("/"); DebugSerial.print(LINK_MAX_RETRIES); DebugSerial.println(")...");
-                 retransmitOldestPending(); // Retransmit and resets _stateTimer
+                 retransmitPending(); // Retransmit window and reset _stateTimer
              } else {
                   DebugSerial.println("! Link max retries reached. Tearing down link.");
                   teardown(); // Give up after max retries
@@ -361,36 +545,67 @@ void Link::checkTimeouts() {
     }
 }
 
-// Retransmit the packet at the front of the queue
-void Link::retransmitOldestPending() {
-     if (_pendingOutgoingPackets.empty()) return;
+// Fast retransmit on a link-layer NAK (ESP-NOW send status). Counts against the same retry
+// budget as ACK timeouts; once exhausted the timeout path decides whether to tear down.
+void Link::retransmitNow() {
+    if (_state != LinkState::ESTABLISHED || _pendingOutgoingPackets.empty()) return;
+    unsigned long now = millis();
+    // One NAK per frame of the window arrives; only the first of a burst triggers a resend
+    if (now - _lastFastRetryTime < LINK_FAST_RETRY_GUARD_MS) return;
+    if (_currentRetryCount >= LINK_MAX_RETRIES) return;
+
+    _currentRetryCount++;
+    _lastFastRetryTime = now;
+    DebugSerial.print("Link: next hop lost a frame, fast retransmit (Attempt ");
+    DebugSerial.print(_currentRetryCount); DebugSerial.print("/"); DebugSerial.print(LINK_MAX_RETRIES); DebugSerial.println(")");
+    retransmitPending(); // Also restarts the ACK timer
+}
+
+// ACK timeout that applies to whatever the link is currently waiting on
+unsigned long Link::currentTimeoutDuration() const {
+    if (_state == LinkState::PENDING_REQ) {
+        return LINK_REQ_TIMEOUT_MS;
+    }
+    // Reuse data timeout for close ACK; ESTABLISHED with pending packets uses it too
+    return LINK_RETRY_TIMEOUT_MS;
+}
 
-     PendingPacket& pending = _pendingOutgoingPackets.front();
-     pending.lastSentTime = millis();
-     uint16_t oldPacketId = pending.packetInfo.packet_id;
-     pending.packetInfo.packet_id = _ownerRef.getNextPacketId(); // Use new packet ID
+// Earliest time checkTimeouts() (or the manager's inactivity prune) has something to do
+bool Link::getNextDeadline(unsigned long& deadline) const {
+    if (_state == LinkState::CLOSED) {
+        deadline = millis(); // Waiting to be pruned by the manager
+        return true;
+    }
+    deadline = _lastActivityTime + LINK_INACTIVITY_TIMEOUT_MS + 1;
+    if (_ackPending && (long)(_ackDeadline - deadline) < 0) {
+        deadline = _ackDeadline;
+    }
+    if (_stateTimer != 0) {
+        unsigned long stateDeadline = _stateTimer + currentTimeoutDuration() + 1;
+        if ((long)(stateDeadline - deadline) < 0) deadline = stateDeadline;
+    }
+    return true;
+}
 
-     DebugSerial.print("Link Retransmitting seq "); DebugSerial.print(pending.packetInfo.sequence_number);
-     DebugSerial.print(" ID "); DebugSerial.print(pending.packetInfo.packet_id); DebugSerial.print(" (Retry "); DebugSerial.print(_currentRetryCount); DebugSerial.println(")");
+// Retransmit every unacknowledged packet in the window (go-back-N; receiver drops out-of-order)
+void Link::retransmitPending() {
+     if (_pendingOutgoingPackets.empty()) return;
 
-     uint8_t buffer[MAX_PACKET_SIZE];
-     size_t len = 0;
-     // Serialize using the info stored in the pending packet
-      bool ok = ReticulumPacket::serialize(buffer, len,
-        pending.packetInfo.destination, _ownerRef.getNodeAddress(),
-        RNS_DST_TYPE_SINGLE, pending.packetInfo.header_type, pending.packetInfo.context,
-        pending.packetInfo.packet_id, 0, // Hops = 0
-        pending.packetInfo.data,
-        pending.packetInfo.sequence_number);
+     for (PendingPacket& pending : _pendingOutgoingPackets) {
+         pending.lastSentTime = millis();
+         pending.packetInfo.packet_id = _ownerRef.getNextPacketId(); // Use new packet ID
 
-      if (ok) {
-         _ownerRef.sendPacketRaw(buffer, len, pending.packetInfo.destination);
-         _stateTimer = millis(); // Reset retransmission timer
-         updateActivity();
-      } else {
-          DebugSerial.println("! ERROR: Link::retransmit serialize failed! Tearing down.");
-          teardown();
-      }
+         DebugSerial.print("Link Retransmitting seq "); DebugSerial.print(pending.packetInfo.sequence_number);
+         DebugSerial.print(" ID "); DebugSerial.print(pending.packetInfo.packet_id); DebugSerial.print(" (Retry "); DebugSerial.print(_currentRetryCount); DebugSerial.println(")");
+
+         if (!transmitPending(pending)) {
+             DebugSerial.println("! ERROR: Link::retransmit serialize failed! Tearing down.");
+             teardown();
+             return;
+         }
+     }
+     _stateTimer = millis(); // Reset retransmission timer
+     updateActivity();
 }
 
 // Initiate link closure process
@@ -398,6 +613,8 @@ void Link::close(bool notifyPeer) {
      if (_state == LinkState::CLOSED) return; // Already closed
 
      DebugSerial.print("Link::close requested for "); Utils::printBytes(_destinationAddress.data(), RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
+     // Don't leave the peer retransmitting data we already delivered
+     if (_state == LinkState::ESTABLISHED) flushPendingAck();
      // Clear any pending packets immediately when close is initiated
      clearPendingQueue();
 
@@ -417,7 +634,7 @@ void Link::close(bool notifyPeer) {
 // Internal: Send the LINK_CLOSE packet
 void Link::sendLinkClose() {
      uint16_t closePacketId = _ownerRef.getNextPacketId();
-     uint8_t buffer[RNS_MIN_HEADER_SIZE]; // No payload
+     uint8_t buffer[RNS_LEGACY_HEADER_SIZE + RNS_SEQ_SIZE]; // No payload
      size_t len = 0;
      bool ok = ReticulumPacket::serialize_control(buffer, len,
         _destinationAddress.data(), _ownerRef.getNodeAddress(),
@@ -455,4 +672,7 @@ void Link::clearPendingQueue() {
     _pendingOutgoingPackets.clear();
     _currentRetryCount = 0;
     _stateTimer = 0; // Stop timers related to pending packets/state waits
+    _ackPending = false; // Any held ACK belongs to the old sequence space
+    _unackedInOrderCount = 0;
+    _ackDeadline = 0;
 }
@@ -0,0 +1,75 @@
+#include "LinkCryptoPool.h"
+#include <cstring> // For memcmp, memcpy, memset
+#include <new>     // For std::nothrow
+
+size_t LinkCryptoPool::capacityFor(size_t freeHeap, size_t perLinkCost) {
+    size_t count = 0;
+    if (perLinkCost > 0 && freeHeap > LINK_HEAP_RESERVE) {
+        count = (freeHeap - LINK_HEAP_RESERVE) / perLinkCost;
+    }
+    if (count < LINK_POOL_MIN) count = LINK_POOL_MIN;
+    if (count > LINK_POOL_MAX) count = LINK_POOL_MAX;
+    return count;
+}
+
+size_t LinkCryptoPool::begin(size_t freeHeap, size_t perLinkCost) {
+    if (_tokens) return _capacity;
+    size_t count = capacityFor(freeHeap, perLinkCost);
+    _tokens.reset(new (std::nothrow) Crypto::Token[count]);
+    _inUse.reset(new (std::nothrow) bool[count]);
+    if (!_tokens || !_inUse) {
+        _tokens.reset();
+        _inUse.reset();
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) _inUse[i] = false;
+    _capacity = count;
+    _used = 0;
+    return _capacity;
+}
+
+size_t LinkCryptoPool::acquire() {
+    for (size_t i = 0; i < _capacity; i++) {
+        if (_inUse[i]) continue;
+        _inUse[i] = true;
+        _tokens[i].clear();
+        _used++;
+        return i;
+    }
+    return NO_SLOT;
+}
+
+void LinkCryptoPool::release(size_t slot) {
+    if (slot >= _capacity || !_inUse[slot]) return;
+    _tokens[slot].clear();
+    _inUse[slot] = false;
+    _used--;
+}
+
+bool LinkCryptoPool::establish(size_t slot, const uint8_t ownSecret[Identity::KEY_SIZE],
+                               const uint8_t ownPublic[Identity::KEY_SIZE],
+                               const uint8_t peerPublic[Identity::KEY_SIZE]) {
+    if (slot >= _capacity || !_inUse[slot]) return false;
+    uint8_t shared[Identity::KEY_SIZE];
+    if (!Identity::exchange(ownSecret, peerPublic, shared)) {
+        memset(shared, 0, sizeof(shared));
+        return false;
+    }
+
+    uint8_t salt[2 * Identity::KEY_SIZE];
+    bool ownFirst = memcmp(ownPublic, peerPublic, Identity::KEY_SIZE) < 0;
+    memcpy(salt, ownFirst ? ownPublic : peerPublic, Identity::KEY_SIZE);
+    memcpy(salt + Identity::KEY_SIZE, ownFirst ? peerPublic : ownPublic, Identity::KEY_SIZE);
+
+    uint8_t key[Crypto::TOKEN_KEY_SIZE];
+    Crypto::hkdf(key, sizeof(key), shared, sizeof(shared), salt, sizeof(salt));
+    _tokens[slot].setKey(key);
+    memset(shared, 0, sizeof(shared));
+    memset(key, 0, sizeof(key));
+    return true;
+}
+
+Crypto::Token* LinkCryptoPool::get(size_t slot) {
+    if (slot >= _capacity || !_inUse[slot] || !_tokens[slot].isKeyed()) return nullptr;
+    return &_tokens[slot];
+}
@@ -7,10 +7,46 @@
 
 LinkManager::LinkManager(ReticulumNode& owner) : _ownerRef(owner) {}
 
+void LinkManager::begin() {
+    // Heap a link costs besides its crypto context: the Link itself, a full window of
+    // pending frames and the map/shared_ptr bookkeeping
+    size_t perLinkCost = sizeof(Crypto::Token) + sizeof(Link) +
+                         LINK_WINDOW_SIZE * (sizeof(RnsPacketInfo) + RNS_MAX_PAYLOAD) + 64;
+    size_t freeHeap = ESP.getFreeHeap();
+    if (_cryptoPool.begin(freeHeap, perLinkCost) == 0) {
+        DebugSerial.println("! ERROR: Link crypto pool allocation failed, links disabled!");
+        return;
+    }
+    DebugSerial.print("LinkManager: "); DebugSerial.print(_cryptoPool.getCapacity());
+    DebugSerial.print(" link slots ("); DebugSerial.print(perLinkCost);
+    DebugSerial.print(" B each, free heap "); DebugSerial.print(freeHeap); DebugSerial.println(")");
+}
+
 size_t LinkManager::getActiveLinkCount() const {
     return _activeLinks.size();
 }
 
+size_t LinkManager::exportLinkPeers(uint8_t* out, size_t capacity) const {
+    size_t len = 0;
+    for (const auto& entry : _activeLinks) {
+        if (!entry.second->isEstablished()) continue;
+        if (len + RNS_ADDRESS_SIZE > capacity) break;
+        memcpy(out + len, entry.first.data(), RNS_ADDRESS_SIZE);
+        len += RNS_ADDRESS_SIZE;
+    }
+    return len;
+}
+
+size_t LinkManager::reopenLinks(const uint8_t* peers, size_t len) {
+    size_t initiated = 0;
+    for (size_t off = 0; off + RNS_ADDRESS_SIZE <= len; off += RNS_ADDRESS_SIZE) {
+        LinkPtr link = getOrCreateLink(peers + off, true);
+        if (link && !link->isActive() && link->establish()) initiated++;
+    }
+    armTimer(); // REQ timeouts; unreachable peers are pruned after their retries
+    return initiated;
+}
+
 // Get existing link or create if possible
 LinkManager::LinkPtr LinkManager::getOrCreateLink(const uint8_t* destination, bool create) {
     if (!destination) {
@@ -25,8 +61,14 @@ LinkManager::LinkPtr LinkManager::getOrCreateLink(const uint8_t* destination, bo
         // Found existing link
         // it->second->updateActivity(); // Update activity time on access? Maybe not needed here.
         return it->second;
-    } else if (create && _activeLinks.size() < LINK_MAX_ACTIVE) {
-        // Create new link if allowed and space available
+    } else if (create) {
+        // Create new link if a crypto context is free; the pool size is the link limit
+        size_t slot = _cryptoPool.acquire();
+        if (slot == LinkCryptoPool::NO_SLOT) {
+            DebugSerial.print("! WARN: Max active links ("); DebugSerial.print(_cryptoPool.getCapacity()); DebugSerial.print(") reached. Cannot create new link to ");
+            Utils::printBytes(destination, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
+            return nullptr;
+        }
         DebugSerial.print("LinkManager: Creating new Link object for "); Utils::printBytes(destination, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
         try {
              // Use 'new (std::nothrow)' for slightly safer allocation check than make_shared exception
@@ -38,20 +80,19 @@ LinkManager::LinkPtr LinkManager::getOrCreateLink(const uint8_t* destination, bo
              // LinkPtr newLink(rawPtr); // Wrap in shared_ptr
 
              // Or stick with make_shared and handle potential exception (less common on embedded)
-             LinkPtr newLink = std::make_shared<Link>(destination, *this);
+             LinkPtr newLink = std::make_shared<Link>(destination, *this, slot);
 
              _activeLinks[destArray] = newLink; // Add to map
              return newLink;
         } catch (const std::bad_alloc& e) {
              DebugSerial.println("! ERROR: std::bad_alloc creating new Link!");
+             _cryptoPool.release(slot);
              return nullptr;
         } catch (...) {
              DebugSerial.println("! ERROR: Unknown exception creating new Link!");
+             _cryptoPool.release(slot);
              return nullptr;
         }
-    } else if (create) {
-         DebugSerial.print("! WARN: Max active links ("); DebugSerial.print(LINK_MAX_ACTIVE); DebugSerial.print(") reached. Cannot create new link to ");
-         Utils::printBytes(destination, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
     }
     return nullptr; // Not found and not created
 }
@@ -64,6 +105,7 @@ void LinkManager::processPacket(const RnsPacketInfo& packetInfo, InterfaceType i
     if (link) {
         link->handlePacket(packetInfo);
         // If handling the packet caused the link state to become CLOSED, pruneInactiveLinks will clean it up.
+        armTimer(); // Packet may have started/stopped ACK or retransmission timers
     } else {
          // If it wasn't a LINK_REQ or we couldn't create a link (e.g., max links reached), ignore it.
          if (packetInfo.context != RNS_CONTEXT_LINK_REQ) {
@@ -83,7 +125,9 @@ bool LinkManager::sendReliableData(const uint8_t* destination, const std::vector
     // If link is closed, try establishing it first
     if (!link->isActive()) { // Checks if state == CLOSED
         DebugSerial.println("LinkManager::sendReliableData: Link is inactive, attempting establishment.");
-        if (!link->establish()) {
+        bool initiated = link->establish();
+        armTimer(); // Arm REQ timeout (or prune the failed attempt)
+        if (!initiated) {
              // Establish might fail if state wasn't CLOSED or serialize failed
              DebugSerial.println("! ERROR: LinkManager::sendReliableData failed to initiate link establishment.");
              // Maybe remove the failed link attempt? Let prune handle it.
@@ -95,7 +139,9 @@ bool LinkManager::sendReliableData(const uint8_t* destination, const std::vector
 
     // If link is established, attempt to send data
     if (link->isEstablished()) {
-        return link->sendData(payload); // Returns true if send attempt initiated
+        bool sent = link->sendData(payload); // Returns true if send attempt initiated
+        if (sent) armTimer(); // Arm retransmission timeout
+        return sent;
     } else {
         // Link is pending or closing, cannot send data now
         DebugSerial.println("! LinkManager::sendReliableData failed: Link not established yet (pending/closing).");
@@ -103,8 +149,9 @@ bool LinkManager::sendReliableData(const uint8_t* destination, const std::vector
     }
 }
 
-// Periodically check timeouts for all active links
+// Check timeouts for all active links once the earliest link deadline has expired
 void LinkManager::checkAllTimeouts() {
+    _timerId = TimerService::INVALID_TIMER; // Our one-shot has just fired
     // Use safe iteration because Link::checkTimeouts might trigger Link::teardown,
     // which now sets the state to CLOSED, allowing pruneInactiveLinks to remove it later.
     for (auto it = _activeLinks.begin(); it != _activeLinks.end(); ++it) {
@@ -112,6 +159,29 @@ void LinkManager::checkAllTimeouts() {
     }
     // Prune links marked as CLOSED or inactive after checking timeouts
     pruneInactiveLinks();
+    armTimer();
+}
+
+// Schedule a single timer for the earliest deadline of any link (none if no links)
+void LinkManager::armTimer() {
+    TimerService& timers = _ownerRef.getTimerService();
+    bool found = false;
+    unsigned long earliest = 0;
+    for (const auto& entry : _activeLinks) {
+        unsigned long deadline;
+        if (entry.second->getNextDeadline(deadline) && (!found || (long)(deadline - earliest) < 0)) {
+            earliest = deadline;
+            found = true;
+        }
+    }
+    if (!found) {
+        timers.cancel(_timerId);
+        _timerId = TimerService::INVALID_TIMER;
+        return;
+    }
+    long delay = (long)(earliest - millis());
+    _timerId = timers.reschedule(_timerId, delay > 0 ? (unsigned long)delay : 0,
+                                 [this]() { this->checkAllTimeouts(); });
 }
 
 // Clean up links that are CLOSED or haven't been active
@@ -164,9 +234,39 @@ void LinkManager::sendPacketRaw(const uint8_t* buffer, size_t len, const uint8_t
     // Link layer packets generally bypass high-level routing and go direct if possible.
     // Use the InterfaceManager's sendPacket which uses the routing table.
     // This ensures links can be established even if only broadcast path exists initially.
+#if LINK_MULTIPATH_ENABLED
+    // Alternate frames between the two best next hops on different interfaces (e.g. ESP-NOW + UDP)
+    if ((_multipathCounter++ & 1) != 0) {
+        const RouteCandidate* split = _ownerRef.getRoutingTable().findSplitCandidate(destination);
+        if (split) {
+            _ownerRef.getInterfaceManager().sendPacketViaCandidate(*split, buffer, len, destination);
+            return;
+        }
+    }
+#endif
      _ownerRef.getInterfaceManager().sendPacket(buffer, len, destination, InterfaceType::UNKNOWN);
 }
 
+void LinkManager::handleEspNowSendFailure(const uint8_t* mac) {
+    if (!mac) return;
+    RoutingTable& routes = _ownerRef.getRoutingTable();
+    for (auto& pair : _activeLinks) {
+        if (pair.second && routes.hasNextHop(pair.first.data(), InterfaceType::ESP_NOW, mac, IPAddress())) {
+            pair.second->retransmitNow();
+        }
+    }
+    armTimer(); // Retransmits restart the ACK timers
+}
+
+size_t LinkManager::getPathMtu(const uint8_t* destination) {
+    return _ownerRef.getInterfaceManager().getPathMtu(destination);
+}
+
+// Link ACK outcomes feed the routing table's ETX for the path to destination
+void LinkManager::reportDelivery(const uint8_t* destination, bool success) {
+    _ownerRef.getRoutingTable().reportDelivery(destination, success);
+}
+
 // Callback called by Link instances when data is successfully received and acknowledged
 void LinkManager::processReceivedLinkData(const uint8_t* source_address, const std::vector<uint8_t>& data) {
     _ownerRef.processAppData(source_address, data); // Pass data up to the main node's app handler
@@ -0,0 +1,88 @@
+#include "NodeSnapshot.h"
+#include <cstring> // For memcmp, memcpy
+
+static const uint8_t MAGIC[4] = { 'R', 'N', 'S', 'S' };
+static const size_t SECTION_HEADER_SIZE = 3;
+
+// Writes a section header, lets export() fill the body and returns the bytes used (0 if empty)
+template <typename Export>
+static size_t writeSection(uint8_t* out, size_t capacity, uint8_t type, Export exportBody) {
+    if (capacity <= SECTION_HEADER_SIZE) return 0;
+    size_t room = capacity - SECTION_HEADER_SIZE;
+    if (room > 0xFFFF) room = 0xFFFF;
+    size_t len = exportBody(out + SECTION_HEADER_SIZE, room);
+    if (len == 0) return 0;
+    out[0] = type;
+    out[1] = len & 0xFF;
+    out[2] = len >> 8;
+    return SECTION_HEADER_SIZE + len;
+}
+
+size_t NodeSnapshot::write(uint8_t* out, size_t capacity, const RoutingTable& routes, const PathTable& paths,
+                           const PacketFilter& filter, time_t wallNow) {
+    if (capacity < HEADER_SIZE) return 0;
+    uint32_t savedAt = (uint32_t)wallNow;
+    memcpy(out, MAGIC, sizeof(MAGIC));
+    out[4] = VERSION;
+    for (int b = 0; b < 4; b++) out[5 + b] = (savedAt >> (8 * b)) & 0xFF;
+    out[9] = isClockSynced(wallNow) ? 1 : 0;
+    size_t len = HEADER_SIZE;
+
+    len += writeSection(out + len, capacity - len, ROUTES, [&routes](uint8_t* body, size_t room) {
+        return routes.exportRoutes(body, room);
+    });
+    len += writeSection(out + len, capacity - len, PATHS, [&paths](uint8_t* body, size_t room) {
+        return paths.exportPaths(body, room);
+    });
+    len += writeSection(out + len, capacity - len, FILTER, [&filter](uint8_t* body, size_t room) {
+        return filter.exportBits(body, room);
+    });
+    len += writeSection(out + len, capacity - len, ANNOUNCES, [&paths](uint8_t* body, size_t room) {
+        return paths.exportAnnounces(body, room);
+    });
+    return len;
+}
+
+bool NodeSnapshot::read(const uint8_t* data, size_t len, RoutingTable& routes, PathTable& paths,
+                        PacketFilter& filter, time_t wallNow, Restored& result,
+                        const PathTable::AnnounceCheck& checkAnnounce) {
+    result = Restored();
+    if (!data || len < HEADER_SIZE || memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || data[4] != VERSION) return false;
+
+    uint32_t savedAt = data[5] | (data[6] << 8) | (data[7] << 16) | ((uint32_t)data[8] << 24);
+    bool savedSynced = data[9] != 0;
+    uint32_t now = (uint32_t)wallNow;
+    if (savedSynced == isClockSynced(wallNow) && now >= savedAt) {
+        uint32_t downS = now - savedAt;
+        result.downtimeMs = downS > 0xFFFFFFFFUL / 1000 ? 0xFFFFFFFFUL : downS * 1000UL;
+        result.downtimeKnown = true;
+    } else {
+        result.downtimeMs = STATE_UNKNOWN_DOWNTIME_MS;
+    }
+
+    // Paths before announces: an announce is only kept for a destination with a path
+    const uint8_t* sections[ANNOUNCES + 1] = {};
+    size_t sectionLens[ANNOUNCES + 1] = {};
+    size_t off = HEADER_SIZE;
+    while (off + SECTION_HEADER_SIZE <= len) {
+        uint8_t type = data[off];
+        size_t bodyLen = data[off + 1] | (data[off + 2] << 8);
+        if (off + SECTION_HEADER_SIZE + bodyLen > len) return false; // Truncated
+        if (type >= ROUTES && type <= ANNOUNCES) {
+            sections[type] = data + off + SECTION_HEADER_SIZE;
+            sectionLens[type] = bodyLen;
+        }
+        off += SECTION_HEADER_SIZE + bodyLen;
+    }
+
+    if (sections[ROUTES]) result.routes = routes.importRoutes(sections[ROUTES], sectionLens[ROUTES], result.downtimeMs);
+    if (sections[PATHS]) result.paths = paths.importPaths(sections[PATHS], sectionLens[PATHS], result.downtimeMs);
+    if (sections[ANNOUNCES]) {
+        result.announces = paths.importAnnounces(sections[ANNOUNCES], sectionLens[ANNOUNCES], checkAnnounce, &result.rejected);
+    }
+    // Saved hashes are one to two rotations old already; past one more they would have aged out
+    if (sections[FILTER] && result.downtimeMs < PACKET_FILTER_ROTATE_MS) {
+        result.filter = filter.importBits(sections[FILTER], sectionLens[FILTER]);
+    }
+    return true;
+}
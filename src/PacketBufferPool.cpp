@@ -0,0 +1,49 @@
+#include "PacketBufferPool.h"
+
+uint8_t PacketBufferPool::_buffers[PACKET_POOL_SIZE][MAX_PACKET_SIZE];
+std::atomic<uint32_t> PacketBufferPool::_inUse(0);
+uint32_t PacketBufferPool::_exhausted = 0;
+
+PacketBufferPool::Buffer PacketBufferPool::acquire() {
+    uint32_t used = _inUse.load();
+    for (;;) {
+        int index = -1;
+        for (int i = 0; i < (int)PACKET_POOL_SIZE; i++) {
+            if (!(used & (1u << i))) { index = i; break; }
+        }
+        if (index < 0) {
+            _exhausted++;
+            return Buffer();
+        }
+        // Another context may have claimed it meanwhile; retry with the fresh mask
+        if (_inUse.compare_exchange_weak(used, used | (1u << index))) return Buffer(index);
+    }
+}
+
+size_t PacketBufferPool::getFreeCount() {
+    uint32_t used = _inUse.load();
+    size_t free = 0;
+    for (size_t i = 0; i < PACKET_POOL_SIZE; i++) {
+        if (!(used & (1u << i))) free++;
+    }
+    return free;
+}
+
+PacketBufferPool::Buffer& PacketBufferPool::Buffer::operator=(Buffer&& other) {
+    if (this != &other) {
+        release();
+        _index = other._index;
+        other._index = -1;
+    }
+    return *this;
+}
+
+uint8_t* PacketBufferPool::Buffer::data() const {
+    return _index >= 0 ? _buffers[_index] : nullptr;
+}
+
+void PacketBufferPool::Buffer::release() {
+    if (_index < 0) return;
+    _inUse.fetch_and(~(1u << _index));
+    _index = -1;
+}
@@ -0,0 +1,82 @@
+#include "PacketFilter.h"
+#include "ReticulumPacket.h" // For RNS_TRUNCATED_HASHLENGTH_BYTES
+#include <cstring> // For memset
+
+PacketFilter::PacketFilter() : _current(0), _currentCount(0), _duplicates(0) {
+    memset(_filters, 0, sizeof(_filters));
+}
+
+// 64-bit FNV-1a; cheap on the C3 and well spread enough for Bloom indexing
+uint64_t PacketFilter::hashPacket(const uint8_t* packet, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    if (!packet || len == 0) return hash;
+
+    hash ^= (uint8_t)(packet[0] & 0x0F); // Upper flag bits may change in transit
+    hash *= 0x100000001b3ULL;
+    // Skip the hops byte, and the transport ID each transport node rewrites (HEADER_2)
+    size_t start = (packet[0] & 0x40) ? 2 + RNS_TRUNCATED_HASHLENGTH_BYTES : 2;
+    for (size_t i = start; i < len; i++) {
+        hash ^= packet[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Double hashing (h1 + i*h2) derives PACKET_FILTER_HASHES bit positions from one hash
+bool PacketFilter::testBits(const uint8_t* filter, uint64_t hash) const {
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    for (uint8_t i = 0; i < PACKET_FILTER_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) % PACKET_FILTER_BITS;
+        if (!(filter[bit >> 3] & (1 << (bit & 7)))) return false;
+    }
+    return true;
+}
+
+void PacketFilter::setBits(uint8_t* filter, uint64_t hash) {
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    for (uint8_t i = 0; i < PACKET_FILTER_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) % PACKET_FILTER_BITS;
+        filter[bit >> 3] |= (1 << (bit & 7));
+    }
+}
+
+bool PacketFilter::contains(uint64_t hash) const {
+    return testBits(_filters[_current], hash) || testBits(_filters[_current ^ 1], hash);
+}
+
+void PacketFilter::insert(uint64_t hash) {
+    if (_currentCount >= PACKET_FILTER_MAX_ENTRIES) rotate();
+    setBits(_filters[_current], hash);
+    _currentCount++;
+}
+
+bool PacketFilter::checkAndInsert(const uint8_t* packet, size_t len) {
+    uint64_t hash = hashPacket(packet, len);
+    if (contains(hash)) {
+        _duplicates++;
+        return true;
+    }
+    insert(hash);
+    return false;
+}
+
+void PacketFilter::rotate() {
+    _current ^= 1;
+    memset(_filters[_current], 0, FILTER_BYTES);
+    _currentCount = 0;
+}
+
+size_t PacketFilter::exportBits(uint8_t* out, size_t capacity) const {
+    if (capacity < EXPORT_SIZE) return 0;
+    for (size_t i = 0; i < FILTER_BYTES; i++) out[i] = _filters[0][i] | _filters[1][i];
+    return EXPORT_SIZE;
+}
+
+bool PacketFilter::importBits(const uint8_t* data, size_t len) {
+    if (len != EXPORT_SIZE) return false;
+    uint8_t* older = _filters[_current ^ 1];
+    for (size_t i = 0; i < FILTER_BYTES; i++) older[i] |= data[i];
+    return true;
+}
@@ -0,0 +1,81 @@
+#include "PathRequestQueue.h"
+
+PathRequestQueue::PathRequestQueue() : _dropped(0) {
+    _packets.reserve(PATH_QUEUE_MAX);
+    _requests.reserve(PATH_QUEUE_MAX);
+}
+
+bool PathRequestQueue::enqueue(const RnsPacketInfo& packet, InterfaceType incoming, unsigned long now) {
+    if (_packets.size() >= PATH_QUEUE_MAX) {
+        uint8_t oldest[RNS_TRUNCATED_HASHLENGTH_BYTES];
+        memcpy(oldest, _packets.front().packet.destination_hash, sizeof(oldest));
+        _packets.erase(_packets.begin());
+        dropRequestIfUnused(oldest);
+        _dropped++;
+    }
+    _packets.push_back({packet, incoming, now});
+
+    for (const auto& request : _requests) {
+        if (sameHash(request.destination_hash, packet.destination_hash)) return false; // Already asked
+    }
+    Request request;
+    memcpy(request.destination_hash, packet.destination_hash, RNS_TRUNCATED_HASHLENGTH_BYTES);
+    request.attempts = 1;
+    request.sentAt = now;
+    _requests.push_back(request);
+    return true;
+}
+
+void PathRequestQueue::take(const uint8_t* destinationHash, std::vector<Pending>& out) {
+    if (!destinationHash) return;
+    for (auto it = _packets.begin(); it != _packets.end(); ) {
+        if (sameHash(it->packet.destination_hash, destinationHash)) {
+            out.push_back(std::move(*it));
+            it = _packets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    dropRequestIfUnused(destinationHash);
+}
+
+void PathRequestQueue::poll(std::vector<std::array<uint8_t, RNS_TRUNCATED_HASHLENGTH_BYTES>>& retry,
+                            std::vector<Pending>& expired, unsigned long now) {
+    for (auto req = _requests.begin(); req != _requests.end(); ) {
+        if (now - req->sentAt < PATH_REQUEST_TIMEOUT_MS) {
+            ++req;
+            continue;
+        }
+        if (req->attempts < PATH_REQUEST_RETRIES) {
+            req->attempts++;
+            req->sentAt = now;
+            std::array<uint8_t, RNS_TRUNCATED_HASHLENGTH_BYTES> hash;
+            memcpy(hash.data(), req->destination_hash, hash.size());
+            retry.push_back(hash);
+            ++req;
+            continue;
+        }
+        // Out of retries: hand the packets back for flooding
+        for (auto it = _packets.begin(); it != _packets.end(); ) {
+            if (sameHash(it->packet.destination_hash, req->destination_hash)) {
+                expired.push_back(std::move(*it));
+                it = _packets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        req = _requests.erase(req);
+    }
+}
+
+void PathRequestQueue::dropRequestIfUnused(const uint8_t* destinationHash) {
+    for (const auto& pending : _packets) {
+        if (sameHash(pending.packet.destination_hash, destinationHash)) return;
+    }
+    for (auto it = _requests.begin(); it != _requests.end(); ++it) {
+        if (sameHash(it->destination_hash, destinationHash)) {
+            _requests.erase(it);
+            return;
+        }
+    }
+}
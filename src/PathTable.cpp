@@ -0,0 +1,178 @@
+#include "PathTable.h"
+#include <algorithm> // For std::sort
+#include <cstring>   // For memcmp, memcpy, memset
+#include <utility>   // For std::move
+
+PathTable::PathTable() : _paths(), _count(0) {}
+
+PathTable::Path* PathTable::findEntry(const uint8_t* destinationHash) {
+    if (!destinationHash) return nullptr;
+    for (size_t i = 0; i < _count; i++) {
+        if (memcmp(_paths[i].destination_hash, destinationHash, RNS_TRUNCATED_HASHLENGTH_BYTES) == 0) return &_paths[i];
+    }
+    return nullptr;
+}
+
+const PathTable::Path* PathTable::find(const uint8_t* destinationHash, unsigned long now) const {
+    const Path* path = const_cast<PathTable*>(this)->findEntry(destinationHash);
+    return (path && !isExpired(*path, now)) ? path : nullptr;
+}
+
+bool PathTable::update(const uint8_t* destinationHash, const uint8_t* nextHop, uint8_t hops,
+                       InterfaceType interface, const uint8_t* senderMac, const IPAddress& senderIp,
+                       uint16_t senderPort, unsigned long now) {
+    if (!destinationHash || !nextHop) return false;
+
+    Path* path = findEntry(destinationHash);
+    if (path) {
+        bool sameNextHop = memcmp(path->next_hop, nextHop, RNS_TRUNCATED_HASHLENGTH_BYTES) == 0 &&
+                           path->via.interface == interface;
+        // Keep a shorter path until it stops being announced
+        if (!sameNextHop && hops > path->hops && !isExpired(*path, now)) return false;
+    } else {
+        if (_count < PATH_TABLE_SIZE) {
+            path = &_paths[_count++];
+        } else {
+            path = &_paths[0];
+            for (size_t i = 1; i < _count; i++) {
+                if ((long)(_paths[i].updated - path->updated) < 0) path = &_paths[i];
+            }
+        }
+        path->announce.clear(); // Belonged to whichever destination used the slot before
+        path->ratchet = false;
+    }
+
+    memcpy(path->destination_hash, destinationHash, RNS_TRUNCATED_HASHLENGTH_BYTES);
+    memcpy(path->next_hop, nextHop, RNS_TRUNCATED_HASHLENGTH_BYTES);
+    path->hops = hops;
+    path->updated = now;
+
+    RouteCandidate& via = path->via;
+    via.interface = interface;
+    if (senderMac) memcpy(via.next_hop_mac, senderMac, 6);
+    else memset(via.next_hop_mac, 0, 6);
+    via.next_hop_ip = senderIp;
+    via.next_hop_port = senderPort;
+    via.hops = hops;
+    via.last_heard_time = now;
+    via.link_quality = ROUTE_LINK_QUALITY_UNKNOWN;
+    via.delivery_ratio = 1.0f;
+    via.consecutive_failures = 0;
+    via.last_failure_time = 0;
+    return true;
+}
+
+void PathTable::cacheAnnounce(const uint8_t* destinationHash, const std::vector<uint8_t>& data, bool ratchet) {
+    Path* path = findEntry(destinationHash);
+    if (!path) return;
+    path->announce = data;
+    path->ratchet = ratchet;
+}
+
+void PathTable::removeAt(size_t index) {
+    // Order does not matter; fill the hole with the last entry
+    if (index != --_count) _paths[index] = std::move(_paths[_count]);
+    _paths[_count].announce.clear();
+}
+
+void PathTable::remove(const uint8_t* destinationHash) {
+    Path* path = findEntry(destinationHash);
+    if (path) removeAt(path - _paths);
+}
+
+void PathTable::expire(unsigned long now) {
+    for (size_t i = 0; i < _count; ) {
+        if (isExpired(_paths[i], now)) removeAt(i);
+        else i++;
+    }
+}
+
+size_t PathTable::exportPaths(uint8_t* out, size_t capacity, unsigned long now) const {
+    size_t len = 0;
+    for (size_t i = 0; i < _count && len + EXPORT_RECORD_SIZE <= capacity; i++) {
+        const Path& path = _paths[i];
+        if (isExpired(path, now)) continue;
+        uint8_t* p = out + len;
+        memcpy(p, path.destination_hash, RNS_TRUNCATED_HASHLENGTH_BYTES); p += RNS_TRUNCATED_HASHLENGTH_BYTES;
+        memcpy(p, path.next_hop, RNS_TRUNCATED_HASHLENGTH_BYTES); p += RNS_TRUNCATED_HASHLENGTH_BYTES;
+        *p++ = path.hops;
+        *p++ = static_cast<uint8_t>(path.via.interface);
+        memcpy(p, path.via.next_hop_mac, 6); p += 6;
+        uint32_t ip = path.via.next_hop_ip;
+        memcpy(p, &ip, 4); p += 4;
+        *p++ = path.via.next_hop_port & 0xFF; *p++ = path.via.next_hop_port >> 8;
+        uint32_t ageS = (now - path.updated) / 1000;
+        for (int b = 0; b < 4; b++) *p++ = (ageS >> (8 * b)) & 0xFF;
+        len += EXPORT_RECORD_SIZE;
+    }
+    return len;
+}
+
+size_t PathTable::importPaths(const uint8_t* data, size_t len, unsigned long extraAgeMs, unsigned long now) {
+    size_t restored = 0;
+    for (size_t off = 0; off + EXPORT_RECORD_SIZE <= len && _count < PATH_TABLE_SIZE; off += EXPORT_RECORD_SIZE) {
+        const uint8_t* p = data + off;
+        if (findEntry(p)) continue; // Announced again since boot
+        uint32_t ageS = p[46] | (p[47] << 8) | (p[48] << 16) | ((uint32_t)p[49] << 24);
+        if (ageS > PATH_TIMEOUT_MS / 1000 || (unsigned long)ageS * 1000UL + extraAgeMs > PATH_TIMEOUT_MS) continue;
+        uint32_t ip;
+        memcpy(&ip, p + 40, 4);
+        InterfaceType interface = static_cast<InterfaceType>(p[33]);
+        update(p, p + RNS_TRUNCATED_HASHLENGTH_BYTES, p[32], interface,
+               interface == InterfaceType::ESP_NOW ? p + 34 : nullptr, IPAddress(ip),
+               (uint16_t)(p[44] | (p[45] << 8)), now);
+        Path* path = findEntry(p);
+        path->updated = now - (ageS * 1000UL + extraAgeMs); // Expires when it would have without the reboot
+        path->via.last_heard_time = path->updated;
+        restored++;
+    }
+    return restored;
+}
+
+size_t PathTable::exportAnnounces(uint8_t* out, size_t capacity) const {
+    // Newest first: those are the identities most likely still announcing
+    const Path* order[PATH_TABLE_SIZE];
+    for (size_t i = 0; i < _count; i++) order[i] = &_paths[i];
+    std::sort(order, order + _count, [](const Path* a, const Path* b) { return (long)(a->updated - b->updated) > 0; });
+
+    size_t len = 0;
+    for (size_t i = 0; i < _count; i++) {
+        const std::vector<uint8_t>& announce = order[i]->announce;
+        if (announce.empty()) continue;
+        size_t recordLen = RNS_TRUNCATED_HASHLENGTH_BYTES + 3 + announce.size();
+        if (len + recordLen > capacity) break;
+        uint8_t* p = out + len;
+        memcpy(p, order[i]->destination_hash, RNS_TRUNCATED_HASHLENGTH_BYTES); p += RNS_TRUNCATED_HASHLENGTH_BYTES;
+        *p++ = order[i]->ratchet ? 1 : 0;
+        *p++ = announce.size() & 0xFF; *p++ = announce.size() >> 8;
+        memcpy(p, announce.data(), announce.size());
+        len += recordLen;
+    }
+    return len;
+}
+
+size_t PathTable::importAnnounces(const uint8_t* data, size_t len, const AnnounceCheck& check, size_t* rejected) {
+    size_t cached = 0;
+    if (rejected) *rejected = 0;
+    size_t off = 0;
+    while (off + RNS_TRUNCATED_HASHLENGTH_BYTES + 3 <= len) {
+        const uint8_t* p = data + off;
+        bool ratchet = p[RNS_TRUNCATED_HASHLENGTH_BYTES] != 0;
+        size_t announceLen = p[RNS_TRUNCATED_HASHLENGTH_BYTES + 1] | (p[RNS_TRUNCATED_HASHLENGTH_BYTES + 2] << 8);
+        const uint8_t* announce = p + RNS_TRUNCATED_HASHLENGTH_BYTES + 3;
+        if (announce + announceLen > data + len) break; // Truncated
+        Path* path = findEntry(p);
+        if (path && path->announce.empty()) {
+            if (check && !check(p, announce, announceLen, ratchet)) {
+                remove(p); // Learned from an announce that does not verify
+                if (rejected) (*rejected)++;
+            } else {
+                path->announce.assign(announce, announce + announceLen);
+                path->ratchet = ratchet;
+                cached++;
+            }
+        }
+        off += RNS_TRUNCATED_HASHLENGTH_BYTES + 3 + announceLen;
+    }
+    return cached;
+}
@@ -0,0 +1,107 @@
+#include "PowerManager.h"
+#include "Config.h"
+#include <esp_timer.h> // For esp_timer_get_time (64-bit, no wrap)
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#if LOW_POWER_MODE_ENABLED
+#include <esp_pm.h>
+#endif
+
+static EventGroupHandle_t _eventGroup = nullptr;
+static const EventBits_t ALL_EVENTS = POWER_EVENT_UART_RX | POWER_EVENT_ESPNOW_RX | POWER_EVENT_LORA_DIO | POWER_EVENT_WIFI |
+                                     POWER_EVENT_HTTP | POWER_EVENT_ANNOUNCE;
+
+bool PowerManager::_lightSleepActive = false;
+uint32_t PowerManager::_sourceWakes[POWER_EVENT_SOURCE_COUNT] = {0};
+uint32_t PowerManager::_timerWakes = 0;
+uint64_t PowerManager::_blockedUs = 0;
+
+void PowerManager::begin() {
+    if (!_eventGroup) {
+        _eventGroup = xEventGroupCreate();
+        if (!_eventGroup) {
+            DebugSerial.println("! ERROR: PowerManager failed to create event group!");
+            return;
+        }
+    }
+#if LOW_POWER_MODE_ENABLED
+#if CONFIG_PM_ENABLE
+    // Let the idle task enter light sleep whenever no task is ready to run
+#if defined(CONFIG_IDF_TARGET_ESP32C3)
+    esp_pm_config_esp32c3_t pmConfig;
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+    esp_pm_config_esp32s3_t pmConfig;
+#elif defined(CONFIG_IDF_TARGET_ESP32S2)
+    esp_pm_config_esp32s2_t pmConfig;
+#else
+    esp_pm_config_esp32_t pmConfig;
+#endif
+    pmConfig.max_freq_mhz = getCpuFrequencyMhz();
+    pmConfig.min_freq_mhz = 40; // XTAL frequency
+    pmConfig.light_sleep_enable = true;
+    esp_err_t err = esp_pm_configure(&pmConfig);
+    if (err == ESP_OK) {
+        _lightSleepActive = true;
+        DebugSerial.println("Power: Automatic light sleep enabled.");
+    } else {
+        DebugSerial.print("! WARN: Power: esp_pm_configure failed: "); DebugSerial.println(esp_err_to_name(err));
+    }
+#else
+    DebugSerial.println("! WARN: Power: CONFIG_PM_ENABLE not set in sdkconfig; loop will block but chip stays awake.");
+#endif
+#if BLUETOOTH_CLASSIC_AVAILABLE
+    DebugSerial.println("! WARN: Power: Bluetooth Classic holds a PM lock and prevents light sleep.");
+#endif
+#endif
+}
+
+void PowerManager::notify(uint32_t events) {
+    if (_eventGroup) xEventGroupSetBits(_eventGroup, events);
+}
+
+void IRAM_ATTR PowerManager::notifyFromISR(uint32_t events) {
+    if (!_eventGroup) return;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xEventGroupSetBitsFromISR(_eventGroup, events, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+void PowerManager::waitForEvent(unsigned long timeoutMs) {
+#if LOW_POWER_MODE_ENABLED
+    if (!_eventGroup || timeoutMs == 0) return;
+
+    int64_t start = esp_timer_get_time();
+    // Clear on exit so each event wakes us once; the interface poll that follows drains all pending data
+    EventBits_t bits = xEventGroupWaitBits(_eventGroup, ALL_EVENTS, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeoutMs));
+    _blockedUs += (uint64_t)(esp_timer_get_time() - start);
+
+    if ((bits & ALL_EVENTS) == 0) {
+        _timerWakes++;
+        return;
+    }
+    for (uint8_t i = 0; i < POWER_EVENT_SOURCE_COUNT; i++) {
+        if (bits & (1u << i)) _sourceWakes[i]++;
+    }
+#else
+    (void)timeoutMs;
+#endif
+}
+
+uint32_t PowerManager::getWakeCount() {
+    uint32_t total = _timerWakes;
+    for (uint8_t i = 0; i < POWER_EVENT_SOURCE_COUNT; i++) total += _sourceWakes[i];
+    return total;
+}
+
+uint32_t PowerManager::getWakeCount(PowerEvent source) {
+    for (uint8_t i = 0; i < POWER_EVENT_SOURCE_COUNT; i++) {
+        if ((uint32_t)source == (1u << i)) return _sourceWakes[i];
+    }
+    return 0;
+}
+
+float PowerManager::getDutyCyclePercent() {
+    uint64_t uptimeUs = (uint64_t)esp_timer_get_time();
+    if (uptimeUs == 0 || _blockedUs >= uptimeUs) return 100.0f;
+    return 100.0f * (float)(uptimeUs - _blockedUs) / (float)uptimeUs;
+}
@@ -5,12 +5,16 @@
 #include "LinkManager.h"      // Needs definition for _linkManager member
 #include "InterfaceManager.h" // Needs definition for _interfaceManager member
 #include "RoutingTable.h"     // Needs definition for _routingTable member
-#include <EEPROM.h>           // Include EEPROM library
+#include "PowerManager.h"
+#include "PacketBufferPool.h"
+#include "NodeSnapshot.h"
+#include <algorithm>          // For std::min
+#include <ctime>              // For time(), the snapshot's wall clock
+#include <EEPROM.h>           // Only read once, to migrate the address from earlier firmware
 
 // Constructor: Initialize members, especially LinkManager passing *this
 ReticulumNode::ReticulumNode() :
-    _packetCounter(0),
-    _packetIdUnsavedCount(0),
+    _timers(),
     _routingTable(), // Default constructor
     // Initialize InterfaceManager first, pass its callback lambda and routing table ref
     _interfaceManager([this](const uint8_t* buff, size_t len, InterfaceType iface, const uint8_t* mac, const IPAddress& ip, uint16_t port){
@@ -18,83 +22,132 @@ ReticulumNode::ReticulumNode() :
     }, _routingTable),
     // Initialize LinkManager, passing *this ReticulumNode reference
     _linkManager(*this),
-    _last_announce_time(0),
-    _last_mem_check_time(0),
     _appDataHandler(nullptr) // Initialize callback to null
 {
     memset(_nodeAddress, 0, RNS_ADDRESS_SIZE); // Clear address initially
+    memset(_transportId, 0, sizeof(_transportId));
 }
 
 void ReticulumNode::setup() {
     // Load config must happen first
-    loadConfig(); // Loads address, packet ID
+    loadConfig(); // Loads address, identity, packet ID
+    runtimeConfig.load(); // Announce interval, route limits, MTUs, WiFi; Config.h defaults if absent
+    _routingTable.setLimits(runtimeConfig.getMaxRoutes(), runtimeConfig.getRouteTimeoutMs());
+    deriveTransportId();
     printNodeAddress();
+    DebugSerial.print("Identity hash: "); Utils::printBytes(_identity.getHash(), Identity::HASH_SIZE, Serial); DebugSerial.println();
     _subscribedGroups = SUBSCRIBED_GROUPS; // Copy groups from Config.h
+    // PLAIN destinations are matched on the first RNS_ADDRESS_SIZE bytes of their hash
+    for (const char* name : SUBSCRIBED_PLAIN_DESTINATIONS) {
+        uint8_t hash[Identity::HASH_SIZE];
+        Identity::destinationHash(name, nullptr, hash);
+        std::array<uint8_t, RNS_ADDRESS_SIZE> group;
+        memcpy(group.data(), hash, RNS_ADDRESS_SIZE);
+        _subscribedGroups.push_back(group);
+    }
+
+    // Event group must exist before interface callbacks can signal it
+    PowerManager::begin();
+    _announceValidator.begin();
+
+    // Lost unicast ESP-NOW frames trigger link retransmission without waiting for ACK timeouts
+    _interfaceManager.setEspNowSendFailureCallback([this](const uint8_t* mac) {
+        _linkManager.handleEspNowSendFailure(mac);
+    });
 
     // Setup interfaces (which also sets up UDP, ESP-NOW etc)
     _interfaceManager.setup();
+    // Link limit comes from the heap left once interface buffers exist
+    _linkManager.begin();
+    restoreState(); // Routes and links saved before the last reboot
 
-    // Initialize timers
-    _last_mem_check_time = millis();
-    // Announce sooner after boot
-    _last_announce_time = millis() - ANNOUNCE_INTERVAL_MS + random(5000, 15000); // Add random delay
-    // Ensure routing table prune timer is initialized
-    _routingTable.prune(nullptr); // Initial call to set timer base
+    // Arm periodic tasks (announce, pruning, memory stats)
+    schedulePeriodicTasks();
 
     DebugSerial.print("Node Setup Complete. Free Heap: "); DebugSerial.println(ESP.getFreeHeap());
 }
 
 void ReticulumNode::loop() {
-    unsigned long now = millis(); // Get time once per loop
-
     _interfaceManager.loop();     // Process interface inputs
-    _linkManager.checkAllTimeouts(); // Check Link timeouts/retransmissions
-    _routingTable.prune(&_interfaceManager); // Prune old routes, pass IfMgr for peer removal
-    sendAnnounceIfNeeded();     // Send periodic announce
-    checkMemoryUsage();         // Check free memory
+    _timers.runExpired();         // Link timeouts, announces, pruning - only what is due
+    applyAnnounceVerdicts();      // Results of background signature checks
+
+#if LOW_POWER_MODE_ENABLED
+    // Block until an interface signals or the next deadline is due; the idle task light-sleeps meanwhile
+    unsigned long idleMs = std::min(_timers.msUntilNext(), _interfaceManager.getMaxIdleMs());
+    PowerManager::waitForEvent(std::min(idleMs, LOW_POWER_MAX_SLEEP_MS));
+#endif
 
     // delay(1); // Generally avoid delay() in main loop if possible
 }
 
 // --- Config Loading/Saving ---
 void ReticulumNode::loadConfig() {
-    if (!EEPROM.begin(EEPROM_SIZE)) {
-        DebugSerial.println("! ERROR: Failed to initialise EEPROM! Using temporary values.");
+    uint16_t packetIdStart = random(0, 0xFFFF); // Unless a reservation or legacy counter is found
+    if (!_stateStore.begin()) {
+        DebugSerial.println("! ERROR: State store unavailable! Using temporary values.");
         generateNodeAddress(); // Generate temp address
-        _packetCounter = random(0,0xFFFF); // Start with random counter
+        _identity.generate();
+        _stateStore.beginPacketIds(packetIdStart);
         return;
     }
-    DebugSerial.println("Loading config from EEPROM...");
-    loadOrGenerateAddress(); // Load or generate node address
-    loadPacketCounter(); // Load last packet counter
-    // EEPROM.end(); // Optional: close EEPROM if not needed constantly
+    DebugSerial.println("Loading state from NVS...");
+    loadOrGenerateAddress(packetIdStart); // Load or generate node address
+    loadOrGenerateIdentity();
+    _stateStore.beginPacketIds(packetIdStart); // Resume after the last reserved block
 }
 
-void ReticulumNode::loadOrGenerateAddress() {
-    bool needsGenerating = false;
-    uint8_t storedAddr[RNS_ADDRESS_SIZE];
-    for (int i = 0; i < RNS_ADDRESS_SIZE; ++i) {
-        storedAddr[i] = EEPROM.read(EEPROM_ADDR_NODE + i);
-    }
-    // Check if address is all 0x00 or all 0xFF (common uninitialized states)
+// Check if address is all 0x00 or all 0xFF (common uninitialized states)
+static bool isUsableAddress(const uint8_t* addr) {
     bool allZeros = true;
     bool allFs = true;
-    for(int i=0; i<RNS_ADDRESS_SIZE; ++i) {
-        if (storedAddr[i] != 0x00) allZeros = false;
-        if (storedAddr[i] != 0xFF) allFs = false;
+    for(size_t i=0; i<RNS_ADDRESS_SIZE; ++i) {
+        if (addr[i] != 0x00) allZeros = false;
+        if (addr[i] != 0xFF) allFs = false;
     }
-    if (allZeros || allFs) {
-        needsGenerating = true;
-        DebugSerial.println("No valid address in EEPROM or first boot.");
+    return !allZeros && !allFs;
+}
+
+void ReticulumNode::loadOrGenerateAddress(uint16_t& packetIdStart) {
+    if (_stateStore.load(StateStore::Record::ADDRESS, _nodeAddress, RNS_ADDRESS_SIZE) == RNS_ADDRESS_SIZE &&
+        isUsableAddress(_nodeAddress)) {
+        DebugSerial.println("Loaded address from NVS.");
+        return;
+    }
+
+    // First boot with NVS: keep the address (and packet numbering) of earlier firmware
+    uint8_t storedAddr[RNS_ADDRESS_SIZE];
+    if (EEPROM.begin(EEPROM_SIZE)) {
+        for (size_t i = 0; i < RNS_ADDRESS_SIZE; ++i) {
+            storedAddr[i] = EEPROM.read(EEPROM_ADDR_NODE + i);
+        }
+        if (isUsableAddress(storedAddr)) {
+            memcpy(_nodeAddress, storedAddr, RNS_ADDRESS_SIZE);
+            uint16_t counter = (EEPROM.read(EEPROM_ADDR_PKTID + 0) << 8) | EEPROM.read(EEPROM_ADDR_PKTID + 1);
+            packetIdStart = counter + 100; // Earlier firmware saved the counter every 100 IDs
+            DebugSerial.println("Migrated address from EEPROM.");
+            saveNodeAddress();
+            return;
+        }
     }
 
-    if (needsGenerating) {
-        generateNodeAddress();
-        saveNodeAddress();
+    DebugSerial.println("No valid address in NVS or first boot.");
+    generateNodeAddress();
+    saveNodeAddress();
+}
+
+void ReticulumNode::loadOrGenerateIdentity() {
+    uint8_t key[Identity::PRIVATE_KEY_SIZE];
+    if (_stateStore.load(StateStore::Record::IDENTITY, key, sizeof(key)) == sizeof(key) &&
+        _identity.loadPrivateKey(key, sizeof(key))) {
+        DebugSerial.println("Loaded identity from NVS.");
     } else {
-        memcpy(_nodeAddress, storedAddr, RNS_ADDRESS_SIZE);
-        DebugSerial.println("Loaded address from EEPROM.");
+        DebugSerial.println("Generating new identity...");
+        _identity.generate();
+        _identity.getPrivateKey(key);
+        _stateStore.stage(StateStore::Record::IDENTITY, key, sizeof(key));
     }
+    memset(key, 0, sizeof(key));
 }
 
 void ReticulumNode::generateNodeAddress() {
@@ -113,46 +166,67 @@ void ReticulumNode::generateNodeAddress() {
 }
 
 void ReticulumNode::saveNodeAddress() {
-    DebugSerial.print("Saving node address to EEPROM: "); printNodeAddress(); // Print before saving
-     // EEPROM.begin required before write if not already called or ended
-     // if (!EEPROM.begin(EEPROM_SIZE)) { DebugSerial.println("! EEPROM begin failed for save!"); return; }
-    for (int i = 0; i < RNS_ADDRESS_SIZE; ++i) {
-        EEPROM.write(EEPROM_ADDR_NODE + i, _nodeAddress[i]);
-    }
-    if (!EEPROM.commit()) {
-        DebugSerial.println("! WARNING: EEPROM commit failed saving address!");
+    DebugSerial.print("Saving node address to NVS: "); printNodeAddress(); // Print before saving
+    if (!_stateStore.stage(StateStore::Record::ADDRESS, _nodeAddress, RNS_ADDRESS_SIZE)) {
+        DebugSerial.println("! WARNING: Failed to save node address!");
     }
-    // EEPROM.end();
 }
 
-void ReticulumNode::loadPacketCounter() {
-    // Manual read for compatibility:
-    _packetCounter = (EEPROM.read(EEPROM_ADDR_PKTID + 0) << 8) | EEPROM.read(EEPROM_ADDR_PKTID + 1);
-    DebugSerial.print("Loaded packet counter start: "); DebugSerial.println(_packetCounter);
-    _packetIdUnsavedCount = 0; // Reset unsaved counter
+// Public method for LinkManager to get next ID
+uint16_t ReticulumNode::getNextPacketId() {
+    return _stateStore.nextPacketId(); // Reserves blocks of IDs, not one flash write per N packets
 }
 
-void ReticulumNode::savePacketCounterIfNeeded() {
-    _packetIdUnsavedCount++;
-    if (_packetIdUnsavedCount >= PACKET_ID_SAVE_INTERVAL) {
-         // DebugSerial.print("Saving packet counter: "); DebugSerial.println(_packetCounter); // Verbose
-         // EEPROM.begin required before write if not already called or ended
-         // if (!EEPROM.begin(EEPROM_SIZE)) { DebugSerial.println("! EEPROM begin failed for save!"); return; }
-         EEPROM.write(EEPROM_ADDR_PKTID + 0, (_packetCounter >> 8) & 0xFF);
-         EEPROM.write(EEPROM_ADDR_PKTID + 1, _packetCounter & 0xFF);
-         if (!EEPROM.commit()) {
-             DebugSerial.println("! WARNING: Failed to save packet counter!");
-         }
-          // EEPROM.end();
-         _packetIdUnsavedCount = 0; // Reset counter
+void ReticulumNode::restoreState() {
+    // A saved announce may have been a refresh still awaiting its background check, so
+    // every one is verified again here, before the loop (and any path response) runs
+    auto checkAnnounce = [this](const uint8_t* destinationHash, const uint8_t* announce, size_t len, bool ratchet) {
+        RnsPacketInfo info;
+        memcpy(info.destination_hash, destinationHash, RNS_TRUNCATED_HASHLENGTH_BYTES);
+        info.data.assign(announce, announce + len);
+        info.context_flag = ratchet;
+        AnnounceValidator::Announce parsed;
+        return AnnounceValidator::parse(info, parsed) && _announceValidator.verify(parsed);
+    };
+    bool restored = _stateStore.loadWith(StateStore::Record::SNAPSHOT, [this, &checkAnnounce](const uint8_t* data, size_t len) {
+        if (!NodeSnapshot::read(data, len, _routingTable, _pathTable, _packetFilter, time(nullptr), _warmStart, checkAnnounce)) {
+            DebugSerial.println("! WARN: Saved snapshot not understood, starting cold.");
+        }
+    });
+    if (restored) {
+        DebugSerial.print("Warm start: "); DebugSerial.print(_warmStart.routes); DebugSerial.print(" routes, ");
+        DebugSerial.print(_warmStart.paths); DebugSerial.print(" paths, ");
+        DebugSerial.print(_warmStart.announces); DebugSerial.print(" identities (");
+        DebugSerial.print(_warmStart.rejected); DebugSerial.print(" failed verification), down ");
+        DebugSerial.print(_warmStart.downtimeMs / 1000); DebugSerial.println(_warmStart.downtimeKnown ? " s" : " s (assumed)");
+    }
+
+    std::vector<uint8_t> peers;
+    _stateStore.loadWith(StateStore::Record::LINKS, [&peers](const uint8_t* data, size_t len) {
+        peers.assign(data, data + len);
+    });
+    if (!peers.empty()) {
+        DebugSerial.print("Reopening "); DebugSerial.print(peers.size() / RNS_ADDRESS_SIZE); DebugSerial.println(" links.");
+    }
+    if (!peers.empty()) {
+        _timers.schedule(STATE_LINK_REOPEN_DELAY_MS, [this, peers]() {
+            _linkManager.reopenLinks(peers.data(), peers.size());
+        });
     }
 }
 
-// Public method for LinkManager to get next ID
-uint16_t ReticulumNode::getNextPacketId() {
-    _packetCounter++;
-    savePacketCounterIfNeeded(); // Throttle EEPROM writes
-    return _packetCounter;
+void ReticulumNode::saveState() {
+    _stateStore.stageWith(StateStore::Record::SNAPSHOT, [this](uint8_t* out, size_t capacity) {
+        return NodeSnapshot::write(out, capacity, _routingTable, _pathTable, _packetFilter, time(nullptr));
+    });
+    _stateStore.stageWith(StateStore::Record::LINKS, [this](uint8_t* out, size_t capacity) {
+        return _linkManager.exportLinkPeers(out, capacity);
+    });
+}
+
+void ReticulumNode::saveStateForRestart() {
+    saveState();
+    _stateStore.flush(); // Written by the time this returns, even if the task is mid-commit
 }
 
 void ReticulumNode::printNodeAddress() {
@@ -161,81 +235,136 @@ void ReticulumNode::printNodeAddress() {
     DebugSerial.println();
 }
 
+// Stable across reboots as long as the node address is. Truncated SHA-256, like
+// Reticulum's own hashes, so it looks like any other transport identity on the wire.
+void ReticulumNode::deriveTransportId() {
+    Identity::truncatedHash(_nodeAddress, RNS_ADDRESS_SIZE, _transportId);
+}
+
+void ReticulumNode::applyRuntimeConfig(const RuntimeConfig& previous) {
+    _routingTable.setLimits(runtimeConfig.getMaxRoutes(), runtimeConfig.getRouteTimeoutMs());
+    _interfaceManager.applyRuntimeConfig(previous);
+    if (runtimeConfig.getAnnounceIntervalMs() != previous.getAnnounceIntervalMs()) {
+        scheduleAnnounces(runtimeConfig.getAnnounceIntervalMs());
+    }
+}
+
 // --- Periodic Tasks ---
+void ReticulumNode::schedulePeriodicTasks() {
+    // Announce sooner after boot (random delay), then every announce interval
+    scheduleAnnounces(random(5000, 15000));
+    // Prune old routes, pass IfMgr for peer removal
+    _timers.schedulePeriodic(PRUNE_INTERVAL_MS, [this]() {
+        _routingTable.prune(&_interfaceManager);
+        _pathTable.expire();
+    });
+    _timers.schedulePeriodic(PACKET_FILTER_ROTATE_MS, [this]() { _packetFilter.rotate(); });
+    _timers.schedulePeriodic(MEM_CHECK_INTERVAL_MS, [this]() { checkMemoryUsage(); });
+    _timers.schedulePeriodic(STATE_SAVE_INTERVAL_MS, [this]() { saveState(); });
+}
+
+void ReticulumNode::scheduleAnnounces(unsigned long firstDelayMs) {
+    _timers.cancel(_announceTimer);
+    _announceTimer = _timers.schedule(firstDelayMs, [this]() {
+        sendAnnounce();
+        _announceTimer = _timers.schedulePeriodic(runtimeConfig.getAnnounceIntervalMs(), [this]() { sendAnnounce(); });
+    });
+}
+
 void ReticulumNode::checkMemoryUsage() {
-    unsigned long now = millis();
-    if (now - _last_mem_check_time > MEM_CHECK_INTERVAL_MS) {
-        DebugSerial.print("[Mem] Free Heap: "); DebugSerial.print(ESP.getFreeHeap());
-        // Add more stats if needed (e.g., Link count, Route count)
-        // DebugSerial.print(" Links: "); DebugSerial.print(_linkManager.getActiveLinkCount()); // Need method in LinkManager
-        // DebugSerial.print(" Routes: "); DebugSerial.print(_routingTable.getRouteCount()); // Need method in RoutingTable
-        DebugSerial.println();
-        _last_mem_check_time = now;
-    }
-}
-
-void ReticulumNode::sendAnnounceIfNeeded() {
-    unsigned long now = millis();
-    // Check if announce interval has passed
-    if (now - _last_announce_time > ANNOUNCE_INTERVAL_MS) {
-        // DebugSerial.println("Generating Announce packet..."); // Verbose
-        RnsPacketInfo announcePkt;
-        announcePkt.header_type = RNS_HEADER_TYPE_ANN;
-        announcePkt.context = RNS_CONTEXT_NONE;
-        announcePkt.packet_id = getNextPacketId(); // Use own method
-        announcePkt.hops = 0;
-        announcePkt.destination_type = RNS_DST_TYPE_GROUP; // Implicit broadcast
-        memset(announcePkt.destination, 0, RNS_ADDRESS_SIZE);
-        announcePkt.source_type = RNS_DST_TYPE_SINGLE;
-        memcpy(announcePkt.source, _nodeAddress, RNS_ADDRESS_SIZE);
-        // announcePkt.payload = {'G','W','v','3'}; // Optional: Add application aspects/version
-
-        uint8_t buffer[MAX_PACKET_SIZE];
-        size_t len = 0;
-        if (ReticulumPacket::serialize(buffer, len,
-            announcePkt.destination, announcePkt.source, announcePkt.destination_type,
-            announcePkt.header_type, announcePkt.context, announcePkt.packet_id,
-            announcePkt.hops, announcePkt.payload, 0)) // No sequence number
-        {
-            _interfaceManager.broadcastAnnounce(buffer, len); // Use InterfaceManager to send
-        } else {
-             DebugSerial.println("! ERROR: Failed to serialize own Announce packet!");
-        }
-        _last_announce_time = now; // Reset timer *after* sending attempt
-        // _routingTable.print(); // Optional: Print table after sending announce
+    DebugSerial.print("[Mem] Free Heap: "); DebugSerial.print(ESP.getFreeHeap());
+    DebugSerial.print(" Links: "); DebugSerial.print(_linkManager.getActiveLinkCount());
+    DebugSerial.print(" Routes: "); DebugSerial.print(_routingTable.getRouteCount());
+    DebugSerial.print(" Timers: "); DebugSerial.print(_timers.getPendingCount());
+    DebugSerial.println();
+}
+
+void ReticulumNode::sendAnnounce() {
+    // DebugSerial.println("Generating Announce packet..."); // Verbose
+    RnsPacketInfo announcePkt;
+    announcePkt.header_type = RNS_HEADER_TYPE_ANN;
+    announcePkt.context = RNS_CONTEXT_NONE;
+    announcePkt.packet_id = getNextPacketId(); // Use own method
+    announcePkt.hops = 0;
+    announcePkt.destination_type = RNS_DST_TYPE_GROUP; // Implicit broadcast
+    memset(announcePkt.destination, 0, RNS_ADDRESS_SIZE);
+    announcePkt.source_type = RNS_DST_TYPE_SINGLE;
+    memcpy(announcePkt.source, _nodeAddress, RNS_ADDRESS_SIZE);
+    // announcePkt.payload = {'G','W','v','3'}; // Optional: Add application aspects/version
+
+    PacketBufferPool::Buffer buffer = PacketBufferPool::acquire();
+    if (!buffer) {
+        DebugSerial.println("! WARN: Packet buffer pool exhausted, announce not sent.");
+        return;
+    }
+    size_t len = 0;
+    if (ReticulumPacket::serialize(buffer.data(), len,
+        announcePkt.destination, announcePkt.source, announcePkt.destination_type,
+        announcePkt.header_type, announcePkt.context, announcePkt.packet_id,
+        announcePkt.hops, announcePkt.payload, 0)) // No sequence number
+    {
+        _packetFilter.checkAndInsert(buffer.data(), len); // Ignore our own announce when neighbours echo it
+        // Own announce: highest priority (0 hops), no jitter
+        _interfaceManager.queueAnnounce(buffer.data(), len, _nodeAddress, 0, 0);
+    } else {
+         DebugSerial.println("! ERROR: Failed to serialize own Announce packet!");
     }
+    // _routingTable.print(); // Optional: Print table after sending announce
 }
 
 // --- Core Packet Handling ---
 void ReticulumNode::handleReceivedPacket(const uint8_t *packetBuffer, size_t packetLen, InterfaceType interface,
                                            const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port)
 {
+    // Frames arrive here with the interface access code already checked and removed
+    // by InterfaceManager, so foreign or forged frames are never parsed
     RnsPacketInfo packetInfo;
+
+    // --- 1. Link Layer Packet Handling ---
+    // Link frames have their own (legacy) layout with source and sequence number
+    if (ReticulumPacket::isLinkFrame(packetBuffer, packetLen)) {
+        if (!ReticulumPacket::deserializeLink(packetBuffer, packetLen, packetInfo)) return;
+        // Ignore packets sourced from self that might have looped back
+        if (Utils::compareAddresses(packetInfo.source, _nodeAddress)) { return; }
+        // Link frames travel one hop, so their sender is the route to the link peer. Replies
+        // and retransmits then go unicast, where ESP-NOW MAC ACKs report a loss at once.
+        if (Utils::compareAddresses(packetInfo.destination, _nodeAddress)) {
+            _routingTable.update(packetInfo, interface, sender_mac, sender_ip, sender_port, &_interfaceManager,
+                                 _interfaceManager.getLastRxLinkQuality());
+        }
+        // DebugSerial.println("Node: Passing packet to Link Manager."); // Verbose
+        _linkManager.processPacket(packetInfo, interface);
+        return; // Link manager handles these exclusively
+    }
+
     if (!ReticulumPacket::deserialize(packetBuffer, packetLen, packetInfo)) {
         // DebugSerial.println("! Deserialize failed in Node. Discarding."); // Verbose
         return;
     }
 
-    // Ignore packets sourced from self that might have looped back
-    if (Utils::compareAddresses(packetInfo.source, _nodeAddress)) { return; }
+    // Seen before (looped back, or heard over several interfaces/neighbours)? Link packets are
+    // exempt above: a retransmitted LINK_DATA must reach the Link so it can be re-ACKed.
+    bool duplicate = _packetFilter.checkAndInsert(packetBuffer, packetLen);
 
-    // --- 1. Link Layer Packet Handling ---
-    if (packetInfo.context == RNS_CONTEXT_LINK_REQ ||
-        packetInfo.context == RNS_CONTEXT_LINK_CLOSE ||
-        packetInfo.context == RNS_CONTEXT_LINK_DATA ||
-        (packetInfo.header_type == RNS_HEADER_TYPE_ACK && packetInfo.context == RNS_CONTEXT_ACK) )
-    {
-        // DebugSerial.println("Node: Passing packet to Link Manager."); // Verbose
-        _linkManager.processPacket(packetInfo, interface);
-        return; // Link manager handles these exclusively
+    // --- 2. Reticulum Transport (official wire format) ---
+    // Link frames were consumed above, so everything from here on is an official packet
+    if (packetInfo.packet_type == RNS_PACKET_ANNOUNCE) {
+        handleTransportAnnounce(packetInfo, interface, duplicate, sender_mac, sender_ip, sender_port);
+        return;
+    }
+    if (packetInfo.packet_type == RNS_PACKET_DATA && packetInfo.destination_type == RNS_DEST_PLAIN &&
+        memcmp(packetInfo.destination_hash, RNS_PATH_REQUEST_HASH, RNS_TRUNCATED_HASHLENGTH_BYTES) == 0) {
+        if (!duplicate) handlePathRequest(packetInfo, interface);
+        return;
+    }
+    if (packetInfo.header_type == RNS_HEADER_2) {
+        if (!duplicate) forwardTransport(packetInfo, interface);
+        return;
     }
 
-    // --- 2. Announce Packet Handling ---
-    if ((packetInfo.header_type & RNS_HEADER_TYPE_MASK) == RNS_HEADER_TYPE_ANN) {
-        // DebugSerial.println("Node: Processing Announce..."); // Verbose
-        _routingTable.update(packetInfo, interface, sender_mac, sender_ip, sender_port, &_interfaceManager);
-        forwardAnnounce(packetInfo, interface); // Attempt re-broadcast
-        return; // Announce handled
+    if (duplicate) {
+        // DebugSerial.println("Node: Duplicate packet dropped."); // Verbose
+        return;
     }
 
     // --- 3. Data / Other Packet Handling (Check Destination) ---
@@ -336,62 +465,293 @@ void ReticulumNode::forwardPacket(const RnsPacketInfo& packetInfo, InterfaceType
         return;
     }
 
-    // Create forwarding packet info (increment hops)
-    RnsPacketInfo forwardInfo = packetInfo; // Creates a copy
-    forwardInfo.hops++;
+    // A single destination the routing table cannot reach: unicast along a transport
+    // path, or ask for one before flooding
+    if (packetInfo.destination_type == RNS_DEST_SINGLE && !_routingTable.findRoute(packetInfo.destination)) {
+        forwardViaPath(packetInfo, incomingInterface);
+        return;
+    }
+    floodPacket(packetInfo, incomingInterface);
+}
 
-    uint8_t forwardBuffer[MAX_PACKET_SIZE];
+// Forwards on the routed interface, or broadcasts on every interface but the incoming one
+void ReticulumNode::floodPacket(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface) {
+    PacketBufferPool::Buffer forwardBuffer = PacketBufferPool::acquire();
+    if (!forwardBuffer) {
+        DebugSerial.println("! WARN: Packet buffer pool exhausted, not forwarding.");
+        return;
+    }
     size_t forwardLen = 0;
-    // Need to serialize using the *original* data payload, not link-processed one
-    if (!ReticulumPacket::serialize(forwardBuffer, forwardLen,
-        forwardInfo.destination, forwardInfo.source, forwardInfo.destination_type,
-        forwardInfo.header_type, forwardInfo.context, forwardInfo.packet_id,
-        forwardInfo.hops, forwardInfo.payload, 0)) // Pass original payload, no sequence num
-    {
+    // Official format, one hop further. Flooded packets are HEADER_1: there is no transport
+    // node left to address.
+    if (!ReticulumPacket::serialize(forwardBuffer.data(), forwardLen, packetInfo.destination_hash, packetInfo.packet_type,
+                                    packetInfo.destination_type, RNS_PROPAGATION_BROADCAST, packetInfo.context,
+                                    packetInfo.hops + 1, packetInfo.data, nullptr, packetInfo.context_flag)) {
         DebugSerial.println("! ERROR: Failed to serialize packet for forwarding!");
         return;
     }
 
-    // DebugSerial.print("Forwarding packet ID "); DebugSerial.print(forwardInfo.packet_id); DebugSerial.print(" Hops "); DebugSerial.println(forwardInfo.hops); // Verbose
+    // DebugSerial.print("Forwarding packet, hops "); DebugSerial.println(packetInfo.hops + 1); // Verbose
     // Use InterfaceManager to send via appropriate interfaces (routing or broadcast)
-    _interfaceManager.sendPacket(forwardBuffer, forwardLen, forwardInfo.destination, incomingInterface);
+    _interfaceManager.sendPacket(forwardBuffer.data(), forwardLen, packetInfo.destination_hash, incomingInterface);
 }
 
-// Handles re-broadcasting/forwarding of Announce packets
-void ReticulumNode::forwardAnnounce(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface) {
-    // Check hop limit (allow MAX_HOPS-1 for forwarding)
-    if (packetInfo.hops >= MAX_HOPS -1) {
-        // DebugSerial.println("Announce hop limit reached for forwarding."); // Verbose
+// --- Reticulum Transport ---
+void ReticulumNode::handleTransportAnnounce(const RnsPacketInfo& packetInfo, InterfaceType interface, bool duplicate,
+                                            const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port) {
+    bool viaTransport = packetInfo.header_type == RNS_HEADER_2;
+    if (viaTransport && memcmp(packetInfo.transport_id, _transportId, RNS_TRUNCATED_HASHLENGTH_BYTES) == 0) {
+        return; // Our own rebroadcast, echoed back by a neighbour
+    }
+
+    const uint8_t* nextHop = viaTransport ? packetInfo.transport_id : packetInfo.destination_hash;
+
+    AnnounceValidator::Announce announce;
+    if (!AnnounceValidator::parse(packetInfo, announce)) {
+        _announcesRejected++;
+        return; // Malformed, or the destination hash is not the announced key's
+    }
+    // Signatures are checked in the background. An announce that would create or move a
+    // path is held until it verifies. A refresh of a path learned from the same key through
+    // the same hop is used at once while its check is queued; if it proves forged,
+    // applyAnnounceVerdicts() drops the path again. One that could not be queued would
+    // never get a verdict, so it is not used at all.
+    float linkQuality = _interfaceManager.getLastRxLinkQuality(); // Of this reception, read before any other
+    const PathTable::Path* known = _pathTable.find(packetInfo.destination_hash);
+    bool refresh = known && memcmp(known->next_hop, nextHop, RNS_TRUNCATED_HASHLENGTH_BYTES) == 0 &&
+                   known->announce.size() >= Identity::PUBLIC_KEY_SIZE &&
+                   memcmp(known->announce.data(), announce.publicKey, Identity::PUBLIC_KEY_SIZE) == 0;
+    uint8_t digest[AnnounceValidator::DIGEST_SIZE];
+    AnnounceValidator::Result result = _announceValidator.verifyDeferred(announce, digest);
+    if (result == AnnounceValidator::Result::INVALID) {
+        _announcesRejected++;
+        return;
+    }
+    if (result == AnnounceValidator::Result::SKIPPED) return; // Unverified; it will be repeated
+    if (!refresh && result == AnnounceValidator::Result::PENDING) {
+        // Wait for the verdict, or drop it if too many are waiting already
+        if (_pendingAnnounces.size() < ANNOUNCE_PENDING_MAX) {
+            PendingAnnounce pending;
+            memcpy(pending.digest, digest, sizeof(pending.digest));
+            pending.packet = packetInfo;
+            pending.interface = interface;
+            pending.duplicate = duplicate;
+            pending.hasSenderMac = sender_mac != nullptr;
+            if (sender_mac) memcpy(pending.senderMac, sender_mac, sizeof(pending.senderMac));
+            pending.senderIp = sender_ip;
+            pending.senderPort = sender_port;
+            pending.linkQuality = linkQuality;
+            _pendingAnnounces.push_back(std::move(pending));
+        }
         return;
     }
+    acceptTransportAnnounce(packetInfo, interface, duplicate, sender_mac, sender_ip, sender_port, linkQuality);
+}
 
-    // Check if this announce was recently forwarded to prevent loops/storms
-    if (!_routingTable.shouldForwardAnnounce(packetInfo.packet_id, packetInfo.source)) {
-         // DebugSerial.println("Announce recently forwarded or loop detected. Skipping re-broadcast."); // Verbose
+void ReticulumNode::acceptTransportAnnounce(const RnsPacketInfo& packetInfo, InterfaceType interface, bool duplicate,
+                                            const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port,
+                                            float linkQuality) {
+    // Packets for the destination go to whoever rebroadcast this announce, or straight
+    // to the destination if it announced itself
+    bool viaTransport = packetInfo.header_type == RNS_HEADER_2;
+    const uint8_t* nextHop = viaTransport ? packetInfo.transport_id : packetInfo.destination_hash;
+    uint8_t hops = packetInfo.hops + 1; // Counting the hop to us
+
+    if (_pathTable.update(packetInfo.destination_hash, nextHop, hops, interface, sender_mac, sender_ip, sender_port)) {
+        _pathTable.cacheAnnounce(packetInfo.destination_hash, packetInfo.data, packetInfo.context_flag);
+        sendAwaitingPath(packetInfo.destination_hash);
+    }
+    // The neighbour it came from becomes a route candidate. Every copy counts: it may have
+    // arrived through another neighbour or interface. Routes are keyed by the first
+    // RNS_ADDRESS_SIZE bytes of the destination hash.
+    RnsPacketInfo routeInfo;
+    memcpy(routeInfo.source, packetInfo.destination_hash, RNS_ADDRESS_SIZE);
+    routeInfo.hops = packetInfo.hops;
+    _routingTable.update(routeInfo, interface, sender_mac, sender_ip, sender_port, &_interfaceManager, linkQuality);
+
+    // Path responses answer one requester; they are not propagated further
+    if (duplicate || hops >= MAX_HOPS || packetInfo.context == RNS_CONTEXT_PATH_RESPONSE) return;
+
+    // Rebroadcast with our transport ID so nodes beyond address their packets through us.
+    // The context flag goes along: it tells receivers the payload holds a ratchet.
+    PacketBufferPool::Buffer buffer = PacketBufferPool::acquire();
+    if (!buffer) {
+        DebugSerial.println("! WARN: Packet buffer pool exhausted, announce not rebroadcast.");
         return;
     }
-    // Mark as forwarded BEFORE sending
-    _routingTable.markAnnounceForwarded(packetInfo.packet_id, packetInfo.source);
+    size_t len = 0;
+    if (!ReticulumPacket::serialize(buffer.data(), len, packetInfo.destination_hash, packetInfo.packet_type,
+                                    packetInfo.destination_type, RNS_PROPAGATION_TRANSPORT, packetInfo.context,
+                                    hops, packetInfo.data, _transportId, packetInfo.context_flag)) {
+        return; // Too large to carry a transport ID
+    }
+    _interfaceManager.queueAnnounce(buffer.data(), len, packetInfo.destination_hash, hops,
+                                    random(0, ANNOUNCE_RANDOM_DELAY_MS));
+}
+
+void ReticulumNode::applyAnnounceVerdicts() {
+    _announceVerdicts.clear();
+    _announceValidator.collect(_announceVerdicts);
+    for (const AnnounceValidator::Verdict& verdict : _announceVerdicts) {
+        // Held announces (every copy heard) go through in arrival order, or are dropped
+        for (size_t i = 0; i < _pendingAnnounces.size();) {
+            PendingAnnounce& pending = _pendingAnnounces[i];
+            if (memcmp(pending.digest, verdict.digest, sizeof(pending.digest)) != 0) {
+                i++;
+                continue;
+            }
+            if (verdict.valid) {
+                acceptTransportAnnounce(pending.packet, pending.interface, pending.duplicate,
+                                        pending.hasSenderMac ? pending.senderMac : nullptr,
+                                        pending.senderIp, pending.senderPort, pending.linkQuality);
+            }
+            _pendingAnnounces.erase(_pendingAnnounces.begin() + i);
+        }
+        if (verdict.valid) continue;
+
+        _announcesRejected++;
+        // Only if the path still rests on the forged announce; a genuine one may have followed
+        const PathTable::Path* path = _pathTable.find(verdict.destinationHash);
+        const size_t randomOffset = Identity::PUBLIC_KEY_SIZE + Identity::NAME_HASH_SIZE;
+        if (path && path->announce.size() >= randomOffset + AnnounceValidator::RANDOM_HASH_SIZE &&
+            memcmp(path->announce.data() + randomOffset, verdict.randomHash, AnnounceValidator::RANDOM_HASH_SIZE) == 0) {
+            DebugSerial.println("! WARN: Forged announce refresh, dropping its path.");
+            _pathTable.remove(verdict.destinationHash);
+        }
+    }
+}
 
-    // Create forwarding packet info (increment hops)
-    RnsPacketInfo forwardInfo = packetInfo;
-    forwardInfo.hops++;
+void ReticulumNode::forwardTransport(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface) {
+    if (memcmp(packetInfo.transport_id, _transportId, RNS_TRUNCATED_HASHLENGTH_BYTES) != 0) {
+        return; // Addressed to another transport node
+    }
+    if (packetInfo.hops >= MAX_HOPS) return;
+    forwardViaPath(packetInfo, incomingInterface);
+}
 
-    uint8_t forwardBuffer[MAX_PACKET_SIZE];
-    size_t forwardLen = 0;
-    // Serialize announce (no sequence number)
-    if (!ReticulumPacket::serialize(forwardBuffer, forwardLen,
-        forwardInfo.destination, forwardInfo.source, forwardInfo.destination_type,
-        forwardInfo.header_type, forwardInfo.context, forwardInfo.packet_id,
-        forwardInfo.hops, forwardInfo.payload, 0))
-    {
-        DebugSerial.println("! ERROR: Failed to serialize announce for forwarding!");
+void ReticulumNode::forwardViaPath(const RnsPacketInfo& packetInfo, InterfaceType incomingInterface) {
+    const PathTable::Path* path = _pathTable.find(packetInfo.destination_hash);
+    if (path) {
+        sendAlongPath(packetInfo, *path);
+        return;
+    }
+    // Hold the packet and ask the network; flooded only if nobody answers. Reached from
+    // handleReceivedPacket(), which runs on the main loop, as do _timers and the queue.
+    if (_pathRequests.enqueue(packetInfo, incomingInterface)) {
+        sendPathRequest(packetInfo.destination_hash);
+    }
+    if (!_timers.isPending(_pathRequestTimer)) {
+        _pathRequestTimer = _timers.schedule(PATH_REQUEST_TIMEOUT_MS / 4, [this]() { processPathRequests(); });
+    }
+}
+
+void ReticulumNode::sendAlongPath(const RnsPacketInfo& packetInfo, const PathTable::Path& path) {
+    PacketBufferPool::Buffer buffer = PacketBufferPool::acquire();
+    if (!buffer) {
+        DebugSerial.println("! WARN: Packet buffer pool exhausted, not forwarding.");
+        return;
+    }
+    // Further transport hops: readdress to the next transport node. Last hop: the
+    // destination is our neighbour, so hand it a plain HEADER_1 packet.
+    bool lastHop = path.hops <= 1;
+    size_t len = 0;
+    if (!ReticulumPacket::serialize(buffer.data(), len, packetInfo.destination_hash, packetInfo.packet_type,
+                                    packetInfo.destination_type, RNS_PROPAGATION_BROADCAST, packetInfo.context,
+                                    packetInfo.hops + 1, packetInfo.data, lastHop ? nullptr : path.next_hop,
+                                    packetInfo.context_flag)) {
+        DebugSerial.println("! ERROR: Failed to serialize transport packet for forwarding!");
+        return;
+    }
+    // Unicast to the neighbour the path was learned from instead of flooding every interface
+    _interfaceManager.sendPacketViaCandidate(path.via, buffer.data(), len, packetInfo.destination);
+    _transportForwarded++;
+}
+
+void ReticulumNode::sendAwaitingPath(const uint8_t* destinationHash) {
+    if (_pathRequests.empty()) return;
+    const PathTable::Path* path = _pathTable.find(destinationHash);
+    if (!path) return;
+    std::vector<PathRequestQueue::Pending> ready;
+    _pathRequests.take(destinationHash, ready);
+    for (const auto& pending : ready) sendAlongPath(pending.packet, *path);
+}
+
+// Path request: DATA to the PLAIN rnstransport.path.request destination carrying
+// [target hash 16][our transport ID 16][random tag 16]
+void ReticulumNode::sendPathRequest(const uint8_t* destinationHash) {
+    std::vector<uint8_t> data(destinationHash, destinationHash + RNS_TRUNCATED_HASHLENGTH_BYTES);
+    data.insert(data.end(), _transportId, _transportId + RNS_TRUNCATED_HASHLENGTH_BYTES);
+    for (size_t i = 0; i < RNS_TRUNCATED_HASHLENGTH_BYTES; i += 4) {
+        uint32_t tag = esp_random();
+        data.insert(data.end(), (uint8_t*)&tag, (uint8_t*)&tag + 4);
+    }
+
+    PacketBufferPool::Buffer buffer = PacketBufferPool::acquire();
+    if (!buffer) {
+        DebugSerial.println("! WARN: Packet buffer pool exhausted, path request not sent.");
+        return;
+    }
+    size_t len = 0;
+    if (!ReticulumPacket::serialize(buffer.data(), len, RNS_PATH_REQUEST_HASH, RNS_PACKET_DATA, RNS_DEST_PLAIN,
+                                    RNS_PROPAGATION_BROADCAST, RNS_CONTEXT_NONE, 0, data)) {
+        return;
+    }
+    _packetFilter.checkAndInsert(buffer.data(), len); // Ignore neighbours passing it back
+    _interfaceManager.sendPacket(buffer.data(), len, RNS_PATH_REQUEST_HASH, InterfaceType::UNKNOWN);
+    _pathRequestsSent++;
+}
+
+void ReticulumNode::handlePathRequest(const RnsPacketInfo& packetInfo, InterfaceType interface) {
+    const std::vector<uint8_t>& data = packetInfo.data;
+    if (data.size() <= RNS_TRUNCATED_HASHLENGTH_BYTES) return; // Untagged requests are ignored, as in Reticulum
+    const uint8_t* target = data.data();
+    const uint8_t* requester = data.size() > 2 * RNS_TRUNCATED_HASHLENGTH_BYTES ? data.data() + RNS_TRUNCATED_HASHLENGTH_BYTES : nullptr;
+
+    PacketBufferPool::Buffer buffer = PacketBufferPool::acquire();
+    if (!buffer) {
+        DebugSerial.println("! WARN: Packet buffer pool exhausted, path request not handled.");
+        return;
+    }
+    size_t len = 0;
+
+    const PathTable::Path* path = _pathTable.find(target);
+    if (path && !path->announce.empty()) {
+        // A path leading back through the requester is of no use to it
+        if (requester && memcmp(path->next_hop, requester, RNS_TRUNCATED_HASHLENGTH_BYTES) == 0) return;
+        // Replay the cached announce as a path response, through us, on the requesting interface only
+        if (!ReticulumPacket::serialize(buffer.data(), len, target, RNS_PACKET_ANNOUNCE, RNS_DEST_SINGLE,
+                                        RNS_PROPAGATION_TRANSPORT, RNS_CONTEXT_PATH_RESPONSE, path->hops,
+                                        path->announce, _transportId, path->ratchet)) {
+            return;
+        }
+        _interfaceManager.sendPacketVia(interface, buffer.data(), len, nullptr);
+        _pathResponsesSent++;
         return;
     }
 
-    // DebugSerial.print("Re-broadcasting Announce ID "); DebugSerial.print(forwardInfo.packet_id); DebugSerial.print(" Hops "); DebugSerial.println(forwardInfo.hops); // Verbose
-    // Announce should be broadcast, not routed to specific dest
-    _interfaceManager.broadcastAnnounce(forwardBuffer, forwardLen);
+    // Unknown here: pass the request on so transport nodes further out can answer
+    if (packetInfo.hops + 1 >= MAX_HOPS) return;
+    if (ReticulumPacket::serialize(buffer.data(), len, RNS_PATH_REQUEST_HASH, RNS_PACKET_DATA, RNS_DEST_PLAIN,
+                                   RNS_PROPAGATION_BROADCAST, RNS_CONTEXT_NONE, packetInfo.hops + 1, data)) {
+        _interfaceManager.sendPacket(buffer.data(), len, RNS_PATH_REQUEST_HASH, interface);
+    }
+}
+
+void ReticulumNode::processPathRequests() {
+    std::vector<std::array<uint8_t, RNS_TRUNCATED_HASHLENGTH_BYTES>> retry;
+    std::vector<PathRequestQueue::Pending> expired;
+    _pathRequests.poll(retry, expired);
+
+    for (const auto& hash : retry) sendPathRequest(hash.data());
+    for (const auto& pending : expired) {
+        // Nobody knows a path: fall back to flooding
+        _pathFallbackFloods++;
+        floodPacket(pending.packet, pending.incoming);
+    }
+
+    if (!_pathRequests.empty()) {
+        _pathRequestTimer = _timers.schedule(PATH_REQUEST_TIMEOUT_MS / 4, [this]() { processPathRequests(); });
+    }
 }
 
 // --- Application Layer Integration ---
@@ -6,7 +6,8 @@
 namespace ReticulumPacket {
 
 // Deserialize packet from official Reticulum wire format
-// Format: [FLAGS 1] [HOPS 1] [DEST_HASH 16] [CONTEXT 1] [DATA]
+// HEADER_1: [FLAGS 1] [HOPS 1] [DEST_HASH 16] [CONTEXT 1] [DATA]
+// HEADER_2: [FLAGS 1] [HOPS 1] [TRANSPORT_ID 16] [DEST_HASH 16] [CONTEXT 1] [DATA]
 bool deserialize(const uint8_t *buffer, size_t len, RnsPacketInfo &info) {
     info.valid = false;
 
@@ -21,23 +22,36 @@ bool deserialize(const uint8_t *buffer, size_t len, RnsPacketInfo &info) {
 
     info.hops = buffer[1];
 
+    size_t offset = 2;
+    if (info.header_type == RNS_HEADER_2) {
+        if (len < RNS_HEADER_2_SIZE) {
+            DebugSerial.println("! Deserialize Error: HEADER_2 packet too short.");
+            return false;
+        }
+        // Transport node the sender addressed this packet to
+        memcpy(info.transport_id, buffer + offset, RNS_TRUNCATED_HASHLENGTH_BYTES);
+        offset += RNS_TRUNCATED_HASHLENGTH_BYTES;
+    } else {
+        memset(info.transport_id, 0, RNS_TRUNCATED_HASHLENGTH_BYTES);
+    }
+
     // Copy 16-byte destination hash
-    memcpy(info.destination_hash, buffer + 2, RNS_TRUNCATED_HASHLENGTH_BYTES);
+    memcpy(info.destination_hash, buffer + offset, RNS_TRUNCATED_HASHLENGTH_BYTES);
 
     // Also populate legacy 8-byte destination field with first 8 bytes of hash
-    memcpy(info.destination, buffer + 2, RNS_ADDRESS_SIZE);
+    memcpy(info.destination, buffer + offset, RNS_ADDRESS_SIZE);
+    offset += RNS_TRUNCATED_HASHLENGTH_BYTES;
 
-    info.context = buffer[18];  // After flags(1) + hops(1) + dest_hash(16)
+    info.context = buffer[offset++];
 
     // Extract data payload (everything after context byte)
-    size_t data_start = 19;
-    if (len > data_start) {
-        info.data.assign(buffer + data_start, buffer + len);
+    if (len > offset) {
+        info.data.assign(buffer + offset, buffer + len);
         info.payload = info.data;  // Also populate legacy payload field
     }
 
-    // Source address is not present in DATA packets (official Reticulum format)
-    // It would only be added by transport nodes (Header 2), which we don't handle yet
+    // Source address is not present in the official format; transport nodes
+    // (HEADER_2) add the next hop's transport ID, not the sender's address
     memset(info.source, 0, RNS_ADDRESS_SIZE);
 
     info.packet_len = len;
@@ -47,7 +61,7 @@ bool deserialize(const uint8_t *buffer, size_t len, RnsPacketInfo &info) {
 }
 
 // Serialize packet using official Reticulum wire format
-// Format: [FLAGS 1] [HOPS 1] [DEST_HASH 16] [CONTEXT 1] [DATA]
+// HEADER_1 unless transport_id is given, then HEADER_2 (see header for layouts)
 bool serialize(uint8_t *buffer, size_t &len,
                const uint8_t* dest_hash_16bytes,
                uint8_t packet_type,
@@ -55,7 +69,9 @@ bool serialize(uint8_t *buffer, size_t &len,
                uint8_t propagation_type,
                uint8_t context,
                uint8_t hops,
-               const std::vector<uint8_t>& data)
+               const std::vector<uint8_t>& data,
+               const uint8_t* transport_id,
+               bool context_flag)
 {
     len = 0;
 
@@ -69,7 +85,8 @@ bool serialize(uint8_t *buffer, size_t &len,
         return false;
     }
 
-    size_t total_len = RNS_HEADER_1_SIZE + data.size();
+    size_t header_len = transport_id ? RNS_HEADER_2_SIZE : RNS_HEADER_1_SIZE;
+    size_t total_len = header_len + data.size();
     if (total_len > MAX_PACKET_SIZE) {
         DebugSerial.println("! Serialize Error: Total packet exceeds max size.");
         return false;
@@ -77,22 +94,30 @@ bool serialize(uint8_t *buffer, size_t &len,
 
     // Build flags byte
     // Format: [IFAC:1][HeaderType:1][ContextFlag:1][PropType:1][DestType:2][PacketType:2]
+    uint8_t header_type = transport_id ? RNS_HEADER_2 : RNS_HEADER_1;
+    if (transport_id) propagation_type = RNS_PROPAGATION_TRANSPORT;
     uint8_t flags = (packet_type & 0b11) |
                     ((dest_type & 0b11) << 2) |
                     ((propagation_type & 0b1) << 4) |
-                    (0 << 5) |  // context_flag = 0 (unused)
-                    (0 << 6) |  // header_type = 0 (HEADER_1)
+                    ((context_flag ? 1 : 0) << 5) |
+                    (header_type << 6) |
                     (0 << 7);   // ifac_flag = 0 (no IFAC)
 
     // Assemble packet
-    buffer[0] = flags;
-    buffer[1] = hops;
-    memcpy(buffer + 2, dest_hash_16bytes, RNS_TRUNCATED_HASHLENGTH_BYTES);
-    buffer[18] = context;
+    size_t offset = 0;
+    buffer[offset++] = flags;
+    buffer[offset++] = hops;
+    if (transport_id) {
+        memcpy(buffer + offset, transport_id, RNS_TRUNCATED_HASHLENGTH_BYTES);
+        offset += RNS_TRUNCATED_HASHLENGTH_BYTES;
+    }
+    memcpy(buffer + offset, dest_hash_16bytes, RNS_TRUNCATED_HASHLENGTH_BYTES);
+    offset += RNS_TRUNCATED_HASHLENGTH_BYTES;
+    buffer[offset++] = context;
 
     // Copy data payload if present
     if (!data.empty()) {
-        memcpy(buffer + 19, data.data(), data.size());
+        memcpy(buffer + offset, data.data(), data.size());
     }
 
     len = total_len;
@@ -113,6 +138,22 @@ bool serialize(uint8_t *buffer, size_t &len,
                uint8_t hops,
                const std::vector<uint8_t>& payload,
                uint16_t sequence_number)
+{
+    return serialize(buffer, len, destination, source, destination_type, header_type, context,
+                     packet_id, hops, payload.data(), payload.size(), sequence_number);
+}
+
+bool serialize(uint8_t *buffer, size_t &len,
+               const uint8_t* destination,
+               const uint8_t* source,
+               uint8_t destination_type,
+               uint8_t header_type,
+               uint8_t context,
+               uint16_t packet_id,
+               uint8_t hops,
+               const uint8_t* payload,
+               size_t payload_len,
+               uint16_t sequence_number)
 {
     len = 0;
     if (!buffer || !destination || !source) {
@@ -146,13 +187,13 @@ bool serialize(uint8_t *buffer, size_t &len,
     buffer[offset++] = sequence_number & 0xFF;
 
     // Add payload
-    if (!payload.empty()) {
-        if (offset + payload.size() > MAX_PACKET_SIZE) {
+    if (payload_len > 0) {
+        if (!payload || offset + payload_len > MAX_PACKET_SIZE) {
             DebugSerial.println("! Legacy Serialize Error: Payload too large.");
             return false;
         }
-        memcpy(buffer + offset, payload.data(), payload.size());
-        offset += payload.size();
+        memcpy(buffer + offset, payload, payload_len);
+        offset += payload_len;
     }
 
     len = offset;
@@ -166,7 +207,9 @@ bool serialize_control(uint8_t *buffer, size_t &len,
                        uint8_t header_type,
                        uint8_t context,
                        uint16_t packet_id,
-                       uint16_t sequence_number)
+                       uint16_t sequence_number,
+                       const uint8_t* extra,
+                       size_t extra_len)
 {
     len = 0;
     if (!buffer || !destination || !source) {
@@ -196,8 +239,66 @@ bool serialize_control(uint8_t *buffer, size_t &len,
     buffer[offset++] = (sequence_number >> 8) & 0xFF;
     buffer[offset++] = sequence_number & 0xFF;
 
+    if (extra && extra_len > 0) {
+        memcpy(buffer + offset, extra, extra_len);
+        offset += extra_len;
+    }
+
     len = offset;
     return true;
 }
 
+// Offsets of the legacy fields (see serialize above)
+static const size_t LEGACY_DST_TYPE_OFFSET = 5;
+static const size_t LEGACY_DEST_OFFSET = LEGACY_DST_TYPE_OFFSET + 2;
+static const size_t LEGACY_SRC_TYPE_OFFSET = LEGACY_DEST_OFFSET + RNS_ADDRESS_SIZE;
+static const size_t LEGACY_SRC_OFFSET = LEGACY_SRC_TYPE_OFFSET + 2;
+
+bool isLinkFrame(const uint8_t *buffer, size_t len) {
+    if (!buffer || len < RNS_LEGACY_HEADER_SIZE + RNS_SEQ_SIZE) return false;
+    // Byte 1 is the hop count of an official packet, which never gets near these values
+    uint8_t context = buffer[1];
+    if (context != RNS_CONTEXT_LINK_REQ && context != RNS_CONTEXT_LINK_CLOSE &&
+        context != RNS_CONTEXT_LINK_DATA && context != RNS_CONTEXT_ACK) {
+        return false;
+    }
+    return (buffer[0] & ~(RNS_HEADER_TYPE_MASK | RNS_HEADER_FLAG_REQUEST_ACK_MASK | RNS_HEADER_FLAG_PIGGYBACK_ACK_MASK)) == 0 &&
+           buffer[LEGACY_DST_TYPE_OFFSET] <= RNS_DST_TYPE_GROUP &&
+           buffer[LEGACY_DST_TYPE_OFFSET + 1] == RNS_ADDRESS_SIZE &&
+           buffer[LEGACY_SRC_TYPE_OFFSET] == RNS_DST_TYPE_SINGLE &&
+           buffer[LEGACY_SRC_TYPE_OFFSET + 1] == RNS_ADDRESS_SIZE;
+}
+
+// Deserialize a link frame
+// [HEADER_TYPE 1] [CONTEXT 1] [PACKET_ID 2] [HOPS 1] [DST_TYPE 1] [DST_LEN 1] [DEST 8]
+// [SRC_TYPE 1] [SRC_LEN 1] [SRC 8] [SEQ_NUM 2] [PAYLOAD...]
+bool deserializeLink(const uint8_t *buffer, size_t len, RnsPacketInfo &info) {
+    info.valid = false;
+    if (!isLinkFrame(buffer, len)) {
+        DebugSerial.println("! Deserialize Error: Not a link frame.");
+        return false;
+    }
+
+    info.header_type = buffer[0];
+    info.context = buffer[1];
+    info.packet_id = ((uint16_t)buffer[2] << 8) | buffer[3];
+    info.hops = buffer[4];
+    info.destination_type = buffer[LEGACY_DST_TYPE_OFFSET];
+    memcpy(info.destination, buffer + LEGACY_DEST_OFFSET, RNS_ADDRESS_SIZE);
+    info.source_type = buffer[LEGACY_SRC_TYPE_OFFSET];
+    memcpy(info.source, buffer + LEGACY_SRC_OFFSET, RNS_ADDRESS_SIZE);
+
+    size_t offset = RNS_LEGACY_HEADER_SIZE;
+    info.sequence_number = ((uint16_t)buffer[offset] << 8) | buffer[offset + 1];
+    offset += RNS_SEQ_SIZE;
+
+    // Sealed data for LINK_DATA, the ephemeral key for a handshake REQ/ACK
+    info.data.assign(buffer + offset, buffer + len);
+    info.payload = info.data;
+
+    info.packet_len = len;
+    info.valid = true;
+    return true;
+}
+
 } // namespace ReticulumPacket
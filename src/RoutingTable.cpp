@@ -7,11 +7,102 @@
 #include <cstring>   // For memcpy
 
 // Constructor
-RoutingTable::RoutingTable() : _last_prune_time(0), _last_recent_announce_prune(0) {}
+RoutingTable::RoutingTable() : _maxRoutes(MAX_ROUTES), _timeoutMs(ROUTE_TIMEOUT_MS) {}
+
+void RoutingTable::setLimits(size_t maxRoutes, unsigned long timeoutMs) {
+    _maxRoutes = std::max<size_t>(1, std::min(maxRoutes, MAX_ROUTES));
+    _timeoutMs = timeoutMs;
+}
+
+// Slow or duty-cycled interfaces cost extra, roughly one hop per order of magnitude in bandwidth
+static float interfaceCost(InterfaceType interface) {
+    switch (interface) {
+        case InterfaceType::ESP_NOW:
+        case InterfaceType::WIFI_UDP:    return 0.0f;
+        case InterfaceType::SERIAL_PORT:
+        case InterfaceType::BLUETOOTH:   return 0.5f;
+        case InterfaceType::LORA:        return 2.0f;
+        case InterfaceType::HAM_MODEM:   return 4.0f;
+        default:                         return 1.0f;
+    }
+}
+
+static bool sameNextHop(const RouteCandidate& c, InterfaceType interface, const uint8_t* mac, const IPAddress& ip) {
+    if (c.interface != interface) return false;
+    if (interface == InterfaceType::ESP_NOW) return memcmp(c.next_hop_mac, mac, 6) == 0;
+    if (interface == InterfaceType::WIFI_UDP) return c.next_hop_ip == ip;
+    return true; // Broadcast interfaces: one candidate per interface
+}
+
+float RoutingTable::candidateCost(const RouteCandidate& candidate, unsigned long now) const {
+    float ratio = candidate.delivery_ratio > 0.0f ? candidate.delivery_ratio : 1.0f / ROUTE_ETX_MAX;
+    float cost = (candidate.hops + 1) * (1.0f / ratio) + interfaceCost(candidate.interface);
+    if (candidate.link_quality >= 0.0f) {
+        cost += (1.0f - candidate.link_quality) * ROUTE_COST_SIGNAL_WEIGHT;
+    }
+    unsigned long age = now - candidate.last_heard_time;
+    if (age > _timeoutMs) age = _timeoutMs;
+    if (_timeoutMs > 0) cost += ((float)age / (float)_timeoutMs) * ROUTE_COST_AGE_WEIGHT;
+    if (isCandidateDown(candidate, now)) cost += ROUTE_DOWN_COST_PENALTY;
+    return cost;
+}
+
+bool RoutingTable::isCandidateDown(const RouteCandidate& candidate, unsigned long now) {
+    return candidate.consecutive_failures >= ROUTE_FAILOVER_FAILURES &&
+           now - candidate.last_failure_time < ROUTE_FAILOVER_HOLDDOWN_MS;
+}
+
+void RoutingTable::selectCandidate(RouteEntry& entry, unsigned long now, bool force) {
+    if (entry.candidate_count == 0) return;
+    if (entry.active_candidate >= entry.candidate_count) {
+        entry.active_candidate = 0;
+        force = true;
+    }
+
+    uint8_t best = entry.active_candidate;
+    float activeCost = candidateCost(entry.candidates[entry.active_candidate], now);
+    float bestCost = activeCost;
+    for (uint8_t i = 0; i < entry.candidate_count; i++) {
+        float cost = candidateCost(entry.candidates[i], now);
+        if (cost < bestCost) { best = i; bestCost = cost; }
+    }
+    // Hysteresis: similar paths must not flap with every announce
+    if (best != entry.active_candidate && (force || bestCost < activeCost * (1.0f - ROUTE_SWITCH_HYSTERESIS))) {
+        // DebugSerial.print("RT: Switching route to "); Utils::printBytes(entry.destination_addr, RNS_ADDRESS_SIZE, Serial); DebugSerial.print(" to If="); DebugSerial.println(static_cast<int>(entry.candidates[best].interface)); // Verbose
+        entry.active_candidate = best;
+        activeCost = bestCost;
+    }
+
+    const RouteCandidate& active = entry.candidates[entry.active_candidate];
+    memcpy(entry.next_hop_mac, active.next_hop_mac, 6);
+    entry.next_hop_ip = active.next_hop_ip;
+    entry.next_hop_port = active.next_hop_port;
+    entry.last_heard_time = active.last_heard_time;
+    entry.interface = active.interface;
+    entry.hops = active.hops;
+    entry.cost = activeCost;
+}
+
+void RoutingTable::removeCandidate(RouteEntry& entry, uint8_t index, InterfaceManager* ifManager) {
+    if (index >= entry.candidate_count) return;
+    // If it was an ESP-NOW next hop, remove the peer to avoid stale entries
+    if (ifManager && entry.candidates[index].interface == InterfaceType::ESP_NOW) {
+        ifManager->removeEspNowPeer(entry.candidates[index].next_hop_mac);
+    }
+    for (uint8_t i = index; i + 1 < entry.candidate_count; i++) {
+        entry.candidates[i] = entry.candidates[i + 1];
+    }
+    entry.candidate_count--;
+    if (entry.active_candidate > index) {
+        entry.active_candidate--;
+    } else if (entry.active_candidate == index) {
+        entry.active_candidate = ROUTE_MAX_CANDIDATES; // Forces reselection
+    }
+}
 
 void RoutingTable::update(const RnsPacketInfo &announcePacket, InterfaceType interface,
                            const uint8_t* sender_mac, const IPAddress& sender_ip, uint16_t sender_port,
-                           InterfaceManager* ifManager)
+                           InterfaceManager* ifManager, float linkQuality)
 {
     // Validate sender info based on interface
     if (interface == InterfaceType::ESP_NOW && !sender_mac) return;
@@ -19,77 +110,140 @@ void RoutingTable::update(const RnsPacketInfo &announcePacket, InterfaceType int
     if (interface == InterfaceType::WIFI_UDP && (!sender_ip || sender_ip == INADDR_NONE || sender_ip[0] == 0)) return;
 
     unsigned long now = millis();
-    bool found = false;
 
-    // Check if route already exists
-    for (auto it = _routes.begin(); it != _routes.end(); ++it) {
-        if (Utils::compareAddresses(it->destination_addr, announcePacket.source)) {
-            // Route exists. Update if new info is better or from different interface?
-            // Simple strategy: Always update timestamp, interface, hops, next hop.
-            // More complex: Update only if hops are lower or similar but timestamp newer.
-            // Current: Always update with latest info.
-            it->last_heard_time = now;
-            it->interface = interface;
-            it->hops = announcePacket.hops;
-
-            if (interface == InterfaceType::ESP_NOW) {
-                memcpy(it->next_hop_mac, sender_mac, 6);
-                it->next_hop_ip = IPAddress(); // Clear IP
-                it->next_hop_port = 0;
-            } else if (interface == InterfaceType::WIFI_UDP) {
-                 it->next_hop_ip = sender_ip;
-                 it->next_hop_port = RNS_UDP_PORT; // Assume standard RNS port for outgoing
-                 memset(it->next_hop_mac, 0, 6);   // Clear MAC
-            }
-            found = true;
-            break;
-        }
-    }
-
-    // If not found, add new route if space allows
-    if (!found) {
-        if (_routes.size() < MAX_ROUTES) {
-            // DebugSerial.print("RT: Adding new route for "); Utils::printBytes(announcePacket.source, RNS_ADDRESS_SIZE, Serial); // Verbose
-            RouteEntry newEntry;
-            memcpy(newEntry.destination_addr, announcePacket.source, RNS_ADDRESS_SIZE);
-            newEntry.last_heard_time = now;
-            newEntry.interface = interface;
-            newEntry.hops = announcePacket.hops;
-
-             if (interface == InterfaceType::ESP_NOW) {
-                memcpy(newEntry.next_hop_mac, sender_mac, 6);
-            } else if (interface == InterfaceType::WIFI_UDP) {
-                 newEntry.next_hop_ip = sender_ip;
-                 newEntry.next_hop_port = RNS_UDP_PORT;
-            }
-            // DebugSerial.print(" via If="); DebugSerial.print(static_cast<int>(interface)); DebugSerial.print(" Hops="); DebugSerial.println(newEntry.hops); // Verbose
-            _routes.push_back(newEntry);
-        } else {
+    RouteEntry* entry = findRoute(announcePacket.source);
+    if (!entry) {
+        if (_routes.size() >= _maxRoutes) {
             // Table full - Replace oldest entry
             auto oldest_it = std::min_element(_routes.begin(), _routes.end(),
                 [](const RouteEntry& a, const RouteEntry& b) {
-                    return a.last_heard_time < b.last_heard_time;
+                    return (long)(a.last_heard_time - b.last_heard_time) < 0; // Restored routes may predate boot
                 });
+            DebugSerial.print("! RT Full. Replacing oldest route to "); Utils::printBytes(oldest_it->destination_addr, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
+            while (oldest_it->candidate_count > 0) removeCandidate(*oldest_it, oldest_it->candidate_count - 1, ifManager);
+            entry = &(*oldest_it);
+        } else {
+            // DebugSerial.print("RT: Adding new route for "); Utils::printBytes(announcePacket.source, RNS_ADDRESS_SIZE, Serial); // Verbose
+            _routes.emplace_back();
+            entry = &_routes.back();
+        }
+        memcpy(entry->destination_addr, announcePacket.source, RNS_ADDRESS_SIZE);
+        entry->candidate_count = 0;
+        entry->active_candidate = 0;
+    }
 
-              if (oldest_it != _routes.end()) {
-                 DebugSerial.print("! RT Full. Replacing oldest route to "); Utils::printBytes(oldest_it->destination_addr, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
-                  // If replacing an ESP-NOW route, remove the old peer to avoid stale entries.
-                  if (ifManager && oldest_it->interface == InterfaceType::ESP_NOW) {
-                     ifManager->removeEspNowPeer(oldest_it->next_hop_mac);
-                  }
-
-                // Overwrite the oldest entry with new data
-                memcpy(oldest_it->destination_addr, announcePacket.source, RNS_ADDRESS_SIZE);
-                oldest_it->last_heard_time = now;
-                oldest_it->interface = interface;
-                oldest_it->hops = announcePacket.hops;
-                 if (interface == InterfaceType::ESP_NOW) { memcpy(oldest_it->next_hop_mac, sender_mac, 6); oldest_it->next_hop_ip=IPAddress(); oldest_it->next_hop_port=0; }
-                 else if (interface == InterfaceType::WIFI_UDP) { oldest_it->next_hop_ip = sender_ip; oldest_it->next_hop_port=RNS_UDP_PORT; memset(oldest_it->next_hop_mac,0,6); }
-            } else {
-                 DebugSerial.println("! RT Full. Error finding oldest route to replace."); // Should not happen if list not empty
+    // Find this next hop among the candidates, or make room for it
+    RouteCandidate* candidate = nullptr;
+    for (uint8_t i = 0; i < entry->candidate_count; i++) {
+        if (sameNextHop(entry->candidates[i], interface, sender_mac, sender_ip)) {
+            candidate = &entry->candidates[i];
+            break;
+        }
+    }
+    if (!candidate) {
+        if (entry->candidate_count >= ROUTE_MAX_CANDIDATES) {
+            // Drop the most expensive candidate other than the active one
+            uint8_t worst = entry->active_candidate == 0 ? 1 : 0;
+            for (uint8_t i = 0; i < entry->candidate_count; i++) {
+                if (i != entry->active_candidate &&
+                    candidateCost(entry->candidates[i], now) > candidateCost(entry->candidates[worst], now)) {
+                    worst = i;
+                }
             }
+            removeCandidate(*entry, worst, ifManager);
+        }
+        candidate = &entry->candidates[entry->candidate_count++];
+        candidate->interface = interface;
+        candidate->delivery_ratio = 1.0f; // No ACK history yet: assume a perfect link
+        candidate->link_quality = ROUTE_LINK_QUALITY_UNKNOWN;
+        candidate->consecutive_failures = 0;
+        candidate->last_failure_time = 0;
+        memset(candidate->next_hop_mac, 0, 6);
+        candidate->next_hop_ip = IPAddress();
+        candidate->next_hop_port = 0;
+        if (interface == InterfaceType::ESP_NOW) {
+            memcpy(candidate->next_hop_mac, sender_mac, 6);
+        } else if (interface == InterfaceType::WIFI_UDP) {
+            candidate->next_hop_ip = sender_ip;
+            candidate->next_hop_port = RNS_UDP_PORT; // Assume standard RNS port for outgoing
         }
     }
+    candidate->hops = announcePacket.hops;
+    candidate->last_heard_time = now;
+    if (linkQuality >= 0.0f) candidate->link_quality = linkQuality;
+
+    selectCandidate(*entry, now, entry->candidate_count == 1);
+}
+
+void RoutingTable::recordCandidateResult(RouteEntry& entry, uint8_t index, bool success, unsigned long now) {
+    RouteCandidate& candidate = entry.candidates[index];
+    if (success) {
+        candidate.consecutive_failures = 0;
+        return;
+    }
+    if (candidate.consecutive_failures < 255) candidate.consecutive_failures++;
+    candidate.last_failure_time = now;
+    if (index == entry.active_candidate && isCandidateDown(candidate, now)) {
+        selectCandidate(entry, now, true); // No hysteresis: the active next hop is dark
+        if (entry.active_candidate != index) {
+            DebugSerial.print("RT: Next hop down, failing over route to "); Utils::printBytes(entry.destination_addr, RNS_ADDRESS_SIZE, Serial);
+            DebugSerial.print(" via If="); DebugSerial.println(static_cast<int>(entry.interface));
+        }
+    }
+}
+
+void RoutingTable::reportDelivery(const uint8_t *destination_addr, bool success) {
+    RouteEntry* entry = findRoute(destination_addr);
+    if (!entry || entry->active_candidate >= entry->candidate_count) return;
+
+    unsigned long now = millis();
+    uint8_t index = entry->active_candidate;
+    RouteCandidate& active = entry->candidates[index];
+    active.delivery_ratio = (1.0f - ROUTE_ETX_ALPHA) * active.delivery_ratio + (success ? ROUTE_ETX_ALPHA : 0.0f);
+    if (active.delivery_ratio < 1.0f / ROUTE_ETX_MAX) active.delivery_ratio = 1.0f / ROUTE_ETX_MAX;
+    recordCandidateResult(*entry, index, success, now);
+    selectCandidate(*entry, now, false);
+}
+
+void RoutingTable::reportNextHopResult(InterfaceType interface, const uint8_t* mac, const IPAddress& ip, bool success,
+                                       float linkQuality) {
+    if (interface == InterfaceType::ESP_NOW && !mac) return;
+    unsigned long now = millis();
+    for (auto& entry : _routes) {
+        for (uint8_t i = 0; i < entry.candidate_count; i++) {
+            if (sameNextHop(entry.candidates[i], interface, mac, ip)) {
+                if (linkQuality >= 0.0f) entry.candidates[i].link_quality = linkQuality;
+                recordCandidateResult(entry, i, success, now);
+            }
+        }
+    }
+}
+
+bool RoutingTable::hasNextHop(const uint8_t *destination_addr, InterfaceType interface, const uint8_t* mac, const IPAddress& ip) {
+    RouteEntry* entry = findRoute(destination_addr);
+    if (!entry) return false;
+    for (uint8_t i = 0; i < entry->candidate_count; i++) {
+        if (sameNextHop(entry->candidates[i], interface, mac, ip)) return true;
+    }
+    return false;
+}
+
+const RouteCandidate* RoutingTable::findSplitCandidate(const uint8_t *destination_addr) {
+    RouteEntry* entry = findRoute(destination_addr);
+    if (!entry || entry->candidate_count < 2) return nullptr;
+
+    unsigned long now = millis();
+    const RouteCandidate& active = entry->candidates[entry->active_candidate];
+    float limit = candidateCost(active, now) * ROUTE_MULTIPATH_COST_RATIO;
+    const RouteCandidate* best = nullptr;
+    float bestCost = 0.0f;
+    for (uint8_t i = 0; i < entry->candidate_count; i++) {
+        const RouteCandidate& c = entry->candidates[i];
+        if (i == entry->active_candidate || c.interface == active.interface || isCandidateDown(c, now)) continue;
+        float cost = candidateCost(c, now);
+        if (cost <= limit && (!best || cost < bestCost)) { best = &c; bestCost = cost; }
+    }
+    return best;
 }
 
 RouteEntry* RoutingTable::findRoute(const uint8_t *destination_addr) {
@@ -105,24 +259,79 @@ RouteEntry* RoutingTable::findRoute(const uint8_t *destination_addr) {
 // Pass InterfaceManager to handle peer removal during pruning
 void RoutingTable::prune(InterfaceManager* ifManager) {
     unsigned long now = millis();
-    if (now - _last_prune_time > PRUNE_INTERVAL_MS) {
-        bool changed = false;
-        for (auto it = _routes.begin(); it != _routes.end(); /* manual increment */ ) {
-            if (now - it->last_heard_time > ROUTE_TIMEOUT_MS) {
-                 DebugSerial.print("RT: Route timed out for "); Utils::printBytes(it->destination_addr, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
-                 // If it was an ESP-NOW route, remove the peer via InterfaceManager
-                 if (ifManager && it->interface == InterfaceType::ESP_NOW) {
-                      ifManager->removeEspNowPeer(it->next_hop_mac);
-                 }
-                it = _routes.erase(it); // Erase and get iterator to next element
-                changed = true;
-            } else {
-                ++it; // Only increment if not erased
+    for (auto it = _routes.begin(); it != _routes.end(); /* manual increment */ ) {
+        bool activeExpired = false;
+        for (uint8_t i = it->candidate_count; i-- > 0; ) {
+            if (now - it->candidates[i].last_heard_time > _timeoutMs) {
+                if (i == it->active_candidate) activeExpired = true;
+                removeCandidate(*it, i, ifManager);
             }
         }
-        _last_prune_time = now;
-        // if (changed) print(); // Optional: Print table if changed
+        if (it->candidate_count == 0) {
+             DebugSerial.print("RT: Route timed out for "); Utils::printBytes(it->destination_addr, RNS_ADDRESS_SIZE, Serial); DebugSerial.println();
+            it = _routes.erase(it); // Erase and get iterator to next element
+        } else {
+            selectCandidate(*it, now, activeExpired); // Ages changed; fail over if the active hop expired
+            ++it; // Only increment if not erased
+        }
+    }
+}
+
+size_t RoutingTable::exportRoutes(uint8_t* out, size_t capacity) const {
+    unsigned long now = millis();
+    size_t len = 0;
+    for (const auto& entry : _routes) {
+        if (entry.active_candidate >= entry.candidate_count) continue;
+        if (len + EXPORT_RECORD_SIZE > capacity) break;
+        const RouteCandidate& c = entry.candidates[entry.active_candidate];
+        uint8_t* p = out + len;
+        memcpy(p, entry.destination_addr, RNS_ADDRESS_SIZE); p += RNS_ADDRESS_SIZE;
+        *p++ = static_cast<uint8_t>(c.interface);
+        *p++ = c.hops;
+        memcpy(p, c.next_hop_mac, 6); p += 6;
+        uint32_t ip = c.next_hop_ip;
+        memcpy(p, &ip, 4); p += 4;
+        *p++ = c.next_hop_port & 0xFF; *p++ = c.next_hop_port >> 8;
+        unsigned long ageS = std::min<unsigned long>((now - c.last_heard_time) / 1000, 0xFFFF);
+        *p++ = ageS & 0xFF; *p++ = ageS >> 8;
+        *p++ = static_cast<uint8_t>(c.delivery_ratio * 255.0f + 0.5f);
+        len += EXPORT_RECORD_SIZE;
+    }
+    return len;
+}
+
+size_t RoutingTable::importRoutes(const uint8_t* data, size_t len, unsigned long extraAgeMs) {
+    unsigned long now = millis();
+    size_t restored = 0;
+    for (size_t off = 0; off + EXPORT_RECORD_SIZE <= len && _routes.size() < _maxRoutes; off += EXPORT_RECORD_SIZE) {
+        const uint8_t* p = data + off;
+        if (findRoute(p)) continue; // Heard again since boot: that is fresher
+        unsigned long savedAgeMs = (unsigned long)(p[22] | (p[23] << 8)) * 1000UL;
+        unsigned long ageMs = savedAgeMs + extraAgeMs;
+        if (savedAgeMs > _timeoutMs || extraAgeMs > _timeoutMs || ageMs > _timeoutMs || p[8] > static_cast<uint8_t>(InterfaceType::HAM_MODEM)) continue;
+
+        _routes.emplace_back();
+        RouteEntry& entry = _routes.back();
+        memcpy(entry.destination_addr, p, RNS_ADDRESS_SIZE);
+        RouteCandidate& c = entry.candidates[0];
+        c.interface = static_cast<InterfaceType>(p[8]);
+        c.hops = p[9];
+        memcpy(c.next_hop_mac, p + 10, 6);
+        uint32_t ip;
+        memcpy(&ip, p + 16, 4);
+        c.next_hop_ip = IPAddress(ip);
+        c.next_hop_port = (uint16_t)(p[20] | (p[21] << 8));
+        c.last_heard_time = now - ageMs; // Wraps before millis() catches up; ages still subtract correctly
+        c.link_quality = ROUTE_LINK_QUALITY_UNKNOWN;
+        c.delivery_ratio = std::max(p[24] / 255.0f, 1.0f / ROUTE_ETX_MAX);
+        c.consecutive_failures = 0;
+        c.last_failure_time = 0;
+        entry.candidate_count = 1;
+        entry.active_candidate = 0;
+        selectCandidate(entry, now, true);
+        restored++;
     }
+    return restored;
 }
 
 void RoutingTable::print() {
@@ -136,7 +345,9 @@ void RoutingTable::print() {
         DebugSerial.print(" Hops="); DebugSerial.print(entry.hops);
         if (entry.interface == InterfaceType::ESP_NOW) { DebugSerial.print(" MAC="); Utils::printBytes(entry.next_hop_mac, 6, Serial); }
         else if (entry.interface == InterfaceType::WIFI_UDP) { DebugSerial.print(" IP="); DebugSerial.print(entry.next_hop_ip); }
-        DebugSerial.print(" Age="); DebugSerial.print((now - entry.last_heard_time) / 1000); DebugSerial.println("s");
+        DebugSerial.print(" Age="); DebugSerial.print((now - entry.last_heard_time) / 1000); DebugSerial.print("s");
+        DebugSerial.print(" Cost="); DebugSerial.print(entry.cost, 2);
+        DebugSerial.print(" Alt="); DebugSerial.println(entry.candidate_count - 1);
     }
     DebugSerial.println("---------------------");
 }
@@ -144,36 +355,3 @@ void RoutingTable::print() {
 size_t RoutingTable::getRouteCount() const {
     return _routes.size();
 }
-
-// --- Announce Forwarding Prevention ---
-bool RoutingTable::shouldForwardAnnounce(uint16_t packet_id, const uint8_t* source_addr) {
-    if (!source_addr) return false;
-    pruneRecentAnnounces();
-    RecentAnnounceKey key;
-    key.packet_id = packet_id;
-    memcpy(key.source_prefix, source_addr, sizeof(key.source_prefix));
-    return _recentAnnounces.find(key) == _recentAnnounces.end();
-}
-
-void RoutingTable::markAnnounceForwarded(uint16_t packet_id, const uint8_t* source_addr) {
-    if (!source_addr) return;
-    RecentAnnounceKey key;
-    key.packet_id = packet_id;
-    memcpy(key.source_prefix, source_addr, sizeof(key.source_prefix));
-    _recentAnnounces[key] = millis();
-    if (_recentAnnounces.size() > MAX_RECENT_ANNOUNCES) { // Prune if exceeds limit slightly
-        pruneRecentAnnounces(true);
-    }
-}
-
-void RoutingTable::pruneRecentAnnounces(bool force) {
-    unsigned long now = millis();
-    if (!force && (now - _last_recent_announce_prune < PRUNE_INTERVAL_MS / 2)) {
-        return;
-    }
-    for (auto it = _recentAnnounces.begin(); it != _recentAnnounces.end(); ) {
-        if (now - it->second > RECENT_ANNOUNCE_TIMEOUT_MS) { it = _recentAnnounces.erase(it); }
-        else { ++it; }
-    }
-    _last_recent_announce_prune = now;
-}
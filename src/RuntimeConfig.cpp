@@ -0,0 +1,222 @@
+#include "RuntimeConfig.h"
+#include "ReticulumPacket.h" // For RNS_HEADER_1_SIZE, MAX_PACKET_SIZE
+#include <cstring> // For strlen, memcpy
+#include <memory>  // For std::unique_ptr
+#include <new>     // For std::nothrow
+#if RUNTIME_CONFIG_JSON
+#include <ArduinoJson.h>
+#endif
+#if JSON_CONFIG_ENABLED
+#include <SPIFFS.h>
+#endif
+
+RuntimeConfig runtimeConfig;
+
+RuntimeConfig::RuntimeConfig() : _loads(0) {
+    setDefaults();
+}
+
+void RuntimeConfig::setDefaults() {
+    _nodeName[0] = '\0';
+    copyText(_nodeName, sizeof(_nodeName), BT_DEVICE_NAME);
+    _wifiSsid[0] = '\0';
+    _wifiPassword[0] = '\0';
+    setWiFiCredentials(WIFI_SSID, WIFI_PASSWORD);
+    _apiToken[0] = '\0';
+    memset(_otaPublicKey, 0, sizeof(_otaPublicKey));
+    _hasOtaPublicKey = false;
+    _announceIntervalMs = ANNOUNCE_INTERVAL_MS;
+    _maxRoutes = MAX_ROUTES;
+    _routeTimeoutMs = ROUTE_TIMEOUT_MS;
+    _routeTimeoutSet = false;
+    _espNowMtu = 0;
+    _udpMtu = 0;
+    _loraMtu = 0;
+}
+
+bool RuntimeConfig::copyText(char* out, size_t capacity, const char* text) {
+    if (!text) return false;
+    size_t len = strlen(text);
+    if (len >= capacity) return false;
+    memcpy(out, text, len + 1);
+    return true;
+}
+
+bool RuntimeConfig::setNodeName(const char* name) {
+    if (!name || name[0] == '\0') return false;
+    return copyText(_nodeName, sizeof(_nodeName), name);
+}
+
+bool RuntimeConfig::setWiFiCredentials(const char* ssid, const char* password) {
+    if (!ssid || !password || strlen(ssid) > SSID_MAX_LEN || strlen(password) > PASSWORD_MAX_LEN) return false;
+    copyText(_wifiSsid, sizeof(_wifiSsid), ssid);
+    copyText(_wifiPassword, sizeof(_wifiPassword), password);
+    return true;
+}
+
+bool RuntimeConfig::setApiToken(const char* token) {
+    if (!token) return false;
+    while (*token == ' ' || *token == '\t') token++;
+    size_t len = strlen(token);
+    while (len > 0 && (token[len - 1] == ' ' || token[len - 1] == '\t')) len--;
+    if (len > TOKEN_MAX_LEN) return false;
+    memcpy(_apiToken, token, len);
+    _apiToken[len] = '\0';
+    return true;
+}
+
+bool RuntimeConfig::setOtaPublicKeyHex(const char* hex) {
+    if (!hex) return false;
+    if (hex[0] == '\0') {
+        _hasOtaPublicKey = false;
+        return true;
+    }
+    if (strlen(hex) != PUBLIC_KEY_SIZE * 2) return false;
+    auto val = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    uint8_t key[PUBLIC_KEY_SIZE];
+    for (size_t i = 0; i < PUBLIC_KEY_SIZE; i++) {
+        int hi = val(hex[2 * i]);
+        int lo = val(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        key[i] = (uint8_t)((hi << 4) | lo);
+    }
+    memcpy(_otaPublicKey, key, PUBLIC_KEY_SIZE);
+    _hasOtaPublicKey = true;
+    return true;
+}
+
+bool RuntimeConfig::setAnnounceInterval(unsigned long intervalMs) {
+    if (intervalMs < ANNOUNCE_INTERVAL_MIN_MS || intervalMs > 0xFFFFFFFFUL / 4) return false;
+    _announceIntervalMs = intervalMs;
+    // Same rule as ROUTE_TIMEOUT_MS: about 3 missed announces
+    if (!_routeTimeoutSet) _routeTimeoutMs = intervalMs * 3 + 15000;
+    return true;
+}
+
+bool RuntimeConfig::setRouteLimits(size_t maxRoutes, unsigned long timeoutMs) {
+    // A timeout below the announce interval would expire every route between announces
+    if (maxRoutes == 0 || maxRoutes > MAX_ROUTES || timeoutMs <= _announceIntervalMs) return false;
+    _maxRoutes = maxRoutes;
+    _routeTimeoutMs = timeoutMs;
+    _routeTimeoutSet = true;
+    return true;
+}
+
+bool RuntimeConfig::setInterfaceMtu(InterfaceType ifType, size_t mtu) {
+    // Interfaces clamp to what their medium carries; this only rules out nonsense
+    if (mtu != 0 && (mtu < RNS_HEADER_1_SIZE || mtu > MAX_PACKET_SIZE)) return false;
+    switch (ifType) {
+        case InterfaceType::ESP_NOW:  _espNowMtu = (uint16_t)mtu; return true;
+        case InterfaceType::WIFI_UDP: _udpMtu = (uint16_t)mtu; return true;
+        case InterfaceType::LORA:     _loraMtu = (uint16_t)mtu; return true;
+        default: return false;
+    }
+}
+
+size_t RuntimeConfig::getInterfaceMtu(InterfaceType ifType) const {
+    switch (ifType) {
+        case InterfaceType::ESP_NOW:  return _espNowMtu;
+        case InterfaceType::WIFI_UDP: return _udpMtu;
+        case InterfaceType::LORA:     return _loraMtu;
+        default: return 0;
+    }
+}
+
+#if RUNTIME_CONFIG_JSON
+bool RuntimeConfig::parse(const char* json, size_t len, String* error) {
+    auto fail = [error](const char* key) {
+        if (error) *error = key;
+        return false;
+    };
+    DynamicJsonDocument doc(RUNTIME_CONFIG_MAX_SIZE);
+    if (deserializeJson(doc, json, len) || !doc.is<JsonObject>()) return fail("json");
+
+    RuntimeConfig next; // Defaults; only copied over if every value is valid
+    next._loads = _loads;
+
+    JsonVariantConst v = doc["node_name"];
+    if (!v.isNull() && !(v.is<const char*>() && next.setNodeName(v.as<const char*>()))) return fail("node_name");
+
+    JsonVariantConst wifi = doc["wifi"];
+    if (!wifi.isNull()) {
+        const char* ssid = wifi["ssid"] | "";
+        const char* password = wifi["password"] | "";
+        if (ssid[0] != '\0' && !next.setWiFiCredentials(ssid, password)) return fail("wifi");
+    }
+
+    JsonVariantConst api = doc["api"];
+    if (!api.isNull()) {
+        v = api["token"];
+        if (!v.isNull() && !(v.is<const char*>() && next.setApiToken(v.as<const char*>()))) return fail("api.token");
+        v = api["public_key"];
+        if (!v.isNull() && !(v.is<const char*>() && next.setOtaPublicKeyHex(v.as<const char*>()))) return fail("api.public_key");
+    }
+
+    v = doc["announce_interval_ms"];
+    if (!v.isNull() && !(v.is<unsigned long>() && next.setAnnounceInterval(v.as<unsigned long>()))) return fail("announce_interval_ms");
+
+    JsonVariantConst routes = doc["routes"];
+    if (!routes.isNull()) {
+        JsonVariantConst maxRoutes = routes["max"];
+        JsonVariantConst timeout = routes["timeout_ms"];
+        if ((!maxRoutes.isNull() && !maxRoutes.is<unsigned int>()) || (!timeout.isNull() && !timeout.is<unsigned long>())) return fail("routes");
+        size_t maxValue = maxRoutes.isNull() ? next._maxRoutes : maxRoutes.as<unsigned int>();
+        unsigned long timeoutValue = timeout.isNull() ? next._routeTimeoutMs : timeout.as<unsigned long>();
+        if (!next.setRouteLimits(maxValue, timeoutValue)) return fail("routes");
+        if (timeout.isNull()) next._routeTimeoutSet = false; // Still follows the announce interval
+    }
+
+    JsonVariantConst mtu = doc["mtu"];
+    if (!mtu.isNull()) {
+        const struct { const char* key; InterfaceType ifType; } slots[] = {
+            { "espnow", InterfaceType::ESP_NOW }, { "udp", InterfaceType::WIFI_UDP }, { "lora", InterfaceType::LORA }
+        };
+        for (const auto& slot : slots) {
+            v = mtu[slot.key];
+            if (!v.isNull() && !(v.is<unsigned int>() && next.setInterfaceMtu(slot.ifType, v.as<unsigned int>()))) return fail("mtu");
+        }
+    }
+
+    *this = next;
+    _loads++;
+    return true;
+}
+#endif
+
+bool RuntimeConfig::load(const char* path) {
+#if JSON_CONFIG_ENABLED
+    if (!SPIFFS.begin(true)) {
+        DebugSerial.println("! WARN: SPIFFS mount failed, using built-in config.");
+        return false;
+    }
+    if (!SPIFFS.exists(path)) return false;
+    File f = SPIFFS.open(path, FILE_READ);
+    if (!f) return false;
+    size_t size = f.size();
+    if (size == 0 || size > RUNTIME_CONFIG_MAX_SIZE) {
+        f.close();
+        DebugSerial.print("! WARN: Ignoring "); DebugSerial.print(path); DebugSerial.println(", empty or too large.");
+        return false;
+    }
+    std::unique_ptr<char[]> text(new (std::nothrow) char[size]);
+    size_t got = text ? f.read((uint8_t*)text.get(), size) : 0;
+    f.close();
+    if (got != size) return false;
+
+    String error;
+    if (!parse(text.get(), size, &error)) {
+        DebugSerial.print("! WARN: Ignoring "); DebugSerial.print(path); DebugSerial.print(", invalid "); DebugSerial.println(error);
+        return false;
+    }
+    DebugSerial.print("Runtime config loaded from "); DebugSerial.println(path);
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
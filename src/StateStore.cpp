@@ -0,0 +1,250 @@
+#include "StateStore.h"
+#include "Identity.h"
+#include <cstring> // For memcpy, memset
+#include <new>     // For std::nothrow
+
+static const char* const RECORD_KEYS[] = { "addr", "identity", "pkt_id", "snapshot", "links" };
+static const size_t RECORD_COUNT = static_cast<size_t>(StateStore::Record::COUNT);
+static_assert(sizeof(RECORD_KEYS) / sizeof(RECORD_KEYS[0]) == RECORD_COUNT, "One NVS key per record");
+
+// FNV-1a, to skip rewriting records that did not change (0 is reserved for "unknown")
+static uint32_t contentHash(const uint8_t* data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+StateStore::StateStore(const char* nvsNamespace) :
+    _namespace(nvsNamespace), _open(false), _packetId(0), _reservedEnd(0),
+#if defined(ARDUINO_ARCH_ESP32)
+    _task(nullptr), _stageLock(nullptr), _commitLock(nullptr),
+#endif
+    _commits(0), _unchanged(0), _failed(0)
+{}
+
+StateStore::~StateStore() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) vTaskDelete(_task);
+    if (_stageLock) vSemaphoreDelete(_stageLock);
+    if (_commitLock) vSemaphoreDelete(_commitLock);
+#endif
+    if (_open) _prefs.end();
+}
+
+size_t StateStore::capacity(Record record) {
+    switch (record) {
+        case Record::ADDRESS:   return RNS_ADDRESS_SIZE;
+        case Record::IDENTITY:  return Identity::PRIVATE_KEY_SIZE;
+        case Record::PACKET_ID: return sizeof(uint16_t);
+        case Record::SNAPSHOT:  return STATE_SNAPSHOT_MAX_SIZE;
+        case Record::LINKS:     return LINK_POOL_MAX * RNS_ADDRESS_SIZE;
+        default:                return 0;
+    }
+}
+
+bool StateStore::begin() {
+    if (_open) return true;
+    if (!_prefs.begin(_namespace, false)) {
+        DebugSerial.println("! ERROR: Failed to open NVS, node state will not persist!");
+        return false;
+    }
+    _open = true;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    _stageLock = xSemaphoreCreateMutex();
+    _commitLock = xSemaphoreCreateMutex();
+    if (!_stageLock || !_commitLock ||
+        xTaskCreate(taskMain, "state_commit", STATE_COMMIT_TASK_STACK, this,
+                    STATE_COMMIT_TASK_PRIORITY, &_task) != pdPASS) {
+        DebugSerial.println("! WARN: State commit task not started, committing from the main loop.");
+        _task = nullptr;
+    }
+#endif
+    return true;
+}
+
+bool StateStore::isTaskRunning() const {
+#if defined(ARDUINO_ARCH_ESP32)
+    return _task != nullptr;
+#else
+    return false;
+#endif
+}
+
+void StateStore::lock() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_stageLock) xSemaphoreTake(_stageLock, portMAX_DELAY);
+#endif
+}
+
+void StateStore::unlock() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_stageLock) xSemaphoreGive(_stageLock);
+#endif
+}
+
+void StateStore::lockCommit() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_commitLock) xSemaphoreTake(_commitLock, portMAX_DELAY);
+#endif
+}
+
+void StateStore::unlockCommit() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_commitLock) xSemaphoreGive(_commitLock);
+#endif
+}
+
+// Caller holds the commit lock
+size_t StateStore::read(size_t index, uint8_t* out, size_t outCapacity) {
+    Record record = static_cast<Record>(index);
+    size_t len = _prefs.getBytesLength(RECORD_KEYS[index]);
+    if (len == 0 || len > outCapacity || len > capacity(record) ||
+        _prefs.getBytes(RECORD_KEYS[index], out, len) != len) {
+        return 0;
+    }
+    _slots[index].committedHash = contentHash(out, len);
+    return len;
+}
+
+size_t StateStore::load(Record record, uint8_t* out, size_t outCapacity) {
+    size_t index = static_cast<size_t>(record);
+    if (!_open || index >= RECORD_COUNT || !out) return 0;
+    lockCommit();
+    size_t len = read(index, out, outCapacity);
+    unlockCommit();
+    return len;
+}
+
+bool StateStore::loadWith(Record record, const std::function<void(const uint8_t* data, size_t len)>& use) {
+    size_t index = static_cast<size_t>(record);
+    if (!_open || index >= RECORD_COUNT) return false;
+    lockCommit();
+    size_t len = _prefs.getBytesLength(RECORD_KEYS[index]);
+    std::unique_ptr<uint8_t[]> buffer(len ? new (std::nothrow) uint8_t[len] : nullptr);
+    if (buffer) len = read(index, buffer.get(), len);
+    unlockCommit();
+    if (!buffer || len == 0) return false;
+    use(buffer.get(), len);
+    memset(buffer.get(), 0, len);
+    return true;
+}
+
+bool StateStore::stage(Record record, const uint8_t* data, size_t len) {
+    return stageWith(record, [data, len](uint8_t* out, size_t capacity) -> size_t {
+        if (len > capacity) return capacity + 1;
+        if (len) memcpy(out, data, len);
+        return len;
+    });
+}
+
+bool StateStore::stageWith(Record record, const std::function<size_t(uint8_t* out, size_t capacity)>& fill) {
+    size_t index = static_cast<size_t>(record);
+    if (!_open || index >= RECORD_COUNT) return false;
+    size_t cap = capacity(record);
+    // Each stage gets its own buffer, handed to the commit task and freed once written,
+    // so the large records only take heap between a save and its commit
+    std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[cap]);
+    if (!buffer) {
+        DebugSerial.print("! WARN: No heap to stage state record "); DebugSerial.println(RECORD_KEYS[index]);
+        return false;
+    }
+    size_t len = fill(buffer.get(), cap);
+    if (len > cap) {
+        DebugSerial.print("! WARN: State record too large, not saved: "); DebugSerial.println(RECORD_KEYS[index]);
+        return false;
+    }
+    Slot& slot = _slots[index];
+    lock();
+    buffer.swap(slot.data); // A pending older version is dropped below
+    slot.len = len;
+    unlock();
+    if (buffer) memset(buffer.get(), 0, cap);
+    requestCommit();
+    return true;
+}
+
+void StateStore::requestCommit() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) {
+        xTaskNotifyGive(_task);
+        return;
+    }
+#endif
+    commitDirty();
+}
+
+void StateStore::flush() {
+    commitDirty();
+}
+
+void StateStore::commitDirty() {
+    if (!_open) return;
+    lockCommit();
+    for (size_t i = 0; i < RECORD_COUNT; i++) {
+        Slot& slot = _slots[i];
+        // Take the staged buffer under the stage lock, write to flash without it
+        std::unique_ptr<uint8_t[]> data;
+        lock();
+        data.swap(slot.data);
+        size_t len = slot.len;
+        unlock();
+        if (!data) continue;
+
+        uint32_t hash = contentHash(data.get(), len);
+        bool written = true;
+        if (hash == slot.committedHash) {
+            _unchanged++;
+        } else if (len == 0) {
+            _prefs.remove(RECORD_KEYS[i]); // An empty record is an absent key
+        } else {
+            written = _prefs.putBytes(RECORD_KEYS[i], data.get(), len) == len;
+        }
+        if (written) {
+            if (hash != slot.committedHash) _commits++;
+            slot.committedHash = hash;
+        } else {
+            _failed++;
+            slot.committedHash = 0;
+            DebugSerial.print("! WARN: NVS write failed for state record "); DebugSerial.println(RECORD_KEYS[i]);
+        }
+        memset(data.get(), 0, len); // Nothing (e.g. the identity key) lingers once written
+    }
+    unlockCommit();
+}
+
+void StateStore::beginPacketIds(uint16_t fallbackStart) {
+    uint8_t stored[sizeof(uint16_t)];
+    if (load(Record::PACKET_ID, stored, sizeof(stored)) == sizeof(stored)) {
+        _packetId = (uint16_t)(stored[0] | (stored[1] << 8)); // Last ID the previous boot may have used
+    } else {
+        _packetId = fallbackStart;
+    }
+    reservePacketIds();
+}
+
+uint16_t StateStore::nextPacketId() {
+    _packetId++;
+    // Reserve the next block while half of this one is left, so the commit lands in time
+    if ((uint16_t)(_reservedEnd - _packetId) < PACKET_ID_BLOCK / 2) reservePacketIds();
+    return _packetId;
+}
+
+void StateStore::reservePacketIds() {
+    _reservedEnd = (uint16_t)(_packetId + PACKET_ID_BLOCK);
+    uint8_t encoded[sizeof(uint16_t)] = { (uint8_t)(_reservedEnd & 0xFF), (uint8_t)(_reservedEnd >> 8) };
+    stage(Record::PACKET_ID, encoded, sizeof(encoded));
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void StateStore::taskMain(void* arg) {
+    StateStore* self = static_cast<StateStore*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->commitDirty();
+    }
+}
+#endif
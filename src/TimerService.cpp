@@ -0,0 +1,75 @@
+#include "TimerService.h"
+#include <algorithm> // For std::push_heap, std::pop_heap
+#include <climits>   // For ULONG_MAX
+
+TimerService::TimerService() : _nextId(1) {}
+
+TimerService::TimerId TimerService::push(unsigned long delayMs, unsigned long period, Callback callback, unsigned long now, TimerId id) {
+    if (!callback) return INVALID_TIMER;
+    if (id == INVALID_TIMER) {
+        id = _nextId++;
+        if (_nextId == INVALID_TIMER) _nextId = 1; // Skip reserved id on wrap
+    }
+    _heap.push_back(Timer{now + delayMs, period, id, std::move(callback)});
+    std::push_heap(_heap.begin(), _heap.end(), FiresLater());
+    return id;
+}
+
+TimerService::TimerId TimerService::schedule(unsigned long delayMs, Callback callback, unsigned long now) {
+    return push(delayMs, 0, std::move(callback), now);
+}
+
+TimerService::TimerId TimerService::schedulePeriodic(unsigned long intervalMs, Callback callback, unsigned long now) {
+    return push(intervalMs, intervalMs, std::move(callback), now);
+}
+
+TimerService::TimerId TimerService::reschedule(TimerId id, unsigned long delayMs, Callback callback, unsigned long now) {
+    cancel(id);
+    return push(delayMs, 0, std::move(callback), now);
+}
+
+void TimerService::cancel(TimerId id) {
+    if (id == INVALID_TIMER) return;
+    // Linear scan is fine: a node only ever has a handful of outstanding deadlines
+    for (auto it = _heap.begin(); it != _heap.end(); ++it) {
+        if (it->id == id) {
+            _heap.erase(it);
+            std::make_heap(_heap.begin(), _heap.end(), FiresLater());
+            return;
+        }
+    }
+}
+
+bool TimerService::isPending(TimerId id) const {
+    if (id == INVALID_TIMER) return false;
+    for (const auto& t : _heap) {
+        if (t.id == id) return true;
+    }
+    return false;
+}
+
+size_t TimerService::runExpired(unsigned long now) {
+    size_t fired = 0;
+    // Bound the pass so a callback re-arming itself with zero delay can't starve the loop
+    size_t budget = _heap.size();
+
+    while (!_heap.empty() && fired < budget && (long)(now - _heap.front().deadline) >= 0) {
+        std::pop_heap(_heap.begin(), _heap.end(), FiresLater());
+        Timer timer = std::move(_heap.back());
+        _heap.pop_back();
+
+        if (timer.period > 0) {
+            // Re-arm before running so the callback may cancel() its own id
+            push(timer.period, timer.period, timer.callback, now, timer.id);
+        }
+        timer.callback(); // May schedule or cancel other timers
+        fired++;
+    }
+    return fired;
+}
+
+unsigned long TimerService::msUntilNext(unsigned long now) const {
+    if (_heap.empty()) return ULONG_MAX;
+    long remaining = (long)(_heap.front().deadline - now);
+    return remaining > 0 ? (unsigned long)remaining : 0;
+}
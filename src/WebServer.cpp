@@ -4,20 +4,56 @@
 
 #if WEBSERVER_ENABLED
 
-#include "WebServer.h"
+#include "HttpRequest.h"
 #include "ReticulumNode.h"
+#include "PowerManager.h"
+#include "PacketBufferPool.h"
+#include "RuntimeConfig.h"
 #include <WiFi.h>
+#include <lwip/sockets.h> // Non-blocking recv/send/select on the client sockets
+#include <cerrno>
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
 #include <Update.h>
-#include <monocypher.h>
+#include "Ed25519StreamVerifier.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
 
 extern ReticulumNode reticulumNode;
 
 static WiFiServer _server(WEBSERVER_PORT);
-static const char* CONFIG_PATH = "/config.json";
+static const char* CONFIG_PATH = RUNTIME_CONFIG_PATH;
+
+// One keep-alive connection. The server task reads the request into the parser and
+// writes the response out; the handler runs on the main loop in between. An accepted
+// OTA upload is received, verified and written to flash by the task (UPLOADING).
+struct HttpConnection {
+    enum class State : uint8_t { IDLE, READING, HANDLING, UPLOADING, WRITING };
+    WiFiClient client;
+    HttpRequestParser request;
+    State state = State::IDLE;
+    String response;
+    size_t sent = 0;
+    bool keepAlive = false;
+    bool restartAfter = false; // Restart the node once the response is out
+    unsigned long lastActivity = 0;
+};
+static HttpConnection _connections[HTTP_MAX_CONNECTIONS];
+
+#if defined(ARDUINO_ARCH_ESP32)
+static TaskHandle_t _task = nullptr;
+#endif
+static HttpConnection* volatile _dispatched = nullptr; // Request waiting for the main loop
+static volatile bool _restartRequested = false;
+#if OTA_ENABLED
+static HttpConnection* volatile _upload = nullptr; // The one OTA upload in progress
+static Ed25519StreamVerifier _otaVerifier;
+#endif
 
-static void sendResponse(WiFiClient &client, int code, const char *contentType, const String &body) {
+static void sendResponse(HttpConnection &conn, int code, const char *contentType, const String &body,
+                         const char *extraHeaders = nullptr) {
     const char *statusText = "OK";
     switch (code) {
         case 200: statusText = "OK"; break;
@@ -26,213 +62,237 @@ static void sendResponse(WiFiClient &client, int code, const char *contentType,
         case 401: statusText = "Unauthorized"; break;
         case 403: statusText = "Forbidden"; break;
         case 404: statusText = "Not Found"; break;
+        case 409: statusText = "Conflict"; break;
+        case 413: statusText = "Payload Too Large"; break;
         case 500: statusText = "Internal Server Error"; break;
         default: statusText = "OK"; break;
     }
 
-    client.print("HTTP/1.1 ");
-    client.print(code);
-    client.print(" "); client.print(statusText); client.print("\r\n");
-    client.print("Content-Type: "); client.print(contentType); client.print("\r\n");
-    client.print("Content-Length: "); client.print(body.length()); client.print("\r\n");
-    client.print("Connection: close\r\n\r\n");
-    client.print(body);
-}
-
-static void sendUnauthorized(WiFiClient &client) {
-    const String body = "Unauthorized";
-    client.print("HTTP/1.1 401 Unauthorized\r\n");
-    client.print("WWW-Authenticate: Bearer realm=\"Reticulum\"\r\n");
-    client.print("Content-Type: text/plain\r\n");
-    client.print("Content-Length: "); client.print(body.length()); client.print("\r\n");
-    client.print("Connection: close\r\n\r\n");
-    client.print(body);
+    String& out = conn.response;
+    out = String();
+    out.reserve(body.length() + 160);
+    out += "HTTP/1.1 "; out += code; out += " "; out += statusText; out += "\r\n";
+    if (extraHeaders) out += extraHeaders;
+    out += "Content-Type: "; out += contentType; out += "\r\n";
+    out += "Content-Length: "; out += body.length(); out += "\r\n";
+    out += conn.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    out += body;
+    conn.sent = 0;
 }
 
-#if JSON_CONFIG_ENABLED
-static String getSavedApiToken() {
-    if (!SPIFFS.exists(CONFIG_PATH)) return String();
-    File f = SPIFFS.open(CONFIG_PATH, FILE_READ);
-    if (!f) return String();
-    DynamicJsonDocument doc(2048);
-    DeserializationError err = deserializeJson(doc, f);
-    f.close();
-    if (err) return String();
-    if (!doc.containsKey("api")) return String();
-    JsonObject api = doc["api"];
-    if (!api.containsKey("token")) return String();
-    return api["token"].as<String>();
+static void sendUnauthorized(HttpConnection &conn) {
+    sendResponse(conn, 401, "text/plain", "Unauthorized", "WWW-Authenticate: Bearer realm=\"Reticulum\"\r\n");
 }
-#endif
 
-static bool checkAuth(const String &authHeader) {
+static bool checkAuth(HttpText authHeader) {
 #if WEBSERVER_AUTH_ENABLED
-    String expected;
-#if JSON_CONFIG_ENABLED
-    expected = getSavedApiToken();
-#endif
-    expected.trim();
     // If no token configured, allow bootstrap (first-time config)
-    if (expected.length() == 0) return true;
+    if (!runtimeConfig.hasApiToken()) return true;
 
-    String token = authHeader;
-    token.trim();
-    if (token.startsWith("Bearer ")) token = token.substring(7);
-    token.trim();
-    return token == expected;
+    HttpText token = authHeader.trimmed();
+    if (token.startsWith("Bearer ")) token = token.substr(7).trimmed();
+    return token.equals(runtimeConfig.getApiToken());
 #else
     (void)authHeader; return true;
 #endif
 }
 
-static String readLine(WiFiClient &c, unsigned long timeout=1000) {
-    String s;
-    unsigned long start = millis();
-    while (millis() - start < timeout) {
-        if (!c.connected()) break;
-        while (c.available()) {
-            char ch = c.read();
-            s += ch;
-            if (s.endsWith("\r\n")) return s;
-        }
-        delay(1);
+// The cached runtime config in config.json form (0 MTU: the medium's own)
+static String runtimeConfigJson() {
+    DynamicJsonDocument doc(1024);
+    doc["node_name"] = runtimeConfig.getNodeName();
+    JsonObject wifi = doc.createNestedObject("wifi");
+    wifi["ssid"] = runtimeConfig.getWiFiSsid();
+    wifi["password"] = runtimeConfig.getWiFiPassword();
+    JsonObject api = doc.createNestedObject("api");
+    api["token"] = runtimeConfig.getApiToken();
+    const uint8_t* key = runtimeConfig.getOtaPublicKey();
+    if (key) {
+        char hex[RuntimeConfig::PUBLIC_KEY_SIZE * 2 + 1];
+        for (size_t i = 0; i < RuntimeConfig::PUBLIC_KEY_SIZE; i++) snprintf(hex + 2 * i, 3, "%02x", key[i]);
+        api["public_key"] = hex; // Copied by ArduinoJson
     }
-    return s;
+    doc["announce_interval_ms"] = runtimeConfig.getAnnounceIntervalMs();
+    JsonObject routes = doc.createNestedObject("routes");
+    routes["max"] = (int)runtimeConfig.getMaxRoutes();
+    routes["timeout_ms"] = runtimeConfig.getRouteTimeoutMs();
+    JsonObject mtu = doc.createNestedObject("mtu");
+    mtu["espnow"] = (int)runtimeConfig.getInterfaceMtu(InterfaceType::ESP_NOW);
+    mtu["udp"] = (int)runtimeConfig.getInterfaceMtu(InterfaceType::WIFI_UDP);
+    mtu["lora"] = (int)runtimeConfig.getInterfaceMtu(InterfaceType::LORA);
+    String out; serializeJson(doc, out);
+    return out;
 }
 
-void processHttpClient(WiFiClient &client) {
-    // Read request line
-    String req = readLine(client);
-    if (req.length() == 0) return;
-    // Example: "GET /api/v1/status HTTP/1.1\r\n"
-    int firstSpace = req.indexOf(' ');
-    int secondSpace = req.indexOf(' ', firstSpace + 1);
-    if (firstSpace < 0 || secondSpace < 0) return;
-    String method = req.substring(0, firstSpace);
-    String path = req.substring(firstSpace + 1, secondSpace);
-
-    // Read headers
-    int contentLength = 0;
-    String authHeader;
-    String signatureHex;
-    String fwVersion;
-    while (true) {
-        String line = readLine(client);
-        if (line.length() <= 2) break; // \r\n
-        line.trim();
-        if (line.startsWith("Content-Length:")) {
-            contentLength = line.substring(15).toInt();
-        } else if (line.startsWith("Authorization:")) {
-            authHeader = line.substring(14);
-            authHeader.trim();
-        } else if (line.startsWith("X-Signature-Ed25519:")) {
-            signatureHex = line.substring(20);
-            signatureHex.trim();
-        } else if (line.startsWith("X-FW-Version:")) {
-            fwVersion = line.substring(13);
-            fwVersion.trim();
-        }
-    }
-
-    // Read body if present
-    String body;
-    if (contentLength > 0) {
-        unsigned long start = millis();
-        while ((int)body.length() < contentLength && millis() - start < 2000) {
-            while (client.available() && (int)body.length() < contentLength) {
-                body += (char)client.read();
-            }
-            delay(1);
-        }
+// Runs on the main loop, so handlers can read node state; the request is complete
+// in the connection's buffer and the response is only built here, not sent
+static void handleRequest(HttpConnection &conn) {
+    const HttpRequestParser& req = conn.request;
+    HttpText method = req.method();
+    HttpText path = req.path();
+    HttpText authHeader = req.header("Authorization");
+    HttpText signatureHex = req.header("X-Signature-Ed25519");
+    HttpText body = req.body();
+
+    // Only an OTA image may be larger than the request buffer
+    if (req.status() == HttpRequestParser::Status::STREAMING && !(method.equals("POST") && path.equals("/api/v1/ota"))) {
+        sendResponse(conn, 413, "text/plain", "Request too large");
+        return;
     }
 
     // Route handling
-    if (method == "GET" && path == "/api/v1/status") {
-        DynamicJsonDocument doc(512);
+    if (method.equals("GET") && path.equals("/api/v1/status")) {
+        DynamicJsonDocument doc(2048);
         doc["uptime_s"] = millis() / 1000;
         doc["free_heap"] = ESP.getFreeHeap();
         doc["active_links"] = (int)reticulumNode.getLinkManager().getActiveLinkCount();
+        doc["link_capacity"] = (int)reticulumNode.getLinkManager().getLinkCapacity();
         doc["route_count"] = (int)reticulumNode.getRoutingTable().getRouteCount();
-        String out; serializeJson(doc, out);
-        sendResponse(client, 200, "application/json", out);
-
-    } else if (method == "GET" && path == "/api/v1/config") {
-        if (!checkAuth(authHeader)) { sendUnauthorized(client); return; }
-        DynamicJsonDocument doc(1024);
-        if (SPIFFS.exists(CONFIG_PATH)) {
-            File f = SPIFFS.open(CONFIG_PATH, FILE_READ);
-            if (!f) { sendResponse(client, 500, "text/plain", "Failed to open config file"); return; }
-            DeserializationError err = deserializeJson(doc, f);
-            f.close();
-            if (err) { sendResponse(client, 500, "text/plain", "Config parse error"); return; }
-        } else {
-            doc["node_name"] = "esp32-rns-node";
-            JsonObject wifi = doc.createNestedObject("wifi");
-            wifi["ssid"] = "";
-            wifi["password"] = "";
+        JsonObject power = doc.createNestedObject("power");
+        power["low_power"] = PowerManager::isLowPowerEnabled();
+        power["light_sleep"] = PowerManager::isLightSleepActive();
+        power["duty_cycle_pct"] = PowerManager::getDutyCyclePercent();
+        JsonObject wakes = power.createNestedObject("wakeups");
+        wakes["total"] = PowerManager::getWakeCount();
+        wakes["timer"] = PowerManager::getTimerWakeCount();
+        wakes["uart"] = PowerManager::getWakeCount(POWER_EVENT_UART_RX);
+        wakes["espnow"] = PowerManager::getWakeCount(POWER_EVENT_ESPNOW_RX);
+        wakes["lora"] = PowerManager::getWakeCount(POWER_EVENT_LORA_DIO);
+        wakes["wifi"] = PowerManager::getWakeCount(POWER_EVENT_WIFI);
+        wakes["http"] = PowerManager::getWakeCount(POWER_EVENT_HTTP);
+        wakes["announce"] = PowerManager::getWakeCount(POWER_EVENT_ANNOUNCE);
+        const EspNowPeerTable& peers = reticulumNode.getInterfaceManager().getEspNowPeerTable();
+        JsonObject espnow = doc.createNestedObject("espnow");
+        espnow["peers"] = (int)peers.size();
+        espnow["hw_peers"] = (int)peers.getRegisteredCount();
+        espnow["peer_evictions"] = reticulumNode.getInterfaceManager().getEspNowPeerEvictions();
+        espnow["reassembled"] = reticulumNode.getInterfaceManager().getEspNowFragmenter().getReassembledCount();
+        espnow["fragments_dropped"] = reticulumNode.getInterfaceManager().getEspNowFragmenter().getDroppedCount();
+        espnow["rx_dropped"] = reticulumNode.getInterfaceManager().getEspNowRxDropCount();
+        espnow["unicast_sent"] = peers.getTotalSent();
+        espnow["unicast_acked"] = peers.getTotalAcked();
+        uint64_t latencySum = 0; size_t latencyPeers = 0;
+        for (size_t i = 0; i < peers.size(); i++) {
+            if (peers.at(i).latencyUs > 0) { latencySum += peers.at(i).latencyUs; latencyPeers++; }
         }
+        espnow["avg_latency_us"] = latencyPeers ? (uint32_t)(latencySum / latencyPeers) : 0;
+        InterfaceManager& interfaces = reticulumNode.getInterfaceManager();
+        JsonObject mtu = doc.createNestedObject("mtu");
+        mtu["node"] = (int)RNS_MTU;
+        mtu["espnow"] = (int)interfaces.getInterfaceMtu(InterfaceType::ESP_NOW);
+        mtu["udp"] = (int)interfaces.getInterfaceMtu(InterfaceType::WIFI_UDP);
+#ifdef LORA_ENABLED
+        mtu["lora"] = (int)interfaces.getInterfaceMtu(InterfaceType::LORA);
+#endif
+        mtu["dropped"] = interfaces.getMtuDropCount();
+        doc["ifac_dropped"] = interfaces.getIfacDropCount();
+        const WiFiConnection& wifiConn = interfaces.getWiFiConnection();
+        JsonObject wifi = doc.createNestedObject("wifi");
+        wifi["connected"] = wifiConn.isConnected();
+        wifi["attempts"] = wifiConn.getAttemptCount();
+        wifi["connects"] = wifiConn.getConnectCount();
+        wifi["disconnects"] = wifiConn.getDisconnectCount();
+        wifi["failure_streak"] = wifiConn.getFailureStreak();
+        JsonObject boot = doc.createNestedObject("boot_ms");
+        boot["interfaces_ready"] = interfaces.getReadyMs();
+        boot["wifi_connected"] = (uint32_t)wifiConn.getFirstConnectMs();
+        boot["first_rx"] = interfaces.getFirstRxMs();
+        boot["first_tx"] = interfaces.getFirstTxMs();
+        JsonObject transport = doc.createNestedObject("transport");
+        transport["paths"] = (int)reticulumNode.getPathTable().size();
+        transport["forwarded"] = reticulumNode.getTransportForwardCount();
+        transport["awaiting_path"] = (int)reticulumNode.getPathRequestQueue().size();
+        transport["path_requests"] = reticulumNode.getPathRequestsSent();
+        transport["path_responses"] = reticulumNode.getPathResponsesSent();
+        transport["fallback_floods"] = reticulumNode.getPathFallbackFloods();
+        const AnnounceValidator& validator = reticulumNode.getAnnounceValidator();
+        JsonObject announces = doc.createNestedObject("announce_validation");
+        announces["verified"] = validator.getVerifiedCount();
+        announces["cache_hits"] = validator.getCacheHitCount();
+        announces["deferred"] = validator.getDeferredCount();
+        announces["skipped"] = validator.getSkippedCount();
+        announces["rejected"] = reticulumNode.getAnnouncesRejected();
+        announces["pending"] = (int)reticulumNode.getPendingAnnounceCount();
+        announces["background_task"] = validator.isTaskRunning();
+        const StateStore& store = reticulumNode.getStateStore();
+        JsonObject state = doc.createNestedObject("state_store");
+        state["open"] = store.isOpen();
+        state["commits"] = store.getCommitCount();
+        state["unchanged"] = store.getUnchangedCount();
+        state["failed"] = store.getFailedCount();
+        state["background_task"] = store.isTaskRunning();
+        const NodeSnapshot::Restored& warm = reticulumNode.getWarmStart();
+        JsonObject warmStart = doc.createNestedObject("warm_start");
+        warmStart["routes"] = (int)warm.routes;
+        warmStart["paths"] = (int)warm.paths;
+        warmStart["identities"] = (int)warm.announces;
+        warmStart["filter"] = warm.filter;
+        warmStart["downtime_s"] = warm.downtimeMs / 1000;
+        warmStart["downtime_known"] = warm.downtimeKnown;
+        JsonObject pool = doc.createNestedObject("packet_pool");
+        pool["size"] = (int)PACKET_POOL_SIZE;
+        pool["free"] = (int)PacketBufferPool::getFreeCount();
+        pool["exhausted"] = PacketBufferPool::getExhaustedCount();
+#ifdef LORA_ENABLED
+        AirtimeTracker* airtime = reticulumNode.getInterfaceManager().getAirtimeTracker(InterfaceType::LORA);
+        if (airtime) {
+            JsonObject lora = doc.createNestedObject("lora_airtime");
+            lora["used_ms"] = airtime->getUsedMs();
+            lora["budget_ms"] = airtime->getBudgetMs();
+            lora["budget_used_pct"] = airtime->getUtilizationPercent();
+        }
+#endif
         String out; serializeJson(doc, out);
-        sendResponse(client, 200, "application/json", out);
-
-    } else if (method == "POST" && path == "/api/v1/config") {
-        if (!checkAuth(authHeader)) { sendUnauthorized(client); return; }
-        DynamicJsonDocument doc(2048);
-        DeserializationError err = deserializeJson(doc, body);
-        if (err) { sendResponse(client, 400, "text/plain", "Invalid JSON"); return; }
+        sendResponse(conn, 200, "application/json", out);
+
+    } else if (method.equals("GET") && path.equals("/api/v1/config")) {
+        if (!checkAuth(authHeader)) { sendUnauthorized(conn); return; }
+        sendResponse(conn, 200, "application/json", runtimeConfigJson());
+
+    } else if (method.equals("POST") && path.equals("/api/v1/config")) {
+        if (!checkAuth(authHeader)) { sendUnauthorized(conn); return; }
+        // Parsed once here; handlers, the node and the interfaces read the cached values
+        RuntimeConfig previous = runtimeConfig;
+        String error;
+        if (!runtimeConfig.parse(body.data, body.len, &error)) { sendResponse(conn, 400, "text/plain", "Invalid config: " + error); return; }
 #if JSON_CONFIG_ENABLED
         File f = SPIFFS.open(CONFIG_PATH, FILE_WRITE);
-        if (!f) { sendResponse(client, 500, "text/plain", "Failed to open config for write"); return; }
-        if (serializeJson(doc, f) == 0) { f.close(); sendResponse(client, 500, "text/plain", "Failed to write config"); return; }
-        f.close();
-#endif
-        // Apply WiFi credentials immediately if provided
-        if (doc.containsKey("wifi")) {
-            JsonObject wifi = doc["wifi"];
-            if (wifi.containsKey("ssid") && wifi.containsKey("password")) {
-                String ssid = wifi["ssid"].as<String>();
-                String pass = wifi["password"].as<String>();
-                if (ssid.length() > 0) { DebugSerial.println("WebServer: applying WiFi credentials from config.json"); WiFi.begin(ssid.c_str(), pass.c_str()); }
-            }
+        bool written = f && f.write((const uint8_t*)body.data, body.len) == body.len;
+        if (f) f.close();
+        if (!written) {
+            runtimeConfig = previous;
+            sendResponse(conn, 500, "text/plain", "Failed to write config");
+            return;
         }
-        String out; serializeJson(doc, out);
-        sendResponse(client, 200, "application/json", out);
+#endif
+        reticulumNode.applyRuntimeConfig(previous); // Announce interval, route limits, MTUs, WiFi credentials
+        sendResponse(conn, 200, "application/json", runtimeConfigJson());
 
-    } else if (method == "POST" && path == "/api/v1/config/save") {
-        if (!checkAuth(authHeader)) { sendUnauthorized(client); return; }
+    } else if (method.equals("POST") && path.equals("/api/v1/config/save")) {
+        if (!checkAuth(authHeader)) { sendUnauthorized(conn); return; }
 #if JSON_CONFIG_ENABLED
-        if (SPIFFS.exists(CONFIG_PATH)) sendResponse(client, 200, "text/plain", "saved"); else sendResponse(client, 500, "text/plain", "no config to save");
+        if (SPIFFS.exists(CONFIG_PATH)) sendResponse(conn, 200, "text/plain", "saved"); else sendResponse(conn, 500, "text/plain", "no config to save");
 #else
-        sendResponse(client, 404, "text/plain", "JSON config disabled");
+        sendResponse(conn, 404, "text/plain", "JSON config disabled");
 #endif
 
-    } else if (method == "POST" && path == "/api/v1/ota") {
-        // Signed OTA upload. Requires OTA_ENABLED and a configured Ed25519 public key in config.json
-        if (!checkAuth(authHeader)) { sendUnauthorized(client); return; }
+    } else if (method.equals("POST") && path.equals("/api/v1/ota")) {
+        // Signed OTA upload. Requires OTA_ENABLED and a configured Ed25519 public key in config.json.
+        // Only the headers are checked here; the server task streams the image to flash.
+        if (!checkAuth(authHeader)) { sendUnauthorized(conn); return; }
 #if OTA_ENABLED
-        if (body.length() == 0) { sendResponse(client, 400, "text/plain", "Empty body"); return; }
-        if (signatureHex.length() == 0) { sendResponse(client, 400, "text/plain", "Missing X-Signature-Ed25519 header"); return; }
+        if (_upload) { sendResponse(conn, 409, "text/plain", "OTA already in progress"); return; }
+        if (req.contentLength() == 0) { sendResponse(conn, 400, "text/plain", "Empty body"); return; }
+        if (signatureHex.empty()) { sendResponse(conn, 400, "text/plain", "Missing X-Signature-Ed25519 header"); return; }
 
-        String pubHex;
-#if JSON_CONFIG_ENABLED
-        // Load public key from config
-        DynamicJsonDocument cdoc(1024);
-        if (SPIFFS.exists(CONFIG_PATH)) {
-            File cf = SPIFFS.open(CONFIG_PATH, FILE_READ);
-            if (cf) {
-                if (deserializeJson(cdoc, cf) == DeserializationError::Ok) {
-                    if (cdoc.containsKey("api") && cdoc["api"].containsKey("public_key")) pubHex = cdoc["api"]["public_key"].as<String>();
-                }
-                cf.close();
-            }
-        }
-#endif
-        if (pubHex.length() == 0) { sendResponse(client, 400, "text/plain", "No public key configured"); return; }
+        const uint8_t* pub = runtimeConfig.getOtaPublicKey(); // Validated when the config was loaded
+        if (!pub) { sendResponse(conn, 400, "text/plain", "No public key configured"); return; }
 
-        auto hexToBin = [](const String &hex, uint8_t *out, size_t expectedLen)->bool {
-            if ((size_t)hex.length() != expectedLen*2) return false;
+        auto hexToBin = [](HttpText hex, uint8_t *out, size_t expectedLen)->bool {
+            if (hex.len != expectedLen*2) return false;
             for (size_t i=0;i<expectedLen;i++) {
-                char h = hex.charAt(2*i);
-                char l = hex.charAt(2*i+1);
+                char h = hex.data[2*i];
+                char l = hex.data[2*i+1];
                 auto val = [](char c)->int { if (c >= '0' && c <= '9') return c - '0'; if (c >= 'a' && c <= 'f') return c - 'a' + 10; if (c >= 'A' && c <= 'F') return c - 'A' + 10; return -1; };
                 int hi = val(h); int lo = val(l);
                 if (hi < 0 || lo < 0) return false;
@@ -241,76 +301,293 @@ void processHttpClient(WiFiClient &client) {
             return true;
         };
 
-        uint8_t sig[64]; uint8_t pub[32];
-        if (!hexToBin(signatureHex, sig, 64)) { sendResponse(client, 400, "text/plain", "Bad signature format (expected 128 hex chars)"); return; }
-        if (!hexToBin(pubHex, pub, 32)) { sendResponse(client, 400, "text/plain", "Bad public_key format (expected 64 hex chars)"); return; }
-
-        // Verify signature (Ed25519)
-        int ok = crypto_ed25519_verify(sig, (const uint8_t*)body.c_str(), body.length(), pub);
-        if (ok != 0) { sendResponse(client, 403, "text/plain", "Invalid signature"); return; }
-
-        // Apply OTA
-        if (!Update.begin((size_t)body.length())) { sendResponse(client, 500, "text/plain", "OTA begin failed"); return; }
-        size_t written = Update.write((const uint8_t*)body.c_str(), body.length());
-        if (written != (size_t)body.length()) { sendResponse(client, 500, "text/plain", "Write failed"); return; }
-        if (!Update.end(true)) { sendResponse(client, 500, "text/plain", "OTA finalize failed"); return; }
-        sendResponse(client, 200, "text/plain", "ok");
-        delay(250);
-        ESP.restart();
+        uint8_t sig[64];
+        if (!hexToBin(signatureHex, sig, 64)) { sendResponse(conn, 400, "text/plain", "Bad signature format (expected 128 hex chars)"); return; }
+
+        // The image goes to the inactive slot as it arrives; the signature is checked
+        // over the same bytes and Update.end() only runs if it holds
+        if (!Update.begin(req.contentLength())) { sendResponse(conn, 500, "text/plain", "OTA begin failed"); return; }
+        _otaVerifier.begin(sig, pub);
+        _upload = &conn;
+        DebugSerial.print("WebServer: OTA upload started, "); DebugSerial.print(req.contentLength()); DebugSerial.println(" bytes");
 #else
-        sendResponse(client, 404, "text/plain", "OTA disabled");
+        sendResponse(conn, 404, "text/plain", "OTA disabled");
 #endif
 
-    } else if (method == "POST" && path == "/api/v1/restart") {
-        if (!checkAuth(authHeader)) { sendUnauthorized(client); return; }
-        sendResponse(client, 200, "text/plain", "restarting");
-        delay(250); ESP.restart();
+    } else if (method.equals("POST") && path.equals("/api/v1/restart")) {
+        if (!checkAuth(authHeader)) { sendUnauthorized(conn); return; }
+        sendResponse(conn, 200, "text/plain", "restarting");
+        conn.restartAfter = true;
 
-    } else if (method == "GET" && path == "/api/v1/metrics") {
-        if (!checkAuth(authHeader)) { sendUnauthorized(client); return; }
+    } else if (method.equals("GET") && path.equals("/api/v1/metrics")) {
+        if (!checkAuth(authHeader)) { sendUnauthorized(conn); return; }
 #if METRICS_ENABLED
         DynamicJsonDocument doc(512);
         doc["heap_free"] = ESP.getFreeHeap();
         doc["uptime_s"] = millis() / 1000;
         String out; serializeJson(doc, out);
-        sendResponse(client, 200, "application/json", out);
+        sendResponse(conn, 200, "application/json", out);
 #else
-        sendResponse(client, 404, "text/plain", "metrics disabled");
+        sendResponse(conn, 404, "text/plain", "metrics disabled");
+#endif
+    } else {
+        sendResponse(conn, 404, "text/plain", "Not found");
+    }
+}
+
+// --- Connection handling (server task) ---
+#if OTA_ENABLED
+static void abortUpload(HttpConnection &conn) {
+    if (_upload != &conn) return;
+    Update.abort(); // The running firmware stays bootable
+    _upload = nullptr;
+}
+#endif
+
+static void closeConnection(HttpConnection &conn) {
+#if OTA_ENABLED
+    abortUpload(conn);
+#endif
+    conn.client.stop();
+    conn.request.reset();
+    conn.response = String(); // Frees the buffer
+    conn.sent = 0;
+    conn.restartAfter = false;
+    conn.state = HttpConnection::State::IDLE;
+}
+
+static void acceptClients(unsigned long now) {
+    WiFiClient client = _server.available(); // Non-blocking
+    if (!client) return;
+    for (HttpConnection &conn : _connections) {
+        if (conn.state != HttpConnection::State::IDLE) continue;
+        conn.client = client;
+        conn.client.setNoDelay(true);
+        conn.state = HttpConnection::State::READING;
+        conn.lastActivity = now;
+        return;
+    }
+    client.stop(); // All slots busy; the client retries
+}
+
+// The handler runs on the main loop; this task waits for it (a few ms at most)
+static void dispatch(HttpConnection &conn) {
+    conn.state = HttpConnection::State::HANDLING;
+    conn.keepAlive = conn.request.keepAlive();
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) {
+        _dispatched = &conn;
+        PowerManager::notify(POWER_EVENT_HTTP);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } else
+#endif
+    {
+        handleRequest(conn);
+    }
+#if OTA_ENABLED
+    if (_upload == &conn) {
+        conn.state = HttpConnection::State::UPLOADING;
+        return;
+    }
 #endif
+    // A streamed body that was refused is never read, so the connection cannot be reused
+    if (conn.request.status() == HttpRequestParser::Status::STREAMING) conn.keepAlive = false;
+    conn.state = HttpConnection::State::WRITING;
+}
+
+static void rejectRequest(HttpConnection &conn, int code, const char *message) {
+    conn.keepAlive = false;
+    sendResponse(conn, code, "text/plain", message);
+    conn.state = HttpConnection::State::WRITING;
+}
+
+static void readRequest(HttpConnection &conn, unsigned long now) {
+    if (conn.request.status() == HttpRequestParser::Status::INCOMPLETE) {
+        // Straight into the parser's buffer; never waits for more bytes
+        int n = recv(conn.client.fd(), conn.request.writePtr(), conn.request.writeRoom(), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EWOULDBLOCK && errno != EAGAIN)) { closeConnection(conn); return; }
+        if (n > 0) {
+            conn.request.commit((size_t)n);
+            conn.lastActivity = now;
+        }
+    }
+    switch (conn.request.status()) {
+        case HttpRequestParser::Status::COMPLETE:
+        case HttpRequestParser::Status::STREAMING:   dispatch(conn); break;
+        case HttpRequestParser::Status::BAD_REQUEST: rejectRequest(conn, 400, "Bad request"); break;
+        case HttpRequestParser::Status::TOO_LARGE:   rejectRequest(conn, 413, "Request too large"); break;
+        case HttpRequestParser::Status::INCOMPLETE:
+            if (now - conn.lastActivity > HTTP_IDLE_TIMEOUT_MS) closeConnection(conn); // Idle keep-alive or stalled client
+            break;
+    }
+}
+
+#if OTA_ENABLED
+// Hashes and flashes whatever part of the image has arrived, one buffer at a time
+static void receiveUpload(HttpConnection &conn, unsigned long now) {
+    HttpRequestParser &req = conn.request;
+    if (req.status() == HttpRequestParser::Status::STREAMING && req.writeRoom() > 0) {
+        int n = recv(conn.client.fd(), req.writePtr(), req.writeRoom(), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EWOULDBLOCK && errno != EAGAIN)) {
+            DebugSerial.println("! WARN: OTA upload aborted, connection closed.");
+            closeConnection(conn);
+            return;
+        }
+        if (n > 0) {
+            req.commit((size_t)n);
+            conn.lastActivity = now;
+        }
+    }
+
+    HttpText chunk = req.takeBody();
+    if (!chunk.empty()) {
+        _otaVerifier.update((const uint8_t*)chunk.data, chunk.len);
+        if (Update.write((uint8_t*)chunk.data, chunk.len) != chunk.len) {
+            abortUpload(conn);
+            rejectRequest(conn, 500, "Write failed");
+            return;
+        }
+    }
+    if (req.bodyRemaining() > 0) {
+        if (now - conn.lastActivity > HTTP_IDLE_TIMEOUT_MS) {
+            DebugSerial.println("! WARN: OTA upload aborted, client stalled.");
+            closeConnection(conn);
+        }
+        return;
+    }
+
+    bool valid = _otaVerifier.finish();
+    _upload = nullptr;
+    conn.keepAlive = req.keepAlive();
+    if (!valid) {
+        Update.abort();
+        DebugSerial.println("! WARN: OTA image rejected, invalid signature.");
+        sendResponse(conn, 403, "text/plain", "Invalid signature");
+    } else if (!Update.end(true)) {
+        sendResponse(conn, 500, "text/plain", "OTA finalize failed");
     } else {
-        sendResponse(client, 404, "text/plain", "Not found");
+        DebugSerial.println("WebServer: OTA image verified, restarting after response.");
+        sendResponse(conn, 200, "text/plain", "ok");
+        conn.restartAfter = true;
     }
+    conn.state = HttpConnection::State::WRITING;
 }
+#endif
+
+static void writeResponse(HttpConnection &conn, unsigned long now) {
+    size_t total = conn.response.length();
+    if (conn.sent < total) {
+        int n = send(conn.client.fd(), conn.response.c_str() + conn.sent, total - conn.sent, MSG_DONTWAIT);
+        if (n < 0 && errno != EWOULDBLOCK && errno != EAGAIN) { closeConnection(conn); return; }
+        if (n > 0) {
+            conn.sent += (size_t)n;
+            conn.lastActivity = now;
+        } else if (now - conn.lastActivity > HTTP_IDLE_TIMEOUT_MS) {
+            closeConnection(conn); // Client stopped reading
+            return;
+        }
+        if (conn.sent < total) return;
+    }
+
+    if (conn.restartAfter) _restartRequested = true; // Carried out by the main loop
+    if (!conn.keepAlive) { closeConnection(conn); return; }
+    conn.response = String();
+    conn.sent = 0;
+    conn.request.next(); // A pipelined request may already be waiting
+    conn.state = HttpConnection::State::READING;
+}
+
+static void serviceConnections() {
+    unsigned long now = millis();
+    acceptClients(now);
+    for (HttpConnection &conn : _connections) {
+        if (conn.state == HttpConnection::State::READING) readRequest(conn, now);
+#if OTA_ENABLED
+        if (conn.state == HttpConnection::State::UPLOADING) receiveUpload(conn, now);
+#endif
+        if (conn.state == HttpConnection::State::WRITING) writeResponse(conn, now);
+    }
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Sleeps until a connection can make progress, at most HTTP_POLL_MS (new clients are polled)
+static void waitForSockets() {
+    fd_set readable, writable;
+    FD_ZERO(&readable);
+    FD_ZERO(&writable);
+    int maxFd = -1;
+    for (HttpConnection &conn : _connections) {
+        int fd = conn.client.fd();
+        if (fd < 0) continue;
+        if (conn.state == HttpConnection::State::READING) {
+            if (conn.request.status() != HttpRequestParser::Status::INCOMPLETE) return; // Pipelined, ready now
+            FD_SET(fd, &readable);
+        } else if (conn.state == HttpConnection::State::UPLOADING) {
+            FD_SET(fd, &readable);
+        } else if (conn.state == HttpConnection::State::WRITING) {
+            FD_SET(fd, &writable);
+        } else {
+            continue;
+        }
+        if (fd > maxFd) maxFd = fd;
+    }
+    if (maxFd < 0) {
+        vTaskDelay(pdMS_TO_TICKS(HTTP_POLL_MS));
+        return;
+    }
+    struct timeval timeout = { 0, (long)(HTTP_POLL_MS * 1000) };
+    select(maxFd + 1, &readable, &writable, nullptr, &timeout);
+}
+
+static void serverTask(void* arg) {
+    (void)arg;
+    for (;;) {
+        waitForSockets();
+        serviceConnections();
+    }
+}
+#endif
 
 void WebServerManager::begin() {
     if (!SPIFFS.begin(true)) DebugSerial.println("WebServer: SPIFFS mount failed"); else DebugSerial.println("WebServer: SPIFFS mounted");
     _server.begin();
+    _server.setNoDelay(true);
+#if defined(ARDUINO_ARCH_ESP32)
+    if (xTaskCreate(serverTask, "http_server", HTTP_TASK_STACK, nullptr, HTTP_TASK_PRIORITY, &_task) != pdPASS) {
+        _task = nullptr;
+        DebugSerial.println("! WARN: WebServer task not started, serving from the main loop.");
+    }
+#endif
     DebugSerial.print("WebServer: started on port "); DebugSerial.println(WEBSERVER_PORT);
 }
 
 void WebServerManager::loop() {
-    WiFiClient client = _server.available();
-    if (client) {
-        if (client.connected()) {
-            processHttpClient(client);
-            delay(1);
-            client.stop();
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_task) {
+        HttpConnection* conn = _dispatched;
+        if (conn) {
+            handleRequest(*conn);
+            _dispatched = nullptr;
+            xTaskNotifyGive(_task);
         }
+    } else
+#endif
+    {
+        serviceConnections(); // Non-blocking socket calls only
+    }
+
+    if (_restartRequested) {
+        reticulumNode.saveStateForRestart();
+        delay(100); // Let the TCP stack flush the response
+        ESP.restart();
     }
 }
 
 bool WebServerManager::loadConfigFromFS(const char* path) {
-#if JSON_CONFIG_ENABLED
-    if (!SPIFFS.exists(path)) return false;
-    File f = SPIFFS.open(path, FILE_READ);
-    if (!f) return false;
-    DynamicJsonDocument doc(2048);
-    DeserializationError err = deserializeJson(doc, f);
-    f.close();
-    return !err;
-#else
-    (void)path; return false;
-#endif
+    RuntimeConfig previous = runtimeConfig;
+    if (!runtimeConfig.load(path)) return false;
+    reticulumNode.applyRuntimeConfig(previous);
+    return true;
 }
 
 bool WebServerManager::saveConfigToFS(const char* path) {
@@ -0,0 +1,93 @@
+#include "WiFiConnection.h"
+#include <climits> // For ULONG_MAX
+
+WiFiConnection::WiFiConnection() :
+    _pending(0), _lastEvent(0), _state(State::IDLE), _failures(0), _deadline(0),
+    _attempts(0), _connects(0), _disconnects(0), _firstConnectMs(0)
+{}
+
+uint8_t WiFiConnection::begin(unsigned long now) {
+    _state = State::CONNECTING;
+    _deadline = now + WIFI_CONNECT_TIMEOUT_MS;
+    _attempts++;
+    return ACTION_CONNECT;
+}
+
+uint8_t WiFiConnection::stop() {
+    uint8_t actions = ACTION_NONE;
+    if (_state == State::CONNECTED) actions |= ACTION_DETACH;
+    if (_state != State::IDLE) actions |= ACTION_DISCONNECT;
+    _state = State::IDLE;
+    _failures = 0;
+    _pending.store(0);
+    return actions;
+}
+
+void WiFiConnection::post(Event event) {
+    _lastEvent.store(event);
+    _pending.fetch_or(event);
+}
+
+uint8_t WiFiConnection::poll(unsigned long now) {
+    uint32_t events = _pending.exchange(0);
+    uint8_t actions = ACTION_NONE;
+    State previous = _state;
+    bool down = (events & (EVENT_LOST_IP | EVENT_DISCONNECTED)) != 0;
+    // Both pending: the connection ended up in whichever state was reported last
+    bool up = (events & EVENT_GOT_IP) && (!down || _lastEvent.load() == EVENT_GOT_IP);
+
+    if (down && _state == State::CONNECTED) {
+        _disconnects++;
+        actions |= ACTION_DETACH;
+        _failures = 0; // A connection that worked is retried soon
+        fail(now);
+    } else if (down && _state == State::CONNECTING && !up) {
+        fail(now);
+    }
+
+    if (up) {
+        // Also from BACKOFF: the station may be connected by someone else (new credentials)
+        connected(now);
+        return actions | ACTION_ATTACH; // Again on an IP change, so UDP binds to the new address
+    }
+
+    if (_state == State::CONNECTING && (long)(now - _deadline) >= 0) {
+        fail(now);
+    } else if (_state == State::BACKOFF && (long)(now - _deadline) >= 0) {
+        _state = State::CONNECTING;
+        _deadline = now + WIFI_CONNECT_TIMEOUT_MS;
+        _attempts++;
+        actions |= ACTION_CONNECT;
+    }
+    // An attempt or connection just ended: drop it now, so its disconnect event
+    // arrives during BACKOFF (where it changes nothing) and the retry starts clean
+    if (_state == State::BACKOFF && previous != State::BACKOFF) actions |= ACTION_DISCONNECT;
+    return actions;
+}
+
+void WiFiConnection::fail(unsigned long now) {
+    if (_failures < UINT8_MAX) _failures++;
+    _state = State::BACKOFF;
+    _deadline = now + backoffDelay(_failures);
+}
+
+void WiFiConnection::connected(unsigned long now) {
+    if (_state != State::CONNECTED) {
+        _connects++;
+        if (_firstConnectMs == 0) _firstConnectMs = now ? now : 1;
+    }
+    _state = State::CONNECTED;
+    _failures = 0;
+}
+
+unsigned long WiFiConnection::msUntilDeadline(unsigned long now) const {
+    if (_state != State::CONNECTING && _state != State::BACKOFF) return ULONG_MAX;
+    long left = (long)(_deadline - now);
+    return left > 0 ? (unsigned long)left : 0;
+}
+
+unsigned long WiFiConnection::backoffDelay(uint8_t failures) {
+    unsigned long delayMs = WIFI_RECONNECT_MIN_MS;
+    for (uint8_t i = 1; i < failures && delayMs < WIFI_RECONNECT_MAX_MS; i++) delayMs *= 2;
+    return delayMs < WIFI_RECONNECT_MAX_MS ? delayMs : WIFI_RECONNECT_MAX_MS;
+}
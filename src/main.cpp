@@ -1,6 +1,8 @@
 #include <Arduino.h>
 #include "ReticulumNode.h"
 #include "Utils.h"
+#include "Identity.h"
+#include "WebServer.h"
 
 // Global instance of the main node application class
 ReticulumNode reticulumNode;
@@ -43,6 +45,9 @@ void setup()
   // Register the application data handler
   reticulumNode.setAppDataHandler(myAppDataReceiver);
 
+  // REST API (no-op unless built with WEBSERVER_ENABLED); sockets are served on their own task
+  WebServerManager::begin();
+
   DebugSerial.println("-----------------------------------");
   DebugSerial.println(" Setup Complete. Entering main loop.");
   DebugSerial.println("-----------------------------------");
@@ -53,6 +58,9 @@ void loop()
   // Run the main node loop function
   reticulumNode.loop();
 
+  // Handle a web request the server task has parsed, if any
+  WebServerManager::loop();
+
 #if DEMO_TRAFFIC_ENABLED
   // SEND MESSAGE EVERY 10 SECONDS (demo mode)
   static uint32_t last_send = 0;
@@ -60,8 +68,8 @@ void loop()
     last_send = millis();
 
     // Full 16-byte destination hash for PLAIN destination ["esp32", "node"]
-    uint8_t dest_hash[16] = {0xB6, 0x01, 0x0E, 0xA1, 0x1F, 0xDF, 0xC0, 0x4E,
-                             0x01, 0x88, 0x3B, 0xD6, 0x06, 0xC5, 0x42, 0xD7};
+    uint8_t dest_hash[16];
+    Identity::destinationHash("esp32.node", nullptr, dest_hash);
 
     // Prepare message payload
     const char* msg = "Hello from ESP32";
@@ -0,0 +1,38 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "AirtimeTracker.h"
+
+void test_lora_time_on_air_sf7() {
+    // 219-byte frame at SF7/125 kHz, CR 4/5, 8-symbol preamble: ~348 ms
+    uint32_t toa = AirtimeTracker::loraTimeOnAirMs(219, 7, 125.0f, 5, 8);
+    TEST_ASSERT_UINT32_WITHIN(2, 348, toa);
+}
+
+void test_lora_time_on_air_grows_with_sf() {
+    uint32_t sf7 = AirtimeTracker::loraTimeOnAirMs(50, 7, 125.0f, 5, 8);
+    uint32_t sf12 = AirtimeTracker::loraTimeOnAirMs(50, 12, 125.0f, 5, 8);
+    TEST_ASSERT_GREATER_THAN(sf7 * 16, sf12);
+}
+
+void test_budget_enforced_and_expires() {
+    AirtimeTracker tracker(1.0f, 120000); // 1% of 120 s = 1200 ms
+    TEST_ASSERT_EQUAL_UINT32(1200, tracker.getBudgetMs());
+    TEST_ASSERT_TRUE(tracker.canTransmit(1000, 0));
+    tracker.record(1000, 0);
+    TEST_ASSERT_TRUE(tracker.canTransmit(200, 5000));
+    TEST_ASSERT_FALSE(tracker.canTransmit(300, 5000));
+    // Once the whole window has passed the usage is forgotten
+    TEST_ASSERT_EQUAL_UINT32(0, tracker.getUsedMs(130000));
+    TEST_ASSERT_TRUE(tracker.canTransmit(1200, 130000));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_lora_time_on_air_sf7);
+    RUN_TEST(test_lora_time_on_air_grows_with_sf);
+    RUN_TEST(test_budget_enforced_and_expires);
+    UNITY_END();
+}
+
+void loop() {}
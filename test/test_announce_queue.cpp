@@ -0,0 +1,61 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "AnnounceQueue.h"
+
+static const uint8_t DEST_A[RNS_ADDRESS_SIZE] = {1, 1, 1, 1, 1, 1, 1, 1};
+static const uint8_t DEST_B[RNS_ADDRESS_SIZE] = {2, 2, 2, 2, 2, 2, 2, 2};
+
+void test_lowest_hops_first() {
+    AnnounceQueue queue;
+    const uint8_t far[] = {0xAA};
+    const uint8_t near[] = {0xBB};
+    uint32_t mask = AnnounceQueue::interfaceBit(InterfaceType::ESP_NOW);
+    queue.enqueue(far, sizeof(far), DEST_A, 5, mask, 0, 0);
+    queue.enqueue(near, sizeof(near), DEST_B, 1, mask, 0, 0);
+
+    std::vector<uint8_t> out;
+    TEST_ASSERT_TRUE(queue.next(InterfaceType::ESP_NOW, out, 0));
+    TEST_ASSERT_EQUAL_UINT8(0xBB, out[0]);
+}
+
+void test_fresher_announce_replaces_queued() {
+    AnnounceQueue queue;
+    const uint8_t stale[] = {0x01};
+    const uint8_t fresh[] = {0x02};
+    uint32_t mask = AnnounceQueue::interfaceBit(InterfaceType::ESP_NOW);
+    queue.enqueue(stale, sizeof(stale), DEST_A, 2, mask, 0, 0);
+    queue.enqueue(fresh, sizeof(fresh), DEST_A, 2, mask, 0, 10);
+
+    TEST_ASSERT_EQUAL(1, queue.size());
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getSuppressedCount());
+    std::vector<uint8_t> out;
+    TEST_ASSERT_TRUE(queue.next(InterfaceType::ESP_NOW, out, 10));
+    TEST_ASSERT_EQUAL_UINT8(0x02, out[0]);
+}
+
+void test_bandwidth_cap_and_delay() {
+    AnnounceQueue queue;
+    const uint8_t pkt[] = {0x01};
+    uint32_t mask = AnnounceQueue::interfaceBit(InterfaceType::LORA);
+    queue.enqueue(pkt, sizeof(pkt), DEST_A, 1, mask, 300, 0);
+    queue.enqueue(pkt, sizeof(pkt), DEST_B, 1, mask, 0, 0);
+
+    std::vector<uint8_t> out;
+    TEST_ASSERT_TRUE(queue.next(InterfaceType::LORA, out, 0));   // DEST_B, no delay
+    queue.recordTransmit(InterfaceType::LORA, 100, 0);          // 100 ms on air at 2% cap
+    unsigned long holdoff = (unsigned long)(100 * (100.0f / ANNOUNCE_CAP_PERCENT));
+    TEST_ASSERT_FALSE(queue.next(InterfaceType::LORA, out, 1000));
+    TEST_ASSERT_EQUAL_UINT32(holdoff - 1000, queue.msUntilReady(mask, 1000));
+    TEST_ASSERT_TRUE(queue.next(InterfaceType::LORA, out, holdoff));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_lowest_hops_first);
+    RUN_TEST(test_fresher_announce_replaces_queued);
+    RUN_TEST(test_bandwidth_cap_and_delay);
+    UNITY_END();
+}
+
+void loop() {}
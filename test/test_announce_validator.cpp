@@ -0,0 +1,168 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "AnnounceValidator.h"
+
+// Announce for fullName signed by identity, in the official payload layout
+static void buildAnnounce(const Identity& identity, const char* fullName, uint8_t randomTag, RnsPacketInfo& out) {
+    const uint8_t appData[] = {'n', 'o', 'd', 'e'};
+    uint8_t nameHash[Identity::NAME_HASH_SIZE];
+    uint8_t randomHash[AnnounceValidator::RANDOM_HASH_SIZE];
+    memset(randomHash, randomTag, sizeof(randomHash));
+    Identity::nameHash(fullName, nameHash);
+    Identity::destinationHash(fullName, &identity, out.destination_hash);
+    out.packet_type = RNS_PACKET_ANNOUNCE;
+    out.context_flag = false;
+
+    std::vector<uint8_t> signedData(out.destination_hash, out.destination_hash + Identity::HASH_SIZE);
+    signedData.insert(signedData.end(), identity.getPublicKey(), identity.getPublicKey() + Identity::PUBLIC_KEY_SIZE);
+    signedData.insert(signedData.end(), nameHash, nameHash + sizeof(nameHash));
+    signedData.insert(signedData.end(), randomHash, randomHash + sizeof(randomHash));
+    signedData.insert(signedData.end(), appData, appData + sizeof(appData));
+    uint8_t signature[Identity::SIGNATURE_SIZE];
+    identity.sign(signedData.data(), signedData.size(), signature);
+
+    out.data.assign(identity.getPublicKey(), identity.getPublicKey() + Identity::PUBLIC_KEY_SIZE);
+    out.data.insert(out.data.end(), nameHash, nameHash + sizeof(nameHash));
+    out.data.insert(out.data.end(), randomHash, randomHash + sizeof(randomHash));
+    out.data.insert(out.data.end(), signature, signature + sizeof(signature));
+    out.data.insert(out.data.end(), appData, appData + sizeof(appData));
+}
+
+static const size_t SIGNATURE_OFFSET = Identity::PUBLIC_KEY_SIZE + Identity::NAME_HASH_SIZE +
+                                       AnnounceValidator::RANDOM_HASH_SIZE;
+
+void test_parse_checks_destination_hash() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo packet;
+    buildAnnounce(identity, "esp32.node", 1, packet);
+    AnnounceValidator::Announce announce;
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(packet, announce));
+    TEST_ASSERT_EQUAL(4, announce.appDataLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(identity.getHash(), announce.identityHash, Identity::HASH_SIZE);
+
+    packet.destination_hash[0] ^= 0x01; // Claiming someone else's destination
+    TEST_ASSERT_FALSE(AnnounceValidator::parse(packet, announce));
+    packet.data.resize(SIGNATURE_OFFSET);
+    TEST_ASSERT_FALSE(AnnounceValidator::parse(packet, announce));
+}
+
+void test_duplicates_verified_once() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo packet;
+    buildAnnounce(identity, "esp32.node", 2, packet);
+    AnnounceValidator::Announce announce;
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(packet, announce));
+
+    AnnounceValidator validator;
+    TEST_ASSERT_TRUE(validator.verify(announce));
+    TEST_ASSERT_TRUE(validator.verify(announce)); // Same announce via another interface
+    TEST_ASSERT_EQUAL_UINT32(1, validator.getVerifiedCount());
+    TEST_ASSERT_EQUAL_UINT32(1, validator.getCacheHitCount());
+    TEST_ASSERT_TRUE(validator.verifyDeferred(announce) == AnnounceValidator::Result::VALID);
+}
+
+void test_forged_signature_rejected() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo packet;
+    buildAnnounce(identity, "esp32.node", 3, packet);
+    packet.data[SIGNATURE_OFFSET] ^= 0x01;
+    AnnounceValidator::Announce announce;
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(packet, announce)); // Layout and hash are fine
+
+    AnnounceValidator validator;
+    TEST_ASSERT_FALSE(validator.verify(announce));
+    TEST_ASSERT_FALSE(validator.verify(announce));
+    TEST_ASSERT_EQUAL_UINT32(1, validator.getInvalidCount());
+}
+
+void test_cache_keyed_on_signed_content() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo genuine, forged, altered;
+    buildAnnounce(identity, "esp32.node", 6, genuine);
+    forged = genuine;
+    forged.data[SIGNATURE_OFFSET] ^= 0x01;
+    altered = genuine;
+    altered.data.back() ^= 0x01; // Different app data under the genuine signature
+    AnnounceValidator::Announce a, f, x;
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(genuine, a));
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(forged, f));
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(altered, x));
+
+    AnnounceValidator validator;
+    TEST_ASSERT_FALSE(validator.verify(f)); // Forged copy arrives first...
+    TEST_ASSERT_TRUE(validator.verify(a));  // ...and does not block the genuine announce
+    TEST_ASSERT_FALSE(validator.verify(x)); // Same identity and random hash, but checked again
+    TEST_ASSERT_EQUAL_UINT32(3, validator.getVerifiedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, validator.getCacheHitCount());
+}
+
+void test_deferred_forgery_reported() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo genuine, forged;
+    buildAnnounce(identity, "esp32.node", 4, genuine);
+    buildAnnounce(identity, "esp32.node", 5, forged);
+    forged.data[SIGNATURE_OFFSET] ^= 0x01;
+    AnnounceValidator::Announce a, b;
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(genuine, a));
+    TEST_ASSERT_TRUE(AnnounceValidator::parse(forged, b));
+
+    AnnounceValidator validator;
+    validator.begin();
+    uint8_t digest[AnnounceValidator::DIGEST_SIZE], copyDigest[AnnounceValidator::DIGEST_SIZE];
+    TEST_ASSERT_TRUE(validator.verifyDeferred(a) == AnnounceValidator::Result::PENDING);
+    TEST_ASSERT_TRUE(validator.verifyDeferred(b, digest) == AnnounceValidator::Result::PENDING);
+    TEST_ASSERT_TRUE(validator.verifyDeferred(b, copyDigest) == AnnounceValidator::Result::PENDING); // Already queued
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(digest, copyDigest, AnnounceValidator::DIGEST_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(2, validator.getDeferredCount());
+
+    std::vector<AnnounceValidator::Verdict> verdicts;
+    for (int i = 0; i < 100 && validator.getVerifiedCount() < 2; i++) {
+        validator.collect(verdicts);
+        delay(10);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, validator.getVerifiedCount());
+    TEST_ASSERT_EQUAL(2, verdicts.size());
+    const AnnounceValidator::Verdict& rejected = verdicts[0].valid ? verdicts[1] : verdicts[0];
+    TEST_ASSERT_FALSE(rejected.valid);
+    TEST_ASSERT_TRUE(verdicts[0].valid != verdicts[1].valid);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(forged.destination_hash, rejected.destinationHash, Identity::HASH_SIZE);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(b.randomHash, rejected.randomHash, AnnounceValidator::RANDOM_HASH_SIZE);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(digest, rejected.digest, AnnounceValidator::DIGEST_SIZE);
+    TEST_ASSERT_TRUE(validator.verifyDeferred(a) == AnnounceValidator::Result::VALID);
+}
+
+void test_full_queue_skips() {
+    Identity identity;
+    identity.generate();
+    AnnounceValidator validator; // No task: nothing leaves the queue until collect()
+    RnsPacketInfo packets[ANNOUNCE_VERIFY_QUEUE_SIZE + 1];
+    AnnounceValidator::Announce announces[ANNOUNCE_VERIFY_QUEUE_SIZE + 1];
+    for (size_t i = 0; i <= ANNOUNCE_VERIFY_QUEUE_SIZE; i++) {
+        buildAnnounce(identity, "esp32.node", (uint8_t)(10 + i), packets[i]);
+        TEST_ASSERT_TRUE(AnnounceValidator::parse(packets[i], announces[i]));
+    }
+    for (size_t i = 0; i < ANNOUNCE_VERIFY_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(validator.verifyDeferred(announces[i]) == AnnounceValidator::Result::PENDING);
+    }
+    TEST_ASSERT_TRUE(validator.verifyDeferred(announces[ANNOUNCE_VERIFY_QUEUE_SIZE]) == AnnounceValidator::Result::SKIPPED);
+    TEST_ASSERT_EQUAL_UINT32(1, validator.getSkippedCount());
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_checks_destination_hash);
+    RUN_TEST(test_duplicates_verified_once);
+    RUN_TEST(test_forged_signature_rejected);
+    RUN_TEST(test_cache_keyed_on_signed_content);
+    RUN_TEST(test_deferred_forgery_reported);
+    RUN_TEST(test_full_queue_skips);
+    UNITY_END();
+}
+
+void loop() {}
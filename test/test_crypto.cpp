@@ -0,0 +1,126 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "Config.h"
+#include "Crypto.h"
+
+static void fromHex(const char* hex, uint8_t* out) {
+    for (size_t i = 0; hex[2 * i]; i++) {
+        char byte[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        out[i] = (uint8_t)strtoul(byte, nullptr, 16);
+    }
+}
+
+void test_sha256_known_answer() {
+    uint8_t expected[32], digest[32];
+    fromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", expected);
+    Crypto::sha256((const uint8_t*)"abc", 3, digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, digest, 32);
+
+    // Same digest when fed in pieces that straddle block boundaries
+    uint8_t data[200];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)i;
+    uint8_t oneShot[32];
+    Crypto::sha256(data, sizeof(data), oneShot);
+    Crypto::Sha256 hash;
+    hash.update(data, 7);
+    hash.update(data + 7, 100);
+    hash.update(data + 107, 93);
+    hash.finish(digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(oneShot, digest, 32);
+}
+
+void test_hmac_and_hkdf_rfc_vectors() {
+    // RFC 4231 test case 1
+    uint8_t key[20], expected[42], out[42];
+    memset(key, 0x0b, sizeof(key));
+    fromHex("b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7", expected);
+    Crypto::hmacSha256(key, sizeof(key), (const uint8_t*)"Hi There", 8, out);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, 32);
+
+    // RFC 5869 test case 1
+    uint8_t ikm[22], salt[13], info[10];
+    memset(ikm, 0x0b, sizeof(ikm));
+    for (size_t i = 0; i < sizeof(salt); i++) salt[i] = (uint8_t)i;
+    for (size_t i = 0; i < sizeof(info); i++) info[i] = (uint8_t)(0xf0 + i);
+    fromHex("3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865", expected);
+    Crypto::hkdf(out, sizeof(out), ikm, sizeof(ikm), salt, sizeof(salt), info, sizeof(info));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, 42);
+}
+
+void test_aes128_known_answer() {
+    // FIPS-197 appendix C.1
+    uint8_t key[16], block[16], expected[16], iv[16] = {0};
+    for (int i = 0; i < 16; i++) { key[i] = (uint8_t)i; block[i] = (uint8_t)(i * 0x11); }
+    fromHex("69c4e0d86a7b0430d8cdb78070b4c55a", expected);
+    Crypto::Aes128 aes;
+    aes.setKey(key);
+    TEST_ASSERT_TRUE(aes.cbcEncrypt(iv, block, block, 16)); // Zero IV: one CBC block is plain AES
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, block, 16);
+    memset(iv, 0, sizeof(iv));
+    TEST_ASSERT_TRUE(aes.cbcDecrypt(iv, block, block, 16));
+    TEST_ASSERT_EQUAL(0x00, block[0]);
+    TEST_ASSERT_EQUAL(0xff, block[15]);
+}
+
+void test_token_roundtrip_and_tamper() {
+    uint8_t key[Crypto::TOKEN_KEY_SIZE];
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)i;
+    Crypto::Token token(key);
+
+    uint8_t plain[40], sealed[128], opened[128];
+    for (size_t i = 0; i < sizeof(plain); i++) plain[i] = (uint8_t)(0xA0 + i);
+    for (size_t len = 0; len <= sizeof(plain); len++) {
+        size_t sealedLen = 0, openedLen = 0;
+        TEST_ASSERT_TRUE(token.encrypt(plain, len, sealed, sizeof(sealed), sealedLen));
+        TEST_ASSERT_EQUAL(Crypto::tokenSize(len), sealedLen);
+        TEST_ASSERT_TRUE(token.decrypt(sealed, sealedLen, opened, sizeof(opened), openedLen));
+        TEST_ASSERT_EQUAL(len, openedLen);
+        if (len) TEST_ASSERT_EQUAL_UINT8_ARRAY(plain, opened, len);
+    }
+
+    size_t sealedLen = 0, openedLen = 0;
+    token.encrypt(plain, sizeof(plain), sealed, sizeof(sealed), sealedLen);
+    sealed[Crypto::AES_BLOCK_SIZE + 3] ^= 0x01; // Flip a ciphertext bit
+    TEST_ASSERT_FALSE(token.decrypt(sealed, sealedLen, opened, sizeof(opened), openedLen));
+    TEST_ASSERT_FALSE(token.encrypt(plain, sizeof(plain), sealed, Crypto::tokenSize(sizeof(plain)) - 1, sealedLen));
+}
+
+// Packets/s for a full-MTU payload; compare the numbers printed on each target
+// (pio test -e esp32-c3-devkitm-1 -f test_crypto, then -e esp32-s3-devkitc-1)
+void test_token_throughput() {
+    uint8_t key[Crypto::TOKEN_KEY_SIZE] = {0};
+    Crypto::Token token(key);
+    static uint8_t plain[RNS_MAX_PAYLOAD - Crypto::TOKEN_MIN_SIZE];
+    static uint8_t sealed[RNS_MAX_PAYLOAD];
+    static uint8_t opened[sizeof(plain) + Crypto::AES_BLOCK_SIZE]; // Room for the padding block
+    size_t sealedLen = 0, openedLen = 0;
+
+    const uint32_t rounds = 200;
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < rounds; i++) token.encrypt(plain, sizeof(plain), sealed, sizeof(sealed), sealedLen);
+    unsigned long encryptUs = micros() - start;
+    start = micros();
+    for (uint32_t i = 0; i < rounds; i++) token.decrypt(sealed, sealedLen, opened, sizeof(opened), openedLen);
+    unsigned long decryptUs = micros() - start;
+    TEST_ASSERT_EQUAL(sizeof(plain), openedLen);
+
+    char line[128];
+    snprintf(line, sizeof(line), "%s hw=%d: %u-byte payload, encrypt %lu pkt/s, decrypt %lu pkt/s",
+             ESP.getChipModel(), CRYPTO_HW_ACCEL, (unsigned)sizeof(plain),
+             (unsigned long)(rounds * 1000000ULL / (encryptUs ? encryptUs : 1)),
+             (unsigned long)(rounds * 1000000ULL / (decryptUs ? decryptUs : 1)));
+    TEST_MESSAGE(line);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_sha256_known_answer);
+    RUN_TEST(test_hmac_and_hkdf_rfc_vectors);
+    RUN_TEST(test_aes128_known_answer);
+    RUN_TEST(test_token_roundtrip_and_tamper);
+    RUN_TEST(test_token_throughput);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,74 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include "Ed25519StreamVerifier.h"
+
+static uint8_t image[3000];
+static uint8_t secretKey[64];
+static uint8_t publicKey[32];
+static uint8_t signature[64];
+
+static void signImage() {
+    uint8_t seed[32];
+    for (int i = 0; i < 32; i++) seed[i] = (uint8_t)(i * 7 + 1);
+    crypto_ed25519_key_pair(secretKey, publicKey, seed); // Wipes the seed
+    for (size_t i = 0; i < sizeof(image); i++) image[i] = (uint8_t)(i * 31 + (i >> 8));
+    crypto_ed25519_sign(signature, secretKey, image, sizeof(image));
+}
+
+static bool verifyInChunks(const uint8_t* sig, const uint8_t* pub, size_t step) {
+    Ed25519StreamVerifier verifier;
+    verifier.begin(sig, pub);
+    for (size_t off = 0; off < sizeof(image); off += step) {
+        size_t n = sizeof(image) - off < step ? sizeof(image) - off : step;
+        verifier.update(image + off, n);
+    }
+    TEST_ASSERT_EQUAL_UINT(sizeof(image), verifier.getLength());
+    return verifier.finish();
+}
+
+void test_matches_one_shot_check() {
+    signImage();
+    TEST_ASSERT_EQUAL_INT(0, crypto_ed25519_check(signature, publicKey, image, sizeof(image)));
+    TEST_ASSERT_TRUE(verifyInChunks(signature, publicKey, sizeof(image)));
+    TEST_ASSERT_TRUE(verifyInChunks(signature, publicKey, 1));
+    TEST_ASSERT_TRUE(verifyInChunks(signature, publicKey, 1460)); // One TCP segment
+}
+
+void test_rejects_tampering() {
+    signImage();
+    image[1234] ^= 0x01;
+    TEST_ASSERT_FALSE(verifyInChunks(signature, publicKey, 512));
+    image[1234] ^= 0x01;
+
+    uint8_t badSig[64];
+    memcpy(badSig, signature, 64);
+    badSig[40] ^= 0x80;
+    TEST_ASSERT_FALSE(verifyInChunks(badSig, publicKey, 512));
+
+    uint8_t otherKey[32];
+    memcpy(otherKey, publicKey, 32);
+    otherKey[0] ^= 0x01;
+    TEST_ASSERT_FALSE(verifyInChunks(signature, otherKey, 512));
+}
+
+void test_finish_requires_begin() {
+    Ed25519StreamVerifier verifier;
+    TEST_ASSERT_FALSE(verifier.finish());
+    signImage();
+    verifier.begin(signature, publicKey);
+    verifier.update(image, sizeof(image));
+    TEST_ASSERT_TRUE(verifier.finish());
+    TEST_ASSERT_FALSE(verifier.finish()); // Single use per begin()
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_one_shot_check);
+    RUN_TEST(test_rejects_tampering);
+    RUN_TEST(test_finish_requires_begin);
+    UNITY_END();
+}
+
+void loop() {}
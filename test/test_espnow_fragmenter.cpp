@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "EspNowFragmenter.h"
+
+static const uint8_t MAC_A[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0A};
+
+// Builds one fragment by hand so multi-fragment packets can be tested at any MTU
+static std::vector<uint8_t> fragment(uint16_t msgId, uint8_t index, uint16_t offset, uint16_t total,
+                                     const uint8_t* data, size_t len) {
+    std::vector<uint8_t> frame = {0x7E, 0xF5, (uint8_t)(msgId >> 8), (uint8_t)msgId, index,
+                                  (uint8_t)(offset >> 8), (uint8_t)offset, (uint8_t)(total >> 8), (uint8_t)total};
+    frame.insert(frame.end(), data, data + len);
+    return frame;
+}
+
+void test_send_and_reassemble_round_trip() {
+    EspNowFragmenter tx, rx;
+    uint8_t packet[150];
+    for (size_t i = 0; i < sizeof(packet); i++) packet[i] = (uint8_t)i;
+    std::vector<std::vector<uint8_t>> frames;
+    TEST_ASSERT_TRUE(tx.send(packet, sizeof(packet), [&](const uint8_t* f, size_t len) {
+        frames.emplace_back(f, f + len);
+        return true;
+    }));
+    const uint8_t* out = nullptr;
+    size_t outLen = 0;
+    bool done = false;
+    for (auto& f : frames) done = rx.reassemble(MAC_A, f.data(), f.size(), out, outLen, 0);
+    TEST_ASSERT_TRUE(done);
+    TEST_ASSERT_EQUAL(sizeof(packet), outLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(packet, out, sizeof(packet));
+}
+
+void test_fragments_leave_room_for_access_code() {
+    EspNowFragmenter tx, rx;
+    const size_t frameMax = EspNowFragmenter::FRAME_MAX - 64; // Largest IFAC, added to every frame
+    uint8_t packet[200];
+    for (size_t i = 0; i < sizeof(packet); i++) packet[i] = (uint8_t)(i * 7);
+    TEST_ASSERT_TRUE(EspNowFragmenter::needsFragmentation(sizeof(packet), frameMax));
+    std::vector<std::vector<uint8_t>> frames;
+    TEST_ASSERT_TRUE(tx.send(packet, sizeof(packet), [&](const uint8_t* f, size_t len) {
+        frames.emplace_back(f, f + len);
+        return true;
+    }, frameMax));
+    TEST_ASSERT_EQUAL(2, frames.size());
+    const uint8_t* out = nullptr;
+    size_t outLen = 0;
+    bool done = false;
+    for (auto& f : frames) {
+        TEST_ASSERT_TRUE(f.size() <= frameMax);
+        done = rx.reassemble(MAC_A, f.data(), f.size(), out, outLen, 0);
+    }
+    TEST_ASSERT_TRUE(done);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(packet, out, sizeof(packet));
+}
+
+void test_out_of_order_and_duplicate_fragments() {
+    EspNowFragmenter rx;
+    uint8_t data[120];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(0xA0 + i);
+    auto second = fragment(7, 1, 60, 120, data + 60, 60);
+    auto first = fragment(7, 0, 0, 120, data, 60);
+    const uint8_t* out = nullptr;
+    size_t outLen = 0;
+    TEST_ASSERT_FALSE(rx.reassemble(MAC_A, second.data(), second.size(), out, outLen, 0));
+    TEST_ASSERT_FALSE(rx.reassemble(MAC_A, second.data(), second.size(), out, outLen, 1)); // Duplicate
+    TEST_ASSERT_TRUE(rx.reassemble(MAC_A, first.data(), first.size(), out, outLen, 2));
+    TEST_ASSERT_EQUAL(120, outLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, out, sizeof(data));
+}
+
+void test_incomplete_packet_times_out() {
+    EspNowFragmenter rx;
+    uint8_t data[60] = {0};
+    auto first = fragment(1, 0, 0, 120, data, 60);
+    auto second = fragment(1, 1, 60, 120, data, 60);
+    const uint8_t* out = nullptr;
+    size_t outLen = 0;
+    rx.reassemble(MAC_A, first.data(), first.size(), out, outLen, 0);
+    // The first half expired; the second half alone starts a new, incomplete packet
+    TEST_ASSERT_FALSE(rx.reassemble(MAC_A, second.data(), second.size(), out, outLen, ESPNOW_REASSEMBLY_TIMEOUT_MS + 1));
+    TEST_ASSERT_EQUAL_UINT32(1, rx.getDroppedCount());
+}
+
+void test_ifac_coded_frame_is_not_a_fragment() {
+    uint8_t data[40] = {0};
+    auto frame = fragment(3, 0, 0, 40, data, sizeof(data));
+    TEST_ASSERT_TRUE(EspNowFragmenter::isFragment(frame.data(), frame.size()));
+    // A frame carrying an access code has bit 7 set; masking may leave anything in the hops byte
+    frame[0] |= 0x80;
+    TEST_ASSERT_FALSE(EspNowFragmenter::isFragment(frame.data(), frame.size()));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_send_and_reassemble_round_trip);
+    RUN_TEST(test_fragments_leave_room_for_access_code);
+    RUN_TEST(test_out_of_order_and_duplicate_fragments);
+    RUN_TEST(test_incomplete_packet_times_out);
+    RUN_TEST(test_ifac_coded_frame_is_not_a_fragment);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "EspNowPeerTable.h"
+
+static const uint8_t MAC_A[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0A};
+static const uint8_t MAC_B[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0B};
+
+void test_status_matches_send_for_latency() {
+    EspNowPeerTable table;
+    table.recordSend(MAC_A, 1000);
+    table.recordSend(MAC_B, 1500);
+    EspNowPeerTable::Peer* b = table.recordResult(MAC_B, true, 2500);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT32(1000, b->latencyUs);
+    TEST_ASSERT_EQUAL_UINT32(1, b->acked);
+}
+
+void test_failures_lower_delivery_ratio() {
+    EspNowPeerTable table;
+    table.recordSend(MAC_A, 0);
+    EspNowPeerTable::Peer* a = table.recordResult(MAC_A, false, 100);
+    TEST_ASSERT_TRUE(a->deliveryRatio < 1.0f);
+    TEST_ASSERT_EQUAL_UINT32(1, table.getTotalSent());
+    TEST_ASSERT_EQUAL_UINT32(0, table.getTotalAcked());
+}
+
+void test_full_table_recycles_least_recent() {
+    EspNowPeerTable table;
+    uint8_t mac[6] = {0x06, 0, 0, 0, 0, 0};
+    for (size_t i = 0; i < ESPNOW_PEER_TABLE_SIZE; i++) {
+        mac[5] = (uint8_t)i;
+        table.touch(mac, 100 + i);
+    }
+    table.touch(MAC_B, 1000); // MAC_B is new; peer 0 (least recently used) is recycled
+    mac[5] = 0;
+    TEST_ASSERT_NULL(table.find(mac));
+    TEST_ASSERT_NOT_NULL(table.find(MAC_B));
+    TEST_ASSERT_EQUAL(ESPNOW_PEER_TABLE_SIZE, table.size());
+}
+
+void test_lru_registered_peer_gives_up_slot() {
+    EspNowPeerTable table;
+    table.setRegistered(table.touch(MAC_A, 100), true);
+    table.setRegistered(table.touch(MAC_B, 200), true);
+    TEST_ASSERT_EQUAL(2, table.getRegisteredCount());
+    EspNowPeerTable::Peer* victim = table.leastRecentRegistered();
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, victim->mac, 6);
+    table.touch(MAC_A, 300); // Used again: MAC_B is now the least recent
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_B, table.leastRecentRegistered()->mac, 6);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, table.leastRecentRegistered(MAC_B)->mac, 6);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_status_matches_send_for_latency);
+    RUN_TEST(test_failures_lower_delivery_ratio);
+    RUN_TEST(test_full_table_recycles_least_recent);
+    RUN_TEST(test_lru_registered_peer_gives_up_slot);
+    UNITY_END();
+}
+
+void loop() {}
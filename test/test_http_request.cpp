@@ -0,0 +1,130 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include "HttpRequest.h"
+
+// Feeds text in chunks of at most step bytes, as socket reads would
+static HttpRequestParser::Status feed(HttpRequestParser& parser, const char* text, size_t step) {
+    HttpRequestParser::Status status = parser.status();
+    size_t len = strlen(text);
+    for (size_t off = 0; off < len; off += step) {
+        size_t n = len - off < step ? len - off : step;
+        if (n > parser.writeRoom()) n = parser.writeRoom();
+        memcpy(parser.writePtr(), text + off, n);
+        status = parser.commit(n);
+    }
+    return status;
+}
+
+void test_parses_request_split_across_reads() {
+    HttpRequestParser parser;
+    const char* request = "POST /api/v1/config HTTP/1.1\r\nHost: node\r\nauthorization: Bearer abc \r\n"
+                          "Content-Length: 7\r\n\r\n{\"a\":1}";
+    TEST_ASSERT_TRUE(feed(parser, request, 3) == HttpRequestParser::Status::COMPLETE);
+    TEST_ASSERT_TRUE(parser.method().equals("POST"));
+    TEST_ASSERT_TRUE(parser.path().equals("/api/v1/config"));
+    TEST_ASSERT_TRUE(parser.header("Authorization").equals("Bearer abc")); // Case-insensitive, trimmed
+    TEST_ASSERT_TRUE(parser.header("X-Missing").empty());
+    TEST_ASSERT_TRUE(parser.body().equals("{\"a\":1}"));
+    TEST_ASSERT_TRUE(parser.keepAlive());
+}
+
+void test_incomplete_until_body_arrives() {
+    HttpRequestParser parser;
+    TEST_ASSERT_TRUE(feed(parser, "POST /x HTTP/1.1\r\nContent-Length: 4\r\n\r\nab", 64) ==
+                     HttpRequestParser::Status::INCOMPLETE);
+    TEST_ASSERT_TRUE(parser.body().empty());
+    TEST_ASSERT_TRUE(feed(parser, "cd", 64) == HttpRequestParser::Status::COMPLETE);
+    TEST_ASSERT_TRUE(parser.body().equals("abcd"));
+}
+
+void test_keep_alive_and_pipelining() {
+    HttpRequestParser parser;
+    const char* two = "GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.0\r\nConnection: keep-alive\r\n\r\nGET /c HTTP/1.0\r\n\r\n";
+    TEST_ASSERT_TRUE(feed(parser, two, 500) == HttpRequestParser::Status::COMPLETE);
+    TEST_ASSERT_TRUE(parser.path().equals("/a"));
+
+    parser.next();
+    TEST_ASSERT_TRUE(parser.status() == HttpRequestParser::Status::COMPLETE);
+    TEST_ASSERT_TRUE(parser.path().equals("/b"));
+    TEST_ASSERT_TRUE(parser.keepAlive());
+
+    parser.next();
+    TEST_ASSERT_TRUE(parser.path().equals("/c"));
+    TEST_ASSERT_FALSE(parser.keepAlive()); // HTTP/1.0 default
+
+    parser.next();
+    TEST_ASSERT_TRUE(parser.status() == HttpRequestParser::Status::INCOMPLETE);
+    TEST_ASSERT_FALSE(parser.hasData());
+    TEST_ASSERT_EQUAL_UINT(HttpRequestParser::BUFFER_SIZE, parser.writeRoom());
+}
+
+void test_rejects_malformed_and_oversized() {
+    HttpRequestParser parser;
+    TEST_ASSERT_TRUE(feed(parser, "GARBAGE\r\n\r\n", 64) == HttpRequestParser::Status::BAD_REQUEST);
+    parser.reset();
+    TEST_ASSERT_TRUE(feed(parser, "GET / HTTP/1.1\r\nNoColon\r\n\r\n", 64) == HttpRequestParser::Status::BAD_REQUEST);
+    parser.reset();
+    TEST_ASSERT_TRUE(feed(parser, "POST / HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n", 64) ==
+                     HttpRequestParser::Status::TOO_LARGE);
+    parser.reset();
+    TEST_ASSERT_TRUE(feed(parser, "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 64) ==
+                     HttpRequestParser::Status::BAD_REQUEST);
+
+    // Headers that never end fill the buffer
+    parser.reset();
+    HttpRequestParser::Status status = feed(parser, "GET / HTTP/1.1\r\n", 64);
+    while (status == HttpRequestParser::Status::INCOMPLETE && parser.writeRoom() > 0) {
+        status = feed(parser, "X-Filler: 0123456789\r\n", 64);
+    }
+    TEST_ASSERT_TRUE(status == HttpRequestParser::Status::TOO_LARGE);
+}
+
+void test_streams_body_larger_than_buffer() {
+    HttpRequestParser parser;
+    const size_t total = HttpRequestParser::BUFFER_SIZE * 3 + 17;
+    char head[96];
+    snprintf(head, sizeof(head), "POST /api/v1/ota HTTP/1.1\r\nContent-Length: %u\r\n\r\n", (unsigned)total);
+    TEST_ASSERT_TRUE(feed(parser, head, 64) == HttpRequestParser::Status::STREAMING);
+    TEST_ASSERT_TRUE(parser.path().equals("/api/v1/ota"));
+    TEST_ASSERT_TRUE(parser.body().empty());
+
+    // Body bytes i % 251, followed by a pipelined request
+    size_t sent = 0, received = 0;
+    bool intact = true;
+    while (parser.bodyRemaining() > 0) {
+        size_t room = parser.writeRoom();
+        TEST_ASSERT_TRUE(room > 0);
+        size_t n = 0;
+        while (n < room && n < 700 && sent < total) parser.writePtr()[n++] = (char)(sent++ % 251);
+        if (sent == total && n < room) {
+            const char* tail = "GET /b HTTP/1.1\r\n\r\n";
+            size_t t = strlen(tail) < room - n ? strlen(tail) : 0;
+            memcpy(parser.writePtr() + n, tail, t);
+            n += t;
+        }
+        parser.commit(n);
+        HttpText chunk = parser.takeBody();
+        for (size_t i = 0; i < chunk.len; i++) intact &= (uint8_t)chunk.data[i] == (received++ % 251);
+    }
+    TEST_ASSERT_TRUE(intact);
+    TEST_ASSERT_EQUAL_UINT(total, received);
+    TEST_ASSERT_TRUE(parser.status() == HttpRequestParser::Status::COMPLETE);
+
+    parser.next();
+    TEST_ASSERT_TRUE(parser.status() == HttpRequestParser::Status::COMPLETE);
+    TEST_ASSERT_TRUE(parser.path().equals("/b"));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_parses_request_split_across_reads);
+    RUN_TEST(test_incomplete_until_body_arrives);
+    RUN_TEST(test_keep_alive_and_pipelining);
+    RUN_TEST(test_rejects_malformed_and_oversized);
+    RUN_TEST(test_streams_body_larger_than_buffer);
+    UNITY_END();
+}
+
+void loop() {}
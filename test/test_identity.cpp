@@ -0,0 +1,78 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "Identity.h"
+
+void test_plain_destination_hash() {
+    // ["esp32", "node"], as computed by the Python reference implementation
+    const uint8_t expected[16] = {0xB6, 0x01, 0x0E, 0xA1, 0x1F, 0xDF, 0xC0, 0x4E,
+                                  0x01, 0x88, 0x3B, 0xD6, 0x06, 0xC5, 0x42, 0xD7};
+    uint8_t hash[Identity::HASH_SIZE];
+    Identity::destinationHash("esp32.node", nullptr, hash);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, hash, 16);
+
+    Identity::destinationHash("rnstransport.path.request", nullptr, hash);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(RNS_PATH_REQUEST_HASH, hash, 16);
+}
+
+void test_identity_destination_hash_depends_on_keys() {
+    Identity a, b;
+    a.generate();
+    b.generate();
+    uint8_t hashA[16], hashB[16], plain[16];
+    Identity::destinationHash("esp32.node", &a, hashA);
+    Identity::destinationHash("esp32.node", &b, hashB);
+    Identity::destinationHash("esp32.node", nullptr, plain);
+    TEST_ASSERT_FALSE(memcmp(hashA, hashB, 16) == 0);
+    TEST_ASSERT_FALSE(memcmp(hashA, plain, 16) == 0);
+}
+
+void test_private_key_roundtrip() {
+    Identity original;
+    original.generate();
+    uint8_t privateKey[Identity::PRIVATE_KEY_SIZE];
+    original.getPrivateKey(privateKey);
+
+    Identity restored;
+    TEST_ASSERT_TRUE(restored.loadPrivateKey(privateKey, sizeof(privateKey)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(original.getPublicKey(), restored.getPublicKey(), Identity::PUBLIC_KEY_SIZE);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(original.getHash(), restored.getHash(), Identity::HASH_SIZE);
+}
+
+void test_sign_and_verify() {
+    Identity signer;
+    signer.generate();
+    Identity peer; // Public half only, as learned from an announce
+    TEST_ASSERT_TRUE(peer.loadPublicKey(signer.getPublicKey(), Identity::PUBLIC_KEY_SIZE));
+    TEST_ASSERT_FALSE(peer.hasPrivateKey());
+
+    const uint8_t message[] = "announce";
+    uint8_t signature[Identity::SIGNATURE_SIZE];
+    TEST_ASSERT_TRUE(signer.sign(message, sizeof(message), signature));
+    TEST_ASSERT_TRUE(peer.verify(message, sizeof(message), signature));
+    signature[0] ^= 0x01;
+    TEST_ASSERT_FALSE(peer.verify(message, sizeof(message), signature));
+    TEST_ASSERT_FALSE(peer.sign(message, sizeof(message), signature));
+}
+
+void test_key_exchange_agrees() {
+    Identity a, b;
+    a.generate();
+    b.generate();
+    uint8_t secretA[32], secretB[32];
+    TEST_ASSERT_TRUE(a.exchange(b.getPublicKey(), secretA));
+    TEST_ASSERT_TRUE(b.exchange(a.getPublicKey(), secretB));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(secretA, secretB, 32);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_plain_destination_hash);
+    RUN_TEST(test_identity_destination_hash_depends_on_keys);
+    RUN_TEST(test_private_key_roundtrip);
+    RUN_TEST(test_sign_and_verify);
+    RUN_TEST(test_key_exchange_agrees);
+    UNITY_END();
+}
+
+void loop() {}
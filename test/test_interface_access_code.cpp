@@ -0,0 +1,97 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include "InterfaceAccessCode.h"
+
+static const size_t CODE_SIZE = 8;
+
+// A HEADER_1 announce-sized frame: flags, hops, destination, context, data
+static size_t makeFrame(uint8_t* frame) {
+    size_t len = 0;
+    frame[len++] = 0x01; // HEADER_1, announce
+    frame[len++] = 0x00; // Hops
+    for (int i = 0; i < 16; i++) frame[len++] = (uint8_t)(0xA0 + i);
+    frame[len++] = 0x00; // Context
+    for (int i = 0; i < 40; i++) frame[len++] = (uint8_t)i;
+    return len;
+}
+
+void test_configure_rejects_empty_and_oversized() {
+    InterfaceAccessCode ifac;
+    TEST_ASSERT_FALSE(ifac.configure(nullptr, "", CODE_SIZE));
+    TEST_ASSERT_FALSE(ifac.configure("net", nullptr, 0));
+    TEST_ASSERT_FALSE(ifac.configure("net", nullptr, RNS_IFAC_MAX_SIZE + 1));
+    TEST_ASSERT_FALSE(ifac.isEnabled());
+    TEST_ASSERT_TRUE(ifac.configure("net", nullptr, CODE_SIZE));
+    TEST_ASSERT_EQUAL_UINT(CODE_SIZE, ifac.getSize());
+}
+
+void test_apply_then_verify_restores_frame() {
+    InterfaceAccessCode sender, receiver;
+    sender.configure("testnet", "passphrase", CODE_SIZE);
+    receiver.configure("testnet", "passphrase", CODE_SIZE);
+
+    uint8_t frame[MAX_PACKET_SIZE], coded[MAX_PACKET_SIZE], plain[MAX_PACKET_SIZE];
+    size_t len = makeFrame(frame), codedLen = 0, plainLen = 0;
+    TEST_ASSERT_TRUE(sender.apply(frame, len, coded, sizeof(coded), codedLen));
+    TEST_ASSERT_EQUAL_UINT(len + CODE_SIZE, codedLen);
+    TEST_ASSERT_TRUE(InterfaceAccessCode::hasFlag(coded, codedLen));
+    TEST_ASSERT_TRUE(memcmp(coded + 2 + CODE_SIZE, frame + 2, len - 2) != 0); // Masked
+
+    TEST_ASSERT_TRUE(receiver.verify(coded, codedLen, plain, sizeof(plain), plainLen));
+    TEST_ASSERT_EQUAL_UINT(len, plainLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, plain, len);
+}
+
+void test_other_network_and_tampering_rejected() {
+    InterfaceAccessCode sender, stranger;
+    sender.configure("testnet", "passphrase", CODE_SIZE);
+    stranger.configure("testnet", "other passphrase", CODE_SIZE);
+
+    uint8_t frame[MAX_PACKET_SIZE], coded[MAX_PACKET_SIZE], plain[MAX_PACKET_SIZE];
+    size_t len = makeFrame(frame), codedLen = 0, plainLen = 0;
+    sender.apply(frame, len, coded, sizeof(coded), codedLen);
+    TEST_ASSERT_FALSE(stranger.verify(coded, codedLen, plain, sizeof(plain), plainLen));
+
+    InterfaceAccessCode receiver;
+    receiver.configure("testnet", "passphrase", CODE_SIZE);
+    coded[codedLen - 1] ^= 0x01;
+    TEST_ASSERT_FALSE(receiver.verify(coded, codedLen, plain, sizeof(plain), plainLen));
+    // Unflagged and truncated frames fail without a signature
+    TEST_ASSERT_FALSE(receiver.verify(frame, len, plain, sizeof(plain), plainLen));
+    TEST_ASSERT_FALSE(receiver.verify(coded, 2 + CODE_SIZE, plain, sizeof(plain), plainLen));
+}
+
+void test_repeated_frame_hits_cache() {
+    InterfaceAccessCode sender, receiver;
+    sender.configure("testnet", nullptr, CODE_SIZE);
+    receiver.configure("testnet", nullptr, CODE_SIZE);
+
+    uint8_t frame[MAX_PACKET_SIZE], coded[MAX_PACKET_SIZE], plain[MAX_PACKET_SIZE];
+    size_t len = makeFrame(frame), codedLen = 0, plainLen = 0;
+    sender.apply(frame, len, coded, sizeof(coded), codedLen);
+    TEST_ASSERT_TRUE(receiver.verify(coded, codedLen, plain, sizeof(plain), plainLen));
+    TEST_ASSERT_EQUAL_UINT32(0, receiver.getCacheHitCount());
+    memset(plain, 0, sizeof(plain));
+    TEST_ASSERT_TRUE(receiver.verify(coded, codedLen, plain, sizeof(plain), plainLen));
+    TEST_ASSERT_EQUAL_UINT32(1, receiver.getCacheHitCount());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, plain, len); // Still unmasked on a hit
+
+    // A rejected frame stays rejected
+    coded[codedLen - 1] ^= 0x01;
+    TEST_ASSERT_FALSE(receiver.verify(coded, codedLen, plain, sizeof(plain), plainLen));
+    TEST_ASSERT_FALSE(receiver.verify(coded, codedLen, plain, sizeof(plain), plainLen));
+    TEST_ASSERT_EQUAL_UINT32(2, receiver.getCacheHitCount());
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_configure_rejects_empty_and_oversized);
+    RUN_TEST(test_apply_then_verify_restores_frame);
+    RUN_TEST(test_other_network_and_tampering_rejected);
+    RUN_TEST(test_repeated_frame_hits_cache);
+    UNITY_END();
+}
+
+void loop() {}
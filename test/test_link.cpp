@@ -0,0 +1,214 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include <vector>
+#include "Link.h"
+#include "LinkManager.h"
+#include "ReticulumPacket.h"
+
+// Two links talking through their serialized frames. Link only uses the LinkManager
+// members defined below, so the node behind a real manager is left out of the build.
+struct Peer {
+    const LinkManager* manager;
+    uint8_t address[RNS_ADDRESS_SIZE];
+    uint16_t nextPacketId;
+    std::vector<std::vector<uint8_t>> sent;
+    std::vector<std::vector<uint8_t>> received;
+};
+static Peer peers[2];
+static uint8_t nodeStorage; // Stands in for the node; the members below never touch it
+
+static Peer& peerOf(const LinkManager* manager) { return manager == peers[0].manager ? peers[0] : peers[1]; }
+
+LinkManager::LinkManager(ReticulumNode& owner) : _ownerRef(owner) {}
+void LinkManager::begin() {
+    _cryptoPool.begin(0, 1);
+    _cryptoPool.acquire(); // Slot 0, for the one link each peer runs
+}
+const uint8_t* LinkManager::getNodeAddress() const { return peerOf(this).address; }
+uint16_t LinkManager::getNextPacketId() { return peerOf(this).nextPacketId++; }
+void LinkManager::sendPacketRaw(const uint8_t* buffer, size_t len, const uint8_t*) {
+    peerOf(this).sent.emplace_back(buffer, buffer + len);
+}
+size_t LinkManager::getPathMtu(const uint8_t*) { return RNS_MTU; }
+void LinkManager::reportDelivery(const uint8_t*, bool) {}
+void LinkManager::processReceivedLinkData(const uint8_t*, const std::vector<uint8_t>& data) {
+    peerOf(this).received.push_back(data);
+}
+void LinkManager::removeLink(const uint8_t*) {}
+
+static ReticulumNode& noNode() { return *reinterpret_cast<ReticulumNode*>(&nodeStorage); }
+
+static void resetPeers(LinkManager& a, LinkManager& b) {
+    LinkManager* managers[2] = { &a, &b };
+    for (int i = 0; i < 2; i++) {
+        peers[i].manager = managers[i];
+        memset(peers[i].address, 0x10 * (i + 1), RNS_ADDRESS_SIZE);
+        peers[i].nextPacketId = 0x100 * (i + 1);
+        peers[i].sent.clear();
+        peers[i].received.clear();
+        managers[i]->begin();
+    }
+}
+
+// Parses every frame the peer sent, as the node's receive path does, and hands it to link
+static size_t deliver(Peer& from, Link& to) {
+    std::vector<std::vector<uint8_t>> frames;
+    frames.swap(from.sent);
+    for (const auto& frame : frames) {
+        RnsPacketInfo info;
+        TEST_ASSERT_TRUE(ReticulumPacket::isLinkFrame(frame.data(), frame.size()));
+        TEST_ASSERT_TRUE(ReticulumPacket::deserializeLink(frame.data(), frame.size(), info));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(from.address, info.source, RNS_ADDRESS_SIZE);
+        to.handlePacket(info);
+    }
+    return frames.size();
+}
+
+static void handshake(Link& a, Link& b) {
+    TEST_ASSERT_TRUE(a.establish());
+    TEST_ASSERT_EQUAL_UINT(1, deliver(peers[0], b)); // LINK_REQ with A's ephemeral key
+    TEST_ASSERT_EQUAL_UINT(1, deliver(peers[1], a)); // ACK with B's
+}
+
+static void assertReceived(const Peer& peer, size_t index, const char* text) {
+    TEST_ASSERT_TRUE(index < peer.received.size());
+    TEST_ASSERT_EQUAL_UINT(strlen(text), peer.received[index].size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(text, peer.received[index].data(), strlen(text));
+}
+
+void test_handshake_keys_both_ends() {
+    LinkManager managerA(noNode()), managerB(noNode());
+    resetPeers(managerA, managerB);
+    Link a(peers[1].address, managerA, 0), b(peers[0].address, managerB, 0);
+
+    TEST_ASSERT_TRUE(a.establish());
+    TEST_ASSERT_EQUAL_UINT(1, peers[0].sent.size());
+    RnsPacketInfo req;
+    TEST_ASSERT_TRUE(ReticulumPacket::deserializeLink(peers[0].sent[0].data(), peers[0].sent[0].size(), req));
+    TEST_ASSERT_EQUAL_UINT8(RNS_CONTEXT_LINK_REQ, req.context);
+    TEST_ASSERT_EQUAL_UINT(Identity::KEY_SIZE, req.data.size()); // Exactly the ephemeral key
+
+    TEST_ASSERT_EQUAL_UINT(1, deliver(peers[0], b));
+    TEST_ASSERT_TRUE(b.isEstablished());
+    TEST_ASSERT_FALSE(a.isEstablished());
+    TEST_ASSERT_EQUAL_UINT(1, deliver(peers[1], a));
+    TEST_ASSERT_TRUE(a.isEstablished());
+
+    // Both ends derived the same session key: sealed data opens in both directions
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'p', 'i', 'n', 'g'}));
+    deliver(peers[0], b);
+    TEST_ASSERT_TRUE(b.sendData(std::vector<uint8_t>{'p', 'o', 'n', 'g'}));
+    deliver(peers[1], a);
+    TEST_ASSERT_EQUAL_UINT(1, peers[1].received.size());
+    assertReceived(peers[1], 0, "ping");
+    TEST_ASSERT_EQUAL_UINT(1, peers[0].received.size());
+    assertReceived(peers[0], 0, "pong");
+}
+
+void test_simultaneous_requests_agree() {
+    LinkManager managerA(noNode()), managerB(noNode());
+    resetPeers(managerA, managerB);
+    Link a(peers[1].address, managerA, 0), b(peers[0].address, managerB, 0);
+
+    TEST_ASSERT_TRUE(a.establish());
+    TEST_ASSERT_TRUE(b.establish());
+    std::vector<std::vector<uint8_t>> fromB;
+    fromB.swap(peers[1].sent); // B's REQ crosses A's on the air
+    deliver(peers[0], b);      // A's REQ: B keys from it and ACKs
+    peers[1].sent.insert(peers[1].sent.begin(), fromB.begin(), fromB.end());
+    deliver(peers[1], a);      // B's REQ, then B's ACK
+    deliver(peers[0], b);      // A's ACK for B's REQ
+    TEST_ASSERT_TRUE(a.isEstablished());
+    TEST_ASSERT_TRUE(b.isEstablished());
+
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'a'}));
+    deliver(peers[0], b);
+    TEST_ASSERT_EQUAL_UINT(1, peers[1].received.size());
+    assertReceived(peers[1], 0, "a");
+}
+
+void test_data_frames_pass_through_serialize_and_parse() {
+    LinkManager managerA(noNode()), managerB(noNode());
+    resetPeers(managerA, managerB);
+    Link a(peers[1].address, managerA, 0), b(peers[0].address, managerB, 0);
+    handshake(a, b);
+    TEST_ASSERT_TRUE(a.isEstablished());
+    TEST_ASSERT_TRUE(b.isEstablished());
+
+    // Sequence numbers past 0 come from the outer header and must match the sealed copy
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'o', 'n', 'e'}));
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'t', 'w', 'o'}));
+    TEST_ASSERT_EQUAL_UINT(2, deliver(peers[0], b));
+    TEST_ASSERT_EQUAL_UINT(2, peers[1].received.size());
+    assertReceived(peers[1], 0, "one");
+    assertReceived(peers[1], 1, "two");
+    TEST_ASSERT_EQUAL_UINT(1, deliver(peers[1], a)); // Cumulative ACK after LINK_ACK_EVERY_N
+
+    // A held ACK rides on reverse data; the piggyback flag must survive parsing too
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'t', 'h', 'r', 'e', 'e'}));
+    TEST_ASSERT_EQUAL_UINT(1, deliver(peers[0], b));
+    TEST_ASSERT_TRUE(b.sendData(std::vector<uint8_t>{'r', 'e', 'p', 'l', 'y'}));
+    TEST_ASSERT_EQUAL_UINT(1, peers[1].sent.size());
+    TEST_ASSERT_TRUE((peers[1].sent[0][0] & RNS_HEADER_FLAG_PIGGYBACK_ACK_MASK) != 0);
+    TEST_ASSERT_EQUAL_UINT(1, deliver(peers[1], a));
+    assertReceived(peers[1], 2, "three");
+    TEST_ASSERT_EQUAL_UINT(1, peers[0].received.size());
+    assertReceived(peers[0], 0, "reply");
+
+    // A retransmitted frame is a duplicate: re-ACKed, not delivered twice
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'f', 'o', 'u', 'r'}));
+    std::vector<uint8_t> copy = peers[0].sent[0];
+    deliver(peers[0], b);
+    peers[0].sent.push_back(copy);
+    deliver(peers[0], b);
+    TEST_ASSERT_EQUAL_UINT(4, peers[1].received.size());
+}
+
+// The retransmission timer only runs while the send window holds unacknowledged data
+static bool windowOpen(const Link& link) {
+    unsigned long deadline = 0;
+    link.getNextDeadline(deadline);
+    return deadline != link.getLastActivityTime() + LINK_INACTIVITY_TIMEOUT_MS + 1;
+}
+
+void test_forged_ack_keeps_window() {
+    LinkManager managerA(noNode()), managerB(noNode());
+    resetPeers(managerA, managerB);
+    Link a(peers[1].address, managerA, 0), b(peers[0].address, managerB, 0);
+    handshake(a, b);
+
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'o', 'n', 'e'}));
+    TEST_ASSERT_TRUE(a.sendData(std::vector<uint8_t>{'t', 'w', 'o'}));
+    std::vector<std::vector<uint8_t>> inFlight;
+    inFlight.swap(peers[0].sent);
+
+    // Anyone can put B's address on a plaintext ACK for the last sequence A sent
+    uint8_t forged[RNS_LEGACY_HEADER_SIZE + RNS_SEQ_SIZE];
+    size_t len = 0;
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize_control(forged, len, peers[0].address, peers[1].address,
+        RNS_HEADER_TYPE_ACK, RNS_CONTEXT_ACK, 0x777, 1));
+    peers[1].sent.emplace_back(forged, forged + len);
+    deliver(peers[1], a);
+    TEST_ASSERT_TRUE(windowOpen(a));
+
+    // B's own ACK is sealed and does release it
+    peers[0].sent.swap(inFlight);
+    TEST_ASSERT_EQUAL_UINT(2, deliver(peers[0], b));
+    TEST_ASSERT_EQUAL_UINT(1, peers[1].sent.size());
+    TEST_ASSERT_TRUE(peers[1].sent[0].size() > len);
+    deliver(peers[1], a);
+    TEST_ASSERT_FALSE(windowOpen(a));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_handshake_keys_both_ends);
+    RUN_TEST(test_simultaneous_requests_agree);
+    RUN_TEST(test_data_frames_pass_through_serialize_and_parse);
+    RUN_TEST(test_forged_ack_keeps_window);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,82 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include "LinkCryptoPool.h"
+
+static const size_t COST = 4096;
+
+void test_capacity_follows_heap_headroom() {
+    TEST_ASSERT_EQUAL_UINT(LINK_POOL_MIN, LinkCryptoPool::capacityFor(0, COST));
+    TEST_ASSERT_EQUAL_UINT(LINK_POOL_MIN, LinkCryptoPool::capacityFor(LINK_HEAP_RESERVE, COST));
+    size_t count = LINK_POOL_MIN + 3;
+    TEST_ASSERT_EQUAL_UINT(count, LinkCryptoPool::capacityFor(LINK_HEAP_RESERVE + count * COST + COST / 2, COST));
+    TEST_ASSERT_EQUAL_UINT(LINK_POOL_MAX, LinkCryptoPool::capacityFor(LINK_HEAP_RESERVE + 1000 * COST, COST));
+}
+
+void test_slots_run_out_and_return() {
+    LinkCryptoPool pool;
+    TEST_ASSERT_EQUAL_UINT(LINK_POOL_MIN, pool.begin(0, COST));
+    size_t slots[LINK_POOL_MIN];
+    for (size_t i = 0; i < LINK_POOL_MIN; i++) {
+        slots[i] = pool.acquire();
+        TEST_ASSERT_TRUE(slots[i] != LinkCryptoPool::NO_SLOT);
+    }
+    TEST_ASSERT_EQUAL_UINT(LinkCryptoPool::NO_SLOT, pool.acquire());
+    pool.release(slots[0]);
+    pool.release(slots[0]); // Double release is harmless
+    TEST_ASSERT_EQUAL_UINT(LINK_POOL_MIN - 1, pool.getUsedCount());
+    TEST_ASSERT_EQUAL_UINT(slots[0], pool.acquire());
+    // A second begin() keeps the existing pool
+    TEST_ASSERT_EQUAL_UINT(LINK_POOL_MIN, pool.begin(LINK_HEAP_RESERVE + 1000 * COST, COST));
+}
+
+void test_both_ends_derive_the_same_key() {
+    LinkCryptoPool a, b;
+    a.begin(0, COST);
+    b.begin(0, COST);
+    size_t slotA = a.acquire(), slotB = b.acquire();
+    TEST_ASSERT_NULL(a.get(slotA)); // Not keyed before the handshake
+
+    uint8_t secretA[Identity::KEY_SIZE], publicA[Identity::KEY_SIZE];
+    uint8_t secretB[Identity::KEY_SIZE], publicB[Identity::KEY_SIZE];
+    Identity::generateEphemeral(secretA, publicA);
+    Identity::generateEphemeral(secretB, publicB);
+    TEST_ASSERT_TRUE(a.establish(slotA, secretA, publicA, publicB));
+    TEST_ASSERT_TRUE(b.establish(slotB, secretB, publicB, publicA));
+
+    const char* message = "link frame";
+    uint8_t sealed[Crypto::TOKEN_MIN_SIZE + Crypto::AES_BLOCK_SIZE], opened[sizeof(sealed)];
+    size_t sealedLen = 0, openedLen = 0;
+    TEST_ASSERT_TRUE(a.get(slotA)->encrypt((const uint8_t*)message, strlen(message), sealed, sizeof(sealed), sealedLen));
+    TEST_ASSERT_TRUE(b.get(slotB)->decrypt(sealed, sealedLen, opened, sizeof(opened), openedLen));
+    TEST_ASSERT_EQUAL_UINT(strlen(message), openedLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY((const uint8_t*)message, opened, openedLen);
+
+    // Releasing forgets the key
+    b.release(slotB);
+    TEST_ASSERT_NULL(b.get(slotB));
+}
+
+void test_degenerate_peer_key_rejected() {
+    LinkCryptoPool pool;
+    pool.begin(0, COST);
+    size_t slot = pool.acquire();
+    uint8_t secret[Identity::KEY_SIZE], pub[Identity::KEY_SIZE];
+    Identity::generateEphemeral(secret, pub);
+    uint8_t zero[Identity::KEY_SIZE] = {0}; // Low-order point
+    TEST_ASSERT_FALSE(pool.establish(slot, secret, pub, zero));
+    TEST_ASSERT_NULL(pool.get(slot));
+    TEST_ASSERT_FALSE(pool.establish(LinkCryptoPool::NO_SLOT, secret, pub, pub));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_follows_heap_headroom);
+    RUN_TEST(test_slots_run_out_and_return);
+    RUN_TEST(test_both_ends_derive_the_same_key);
+    RUN_TEST(test_degenerate_peer_key_rejected);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,149 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include "ReticulumNode.h"
+
+// The node as a whole, fed through the ESP-NOW receive callback and its own loop().
+// Nothing is set up: no radio is started, received frames are queued and handled as on air.
+static ReticulumNode* node;
+static const uint8_t MAC_A[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0A};
+static const uint8_t MAC_B[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0B};
+
+// Announce for fullName signed by identity, in the official payload layout
+static void buildAnnounce(const Identity& identity, const char* fullName, RnsPacketInfo& out, uint8_t randomTag = 0x42) {
+    const uint8_t appData[] = {'n', 'o', 'd', 'e'};
+    uint8_t nameHash[Identity::NAME_HASH_SIZE];
+    uint8_t randomHash[AnnounceValidator::RANDOM_HASH_SIZE];
+    memset(randomHash, randomTag, sizeof(randomHash));
+    Identity::nameHash(fullName, nameHash);
+    Identity::destinationHash(fullName, &identity, out.destination_hash);
+
+    std::vector<uint8_t> signedData(out.destination_hash, out.destination_hash + Identity::HASH_SIZE);
+    signedData.insert(signedData.end(), identity.getPublicKey(), identity.getPublicKey() + Identity::PUBLIC_KEY_SIZE);
+    signedData.insert(signedData.end(), nameHash, nameHash + sizeof(nameHash));
+    signedData.insert(signedData.end(), randomHash, randomHash + sizeof(randomHash));
+    signedData.insert(signedData.end(), appData, appData + sizeof(appData));
+    uint8_t signature[Identity::SIGNATURE_SIZE];
+    identity.sign(signedData.data(), signedData.size(), signature);
+
+    out.data.assign(identity.getPublicKey(), identity.getPublicKey() + Identity::PUBLIC_KEY_SIZE);
+    out.data.insert(out.data.end(), nameHash, nameHash + sizeof(nameHash));
+    out.data.insert(out.data.end(), randomHash, randomHash + sizeof(randomHash));
+    out.data.insert(out.data.end(), signature, signature + sizeof(signature));
+    out.data.insert(out.data.end(), appData, appData + sizeof(appData));
+}
+
+// Queues the serialized announce as if just heard from mac; the next loop() handles it
+static void hearAnnounce(const uint8_t* mac, const RnsPacketInfo& announce, uint8_t hops) {
+    uint8_t frame[MAX_PACKET_SIZE];
+    size_t len = 0;
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize(frame, len, announce.destination_hash, RNS_PACKET_ANNOUNCE,
+                                                RNS_DEST_SINGLE, RNS_PROPAGATION_BROADCAST, RNS_CONTEXT_NONE,
+                                                hops, announce.data));
+    InterfaceManager::staticEspNowRecvCallback(mac, frame, (int)len);
+}
+
+// Hears the announce, then runs the loop until the background check (run by collect()
+// without the task, one per loop) has been applied
+static void receiveAnnounce(const uint8_t* mac, const RnsPacketInfo& announce, uint8_t hops) {
+    hearAnnounce(mac, announce, hops);
+    for (size_t i = 0; i <= ANNOUNCE_VERIFY_QUEUE_SIZE; i++) node->loop();
+}
+
+void test_official_announce_adds_route() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo announce;
+    buildAnnounce(identity, "esp32.node", announce);
+
+    receiveAnnounce(MAC_A, announce, 1);
+    TEST_ASSERT_EQUAL_UINT(0, node->getPendingAnnounceCount());
+    TEST_ASSERT_NOT_NULL(node->getPathTable().find(announce.destination_hash));
+    RouteEntry* route = node->getRoutingTable().findRoute(announce.destination_hash);
+    TEST_ASSERT_NOT_NULL(route);
+    TEST_ASSERT_TRUE(route->interface == InterfaceType::ESP_NOW);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, route->next_hop_mac, 6);
+    TEST_ASSERT_EQUAL_UINT8(1, route->hops);
+
+    // The same announce through another neighbour is a duplicate, but still a backup next hop
+    receiveAnnounce(MAC_B, announce, 2);
+    route = node->getRoutingTable().findRoute(announce.destination_hash);
+    TEST_ASSERT_NOT_NULL(route);
+    TEST_ASSERT_EQUAL_UINT8(2, route->candidate_count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, route->next_hop_mac, 6); // Fewer hops stays active
+}
+
+void test_forged_announce_adds_no_route() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo announce;
+    buildAnnounce(identity, "esp32.forged", announce);
+    announce.data[announce.data.size() - 5] ^= 0x01; // Last signature byte
+
+    receiveAnnounce(MAC_A, announce, 1);
+    TEST_ASSERT_NULL(node->getPathTable().find(announce.destination_hash));
+    TEST_ASSERT_NULL(node->getRoutingTable().findRoute(announce.destination_hash));
+}
+
+void test_unqueued_refresh_not_used() {
+    Identity identity;
+    identity.generate();
+    RnsPacketInfo genuine;
+    buildAnnounce(identity, "esp32.refresh", genuine);
+    receiveAnnounce(MAC_A, genuine, 1);
+    TEST_ASSERT_NOT_NULL(node->getPathTable().find(genuine.destination_hash));
+
+    // Fill the verification queue with new destinations (collect() checks one per loop)
+    Identity others[5];
+    RnsPacketInfo newcomers[5];
+    for (int i = 0; i < 5; i++) {
+        others[i].generate();
+        buildAnnounce(others[i], "esp32.busy", newcomers[i]);
+    }
+    for (int i = 0; i < 3; i++) hearAnnounce(MAC_B, newcomers[i], 1);
+    node->loop();
+    for (int i = 3; i < 5; i++) hearAnnounce(MAC_B, newcomers[i], 1);
+    // A forged refresh of the known path (same key and hop) finds no room to be checked
+    RnsPacketInfo forged;
+    buildAnnounce(identity, "esp32.refresh", forged, 0x43);
+    forged.data[forged.data.size() - 5] ^= 0x01; // Last signature byte
+    hearAnnounce(MAC_A, forged, 1);
+    uint32_t skipped = node->getAnnounceValidator().getSkippedCount();
+    node->loop();
+    TEST_ASSERT_EQUAL_UINT32(skipped + 1, node->getAnnounceValidator().getSkippedCount());
+
+    const PathTable::Path* path = node->getPathTable().find(genuine.destination_hash);
+    TEST_ASSERT_NOT_NULL(path);
+    TEST_ASSERT_TRUE(path->announce == genuine.data); // Still the verified announce
+    for (size_t i = 0; i < ANNOUNCE_VERIFY_QUEUE_SIZE; i++) node->loop();
+    TEST_ASSERT_EQUAL_UINT(0, node->getPendingAnnounceCount());
+}
+
+void test_link_frame_adds_route_to_peer() {
+    const uint8_t peer[RNS_ADDRESS_SIZE] = {0x50, 0x45, 0x45, 0x52, 0x00, 0x00, 0x00, 0x01};
+    uint8_t frame[MAX_PACKET_SIZE];
+    size_t len = 0;
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize_control(frame, len, node->getNodeAddress(), peer, RNS_HEADER_TYPE_ACK,
+                                                        RNS_CONTEXT_ACK, 7, 0));
+    InterfaceManager::staticEspNowRecvCallback(MAC_B, frame, (int)len);
+    node->loop();
+
+    // The link's frames now go unicast to that neighbour, whose send failures trigger retransmits
+    RouteEntry* route = node->getRoutingTable().findRoute(peer);
+    TEST_ASSERT_NOT_NULL(route);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_B, route->next_hop_mac, 6);
+    TEST_ASSERT_TRUE(node->getRoutingTable().hasNextHop(peer, InterfaceType::ESP_NOW, MAC_B, IPAddress()));
+}
+
+void setup() {
+    delay(2000);
+    node = new ReticulumNode();
+    UNITY_BEGIN();
+    RUN_TEST(test_official_announce_adds_route);
+    RUN_TEST(test_forged_announce_adds_no_route);
+    RUN_TEST(test_unqueued_refresh_not_used);
+    RUN_TEST(test_link_frame_adds_route_to_peer);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,132 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstring>
+#include "NodeSnapshot.h"
+
+static const uint8_t DEST[RNS_ADDRESS_SIZE] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+static const uint8_t MAC_A[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0A};
+static const uint8_t PATH_DEST[RNS_TRUNCATED_HASHLENGTH_BYTES] = {0xD0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+static const uint8_t PATH_HOP[RNS_TRUNCATED_HASHLENGTH_BYTES] = {0xA0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+static const uint8_t PACKET[] = {0x01, 0x00, 0xAA, 0xBB, 0xCC, 0xDD};
+static const time_t SAVED_AT = 1700000000; // NTP-synced wall clock
+
+static uint8_t snapshot[STATE_SNAPSHOT_MAX_SIZE];
+
+static size_t saveSnapshot() {
+    RoutingTable routes;
+    RnsPacketInfo announce;
+    memcpy(announce.source, DEST, RNS_ADDRESS_SIZE);
+    announce.hops = 1;
+    routes.update(announce, InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0);
+
+    PathTable paths;
+    paths.update(PATH_DEST, PATH_HOP, 2, InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0);
+    std::vector<uint8_t> payload(150, 0x5A); // Public key, hashes, signature
+    paths.cacheAnnounce(PATH_DEST, payload, true);
+
+    PacketFilter filter;
+    filter.checkAndInsert(PACKET, sizeof(PACKET));
+    return NodeSnapshot::write(snapshot, sizeof(snapshot), routes, paths, filter, SAVED_AT);
+}
+
+void test_short_downtime_restores_everything() {
+    size_t len = saveSnapshot();
+    TEST_ASSERT_GREATER_THAN(NodeSnapshot::HEADER_SIZE, len);
+
+    RoutingTable routes;
+    PathTable paths;
+    PacketFilter filter;
+    NodeSnapshot::Restored result;
+    TEST_ASSERT_TRUE(NodeSnapshot::read(snapshot, len, routes, paths, filter, SAVED_AT + 30, result));
+    TEST_ASSERT_TRUE(result.downtimeKnown);
+    TEST_ASSERT_EQUAL_UINT32(30000, result.downtimeMs);
+    TEST_ASSERT_EQUAL_UINT(1, result.routes);
+    TEST_ASSERT_EQUAL_UINT(1, result.paths);
+    TEST_ASSERT_EQUAL_UINT(1, result.announces);
+    TEST_ASSERT_TRUE(result.filter);
+
+    RouteEntry* route = routes.findRoute(DEST);
+    TEST_ASSERT_NOT_NULL(route);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, route->next_hop_mac, 6);
+    const PathTable::Path* path = paths.find(PATH_DEST);
+    TEST_ASSERT_NOT_NULL(path);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(PATH_HOP, path->next_hop, RNS_TRUNCATED_HASHLENGTH_BYTES);
+    TEST_ASSERT_EQUAL_UINT(150, path->announce.size());
+    TEST_ASSERT_TRUE(path->ratchet); // Needed to parse the announce again
+    TEST_ASSERT_TRUE(filter.checkAndInsert(PACKET, sizeof(PACKET))); // Still a duplicate
+}
+
+void test_long_downtime_expires_entries() {
+    size_t len = saveSnapshot();
+    RoutingTable routes;
+    PathTable paths;
+    PacketFilter filter;
+    NodeSnapshot::Restored result;
+    time_t later = SAVED_AT + ROUTE_TIMEOUT_MS / 1000 + 1;
+    TEST_ASSERT_TRUE(NodeSnapshot::read(snapshot, len, routes, paths, filter, later, result));
+    TEST_ASSERT_EQUAL_UINT(0, result.routes);
+    TEST_ASSERT_EQUAL_UINT(0, result.paths);
+    TEST_ASSERT_EQUAL_UINT(0, result.announces);
+    TEST_ASSERT_FALSE(result.filter);
+    TEST_ASSERT_EQUAL_UINT(0, routes.getRouteCount());
+}
+
+void test_unsynced_clock_assumes_downtime() {
+    size_t len = saveSnapshot();
+    RoutingTable routes;
+    PathTable paths;
+    PacketFilter filter;
+    NodeSnapshot::Restored result;
+    // Power cycle without NTP: the clock restarted near zero
+    TEST_ASSERT_TRUE(NodeSnapshot::read(snapshot, len, routes, paths, filter, 12, result));
+    TEST_ASSERT_FALSE(result.downtimeKnown);
+    TEST_ASSERT_EQUAL_UINT32(STATE_UNKNOWN_DOWNTIME_MS, result.downtimeMs);
+    TEST_ASSERT_EQUAL_UINT(1, result.routes);
+}
+
+void test_malformed_snapshot_rejected() {
+    size_t len = saveSnapshot();
+    RoutingTable routes;
+    PathTable paths;
+    PacketFilter filter;
+    NodeSnapshot::Restored result;
+    TEST_ASSERT_FALSE(NodeSnapshot::read(snapshot, len - 1, routes, paths, filter, SAVED_AT, result)); // Truncated
+    snapshot[4] = NodeSnapshot::VERSION + 1;
+    TEST_ASSERT_FALSE(NodeSnapshot::read(snapshot, len, routes, paths, filter, SAVED_AT, result));
+    TEST_ASSERT_EQUAL_UINT(0, NodeSnapshot::write(snapshot, NodeSnapshot::HEADER_SIZE - 1, routes, paths, filter, SAVED_AT));
+}
+
+void test_announce_check_drops_unverified() {
+    size_t len = saveSnapshot();
+    RoutingTable routes;
+    PathTable paths;
+    PacketFilter filter;
+    NodeSnapshot::Restored result;
+    size_t checked = 0;
+    auto reject = [&checked](const uint8_t* destinationHash, const uint8_t*, size_t len, bool ratchet) {
+        checked++;
+        TEST_ASSERT_TRUE(ratchet);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(PATH_DEST, destinationHash, RNS_TRUNCATED_HASHLENGTH_BYTES);
+        TEST_ASSERT_EQUAL_UINT(150, len);
+        return false;
+    };
+    TEST_ASSERT_TRUE(NodeSnapshot::read(snapshot, len, routes, paths, filter, SAVED_AT + 30, result, reject));
+    TEST_ASSERT_EQUAL_UINT(1, checked);
+    TEST_ASSERT_EQUAL_UINT(0, result.announces);
+    TEST_ASSERT_EQUAL_UINT(1, result.rejected);
+    TEST_ASSERT_NULL(paths.find(PATH_DEST)); // The path it taught is not trusted either
+    TEST_ASSERT_NOT_NULL(routes.findRoute(DEST));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_short_downtime_restores_everything);
+    RUN_TEST(test_long_downtime_expires_entries);
+    RUN_TEST(test_unsynced_clock_assumes_downtime);
+    RUN_TEST(test_malformed_snapshot_rejected);
+    RUN_TEST(test_announce_check_drops_unverified);
+    UNITY_END();
+}
+
+void loop() {}
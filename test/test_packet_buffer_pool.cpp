@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "PacketBufferPool.h"
+
+void test_acquire_until_exhausted() {
+    PacketBufferPool::Buffer buffers[PACKET_POOL_SIZE];
+    for (size_t i = 0; i < PACKET_POOL_SIZE; i++) {
+        buffers[i] = PacketBufferPool::acquire();
+        TEST_ASSERT_TRUE((bool)buffers[i]);
+    }
+    TEST_ASSERT_EQUAL(0, PacketBufferPool::getFreeCount());
+    uint32_t exhausted = PacketBufferPool::getExhaustedCount();
+    PacketBufferPool::Buffer extra = PacketBufferPool::acquire();
+    TEST_ASSERT_FALSE((bool)extra);
+    TEST_ASSERT_EQUAL_UINT32(exhausted + 1, PacketBufferPool::getExhaustedCount());
+}
+
+void test_buffers_return_on_scope_exit() {
+    {
+        PacketBufferPool::Buffer a = PacketBufferPool::acquire();
+        PacketBufferPool::Buffer b = PacketBufferPool::acquire();
+        TEST_ASSERT_TRUE(a.data() != b.data());
+        TEST_ASSERT_EQUAL(PACKET_POOL_SIZE - 2, PacketBufferPool::getFreeCount());
+    }
+    TEST_ASSERT_EQUAL(PACKET_POOL_SIZE, PacketBufferPool::getFreeCount());
+}
+
+void test_move_transfers_ownership() {
+    PacketBufferPool::Buffer a = PacketBufferPool::acquire();
+    uint8_t* data = a.data();
+    PacketBufferPool::Buffer b(std::move(a));
+    TEST_ASSERT_FALSE((bool)a);
+    TEST_ASSERT_TRUE(b.data() == data);
+    TEST_ASSERT_EQUAL(PACKET_POOL_SIZE - 1, PacketBufferPool::getFreeCount());
+    b.release();
+    TEST_ASSERT_EQUAL(PACKET_POOL_SIZE, PacketBufferPool::getFreeCount());
+}
+
+void test_capacity_covers_full_packet() {
+    TEST_ASSERT_TRUE(PacketBufferPool::Buffer::capacity() >= RNS_MTU + RNS_IFAC_MAX_SIZE);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_acquire_until_exhausted);
+    RUN_TEST(test_buffers_return_on_scope_exit);
+    RUN_TEST(test_move_transfers_ownership);
+    RUN_TEST(test_capacity_covers_full_packet);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "PacketFilter.h"
+
+void test_duplicate_detected_across_hops() {
+    PacketFilter filter;
+    uint8_t packet[] = {0x08, 0x00, 0xAA, 0xBB, 0xCC, 0xDD};
+    TEST_ASSERT_FALSE(filter.checkAndInsert(packet, sizeof(packet)));
+    packet[1] = 3; // Same packet, forwarded three hops further
+    TEST_ASSERT_TRUE(filter.checkAndInsert(packet, sizeof(packet)));
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getDuplicateCount());
+}
+
+void test_different_payload_not_duplicate() {
+    PacketFilter filter;
+    uint8_t a[] = {0x08, 0x00, 0x01, 0x02, 0x03};
+    uint8_t b[] = {0x08, 0x00, 0x01, 0x02, 0x04};
+    TEST_ASSERT_FALSE(filter.checkAndInsert(a, sizeof(a)));
+    TEST_ASSERT_FALSE(filter.checkAndInsert(b, sizeof(b)));
+}
+
+void test_transport_id_rewrite_is_duplicate() {
+    PacketFilter filter;
+    uint8_t packet[2 + 16 + 3] = {0x50, 0x01}; // HEADER_2, transport ID then dest/context
+    memset(packet + 2, 0x11, 16);
+    packet[18] = 0xAA; packet[19] = 0xBB; packet[20] = 0xCC;
+    TEST_ASSERT_FALSE(filter.checkAndInsert(packet, sizeof(packet)));
+    packet[1] = 2;
+    memset(packet + 2, 0x22, 16); // Next transport node re-addressed it
+    TEST_ASSERT_TRUE(filter.checkAndInsert(packet, sizeof(packet)));
+}
+
+void test_rotation_ages_out() {
+    PacketFilter filter;
+    uint8_t packet[] = {0x00, 0x00, 0x42};
+    filter.checkAndInsert(packet, sizeof(packet));
+    filter.rotate();
+    TEST_ASSERT_TRUE(filter.contains(PacketFilter::hashPacket(packet, sizeof(packet)))); // Still in previous
+    filter.rotate();
+    TEST_ASSERT_FALSE(filter.contains(PacketFilter::hashPacket(packet, sizeof(packet))));
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_duplicate_detected_across_hops);
+    RUN_TEST(test_different_payload_not_duplicate);
+    RUN_TEST(test_transport_id_rewrite_is_duplicate);
+    RUN_TEST(test_rotation_ages_out);
+    UNITY_END();
+}
+
+void loop() {}
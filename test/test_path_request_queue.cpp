@@ -0,0 +1,69 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "PathRequestQueue.h"
+
+static RnsPacketInfo packetTo(uint8_t id) {
+    RnsPacketInfo info;
+    memset(info.destination_hash, id, sizeof(info.destination_hash));
+    info.data.push_back(id);
+    return info;
+}
+
+void test_one_request_per_destination() {
+    PathRequestQueue queue;
+    TEST_ASSERT_TRUE(queue.enqueue(packetTo(1), InterfaceType::ESP_NOW, 0));
+    TEST_ASSERT_FALSE(queue.enqueue(packetTo(1), InterfaceType::ESP_NOW, 0));
+    TEST_ASSERT_TRUE(queue.enqueue(packetTo(2), InterfaceType::ESP_NOW, 0));
+    TEST_ASSERT_EQUAL(3, queue.size());
+}
+
+void test_take_releases_destination() {
+    PathRequestQueue queue;
+    queue.enqueue(packetTo(1), InterfaceType::ESP_NOW, 0);
+    queue.enqueue(packetTo(2), InterfaceType::ESP_NOW, 0);
+    queue.enqueue(packetTo(1), InterfaceType::LORA, 0);
+    std::vector<PathRequestQueue::Pending> ready;
+    queue.take(packetTo(1).destination_hash, ready);
+    TEST_ASSERT_EQUAL(2, ready.size());
+    TEST_ASSERT_EQUAL(1, queue.size());
+    TEST_ASSERT_TRUE(queue.enqueue(packetTo(1), InterfaceType::ESP_NOW, 0)); // Fresh request
+}
+
+void test_retries_then_expires() {
+    PathRequestQueue queue;
+    queue.enqueue(packetTo(1), InterfaceType::ESP_NOW, 0);
+    std::vector<std::array<uint8_t, RNS_TRUNCATED_HASHLENGTH_BYTES>> retry;
+    std::vector<PathRequestQueue::Pending> expired;
+    unsigned long now = 0;
+    for (uint8_t i = 1; i < PATH_REQUEST_RETRIES; i++) {
+        now += PATH_REQUEST_TIMEOUT_MS;
+        queue.poll(retry, expired, now);
+    }
+    TEST_ASSERT_EQUAL(PATH_REQUEST_RETRIES - 1, retry.size());
+    TEST_ASSERT_EQUAL(0, expired.size());
+    queue.poll(retry, expired, now + PATH_REQUEST_TIMEOUT_MS);
+    TEST_ASSERT_EQUAL(1, expired.size());
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_full_queue_drops_oldest() {
+    PathRequestQueue queue;
+    for (size_t i = 0; i <= PATH_QUEUE_MAX; i++) queue.enqueue(packetTo((uint8_t)i), InterfaceType::ESP_NOW, 0);
+    TEST_ASSERT_EQUAL(PATH_QUEUE_MAX, queue.size());
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getDroppedCount());
+    std::vector<PathRequestQueue::Pending> ready;
+    queue.take(packetTo(0).destination_hash, ready);
+    TEST_ASSERT_EQUAL(0, ready.size());
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_one_request_per_destination);
+    RUN_TEST(test_take_releases_destination);
+    RUN_TEST(test_retries_then_expires);
+    RUN_TEST(test_full_queue_drops_oldest);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,62 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "PathTable.h"
+
+static const uint8_t DEST[16] = {0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+                                 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF};
+static const uint8_t HOP_A[16] = {0xA0};
+static const uint8_t HOP_B[16] = {0xB0};
+static const uint8_t MAC_A[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0A};
+static const uint8_t MAC_B[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0B};
+
+void test_shorter_path_kept() {
+    PathTable table;
+    TEST_ASSERT_TRUE(table.update(DEST, HOP_A, 2, InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0, 1000));
+    TEST_ASSERT_FALSE(table.update(DEST, HOP_B, 3, InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0, 1000));
+    const PathTable::Path* path = table.find(DEST, 1000);
+    TEST_ASSERT_NOT_NULL(path);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(HOP_A, path->next_hop, 16);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, path->via.next_hop_mac, 6);
+    TEST_ASSERT_EQUAL(1, table.size());
+}
+
+void test_same_next_hop_refreshes() {
+    PathTable table;
+    table.update(DEST, HOP_A, 1, InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0, 1000);
+    TEST_ASSERT_TRUE(table.update(DEST, HOP_A, 3, InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0, 2000));
+    TEST_ASSERT_EQUAL(3, table.find(DEST, 2000)->hops); // Topology changed behind the same hop
+}
+
+void test_paths_expire() {
+    PathTable table;
+    table.update(DEST, HOP_A, 1, InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0, 1000);
+    TEST_ASSERT_NULL(table.find(DEST, 1000 + PATH_TIMEOUT_MS + 1));
+    // An expired path gives way to a longer one
+    TEST_ASSERT_TRUE(table.update(DEST, HOP_B, 4, InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0, 1000 + PATH_TIMEOUT_MS + 1));
+    table.expire(1000 + PATH_TIMEOUT_MS + 1);
+    TEST_ASSERT_EQUAL(1, table.size());
+    table.expire(1000 + 2 * PATH_TIMEOUT_MS + 2);
+    TEST_ASSERT_EQUAL(0, table.size());
+}
+
+void test_remove_forgets_path() {
+    PathTable table;
+    table.update(DEST, HOP_A, 1, InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0, 1000);
+    table.update(HOP_B, HOP_B, 1, InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0, 1000);
+    table.remove(DEST);
+    TEST_ASSERT_NULL(table.find(DEST, 1000));
+    TEST_ASSERT_NOT_NULL(table.find(HOP_B, 1000));
+    TEST_ASSERT_EQUAL(1, table.size());
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_shorter_path_kept);
+    RUN_TEST(test_same_next_hop_refreshes);
+    RUN_TEST(test_paths_expire);
+    RUN_TEST(test_remove_forgets_path);
+    UNITY_END();
+}
+
+void loop() {}
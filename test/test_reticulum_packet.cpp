@@ -25,10 +25,85 @@ void test_serialize_deserialize_roundtrip() {
     }
 }
 
+void test_header2_roundtrip() {
+    uint8_t dest_hash[16], transport_id[16];
+    for (int i = 0; i < 16; ++i) { dest_hash[i] = (uint8_t)i; transport_id[i] = (uint8_t)(0xA0 + i); }
+    std::vector<uint8_t> data = {'H','i'};
+    uint8_t buffer[512];
+    size_t len = 0;
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize(buffer, len, dest_hash, RNS_PACKET_DATA, RNS_DEST_SINGLE,
+                                                RNS_PROPAGATION_BROADCAST, RNS_CONTEXT_NONE, 2, data, transport_id));
+    TEST_ASSERT_EQUAL_UINT32(RNS_HEADER_2_SIZE + data.size(), len);
+
+    RnsPacketInfo info;
+    TEST_ASSERT_TRUE(ReticulumPacket::deserialize(buffer, len, info));
+    TEST_ASSERT_EQUAL_UINT8(RNS_HEADER_2, info.header_type);
+    TEST_ASSERT_EQUAL_UINT8(RNS_PROPAGATION_TRANSPORT, info.propagation_type);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(transport_id, info.transport_id, 16);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(dest_hash, info.destination_hash, 16);
+    TEST_ASSERT_EQUAL_UINT32(data.size(), info.data.size());
+
+    // The context flag (an announce's ratchet) survives re-serializing
+    TEST_ASSERT_FALSE(info.context_flag);
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize(buffer, len, dest_hash, RNS_PACKET_ANNOUNCE, RNS_DEST_SINGLE,
+                                                RNS_PROPAGATION_TRANSPORT, RNS_CONTEXT_NONE, 3, data, transport_id, true));
+    TEST_ASSERT_TRUE(ReticulumPacket::deserialize(buffer, len, info));
+    TEST_ASSERT_TRUE(info.context_flag);
+    TEST_ASSERT_EQUAL_UINT8(RNS_PACKET_ANNOUNCE, info.packet_type);
+
+    // Truncated HEADER_2 must not be read as HEADER_1
+    TEST_ASSERT_FALSE(ReticulumPacket::deserialize(buffer, RNS_HEADER_2_SIZE - 1, info));
+}
+
+void test_link_frame_roundtrip() {
+    uint8_t dest[RNS_ADDRESS_SIZE], src[RNS_ADDRESS_SIZE];
+    for (int i = 0; i < RNS_ADDRESS_SIZE; ++i) { dest[i] = (uint8_t)(0x10 + i); src[i] = (uint8_t)(0x20 + i); }
+    std::vector<uint8_t> sealed = {'s','e','a','l','e','d'};
+    uint8_t buffer[512];
+    size_t len = 0;
+    uint8_t headerType = RNS_HEADER_TYPE_DATA | RNS_HEADER_FLAG_REQUEST_ACK_MASK | RNS_HEADER_FLAG_PIGGYBACK_ACK_MASK;
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize(buffer, len, dest, src, RNS_DST_TYPE_SINGLE, headerType,
+                                                RNS_CONTEXT_LINK_DATA, 0x1234, 0, sealed, 0x0102));
+    TEST_ASSERT_TRUE(ReticulumPacket::isLinkFrame(buffer, len));
+
+    RnsPacketInfo info;
+    TEST_ASSERT_TRUE(ReticulumPacket::deserializeLink(buffer, len, info));
+    TEST_ASSERT_EQUAL_UINT8(headerType, info.header_type); // Flags are kept, not reduced to one bit
+    TEST_ASSERT_EQUAL_UINT8(RNS_CONTEXT_LINK_DATA, info.context);
+    TEST_ASSERT_EQUAL_UINT16(0x1234, info.packet_id);
+    TEST_ASSERT_EQUAL_UINT16(0x0102, info.sequence_number);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(dest, info.destination, RNS_ADDRESS_SIZE);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(src, info.source, RNS_ADDRESS_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(sealed.size(), info.data.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(sealed.data(), info.data.data(), sealed.size());
+
+    // Control frames carry the handshake key right after the sequence number
+    uint8_t key[32];
+    for (int i = 0; i < 32; ++i) key[i] = (uint8_t)(0x80 + i);
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize_control(buffer, len, dest, src, RNS_HEADER_TYPE_ACK, RNS_CONTEXT_ACK,
+                                                        7, 0, key, sizeof(key)));
+    TEST_ASSERT_TRUE(ReticulumPacket::deserializeLink(buffer, len, info));
+    TEST_ASSERT_EQUAL_UINT8(RNS_HEADER_TYPE_ACK, info.header_type);
+    TEST_ASSERT_EQUAL_UINT16(0, info.sequence_number);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(key), info.data.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(key, info.data.data(), sizeof(key));
+
+    // Official packets are never taken for link frames
+    std::vector<uint8_t> data(40, 0xA1);
+    uint8_t dest_hash[16];
+    memset(dest_hash, 8, sizeof(dest_hash));
+    TEST_ASSERT_TRUE(ReticulumPacket::serialize(buffer, len, dest_hash, RNS_PACKET_DATA, RNS_DEST_SINGLE,
+                                                RNS_PROPAGATION_BROADCAST, RNS_CONTEXT_NONE, 5, data));
+    TEST_ASSERT_FALSE(ReticulumPacket::isLinkFrame(buffer, len));
+    TEST_ASSERT_FALSE(ReticulumPacket::isLinkFrame(buffer, RNS_LEGACY_HEADER_SIZE));
+}
+
 void setup() {
     delay(2000);
     UNITY_BEGIN();
     RUN_TEST(test_serialize_deserialize_roundtrip);
+    RUN_TEST(test_header2_roundtrip);
+    RUN_TEST(test_link_frame_roundtrip);
     UNITY_END();
 }
 
@@ -0,0 +1,108 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "RoutingTable.h"
+
+static const uint8_t DEST[RNS_ADDRESS_SIZE] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+static const uint8_t MAC_A[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0A};
+static const uint8_t MAC_B[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x0B};
+
+static RnsPacketInfo announceFrom(uint8_t hops) {
+    RnsPacketInfo info;
+    memcpy(info.source, DEST, RNS_ADDRESS_SIZE);
+    info.hops = hops;
+    return info;
+}
+
+void test_fast_interface_preferred_at_equal_hops() {
+    RoutingTable table;
+    table.update(announceFrom(1), InterfaceType::LORA, nullptr, IPAddress(), 0, nullptr, 1.0f);
+    table.update(announceFrom(1), InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0);
+    RouteEntry* route = table.findRoute(DEST);
+    TEST_ASSERT_NOT_NULL(route);
+    TEST_ASSERT_EQUAL(2, route->candidate_count);
+    TEST_ASSERT_TRUE(route->interface == InterfaceType::ESP_NOW);
+}
+
+void test_hysteresis_keeps_active_route() {
+    RoutingTable table;
+    table.update(announceFrom(2), InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0);
+    table.update(announceFrom(2), InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0);
+    RouteEntry* route = table.findRoute(DEST);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, route->next_hop_mac, 6); // Equal cost: no switch
+    table.update(announceFrom(0), InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_B, route->next_hop_mac, 6); // Clearly better: switch
+}
+
+void test_delivery_failures_move_route() {
+    RoutingTable table;
+    table.update(announceFrom(1), InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0);
+    table.update(announceFrom(2), InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0);
+    RouteEntry* route = table.findRoute(DEST);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, route->next_hop_mac, 6);
+    for (uint8_t i = 0; i < ROUTE_FAILOVER_FAILURES; i++) table.reportDelivery(DEST, false);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_B, route->next_hop_mac, 6);
+}
+
+void test_send_failures_fail_over_immediately() {
+    RoutingTable table;
+    table.update(announceFrom(1), InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0);
+    table.update(announceFrom(3), InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0);
+    RouteEntry* route = table.findRoute(DEST);
+    for (uint8_t i = 0; i < ROUTE_FAILOVER_FAILURES; i++) {
+        table.reportNextHopResult(InterfaceType::ESP_NOW, MAC_A, IPAddress(), false);
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_B, route->next_hop_mac, 6); // Backup promoted despite more hops
+    TEST_ASSERT_NULL(table.findSplitCandidate(DEST)); // Same interface: nothing to split over
+}
+
+void test_age_cost_follows_configured_timeout() {
+    RouteCandidate candidate = {};
+    candidate.interface = InterfaceType::ESP_NOW;
+    candidate.hops = 1;
+    candidate.link_quality = ROUTE_LINK_QUALITY_UNKNOWN;
+    candidate.delivery_ratio = 1.0f;
+    candidate.last_heard_time = 0;
+
+    RoutingTable standard, shortLived;
+    unsigned long timeout = ROUTE_TIMEOUT_MS / 4;
+    shortLived.setLimits(MAX_ROUTES, timeout);
+    float fresh = standard.candidateCost(candidate, 0);
+    TEST_ASSERT_EQUAL_FLOAT(fresh, shortLived.candidateCost(candidate, 0));
+    // Heard a whole (configured) timeout ago: the full age penalty, not a quarter of it
+    TEST_ASSERT_EQUAL_FLOAT(fresh + ROUTE_COST_AGE_WEIGHT, shortLived.candidateCost(candidate, timeout));
+    TEST_ASSERT_EQUAL_FLOAT(fresh + ROUTE_COST_AGE_WEIGHT * timeout / ROUTE_TIMEOUT_MS, standard.candidateCost(candidate, timeout));
+}
+
+void test_export_import_restores_active_route() {
+    RoutingTable saved;
+    saved.update(announceFrom(1), InterfaceType::ESP_NOW, MAC_A, IPAddress(), 0);
+    saved.update(announceFrom(3), InterfaceType::ESP_NOW, MAC_B, IPAddress(), 0);
+    uint8_t buffer[MAX_ROUTES * RoutingTable::EXPORT_RECORD_SIZE];
+    size_t len = saved.exportRoutes(buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_UINT(RoutingTable::EXPORT_RECORD_SIZE, len); // Backups are not saved
+    TEST_ASSERT_EQUAL_UINT(0, saved.exportRoutes(buffer, len - 1));
+    len = saved.exportRoutes(buffer, sizeof(buffer));
+
+    RoutingTable restored;
+    TEST_ASSERT_EQUAL_UINT(1, restored.importRoutes(buffer, len));
+    RouteEntry* route = restored.findRoute(DEST);
+    TEST_ASSERT_NOT_NULL(route);
+    TEST_ASSERT_TRUE(route->interface == InterfaceType::ESP_NOW);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(MAC_A, route->next_hop_mac, 6);
+    TEST_ASSERT_EQUAL(1, route->hops);
+    TEST_ASSERT_EQUAL_UINT(0, restored.importRoutes(buffer, len)); // Already known
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_interface_preferred_at_equal_hops);
+    RUN_TEST(test_hysteresis_keeps_active_route);
+    RUN_TEST(test_delivery_failures_move_route);
+    RUN_TEST(test_send_failures_fail_over_immediately);
+    RUN_TEST(test_age_cost_follows_configured_timeout);
+    RUN_TEST(test_export_import_restores_active_route);
+    UNITY_END();
+}
+
+void loop() {}
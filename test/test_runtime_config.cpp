@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "RuntimeConfig.h"
+
+void test_defaults_come_from_config_h() {
+    RuntimeConfig config;
+    TEST_ASSERT_EQUAL_UINT32(ANNOUNCE_INTERVAL_MS, config.getAnnounceIntervalMs());
+    TEST_ASSERT_EQUAL_UINT32(ROUTE_TIMEOUT_MS, config.getRouteTimeoutMs());
+    TEST_ASSERT_EQUAL_UINT(MAX_ROUTES, config.getMaxRoutes());
+    TEST_ASSERT_EQUAL_UINT(0, config.getInterfaceMtu(InterfaceType::ESP_NOW));
+    TEST_ASSERT_FALSE(config.hasApiToken());
+    TEST_ASSERT_NULL(config.getOtaPublicKey());
+}
+
+void test_announce_interval_and_route_limits() {
+    RuntimeConfig config;
+    TEST_ASSERT_FALSE(config.setAnnounceInterval(ANNOUNCE_INTERVAL_MIN_MS - 1));
+    TEST_ASSERT_TRUE(config.setAnnounceInterval(60000));
+    TEST_ASSERT_EQUAL_UINT32(60000 * 3 + 15000, config.getRouteTimeoutMs()); // Follows the interval
+
+    TEST_ASSERT_FALSE(config.setRouteLimits(0, 300000));
+    TEST_ASSERT_FALSE(config.setRouteLimits(MAX_ROUTES + 1, 300000));
+    TEST_ASSERT_FALSE(config.setRouteLimits(10, 60000)); // Not above the announce interval
+    TEST_ASSERT_TRUE(config.setRouteLimits(10, 300000));
+    TEST_ASSERT_EQUAL_UINT(10, config.getMaxRoutes());
+
+    TEST_ASSERT_TRUE(config.setAnnounceInterval(90000));
+    TEST_ASSERT_EQUAL_UINT32(300000, config.getRouteTimeoutMs()); // Set explicitly, kept
+}
+
+void test_token_key_and_mtu_validation() {
+    RuntimeConfig config;
+    TEST_ASSERT_TRUE(config.setApiToken("  secret\t"));
+    TEST_ASSERT_EQUAL_STRING("secret", config.getApiToken());
+    TEST_ASSERT_TRUE(config.setApiToken(""));
+    TEST_ASSERT_FALSE(config.hasApiToken());
+
+    TEST_ASSERT_FALSE(config.setOtaPublicKeyHex("abcd"));
+    TEST_ASSERT_FALSE(config.setOtaPublicKeyHex("zz00000000000000000000000000000000000000000000000000000000000000"));
+    TEST_ASSERT_NULL(config.getOtaPublicKey());
+    TEST_ASSERT_TRUE(config.setOtaPublicKeyHex("0aFF000000000000000000000000000000000000000000000000000000000001"));
+    const uint8_t* key = config.getOtaPublicKey();
+    TEST_ASSERT_NOT_NULL(key);
+    TEST_ASSERT_EQUAL_UINT8(0x0A, key[0]);
+    TEST_ASSERT_EQUAL_UINT8(0xFF, key[1]);
+    TEST_ASSERT_EQUAL_UINT8(0x01, key[31]);
+
+    TEST_ASSERT_FALSE(config.setInterfaceMtu(InterfaceType::WIFI_UDP, 10)); // Below a header
+    TEST_ASSERT_TRUE(config.setInterfaceMtu(InterfaceType::WIFI_UDP, 200));
+    TEST_ASSERT_EQUAL_UINT(200, config.getInterfaceMtu(InterfaceType::WIFI_UDP));
+    TEST_ASSERT_FALSE(config.setInterfaceMtu(InterfaceType::SERIAL_PORT, 200)); // Not tunable
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_defaults_come_from_config_h);
+    RUN_TEST(test_announce_interval_and_route_limits);
+    RUN_TEST(test_token_key_and_mtu_validation);
+    UNITY_END();
+}
+
+void loop() {}
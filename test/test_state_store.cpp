@@ -0,0 +1,92 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Preferences.h>
+#include <cstring>
+#include "StateStore.h"
+
+static const char* TEST_NAMESPACE = "rns_test"; // Leaves the node's own state alone
+
+static void eraseTestState() {
+    Preferences prefs;
+    prefs.begin(TEST_NAMESPACE, false);
+    prefs.clear();
+    prefs.end();
+}
+
+void test_packet_ids_not_reused_after_reboot() {
+    eraseTestState();
+    uint16_t last = 0;
+    uint32_t commits = 0;
+    {
+        StateStore store(TEST_NAMESPACE);
+        TEST_ASSERT_TRUE(store.begin());
+        store.beginPacketIds(0xFF00); // Wraps during the run
+        for (int i = 0; i < 3000; i++) last = store.nextPacketId();
+        store.flush();
+        commits = store.getCommitCount();
+    }
+    // One write at boot, then one per half block
+    TEST_ASSERT_TRUE(commits <= 1 + 3000 / (PACKET_ID_BLOCK / 2));
+
+    StateStore rebooted(TEST_NAMESPACE);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    rebooted.beginPacketIds(0);
+    uint16_t next = rebooted.nextPacketId();
+    TEST_ASSERT_TRUE((int16_t)(next - last) > 0);
+    TEST_ASSERT_TRUE((uint16_t)(next - last) <= PACKET_ID_BLOCK);
+}
+
+void test_records_round_trip_and_skip_unchanged() {
+    eraseTestState();
+    uint8_t snapshot[100];
+    for (size_t i = 0; i < sizeof(snapshot); i++) snapshot[i] = (uint8_t)(i * 7);
+    {
+        StateStore store(TEST_NAMESPACE);
+        store.begin();
+        TEST_ASSERT_TRUE(store.stage(StateStore::Record::SNAPSHOT, snapshot, sizeof(snapshot)));
+        store.flush();
+    }
+
+    StateStore store(TEST_NAMESPACE);
+    store.begin();
+    size_t loaded = 0;
+    TEST_ASSERT_TRUE(store.loadWith(StateStore::Record::SNAPSHOT, [&](const uint8_t* data, size_t len) {
+        loaded = len;
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(snapshot, data, len);
+    }));
+    TEST_ASSERT_EQUAL_UINT(sizeof(snapshot), loaded);
+    uint8_t small[8];
+    TEST_ASSERT_EQUAL_UINT(0, store.load(StateStore::Record::SNAPSHOT, small, sizeof(small))); // Does not fit
+
+    // Same content again: not rewritten
+    store.stage(StateStore::Record::SNAPSHOT, snapshot, sizeof(snapshot));
+    store.flush();
+    TEST_ASSERT_EQUAL_UINT32(0, store.getCommitCount());
+    TEST_ASSERT_EQUAL_UINT32(1, store.getUnchangedCount());
+    snapshot[0] ^= 0xFF;
+    store.stage(StateStore::Record::SNAPSHOT, snapshot, sizeof(snapshot));
+    store.flush();
+    TEST_ASSERT_EQUAL_UINT32(1, store.getCommitCount());
+}
+
+void test_oversized_record_rejected() {
+    eraseTestState();
+    StateStore store(TEST_NAMESPACE);
+    store.begin();
+    uint8_t address[RNS_ADDRESS_SIZE + 1] = {0};
+    TEST_ASSERT_FALSE(store.stage(StateStore::Record::ADDRESS, address, sizeof(address)));
+    TEST_ASSERT_TRUE(store.stage(StateStore::Record::ADDRESS, address, RNS_ADDRESS_SIZE));
+    store.flush();
+    eraseTestState();
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_packet_ids_not_reused_after_reboot);
+    RUN_TEST(test_records_round_trip_and_skip_unchanged);
+    RUN_TEST(test_oversized_record_rejected);
+    UNITY_END();
+}
+
+void loop() {}
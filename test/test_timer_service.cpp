@@ -0,0 +1,105 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <climits>
+#include <vector>
+#include "TimerService.h"
+
+void test_fires_in_deadline_order() {
+    TimerService timers;
+    std::vector<int> order;
+    timers.schedule(30, [&]() { order.push_back(3); }, 0);
+    timers.schedule(10, [&]() { order.push_back(1); }, 0);
+    timers.schedule(20, [&]() { order.push_back(2); }, 0);
+    TEST_ASSERT_EQUAL_UINT32(10, timers.msUntilNext(0));
+
+    TEST_ASSERT_EQUAL(0, timers.runExpired(9));
+    TEST_ASSERT_EQUAL(1, timers.runExpired(10));
+    TEST_ASSERT_EQUAL(2, timers.runExpired(100));
+    TEST_ASSERT_EQUAL(3, order.size());
+    for (int i = 0; i < 3; i++) TEST_ASSERT_EQUAL(i + 1, order[i]);
+    TEST_ASSERT_EQUAL(0, timers.getPendingCount());
+    TEST_ASSERT_TRUE(timers.msUntilNext(100) == ULONG_MAX);
+}
+
+void test_periodic_rearms_with_same_id() {
+    TimerService timers;
+    int fired = 0;
+    TimerService::TimerId id = timers.schedulePeriodic(100, [&]() { fired++; }, 0);
+    TEST_ASSERT_EQUAL(1, timers.runExpired(100));
+    TEST_ASSERT_TRUE(timers.isPending(id));
+    TEST_ASSERT_EQUAL_UINT32(100, timers.msUntilNext(100)); // Re-armed from the firing time
+    TEST_ASSERT_EQUAL(0, timers.runExpired(199));
+    TEST_ASSERT_EQUAL(1, timers.runExpired(200));
+    TEST_ASSERT_EQUAL(2, fired);
+
+    timers.cancel(id);
+    TEST_ASSERT_FALSE(timers.isPending(id));
+    TEST_ASSERT_EQUAL(0, timers.runExpired(1000));
+}
+
+void test_cancel_and_reschedule_from_callback() {
+    TimerService timers;
+    int periodicFired = 0, laterFired = 0, replacementFired = 0;
+    TimerService::TimerId periodic = TimerService::INVALID_TIMER;
+    TimerService::TimerId later = timers.schedule(50, [&]() { laterFired++; }, 0);
+    // A periodic timer cancelling itself is not re-armed
+    periodic = timers.schedulePeriodic(10, [&]() { periodicFired++; timers.cancel(periodic); }, 0);
+    // A timer moving another one's deadline from inside its callback
+    timers.schedule(20, [&]() {
+        later = timers.reschedule(later, 100, [&]() { replacementFired++; }, 20);
+    }, 0);
+
+    TEST_ASSERT_EQUAL(2, timers.runExpired(60));
+    TEST_ASSERT_EQUAL(1, periodicFired);
+    TEST_ASSERT_FALSE(timers.isPending(periodic));
+    TEST_ASSERT_EQUAL(0, laterFired); // Its old deadline passed, but it was replaced
+    TEST_ASSERT_TRUE(timers.isPending(later));
+    TEST_ASSERT_EQUAL(1, timers.runExpired(120));
+    TEST_ASSERT_EQUAL(1, replacementFired);
+    TEST_ASSERT_EQUAL(0, laterFired);
+    TEST_ASSERT_EQUAL(0, timers.getPendingCount());
+}
+
+void test_run_expired_budget() {
+    TimerService timers;
+    int fired = 0;
+    // Re-arms itself with zero delay: must not keep the pass going forever
+    std::function<void()> again = [&]() { fired++; timers.schedule(0, again, 0); };
+    timers.schedule(0, again, 0);
+    timers.schedule(0, [&]() { fired++; }, 0);
+    TEST_ASSERT_EQUAL(2, timers.runExpired(0)); // Budget is the count pending when the pass started
+    TEST_ASSERT_EQUAL(2, fired);
+    TEST_ASSERT_EQUAL(1, timers.getPendingCount());
+    TEST_ASSERT_EQUAL(1, timers.runExpired(0));
+}
+
+void test_deadlines_across_millis_wrap() {
+    TimerService timers;
+    std::vector<int> order;
+    unsigned long now = ULONG_MAX - 15;
+    timers.schedule(30, [&]() { order.push_back(2); }, now); // Deadline wraps to 14
+    timers.schedule(10, [&]() { order.push_back(1); }, now); // Deadline ULONG_MAX - 5
+    TEST_ASSERT_EQUAL_UINT32(10, timers.msUntilNext(now));
+
+    TEST_ASSERT_EQUAL(0, timers.runExpired(now + 9));
+    TEST_ASSERT_EQUAL(1, timers.runExpired(now + 10));
+    TEST_ASSERT_EQUAL_UINT32(20, timers.msUntilNext(now + 10));
+    TEST_ASSERT_EQUAL(0, timers.runExpired(now + 29)); // 13 after the wrap: still early
+    TEST_ASSERT_EQUAL(1, timers.runExpired(now + 30));
+    TEST_ASSERT_EQUAL(2, order.size());
+    TEST_ASSERT_EQUAL(1, order[0]);
+    TEST_ASSERT_EQUAL(2, order[1]);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_in_deadline_order);
+    RUN_TEST(test_periodic_rearms_with_same_id);
+    RUN_TEST(test_cancel_and_reschedule_from_callback);
+    RUN_TEST(test_run_expired_budget);
+    RUN_TEST(test_deadlines_across_millis_wrap);
+    UNITY_END();
+}
+
+void loop() {}
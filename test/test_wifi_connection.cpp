@@ -0,0 +1,107 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <climits>
+#include "WiFiConnection.h"
+
+void test_backoff_doubles_and_caps() {
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MIN_MS, WiFiConnection::backoffDelay(1));
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MIN_MS * 2, WiFiConnection::backoffDelay(2));
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MIN_MS * 4, WiFiConnection::backoffDelay(3));
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MAX_MS, WiFiConnection::backoffDelay(40));
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MAX_MS, WiFiConnection::backoffDelay(255));
+}
+
+void test_connect_attaches_on_ip() {
+    WiFiConnection wifi;
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_CONNECT, wifi.begin(1000));
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_NONE, wifi.poll(1500));
+    TEST_ASSERT_FALSE(wifi.isConnected());
+    TEST_ASSERT_EQUAL_UINT32(WIFI_CONNECT_TIMEOUT_MS - 500, wifi.msUntilDeadline(1500));
+
+    wifi.post(WiFiConnection::EVENT_GOT_IP);
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_ATTACH, wifi.poll(3000));
+    TEST_ASSERT_TRUE(wifi.isConnected());
+    TEST_ASSERT_EQUAL_UINT32(3000, wifi.getFirstConnectMs());
+    TEST_ASSERT_EQUAL_UINT32(1, wifi.getConnectCount());
+    TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, wifi.msUntilDeadline(3000));
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_NONE, wifi.poll(3000 + WIFI_CONNECT_TIMEOUT_MS * 2));
+}
+
+void test_failed_attempts_back_off() {
+    WiFiConnection wifi;
+    wifi.begin(0);
+    wifi.post(WiFiConnection::EVENT_DISCONNECTED); // e.g. AP not found
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_DISCONNECT, wifi.poll(100));
+    TEST_ASSERT_TRUE(wifi.getState() == WiFiConnection::State::BACKOFF);
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MIN_MS, wifi.msUntilDeadline(100));
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_NONE, wifi.poll(99 + WIFI_RECONNECT_MIN_MS));
+
+    unsigned long now = 100 + WIFI_RECONNECT_MIN_MS;
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_CONNECT, wifi.poll(now));
+    TEST_ASSERT_EQUAL_UINT32(2, wifi.getAttemptCount());
+
+    // No event at all: the attempt times out, is dropped, and the next wait is doubled
+    now += WIFI_CONNECT_TIMEOUT_MS;
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_DISCONNECT, wifi.poll(now));
+    TEST_ASSERT_EQUAL_UINT8(2, wifi.getFailureStreak());
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MIN_MS * 2, wifi.msUntilDeadline(now));
+
+    // A stale disconnect while waiting changes nothing
+    wifi.post(WiFiConnection::EVENT_DISCONNECTED);
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_NONE, wifi.poll(now + 1));
+    TEST_ASSERT_EQUAL_UINT8(2, wifi.getFailureStreak());
+}
+
+void test_lost_connection_detaches_and_retries_soon() {
+    WiFiConnection wifi;
+    wifi.begin(0);
+    wifi.post(WiFiConnection::EVENT_GOT_IP);
+    wifi.poll(10);
+
+    wifi.post(WiFiConnection::EVENT_DISCONNECTED);
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_DETACH | WiFiConnection::ACTION_DISCONNECT, wifi.poll(5000));
+    TEST_ASSERT_FALSE(wifi.isConnected());
+    TEST_ASSERT_EQUAL_UINT32(1, wifi.getDisconnectCount());
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RECONNECT_MIN_MS, wifi.msUntilDeadline(5000));
+
+    // Reported down then up again before the loop ran: detach and attach in one go
+    wifi.post(WiFiConnection::EVENT_GOT_IP);
+    wifi.poll(5001);
+    wifi.post(WiFiConnection::EVENT_LOST_IP);
+    wifi.post(WiFiConnection::EVENT_GOT_IP);
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_DETACH | WiFiConnection::ACTION_ATTACH, wifi.poll(6000));
+    TEST_ASSERT_TRUE(wifi.isConnected());
+    TEST_ASSERT_EQUAL_UINT32(10, wifi.getFirstConnectMs()); // First connect is kept
+}
+
+void test_stop_goes_idle() {
+    WiFiConnection wifi;
+    wifi.begin(0);
+    wifi.post(WiFiConnection::EVENT_GOT_IP);
+    wifi.poll(10);
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_DETACH | WiFiConnection::ACTION_DISCONNECT, wifi.stop());
+    TEST_ASSERT_TRUE(wifi.getState() == WiFiConnection::State::IDLE);
+    // Its disconnect event and any amount of time start no attempt
+    wifi.post(WiFiConnection::EVENT_DISCONNECTED);
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_NONE, wifi.poll(20));
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_NONE, wifi.poll(20 + WIFI_RECONNECT_MAX_MS * 2));
+    TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, wifi.msUntilDeadline(20));
+    TEST_ASSERT_EQUAL_UINT32(1, wifi.getAttemptCount());
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_NONE, wifi.stop()); // Already idle
+
+    TEST_ASSERT_EQUAL_UINT8(WiFiConnection::ACTION_CONNECT, wifi.begin(100000));
+    TEST_ASSERT_TRUE(wifi.getState() == WiFiConnection::State::CONNECTING);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_backoff_doubles_and_caps);
+    RUN_TEST(test_connect_attaches_on_ip);
+    RUN_TEST(test_failed_attempts_back_off);
+    RUN_TEST(test_lost_connection_detaches_and_retries_soon);
+    RUN_TEST(test_stop_goes_idle);
+    UNITY_END();
+}
+
+void loop() {}